@@ -34,7 +34,17 @@
 // includes
 #include "gensvm_sparse.h"
 
+/**
+ * Number of rows in a single block of the data matrix, for the Z'*A*Z
+ * calculation in gensvm_get_ZAZ_ZB() and for streaming the data (see
+ * gensvm_stream.c).
+ */
+#ifndef GENSVM_BLOCK_SIZE
+  #define GENSVM_BLOCK_SIZE 512
+#endif
+
 // type declarations
+struct GenFileMap;
 
 /**
  * @brief A structure to represent the data.
@@ -52,6 +62,10 @@
  * @param gamma 	kernel parameter for RBF, poly, and sigmoid
  * @param coef 		kernel parameter for poly and sigmoid
  * @param degree 	kernel parameter for poly
+ * @param is_view 	whether the arrays belong to another GenData
+ * @param map 		memory map with the arrays of a binary data file
+ * @param out_of_core 	whether the rows of the data matrix in the memory
+ * 			map are released after use
  *
  */
 struct GenData {
@@ -83,6 +97,14 @@ struct GenData {
 	///< kernel parameter for poly and sigmoid
 	double degree;
 	///< kernel parameter for poly
+	bool is_view;
+	///< whether y, RAW and the arrays of spZ belong to another GenData
+	struct GenFileMap *map;
+	///< memory map of a binary data file that holds y, RAW or the arrays
+	///< of spZ, or NULL
+	bool out_of_core;
+	///< whether the rows of the data matrix in the memory map are released
+	///< after use, see gensvm_stream.c
 };
 
 /**
@@ -144,11 +166,25 @@ struct GenModel {
 	///< status of the model after training
 	long seed;
 	///< seed for the random number generator (-1 = random)
+	double temperature;
+	///< temperature of the softmax over the negative distances to the
+	///< simplex vertices, see gensvm_predict_softmax()
+	struct GenFileMap *map;
+	///< memory map of a binary model file that holds V, or NULL
 };
 
 /**
  * @brief A structure to hold the GenSVM workspace
  *
+ * @details
+ * If GenWork::arena is not NULL, the workspace and its matrices are taken
+ * from this arena, and they are given back by releasing or resetting the
+ * arena instead of by gensvm_free_work().
+ *
+ * The matrices with m+1 columns are stored with the leading dimension
+ * GenWork::ld, which is padded such that every row starts on a cache line
+ * (see gensvm_padded_ld()). All matrices are aligned to #GENSVM_ALIGN
+ * bytes.
  */
 struct GenWork {
 	long n;
@@ -157,9 +193,12 @@ struct GenWork {
 	///< number of features for the workspace
 	long K;
 	///< number of classes for the workspace
+	long ld;
+	///< leading dimension of LZ, ZBc, ZAZ and tmpZAZ, at least m+1
 
 	double *LZ;
-	///< n x (m+1) working matrix for the Z'*A*Z calculation
+	///< #GENSVM_BLOCK_SIZE x (m+1) working matrix for the Z'*A*Z
+	///< calculation
 	double *ZB;
 	///< (m+1) x (K-1) working matrix for the Z'*B calculation
 	double *ZBc;
@@ -174,6 +213,8 @@ struct GenWork {
 	///< K-1 working vector for a row of the B matrix
 	long *yhat;
 	///< n vector of predicted classes
+	struct GenArena *arena;
+	///< arena the workspace is taken from, or NULL
 };
 
 // function declarations
@@ -184,8 +225,12 @@ void gensvm_free_model(struct GenModel *model);
 
 struct GenData *gensvm_init_data(void);
 void gensvm_free_data(struct GenData *data);
+void gensvm_data_to_dense(struct GenData *data);
 
 struct GenWork *gensvm_init_work(struct GenModel *model);
+struct GenWork *gensvm_init_work_arena(struct GenModel *model,
+		struct GenArena *arena);
+size_t gensvm_work_size(long n, long m, long K);
 void gensvm_free_work(struct GenWork *work);
 void gensvm_reset_work(struct GenWork *work);
 
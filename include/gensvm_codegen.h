@@ -0,0 +1,56 @@
+/**
+ * @file gensvm_codegen.h
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Header file for gensvm_codegen.c
+ *
+ * @details
+ * Contains the function declarations for generating a standalone C
+ * predictor from a trained model.
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef GENSVM_CODEGEN_H
+#define GENSVM_CODEGEN_H
+
+// includes
+#include "gensvm_simplex.h"
+#include "gensvm_print.h"
+
+/**
+ * Largest number of terms of a product that is written out in full in the
+ * generated code, larger products are written as a loop
+ */
+#ifndef GENSVM_CODEGEN_MAX_UNROLL
+  #define GENSVM_CODEGEN_MAX_UNROLL 1024
+#endif
+
+/**
+ * Maximum length of the prefix of the generated functions
+ */
+#define GENSVM_CODEGEN_MAX_PREFIX 64
+
+// function declarations
+void gensvm_codegen_prefix(const char *filename, char *prefix);
+void gensvm_write_model_c(struct GenModel *model, char *output_filename,
+		const char *prefix);
+
+#endif
@@ -0,0 +1,63 @@
+/**
+ * @file gensvm_compact.h
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Header file for gensvm_compact.c
+ *
+ * @details
+ * Contains the structure and function declarations for expressing a kernel
+ * model in terms of a reduced set of training instances.
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef GENSVM_COMPACT_H
+#define GENSVM_COMPACT_H
+
+// includes
+#include "gensvm_kernel.h"
+#include "gensvm_parse.h"
+#include "gensvm_print.h"
+#include "gensvm_simplex.h"
+
+/**
+ * @brief A candidate training instance for the reduced set
+ *
+ * @param idx 		index of the instance in the training data
+ * @param sv 		whether the instance is a support vector
+ * @param weight 	squared norm of the coefficients of the instance
+ */
+struct GenCompactRow {
+	long idx;
+	///< index of the instance in the training data
+	bool sv;
+	///< whether the instance is a support vector
+	double weight;
+	///< squared norm of the coefficients of the instance
+};
+
+// function declarations
+double gensvm_compact(struct GenModel *model, struct GenData *traindata,
+		struct GenData *support, double tolerance);
+
+int dgelsy(int M, int N, int NRHS, double *A, int LDA, double *B, int LDB,
+		int *JPVT, double RCOND, int *RANK, double *WORK, int LWORK);
+
+#endif
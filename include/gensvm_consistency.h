@@ -32,13 +32,115 @@
 #include "gensvm_print.h"
 #include "gensvm_cv_util.h"
 #include "gensvm_cross_validation.h"
+#include "gensvm_gridsearch.h"
 #include "gensvm_timer.h"
 
+#include <pthread.h>
+#include <unistd.h>
+
+/**
+ * Largest number of kernels that a consistency repeat keeps for its folds.
+ * A kernel is only recomputed when none of the kept kernels has the
+ * parameters of the task. Fewer kernels are kept if they don't fit in the
+ * memory limit, see gensvm_repeats_cache_size().
+ */
+#define GENSVM_KERNEL_CACHE_SIZE 4
+
+/**
+ * @brief Shared state of the consistency repeats
+ *
+ * @param q 		queue with the tasks to repeat
+ * @param repeats 	number of repeats
+ * @param n_threads 	number of threads running the repeats
+ * @param cache_size 	number of kernels in the kernel cache of every
+ * 			repeat
+ * @param ctx 		silent GenContext used by the repeats
+ * @param seed 		seed from which the generators of the repeats are
+ * 			derived
+ * @param cv_idx 	cross validation split of every repeat (repeats x n)
+ * @param V 		initial GenModel::V of every repeat
+ * @param perf 		performance of every task and repeat (N x repeats)
+ * @param time 		training time of every task and repeat (N x repeats)
+ */
+struct GenRepeats {
+	struct GenQueue *q;
+	///< queue with the tasks to repeat
+	long repeats;
+	///< number of repeats
+	long n_threads;
+	///< number of threads running the repeats
+	long cache_size;
+	///< number of kernels in the kernel cache of every repeat
+	struct GenContext *ctx;
+	///< silent GenContext used by the repeats
+	uint64_t seed;
+	///< seed from which the generators of the repeats are derived
+	long *cv_idx;
+	///< cross validation split of every repeat (repeats x n)
+	double *V;
+	///< initial GenModel::V of every repeat
+	double *perf;
+	///< performance of every task and repeat (N x repeats)
+	double *time;
+	///< training time of every task and repeat (N x repeats)
+};
+
+/**
+ * @brief Kernel of the folds of a consistency repeat
+ *
+ * @details
+ * An entry of the kernel cache of gensvm_consistency_repeat(). The train and
+ * test folds are views on the fold data of the repeat, of which the data
+ * matrices are replaced by the kernel with the parameters of
+ * GenKernelFolds::task.
+ *
+ * @param task 		task with the kernel parameters, NULL if unused
+ * @param train_folds 	train folds with the kernel
+ * @param test_folds 	test folds with the kernel
+ * @param used 		index of the task that last used the kernel
+ */
+struct GenKernelFolds {
+	struct GenTask *task;
+	///< task with the kernel parameters, NULL if unused
+	struct GenData **train_folds;
+	///< train folds with the kernel
+	struct GenData **test_folds;
+	///< test folds with the kernel
+	long used;
+	///< index of the task that last used the kernel
+};
+
+/**
+ * @brief Argument of a thread running consistency repeats
+ *
+ * @param reps 	the shared GenRepeats
+ * @param id 	index of the thread
+ */
+struct GenRepeatThread {
+	struct GenRepeats *reps;
+	///< the shared GenRepeats
+	long id;
+	///< index of the thread
+};
+
 // function declarations
-struct GenQueue *gensvm_top_queue(struct GenQueue *q, double percentile);
+struct GenQueue *gensvm_top_queue(struct GenQueue *q, double percentile,
+		struct GenContext *ctx);
 int gensvm_dsort(const void *elem1, const void *elem2);
+struct GenKernelFolds *gensvm_kernel_cache_get(struct GenKernelFolds *cache,
+		long cache_size, struct GenTask *task, struct GenModel *model,
+		long folds, long i, struct GenContext *ctx);
+size_t gensvm_repeats_memory(struct GenQueue *nq, long n_threads,
+		long cache_size);
+long gensvm_repeats_cache_size(struct GenQueue *nq, long *n_threads);
+void gensvm_consistency_repeat(struct GenRepeats *reps, long r);
+void *gensvm_consistency_thread(void *arg);
+struct GenRepeats *gensvm_init_repeats(struct GenQueue *nq, long repeats,
+		struct GenContext *ctx);
+void gensvm_run_repeats(struct GenRepeats *reps, struct GenContext *ctx);
+void gensvm_free_repeats(struct GenRepeats *reps);
 int gensvm_consistency_repeats(struct GenQueue *q, long repeats,
-		double percentile);
+		double percentile, struct GenContext *ctx);
 double gensvm_percentile(double *values, long N, double p);
 
 #endif
@@ -0,0 +1,88 @@
+/**
+ * @file gensvm_context.h
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Header file for gensvm_context.c
+ *
+ * @details
+ * Contains the structure definition of the library context and the
+ * declarations of the functions that write output and draw random numbers
+ * through a context.
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef GENSVM_CONTEXT_H
+#define GENSVM_CONTEXT_H
+
+// includes
+#include "gensvm_print.h"
+#include "gensvm_rand.h"
+
+#include <unistd.h>
+
+/**
+ * @brief State of the library used while training models
+ *
+ * @details
+ * The context holds the state that would otherwise be global: the output
+ * streams, the random number generator, the number of threads that may be
+ * used, and an optional arena for temporary arrays. Functions that take a
+ * GenContext only use the state in the context, such that several models can
+ * be trained concurrently in one process, each with their own context.
+ *
+ * A NULL context can be passed to any function that takes a GenContext. In
+ * that case the global streams #GENSVM_OUTPUT_FILE and #GENSVM_ERROR_FILE
+ * and the generator of rand() are used, as in previous versions.
+ *
+ * @param output 	stream for regular output, NULL to suppress output
+ * @param error 	stream for errors and warnings, NULL to suppress
+ * @param rng 		random number generator of the context
+ * @param n_threads 	maximum number of threads, 0 to use all processors
+ * @param arena 	arena for temporary arrays, not owned by the context,
+ * 			NULL to allocate these arrays separately
+ */
+struct GenContext {
+	FILE *output;
+	///< stream for regular output, NULL to suppress output
+	FILE *error;
+	///< stream for errors and warnings, NULL to suppress
+	struct GenRNG *rng;
+	///< random number generator of the context
+	long n_threads;
+	///< maximum number of threads, 0 to use all processors
+	struct GenArena *arena;
+	///< arena for temporary arrays, NULL to allocate them separately
+};
+
+// function declarations
+struct GenContext *gensvm_init_context(uint64_t seed);
+void gensvm_free_context(struct GenContext *ctx);
+void gensvm_context_silence(struct GenContext *ctx,
+		struct GenContext *quiet);
+void gensvm_note(struct GenContext *ctx, const char *fmt, ...);
+void gensvm_error(struct GenContext *ctx, const char *fmt, ...);
+void gensvm_context_seed(struct GenContext *ctx, uint64_t seed);
+uint64_t gensvm_context_random(struct GenContext *ctx);
+double gensvm_context_uniform(struct GenContext *ctx);
+long gensvm_context_threads(struct GenContext *ctx, long max_threads);
+struct GenArena *gensvm_context_arena(struct GenContext *ctx);
+
+#endif
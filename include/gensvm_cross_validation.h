@@ -34,8 +34,11 @@
 #include "gensvm_predict.h"
 
 // function declarations
+size_t gensvm_cross_validation_size(struct GenModel *model,
+		struct GenData **train_folds, struct GenData **test_folds,
+		long folds);
 double gensvm_cross_validation(struct GenModel *model,
 		struct GenData **train_folds, struct GenData **test_folds,
-		long folds, long n_total);
+		long folds, long n_total, struct GenContext *ctx);
 
 #endif
@@ -32,8 +32,13 @@
 #define GENSVM_CV_UTIL_H
 
 #include "gensvm_base.h"
+#include "gensvm_rand.h"
 
 void gensvm_make_cv_split(long N, long folds, long *cv_idx);
+void gensvm_make_cv_split_rng(long N, long folds, long *cv_idx,
+		struct GenRNG *rng);
+void gensvm_make_stratified_cv_split(long N, long folds, long *y,
+		long *cv_idx, struct GenRNG *rng);
 void gensvm_get_tt_split(struct GenData *full_data, struct GenData *train_data,
 		struct GenData *test_data, long *cv_idx, long fold_idx);
 void gensvm_get_tt_split_dense(struct GenData *full_data,
@@ -42,5 +47,10 @@ void gensvm_get_tt_split_dense(struct GenData *full_data,
 void gensvm_get_tt_split_sparse(struct GenData *full_data,
 		struct GenData *train_data, struct GenData *test_data,
 		long *cv_idx, long fold_idx);
+struct GenData *gensvm_make_fold_data(struct GenData *full_data,
+		long *cv_idx, long folds);
+void gensvm_get_tt_view(struct GenData *fold_data,
+		struct GenData *train_data, struct GenData *test_data,
+		long *cv_idx, long fold_idx);
 
 #endif
@@ -71,6 +71,36 @@ typedef enum {
 	K_SIGMOID=3,  	/**< Sigmoid kernel */
 } KernelType;
 
+/**
+ * @brief type of search used to generate the tasks of a parameter search
+ */
+typedef enum {
+	S_GRID=0, 	/**< full grid of all parameter values */
+	S_RANDOM=1, 	/**< random sampling of the parameter ranges */
+	S_SOBOL=2, 	/**< Sobol sequence over the parameter ranges */
+	S_HALTON=3 	/**< Halton sequence over the parameter ranges */
+} SearchType;
+
+/**
+ * @brief format of a file with predictions
+ */
+typedef enum {
+	P_DATA=0, 	/**< instances followed by their predicted label */
+	P_LABELS=1, 	/**< only the predicted labels */
+	P_DECISION=2, 	/**< predicted labels followed by the decision values */
+	P_DISTANCES=3, 	/**< predicted labels followed by the class distances */
+	P_PROBABILITIES=4 	/**< predicted labels followed by the class scores */
+} PredictionFormat;
+
+/**
+ * @brief type of a quantized representation of a linear model
+ */
+typedef enum {
+	Q_NONE=0, 	/**< no quantization, coefficients in double precision */
+	Q_INT8=1, 	/**< 8-bit integers with a scale for every column */
+	Q_FLOAT16=2 	/**< IEEE 754 half precision floating point */
+} QuantizeType;
+
 // ########################### Global constants ########################### //
 
 /**
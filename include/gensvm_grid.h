@@ -39,11 +39,15 @@
  * @brief Structure for describing the entire grid search
  *
  * @param traintype 		type of training to use
+ * @param search 		type of search to generate the tasks
+ * @param n_tasks 		number of tasks of a random or quasi-random
+ * 				search
  * @param kerneltype 		type of kernel to use throughout training
  * @param repeats 		number of repeats to be done after the grid
  * 				search to find the parameter set with the
  * 				most consistent high performance
  * @param folds 		number of folds in cross validation
+ * @param stratified 		whether to use stratified cross validation
  * @param Np 			size of the array of p values
  * @param Nl 			size of the array of lambda values
  * @param Nk 			size of the array of kappa values
@@ -67,10 +71,16 @@
 struct GenGrid {
 	TrainType traintype;
 	///< type of training to use
+	SearchType search;
+	///< type of search to generate the tasks
+	long n_tasks;
+	///< number of tasks of a random or quasi-random search
 	KernelType kerneltype;
 	///< type of kernel to use throughout training
 	long folds;
 	///< number of folds in cross validation
+	bool stratified;
+	///< whether to use stratified cross validation
 	long repeats;
 	///< number of repeats to be done after the grid search to find the
 	///< parameter set with the most consistent high performance
@@ -37,6 +37,7 @@
 #include "gensvm_cross_validation.h"
 #include "gensvm_cv_util.h"
 #include "gensvm_grid.h"
+#include "gensvm_journal.h"
 #include "gensvm_queue.h"
 #include "gensvm_timer.h"
 
@@ -45,9 +46,11 @@ void gensvm_fill_queue(struct GenGrid *grid, struct GenQueue *queue,
 		struct GenData *train_data, struct GenData *test_data);
 bool gensvm_kernel_changed(struct GenTask *newtask, struct GenTask *oldtask);
 void gensvm_kernel_folds(long folds, struct GenModel *model,
-		struct GenData **train_folds, struct GenData **test_folds);
+		struct GenData **train_folds, struct GenData **test_folds,
+		struct GenContext *ctx);
 void gensvm_gridsearch_progress(struct GenTask *task, long N, double perf,
-		double duration, double current_max);
-void gensvm_train_queue(struct GenQueue *q);
+		double duration, double current_max, struct GenContext *ctx);
+void gensvm_train_queue(struct GenQueue *q, struct GenJournal *journal,
+		struct GenContext *ctx);
 
 #endif
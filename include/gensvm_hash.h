@@ -0,0 +1,48 @@
+/**
+ * @file gensvm_hash.h
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Header file for gensvm_hash.c
+ *
+ * @details
+ * Function declarations for computing non-cryptographic hashes of memory
+ * blocks and datasets.
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef GENSVM_HASH_H
+#define GENSVM_HASH_H
+
+// includes
+#include "gensvm_base.h"
+
+#include <stdint.h>
+
+/**
+ * Initial value of the 64-bit FNV-1a hash (the FNV offset basis)
+ */
+#define GENSVM_HASH_INIT 0xcbf29ce484222325ULL
+
+// function declarations
+uint64_t gensvm_hash_bytes(uint64_t hash, const void *buf, size_t len);
+uint64_t gensvm_hash_data(struct GenData *data);
+
+#endif
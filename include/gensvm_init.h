@@ -32,9 +32,11 @@
 #define GENSVM_INIT_H
 
 #include "gensvm_base.h"
+#include "gensvm_context.h"
+#include "gensvm_stream.h"
 
 void gensvm_init_V(struct GenModel *from_model, struct GenModel *to_model,
-		struct GenData *data);
+		struct GenData *data, struct GenContext *ctx);
 void gensvm_initialize_weights(struct GenData *data, struct GenModel *model);
 
 #endif
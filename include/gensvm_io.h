@@ -32,18 +32,401 @@
 
 // includes
 #include "gensvm_base.h"
+#include "gensvm_context.h"
+#include "gensvm_hash.h"
+#include "gensvm_parse.h"
 #include "gensvm_print.h"
 #include "gensvm_strutil.h"
 
+#include <pthread.h>
+#include <stdint.h>
+
+/**
+ * Minimum number of bytes of a data file per thread of the reader
+ */
+#ifndef GENSVM_READ_CHUNK_SIZE
+  #define GENSVM_READ_CHUNK_SIZE (1 << 22)
+#endif
+
+/**
+ * Number of lines that are sampled to estimate the density of a data file
+ */
+#ifndef GENSVM_READ_SAMPLE_LINES
+  #define GENSVM_READ_SAMPLE_LINES 1024
+#endif
+
+/**
+ * Size in bytes of the output buffer used when writing predictions
+ */
+#ifndef GENSVM_WRITE_BUFFER_SIZE
+  #define GENSVM_WRITE_BUFFER_SIZE (1 << 20)
+#endif
+
+/**
+ * Magic string at the start of a binary data file
+ */
+#define GENSVM_BINARY_MAGIC "GENSVMDB"
+
+/**
+ * Version of the binary data file format
+ */
+#define GENSVM_BINARY_VERSION 1
+
+/**
+ * Byte order mark of a binary data file
+ */
+#define GENSVM_BINARY_BYTE_ORDER 0x01020304
+
+/**
+ * Alignment in bytes of the header and the arrays in a binary data file
+ */
+#define GENSVM_BINARY_ALIGN 64
+
+/**
+ * Flag of a binary data file with class labels
+ */
+#define GENSVM_BINARY_LABELS 1
+
+/**
+ * Flag of a binary data file with a sparse data matrix
+ */
+#define GENSVM_BINARY_SPARSE 2
+
+/**
+ * @brief Header of a binary data file
+ *
+ * @details
+ * See @ref spec_binary_data_file for the file format. The header is exactly
+ * #GENSVM_BINARY_ALIGN bytes long.
+ *
+ * @param magic 	equal to #GENSVM_BINARY_MAGIC
+ * @param version 	version of the file format
+ * @param byte_order 	equal to #GENSVM_BINARY_BYTE_ORDER in the byte order
+ * 			of the machine that wrote the file
+ * @param flags 	combination of #GENSVM_BINARY_LABELS and
+ * 			#GENSVM_BINARY_SPARSE
+ * @param reserved 	unused, set to zero
+ * @param n 		number of instances
+ * @param m 		number of features
+ * @param K 		number of classes
+ * @param nnz 		number of nonzero elements of the sparse matrix,
+ * 			including the column of ones
+ * @param padding 	padding to #GENSVM_BINARY_ALIGN bytes
+ */
+struct GenBinaryHeader {
+	char magic[8];
+	///< equal to #GENSVM_BINARY_MAGIC
+	uint32_t version;
+	///< version of the file format
+	uint32_t byte_order;
+	///< equal to #GENSVM_BINARY_BYTE_ORDER
+	uint32_t flags;
+	///< combination of #GENSVM_BINARY_LABELS and #GENSVM_BINARY_SPARSE
+	uint32_t reserved;
+	///< unused, set to zero
+	int64_t n;
+	///< number of instances
+	int64_t m;
+	///< number of features
+	int64_t K;
+	///< number of classes
+	int64_t nnz;
+	///< number of nonzero elements of the sparse matrix
+	int64_t padding[1];
+	///< padding to #GENSVM_BINARY_ALIGN bytes
+};
+
+/**
+ * Magic string at the start of a binary model file
+ */
+#define GENSVM_BINARY_MODEL_MAGIC "GENSVMMD"
+
+/**
+ * Version of the binary model file format
+ */
+#define GENSVM_BINARY_MODEL_VERSION 1
+
+/**
+ * @brief Header of a binary model file
+ *
+ * @details
+ * See @ref spec_binary_model_file for the file format. The header is a
+ * multiple of #GENSVM_BINARY_ALIGN bytes long.
+ *
+ * @param magic 		equal to #GENSVM_BINARY_MODEL_MAGIC
+ * @param version 		version of the file format
+ * @param byte_order 		equal to #GENSVM_BINARY_BYTE_ORDER in the
+ * 				byte order of the machine that wrote the file
+ * @param weight_idx 		GenModel::weight_idx
+ * @param kerneltype 		GenModel::kerneltype
+ * @param n 			GenModel::n
+ * @param m 			GenModel::m
+ * @param K 			GenModel::K
+ * @param max_iter 		GenModel::max_iter
+ * @param elapsed_iter 		GenModel::elapsed_iter
+ * @param seed 			GenModel::seed
+ * @param name_length 		length of GenModel::data_file
+ * @param p 			GenModel::p
+ * @param lambda 		GenModel::lambda
+ * @param kappa 		GenModel::kappa
+ * @param epsilon 		GenModel::epsilon
+ * @param gamma 		GenModel::gamma
+ * @param coef 			GenModel::coef
+ * @param degree 		GenModel::degree
+ * @param kernel_eigen_cutoff 	GenModel::kernel_eigen_cutoff
+ * @param training_error 	GenModel::training_error
+ * @param checksum 		hash of the file with the checksum set to zero
+ * @param temperature 		GenModel::temperature, or zero for the
+ * 				default of 1.0
+ * @param padding 		padding to a multiple of #GENSVM_BINARY_ALIGN
+ * 				bytes
+ */
+struct GenBinaryModelHeader {
+	char magic[8];
+	///< equal to #GENSVM_BINARY_MODEL_MAGIC
+	uint32_t version;
+	///< version of the file format
+	uint32_t byte_order;
+	///< equal to #GENSVM_BINARY_BYTE_ORDER
+	int32_t weight_idx;
+	///< which weights to use
+	int32_t kerneltype;
+	///< type of kernel used in the model
+	int64_t n;
+	///< number of instances in the training data
+	int64_t m;
+	///< number of columns of V minus one
+	int64_t K;
+	///< number of classes
+	int64_t max_iter;
+	///< maximum number of iterations
+	int64_t elapsed_iter;
+	///< number of elapsed iterations in training
+	int64_t seed;
+	///< seed for the random number generator
+	int64_t name_length;
+	///< length of the filename of the training data
+	double p;
+	///< parameter for the L-p norm
+	double lambda;
+	///< regularization parameter
+	double kappa;
+	///< parameter for the Huber hinge
+	double epsilon;
+	///< stopping criterion
+	double gamma;
+	///< kernel parameter
+	double coef;
+	///< kernel parameter
+	double degree;
+	///< kernel parameter
+	double kernel_eigen_cutoff;
+	///< cutoff for the eigendecomposition of the kernel
+	double training_error;
+	///< loss function value after training
+	uint64_t checksum;
+	///< hash of the file with the checksum set to zero
+	double temperature;
+	///< temperature of the scores, or zero for the default of 1.0
+	int64_t padding[3];
+	///< padding to a multiple of #GENSVM_BINARY_ALIGN bytes
+};
+
+/**
+ * @brief A part of a data file that is read by a single thread
+ *
+ * @param filename 	name of the data file, for error messages
+ * @param start 	start of the chunk, at the start of a line
+ * @param end 		end of the chunk, at the start of a line
+ * @param rows 		number of instances in the chunk
+ * @param first 	index of the first instance in the chunk
+ * @param n 		number of instances to read from the file
+ * @param m 		number of features
+ * @param RAW 		augmented data matrix to read the features into
+ * @param y 		array to read the labels into, or NULL
+ * @param K 		largest label in the chunk
+ * @param csr 		arrays to read the nonzero features and the labels
+ * 			into if RAW is NULL
+ */
+struct GenReadChunk {
+	char *filename;
+	///< name of the data file, for error messages
+	const char *start;
+	///< start of the chunk, at the start of a line
+	const char *end;
+	///< end of the chunk, at the start of a line
+	long rows;
+	///< number of instances in the chunk
+	long first;
+	///< index of the first instance in the chunk
+	long n;
+	///< number of instances to read from the file
+	long m;
+	///< number of features
+	double *RAW;
+	///< augmented data matrix to read the features into
+	long *y;
+	///< array to read the labels into, or NULL
+	long K;
+	///< largest label in the chunk
+	struct GenLibSVMChunk *csr;
+	///< arrays to read the nonzero features and the labels into if RAW is
+	///< NULL
+};
+
+/**
+ * @brief A part of a LibSVM data file that is read by a single thread
+ *
+ * @details
+ * The chunk is first parsed into its own arrays, which grow geometrically.
+ * When all chunks are parsed the size of the dataset is known, and the arrays
+ * of every chunk are copied to the dataset from row GenLibSVMChunk::first and
+ * nonzero element GenLibSVMChunk::offset.
+ *
+ * @param filename 	name of the data file, for error messages
+ * @param start 	start of the chunk, at the start of a line
+ * @param end 		end of the chunk, at the start of a line
+ * @param lines 	number of lines read, including blank lines
+ * @param error 	whether the last line read is not valid
+ * @param rows 		number of instances in the chunk
+ * @param nnz 		number of index:value pairs in the chunk
+ * @param size_rows 	allocated length of y and row_nnz
+ * @param size_nnz 	allocated length of ja and values
+ * @param y 		labels of the instances
+ * @param row_nnz 	number of index:value pairs of every instance
+ * @param ja 		indices of the index:value pairs
+ * @param values 	values of the index:value pairs
+ * @param num_labels 	number of instances with a label
+ * @param min_index 	smallest index in the chunk, at most 1
+ * @param max_index 	largest index in the chunk
+ * @param K 		largest label in the chunk
+ * @param first 	index of the first instance in the chunk
+ * @param offset 	index of the first nonzero element of the chunk in the
+ * 			sparse matrix
+ * @param shift 	value added to every index, 1 for zero-based files
+ * @param data 		dataset to copy the chunk to
+ */
+struct GenLibSVMChunk {
+	char *filename;
+	///< name of the data file, for error messages
+	const char *start;
+	///< start of the chunk, at the start of a line
+	const char *end;
+	///< end of the chunk, at the start of a line
+	long lines;
+	///< number of lines read, including blank lines
+	bool error;
+	///< whether the last line read is not valid
+	long rows;
+	///< number of instances in the chunk
+	long nnz;
+	///< number of index:value pairs in the chunk
+	long size_rows;
+	///< allocated length of y and row_nnz
+	long size_nnz;
+	///< allocated length of ja and values
+	long *y;
+	///< labels of the instances
+	long *row_nnz;
+	///< number of index:value pairs of every instance
+	long *ja;
+	///< indices of the index:value pairs
+	double *values;
+	///< values of the index:value pairs
+	long num_labels;
+	///< number of instances with a label
+	long min_index;
+	///< smallest index in the chunk, at most 1
+	long max_index;
+	///< largest index in the chunk
+	long K;
+	///< largest label in the chunk
+	long first;
+	///< index of the first instance in the chunk
+	long offset;
+	///< index of the first nonzero element of the chunk in the sparse
+	///< matrix
+	long shift;
+	///< value added to every index, 1 for zero-based files
+	struct GenData *data;
+	///< dataset to copy the chunk to
+};
+
+/**
+ * @brief A data file that is read in blocks of instances
+ *
+ * @details
+ * A data stream is opened with gensvm_open_data_stream() and read with
+ * gensvm_read_data_stream(), which only holds a single block of instances
+ * in memory. The file is read sequentially, so it can also be a pipe.
+ *
+ * @param fid 		file that is read
+ * @param filename 	name of the file, for error messages
+ * @param libsvm_format whether the file is in LibSVM/SVMlight format
+ * @param n 		number of instances in the file, or -1 if unknown
+ * @param m 		number of features
+ * @param rows 		number of instances read so far
+ * @param line_nr 	number of lines read so far
+ * @param labels 	1 if the instances have labels, 0 if they don't, and
+ * 			-1 if this isn't known yet
+ * @param line 		buffer for the current line
+ * @param line_size 	size of the line buffer
+ */
+struct GenDataStream {
+	FILE *fid;
+	///< file that is read
+	char *filename;
+	///< name of the file, for error messages
+	bool libsvm_format;
+	///< whether the file is in LibSVM/SVMlight format
+	long n;
+	///< number of instances in the file, or -1 if unknown
+	long m;
+	///< number of features
+	long rows;
+	///< number of instances read so far
+	long line_nr;
+	///< number of lines read so far
+	int labels;
+	///< whether the instances have labels, or -1 if unknown
+	char *line;
+	///< buffer for the current line
+	size_t line_size;
+	///< size of the line buffer
+};
+
 // function declarations
 void gensvm_read_data(struct GenData *dataset, char *data_file);
+void *gensvm_read_count_rows(void *arg);
+void *gensvm_read_chunk(void *arg);
 void gensvm_read_data_libsvm(struct GenData *dataset, char *data_file);
+void *gensvm_read_libsvm_chunk(void *arg);
+void *gensvm_read_libsvm_copy(void *arg);
+bool gensvm_is_binary_data(char *data_file);
+void gensvm_read_data_binary(struct GenData *dataset, char *data_file);
+void gensvm_write_data_binary(struct GenData *dataset, char *data_file);
+void gensvm_load_data(struct GenData *dataset, char *data_file,
+		bool libsvm_format);
+struct GenDataStream *gensvm_open_data_stream(char *data_file,
+		bool libsvm_format, long m);
+long gensvm_read_data_stream(struct GenDataStream *stream,
+		struct GenData *block);
+void gensvm_close_data_stream(struct GenDataStream *stream);
 
 void gensvm_read_model(struct GenModel *model, char *model_filename);
 void gensvm_write_model(struct GenModel *model, char *output_filename);
+bool gensvm_is_binary_model(char *model_filename);
+void gensvm_read_model_binary(struct GenModel *model, char *model_filename);
+void gensvm_write_model_binary(struct GenModel *model,
+		char *output_filename);
 
 void gensvm_write_predictions(struct GenData *data, long *predy,
 		char *output_filename);
+void gensvm_write_predictions_format(struct GenData *data, long *predy,
+		double *values, long K, PredictionFormat format,
+		char *output_filename);
+void gensvm_write_predictions_stream(FILE *fid, struct GenData *data,
+		long *predy, double *values, long K, PredictionFormat format);
 void gensvm_time_string(char *buffer);
 
 #endif
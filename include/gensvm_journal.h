@@ -0,0 +1,116 @@
+/**
+ * @file gensvm_journal.h
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Header file for gensvm_journal.c
+ *
+ * @details
+ * Contains the structure definitions of the grid search journal and the
+ * function declarations for reading and writing it.
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef GENSVM_JOURNAL_H
+#define GENSVM_JOURNAL_H
+
+// includes
+#include "gensvm_hash.h"
+#include "gensvm_print.h"
+#include "gensvm_strutil.h"
+#include "gensvm_task.h"
+
+/**
+ * Initial length of the hash table of a journal. The table has a power of
+ * two length and is kept at most half full.
+ */
+#define GENSVM_JOURNAL_INDEX_SIZE 64
+
+/**
+ * @brief A single completed task in the journal
+ *
+ * @param key 		hash of the dataset, cv split and task parameters
+ * @param performance 	cross validation performance of the task
+ * @param iter 		total number of iterations over all folds
+ * @param duration 	time in seconds needed for the cross validation
+ * @param temperature 	temperature of the scores fitted in cross validation
+ */
+struct GenJournalEntry {
+	uint64_t key;
+	///< hash of the dataset, cv split and task parameters
+	double performance;
+	///< cross validation performance of the task
+	long iter;
+	///< total number of iterations over all folds
+	double duration;
+	///< time in seconds needed for the cross validation
+	double temperature;
+	///< temperature of the scores fitted in cross validation
+};
+
+/**
+ * @brief An append-only journal of completed grid search tasks
+ *
+ * @param filename 	name of the journal file
+ * @param fid 		file handle of the journal, opened for appending
+ * @param N 		number of entries in the journal
+ * @param size 		allocated length of the entries array
+ * @param entries 	all entries read from or written to the journal
+ * @param index 	hash table with the position of every entry, by key
+ * @param index_size 	length of the hash table, a power of two
+ * @param unsynced 	number of appended entries not synchronized to disk
+ */
+struct GenJournal {
+	char *filename;
+	///< name of the journal file
+	FILE *fid;
+	///< file handle of the journal, opened for appending
+	long N;
+	///< number of entries in the journal
+	long size;
+	///< allocated length of the entries array
+	struct GenJournalEntry *entries;
+	///< all entries read from or written to the journal
+	long *index;
+	///< hash table with the position of every entry, -1 if empty
+	long index_size;
+	///< length of the hash table, a power of two
+	long unsynced;
+	///< number of appended entries not synchronized to disk
+};
+
+// function declarations
+struct GenJournal *gensvm_init_journal(void);
+void gensvm_free_journal(struct GenJournal *journal);
+void gensvm_journal_read(struct GenJournal *journal, char *filename);
+struct GenJournal *gensvm_journal_open(char *filename);
+struct GenJournalEntry *gensvm_journal_find(struct GenJournal *journal,
+		uint64_t key);
+void gensvm_journal_add(struct GenJournal *journal, uint64_t key,
+		double performance, long iter, double duration,
+		double temperature);
+void gensvm_journal_append(struct GenJournal *journal, uint64_t key,
+		double performance, long iter, double duration,
+		double temperature);
+void gensvm_journal_sync(struct GenJournal *journal);
+uint64_t gensvm_journal_split_hash(struct GenData *data, long *cv_idx);
+uint64_t gensvm_journal_task_key(struct GenTask *task, uint64_t split_hash);
+
+#endif
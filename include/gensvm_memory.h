@@ -5,7 +5,9 @@
  * @brief Header file for gensvm_memory.c
  *
  * @details
- * Contains macro definitions for easy memory access.
+ * Contains macro definitions for easy memory access, the structure and
+ * function declarations for an arena of temporary arrays, and the functions
+ * for accounting of memory use and a memory limit.
 
  * @copyright
  Copyright 2016, G.J.J. van den Burg.
@@ -30,8 +32,11 @@
 #ifndef GENSVM_MEMORY_H
 #define GENSVM_MEMORY_H
 
+#include <stdbool.h>
 #include <stddef.h>
 
+struct GenContext;
+
 /**
  * Wrapper macro for mycalloc(). This macro uses the __FILE__ and __LINE__ 
  * standard macros to fill in some of the arguments to mycalloc(). This macro 
@@ -54,6 +59,13 @@
  */
 #define Realloc(var, type, size) \
 	myrealloc(__FILE__, __LINE__, (size)*sizeof(type), var)
+/**
+ * Wrapper macro for gensvm_free(). Memory allocated with the macros in this
+ * file should be freed with this macro, such that it no longer counts as in
+ * use when memory use is recorded.
+ */
+#define Free(var) \
+	gensvm_free(var)
 /**
  * Wrapper macro for memset(). Since memset is only used to zero a matrix, 
  * this macro is defined.
@@ -61,9 +73,163 @@
 #define Memset(var, type, size) \
 	memset(var, 0, (size)*sizeof(type))
 
+/**
+ * Alignment in bytes of the arrays allocated with AlignedMalloc() and
+ * AlignedCalloc(). This is the size of a cache line and of the widest vector
+ * registers, such that aligned vector loads can be used and no two threads
+ * write to the same cache line of different arrays.
+ */
+#define GENSVM_ALIGN 64
+
+/**
+ * Whether the leading dimension of matrices in the workspace is padded to a
+ * multiple of #GENSVM_ALIGN bytes (see gensvm_padded_ld()). Compile with
+ * -DGENSVM_PAD_LD=0 to store these matrices without padding.
+ */
+#ifndef GENSVM_PAD_LD
+  #define GENSVM_PAD_LD 1
+#endif
+
+/**
+ * Maximum number of allocation sites for which the memory use is recorded
+ * separately, see gensvm_memory_track()
+ */
+#ifndef GENSVM_MEMORY_SITES
+  #define GENSVM_MEMORY_SITES 512
+#endif
+
+/**
+ * Wrapper macro for myaligned_malloc(). This is Malloc() for memory that is
+ * aligned to #GENSVM_ALIGN bytes. The memory is freed with Free().
+ */
+#define AlignedMalloc(type, size) \
+	myaligned_malloc(__FILE__, __LINE__, (size)*sizeof(type))
+/**
+ * Wrapper macro for myaligned_calloc(). This is Calloc() for memory that is
+ * aligned to #GENSVM_ALIGN bytes. The memory is freed with Free().
+ */
+#define AlignedCalloc(type, size) \
+	myaligned_calloc(__FILE__, __LINE__, size, sizeof(type))
+
+/**
+ * Wrapper macro for gensvm_arena_calloc(). This macro uses the __FILE__ and
+ * __LINE__ standard macros to fill in some of the arguments to
+ * gensvm_arena_calloc(), as Calloc() does for mycalloc().
+ */
+#define ArenaCalloc(arena, type, size) \
+	gensvm_arena_calloc(arena, __FILE__, __LINE__, size, sizeof(type))
+
+/**
+ * Alignment in bytes of the arrays in a GenArena
+ */
+#define GENSVM_ARENA_ALIGN GENSVM_ALIGN
+
+/**
+ * @brief An arena for temporary arrays
+ *
+ * @details
+ * Arrays are taken from a single block of memory by moving a pointer, and
+ * are given back all at once with gensvm_arena_release() or
+ * gensvm_arena_reset(). This replaces the allocation and freeing of the
+ * same arrays for every fold and every task of a grid search by reuse of
+ * memory that is already mapped.
+ *
+ * An array that doesn't fit in the block is allocated separately and is
+ * freed by gensvm_arena_reset(), which also enlarges the block to the
+ * largest amount of memory that was used since the previous reset. After
+ * the first task, the block is therefore large enough for all tasks of the
+ * same size.
+ *
+ * @param block 	the allocated memory
+ * @param base 		the block of memory, aligned in block
+ * @param size 		size of the block in bytes
+ * @param used 		number of bytes of the block in use
+ * @param peak 		largest number of bytes in use since the last reset,
+ * 			including the separate arrays
+ * @param extra 	separately allocated arrays
+ * @param n_extra 	number of separately allocated arrays
+ * @param extra_bytes 	number of bytes in the separately allocated arrays
+ */
+struct GenArena {
+	char *block;
+	///< the allocated memory
+	char *base;
+	///< the block of memory, aligned in block
+	size_t size;
+	///< size of the block in bytes
+	size_t used;
+	///< number of bytes of the block in use
+	size_t peak;
+	///< largest number of bytes in use since the last reset
+	void **extra;
+	///< separately allocated arrays
+	long n_extra;
+	///< number of separately allocated arrays
+	size_t extra_bytes;
+	///< number of bytes in the separately allocated arrays
+};
+
+/**
+ * @brief Memory use of an allocation site
+ *
+ * @details
+ * An allocation site is a line in the source code where Malloc(), Calloc(),
+ * Realloc() or one of their aligned versions is used. The bytes in use are
+ * those of the allocations at the site that aren't yet freed with Free().
+ *
+ * @param file 		source file of the site
+ * @param line 		line number of the site
+ * @param count 	number of allocations at the site
+ * @param bytes 	total number of bytes requested at the site
+ * @param largest 	largest number of bytes requested in one allocation
+ * @param live 		number of bytes in use from the site
+ * @param peak 		largest number of bytes in use from the site
+ */
+struct GenMemorySite {
+	const char *file;
+	///< source file of the site
+	int line;
+	///< line number of the site
+	unsigned long count;
+	///< number of allocations at the site
+	size_t bytes;
+	///< total number of bytes requested at the site
+	size_t largest;
+	///< largest number of bytes requested in one allocation
+	size_t live;
+	///< number of bytes in use from the site
+	size_t peak;
+	///< largest number of bytes in use from the site
+};
+
 void *mycalloc(const char *file, int line, unsigned long size,
 	size_t typesize);
 void *mymalloc(const char *file, int line, unsigned long size);
 void *myrealloc(const char *file, int line, unsigned long size, void *var);
+void *myaligned_malloc(const char *file, int line, unsigned long size);
+void *myaligned_calloc(const char *file, int line, unsigned long size,
+		size_t typesize);
+void gensvm_free(void *ptr);
+long gensvm_padded_ld(long cols, size_t typesize);
+
+void gensvm_memory_track(bool track);
+void gensvm_memory_set_limit(size_t limit);
+size_t gensvm_memory_limit(void);
+size_t gensvm_memory_live(void);
+size_t gensvm_memory_peak(void);
+bool gensvm_memory_available(size_t size);
+struct GenMemorySite *gensvm_memory_sites(long *n_sites);
+void gensvm_memory_reset(void);
+void gensvm_memory_report(struct GenContext *ctx);
+
+size_t gensvm_arena_size(unsigned long size, size_t typesize);
+struct GenArena *gensvm_init_arena(size_t size);
+void gensvm_free_arena(struct GenArena *arena);
+void gensvm_arena_reserve(struct GenArena *arena, size_t size);
+void *gensvm_arena_calloc(struct GenArena *arena, const char *file, int line,
+		unsigned long size, size_t typesize);
+size_t gensvm_arena_mark(struct GenArena *arena);
+void gensvm_arena_release(struct GenArena *arena, size_t mark);
+void gensvm_arena_reset(struct GenArena *arena);
 
 #endif
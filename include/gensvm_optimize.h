@@ -31,6 +31,7 @@
 #ifndef GENSVM_OPTIMIZE_H
 #define GENSVM_OPTIMIZE_H
 
+#include "gensvm_context.h"
 #include "gensvm_sv.h"
 #include "gensvm_simplex.h"
 #include "gensvm_predict.h"
@@ -38,7 +39,8 @@
 #include "gensvm_zv.h"
 
 // function declarations
-void gensvm_optimize(struct GenModel *model, struct GenData *data);
+void gensvm_optimize(struct GenModel *model, struct GenData *data,
+		struct GenContext *ctx);
 double gensvm_get_loss(struct GenModel *model, struct GenData *data, 
 		struct GenWork *work);
 void gensvm_calculate_errors(struct GenModel *model, struct GenData *data,
@@ -0,0 +1,85 @@
+/**
+ * @file gensvm_parse.h
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Header file for gensvm_parse.c
+ *
+ * @details
+ * Contains the structure definition of a file mapped into memory and the
+ * declarations of the functions for parsing numbers from memory.
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef GENSVM_PARSE_H
+#define GENSVM_PARSE_H
+
+// includes
+#include "gensvm_print.h"
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * Maximum length of a number that is parsed with strtod()
+ */
+#define GENSVM_MAX_NUMBER_LENGTH 64
+
+/**
+ * Maximum length of a number that is formatted with gensvm_format_double()
+ */
+#define GENSVM_MAX_DOUBLE_LENGTH 336
+
+/**
+ * @brief The contents of a file in memory
+ *
+ * @details
+ * Regular files are mapped into memory with mmap(). Other files (such as
+ * pipes) are read into an allocated buffer instead. The data is not
+ * terminated by a null character.
+ *
+ * @param data 		contents of the file
+ * @param size 		size of the file in bytes
+ * @param mapped 	whether the data is mapped with mmap() or allocated
+ */
+struct GenFileMap {
+	char *data;
+	///< contents of the file
+	size_t size;
+	///< size of the file in bytes
+	bool mapped;
+	///< whether the data is mapped with mmap() or allocated
+};
+
+// function declarations
+struct GenFileMap *gensvm_map_file(char *filename, bool writable);
+void gensvm_unmap_file(struct GenFileMap *map);
+bool gensvm_map_contains(struct GenFileMap *map, const void *ptr);
+const char *gensvm_skip_blank(const char *p, const char *end);
+const char *gensvm_next_line(const char *p, const char *end);
+bool gensvm_parse_double(const char **str, const char *end, double *value);
+bool gensvm_parse_long(const char **str, const char *end, long *value);
+size_t gensvm_format_long(char *buf, long value);
+size_t gensvm_format_double(char *buf, double value);
+
+#endif
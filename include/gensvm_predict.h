@@ -31,11 +31,77 @@
 #define GENSVM_PREDICT_H
 
 // includes
+#include "gensvm_context.h"
 #include "gensvm_kernel.h"
 #include "gensvm_simplex.h"
 #include "gensvm_zv.h"
 
+#include <pthread.h>
+
+/**
+ * Minimum number of instances per thread when assigning labels
+ */
+#ifndef GENSVM_PREDICT_MIN_ROWS
+  #define GENSVM_PREDICT_MIN_ROWS 16384
+#endif
+
+/**
+ * Smallest temperature returned by gensvm_fit_temperature()
+ */
+#ifndef GENSVM_MIN_TEMPERATURE
+  #define GENSVM_MIN_TEMPERATURE 1e-3
+#endif
+
+/**
+ * Largest temperature returned by gensvm_fit_temperature()
+ */
+#ifndef GENSVM_MAX_TEMPERATURE
+  #define GENSVM_MAX_TEMPERATURE 1e3
+#endif
+
+/**
+ * @brief A range of instances to assign labels to
+ *
+ * @param ZV 		simplex space vectors of all instances
+ * @param U 		simplex matrix
+ * @param K 		number of classes
+ * @param start 	first instance of the range
+ * @param end 		end of the range (exclusive)
+ * @param predy 	predicted labels of all instances
+ * @param dist 		distances of all instances to the simplex vertices, or
+ * 			NULL
+ * @param S 		work array of the range
+ */
+struct GenPredictChunk {
+	double *ZV;
+	///< simplex space vectors of all instances
+	double *U;
+	///< simplex matrix
+	long K;
+	///< number of classes
+	long start;
+	///< first instance of the range
+	long end;
+	///< end of the range (exclusive)
+	long *predy;
+	///< predicted labels of all instances
+	double *dist;
+	///< distances of all instances to the simplex vertices, or NULL
+	double *S;
+	///< work array of the range
+};
+
 // function declarations
+void gensvm_predict_assign_rows(const double *ZV, const double *U, long n,
+		long K, double *S, long *predy, double *dist);
+size_t gensvm_predict_assign_size(long n, long K);
+void gensvm_predict_assign(double *ZV, double *U, long n, long K,
+		long *predy, double *dist, struct GenContext *ctx);
+void gensvm_predict_softmax(double *P, long n, long K, double temperature);
+double gensvm_fit_temperature(const double *dist, const long *y, long n,
+		long K);
+void gensvm_predict_values(struct GenData *testdata, struct GenModel *model,
+		PredictionFormat format, long *predy, double *values);
 void gensvm_predict_labels(struct GenData *testdata,
 	       	struct GenModel *model, long *predy);
 double gensvm_prediction_perf(struct GenData *data, long *perdy);
@@ -0,0 +1,84 @@
+/**
+ * @file gensvm_predictor.h
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Header file for gensvm_predictor.c
+ *
+ * @details
+ * Contains the structure and function declarations for a predictor that
+ * predicts the labels of batches of instances without allocating memory.
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef GENSVM_PREDICTOR_H
+#define GENSVM_PREDICTOR_H
+
+// includes
+#include "gensvm_predict.h"
+
+/**
+ * @brief A prepared model for predicting batches of instances
+ *
+ * @details
+ * A predictor is created once from a trained linear model with
+ * gensvm_init_predictor(). It holds a copy of the model coefficients, the
+ * simplex matrix and the work arrays for a batch of instances, so that
+ * predicting with gensvm_predict_batch() or gensvm_predict_batch_sparse()
+ * doesn't allocate memory. A predictor can be used by one thread at a time.
+ *
+ * @param m 		number of features
+ * @param K 		number of classes
+ * @param max_rows 	number of instances that are predicted at once
+ * @param V 		augmented weight matrix ((m+1) x (K-1))
+ * @param U 		simplex matrix (K x (K-1))
+ * @param ZV 		work array for the simplex space vectors
+ * 			(max_rows x (K-1))
+ * @param S 		work array for the inner products with the vertices
+ * 			(#GENSVM_BLOCK_SIZE x K)
+ */
+struct GenPredictor {
+	long m;
+	///< number of features
+	long K;
+	///< number of classes
+	long max_rows;
+	///< number of instances that are predicted at once
+	double *V;
+	///< augmented weight matrix
+	double *U;
+	///< simplex matrix
+	double *ZV;
+	///< work array for the simplex space vectors
+	double *S;
+	///< work array for the inner products with the vertices
+};
+
+// function declarations
+struct GenPredictor *gensvm_init_predictor(struct GenModel *model,
+		long max_rows);
+void gensvm_free_predictor(struct GenPredictor *predictor);
+void gensvm_predict_batch(struct GenPredictor *predictor,
+		const double *rows, long n, long *predy);
+bool gensvm_predict_batch_sparse(struct GenPredictor *predictor,
+		const long *ia, const long *ja, const double *values, long n,
+		long *predy);
+
+#endif
@@ -0,0 +1,136 @@
+/**
+ * @file gensvm_quantize.h
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Header file for gensvm_quantize.c
+ *
+ * @details
+ * Contains the structure and function declarations for linear models with
+ * quantized coefficients and for comparing their predictions with the
+ * double precision model.
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef GENSVM_QUANTIZE_H
+#define GENSVM_QUANTIZE_H
+
+// includes
+#include "gensvm_predict.h"
+
+#include <stdint.h>
+
+/**
+ * @brief A linear model with quantized coefficients
+ *
+ * @details
+ * The weights of the features (all rows of GenModel::V except the first)
+ * are stored transposed, such that the weights of a column of V are
+ * contiguous. For #Q_INT8 a weight @f$ w_{jk} @f$ is stored as the integer
+ * @f$ \textrm{round}(w_{jk} / s_k) @f$, where the scale @f$ s_k @f$ maps the
+ * largest absolute weight of column k to 127. For #Q_FLOAT16 the weights
+ * are stored as IEEE 754 half precision numbers. The bias is small and is
+ * kept in double precision.
+ *
+ * @param type 		type of the quantization
+ * @param m 		number of features
+ * @param K 		number of classes
+ * @param temperature 	temperature for the class probabilities
+ * @param bias 		first row of V (K-1)
+ * @param scale 	scale of every column for #Q_INT8, ones for
+ * 			#Q_FLOAT16 (K-1)
+ * @param W8 		transposed int8 weights ((K-1) x m), or NULL
+ * @param W16 		transposed float16 weights ((K-1) x m), or NULL
+ * @param U 		simplex matrix (K x (K-1))
+ */
+struct GenQuantModel {
+	QuantizeType type;
+	///< type of the quantization
+	long m;
+	///< number of features
+	long K;
+	///< number of classes
+	double temperature;
+	///< temperature for the class probabilities
+	double *bias;
+	///< first row of V
+	double *scale;
+	///< scale of every column
+	int8_t *W8;
+	///< transposed int8 weights, or NULL
+	uint16_t *W16;
+	///< transposed float16 weights, or NULL
+	double *U;
+	///< simplex matrix
+};
+
+/**
+ * @brief Comparison of a quantized model with the double precision model
+ *
+ * @details
+ * The report is accumulated over blocks of test data with
+ * gensvm_quant_compare() and printed with gensvm_quant_report().
+ *
+ * @param n 		number of instances
+ * @param n_agree 	number of instances with the same label for both
+ * 			models
+ * @param n_labeled 	number of instances with a known label
+ * @param n_correct 	number of correct labels of the double model
+ * @param n_correct_quant number of correct labels of the quantized model
+ * @param max_error 	largest absolute difference of a decision value
+ * @param sum_sq_error 	sum of squared differences of the decision values
+ */
+struct GenQuantReport {
+	long n;
+	///< number of instances
+	long n_agree;
+	///< number of instances with the same label for both models
+	long n_labeled;
+	///< number of instances with a known label
+	long n_correct;
+	///< number of correct labels of the double model
+	long n_correct_quant;
+	///< number of correct labels of the quantized model
+	double max_error;
+	///< largest absolute difference of a decision value
+	double sum_sq_error;
+	///< sum of squared differences of the decision values
+};
+
+// function declarations
+struct GenQuantModel *gensvm_quantize_model(struct GenModel *model,
+		QuantizeType type);
+void gensvm_free_quant_model(struct GenQuantModel *q);
+uint16_t gensvm_double_to_half(double value);
+double gensvm_half_to_double(uint16_t half);
+void gensvm_quant_calculate_ZV(struct GenQuantModel *q,
+		struct GenData *data, double *ZV);
+void gensvm_quant_predict_values(struct GenQuantModel *q,
+		struct GenData *testdata, PredictionFormat format, long *predy,
+		double *values);
+struct GenQuantReport *gensvm_init_quant_report(void);
+void gensvm_free_quant_report(struct GenQuantReport *report);
+void gensvm_quant_compare(struct GenQuantReport *report,
+		struct GenQuantModel *q, struct GenModel *model,
+		struct GenData *data);
+void gensvm_quant_report(struct GenQuantReport *report,
+		struct GenQuantModel *q);
+
+#endif
@@ -0,0 +1,63 @@
+/**
+ * @file gensvm_rand.h
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Header file for gensvm_rand.c
+ *
+ * @details
+ * Contains the structure definition of the random number generator and the
+ * declarations of the functions for drawing random numbers.
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef GENSVM_RAND_H
+#define GENSVM_RAND_H
+
+// includes
+#include "gensvm_globals.h"
+
+#include <stdint.h>
+
+/**
+ * @brief State of a seedable pseudo-random number generator
+ *
+ * @details
+ * The xoshiro256** generator is used. Unlike rand(), the state is explicit,
+ * so every thread, task, or repeat can have its own reproducible stream of
+ * random numbers.
+ *
+ * @param s 	the 256-bit state of the generator
+ */
+struct GenRNG {
+	uint64_t s[4];
+	///< the 256-bit state of the generator
+};
+
+// function declarations
+struct GenRNG *gensvm_init_rng(uint64_t seed);
+void gensvm_free_rng(struct GenRNG *rng);
+void gensvm_rng_seed(struct GenRNG *rng, uint64_t seed);
+uint64_t gensvm_rng_derive(uint64_t seed, uint64_t stream);
+uint64_t gensvm_rng_next(struct GenRNG *rng);
+uint64_t gensvm_rng_bounded(struct GenRNG *rng, uint64_t bound);
+double gensvm_rng_uniform(struct GenRNG *rng);
+
+#endif
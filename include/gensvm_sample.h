@@ -0,0 +1,89 @@
+/**
+ * @file gensvm_sample.h
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Header file for gensvm_sample.c
+ *
+ * @details
+ * Contains the structure definition of the Sobol sequence generator and the
+ * declarations of the functions for random and quasi-random search.
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef GENSVM_SAMPLE_H
+#define GENSVM_SAMPLE_H
+
+// includes
+#include "gensvm_context.h"
+#include "gensvm_grid.h"
+#include "gensvm_queue.h"
+
+/**
+ * Maximum dimension of the Sobol and Halton sequences. This equals the number
+ * of parameters of a GenTask that can be searched over.
+ */
+#define GENSVM_SAMPLE_MAX_DIM 8
+
+/**
+ * Number of values a sampled kernel parameter (gamma or coef) can take. These
+ * are rounded onto evenly spaced points of their range, such that tasks share
+ * kernels and the kernel reuse of gensvm_train_queue() applies.
+ */
+#define GENSVM_SAMPLE_KERNEL_LEVELS 8
+
+/**
+ * Number of bits of the points of the Sobol sequence
+ */
+#define GENSVM_SOBOL_BITS 32
+
+/**
+ * @brief State of a Sobol sequence generator
+ *
+ * @details
+ * The points are generated in Gray code order with the method of Antonov and
+ * Saleev, such that every point costs one XOR per dimension.
+ *
+ * @param dim 		dimension of the points
+ * @param index 	index of the next point
+ * @param V 		direction numbers (dim x GENSVM_SOBOL_BITS)
+ * @param X 		integer coordinates of the next point
+ */
+struct GenSobol {
+	long dim;
+	///< dimension of the points
+	uint64_t index;
+	///< index of the next point
+	uint32_t *V;
+	///< direction numbers (dim x GENSVM_SOBOL_BITS)
+	uint32_t *X;
+	///< integer coordinates of the next point
+};
+
+// function declarations
+struct GenSobol *gensvm_init_sobol(long dim);
+void gensvm_free_sobol(struct GenSobol *sobol);
+void gensvm_sobol_next(struct GenSobol *sobol, double *x);
+double gensvm_halton(uint64_t index, long dim);
+void gensvm_sample_queue(struct GenGrid *grid, struct GenQueue *queue,
+		struct GenData *train_data, struct GenData *test_data,
+		struct GenContext *ctx);
+
+#endif
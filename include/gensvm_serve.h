@@ -0,0 +1,203 @@
+/**
+ * @file gensvm_serve.h
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Header file for gensvm_serve.c
+ *
+ * @details
+ * Contains the structures, constants and function declarations for serving
+ * predictions of loaded models over a Unix domain socket.
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef GENSVM_SERVE_H
+#define GENSVM_SERVE_H
+
+// includes
+#include "gensvm_compact.h"
+#include "gensvm_io.h"
+#include "gensvm_kernel.h"
+#include "gensvm_predict.h"
+
+#include <pthread.h>
+#include <stdint.h>
+
+/**
+ * Magic number at the start of every request and response
+ */
+#define GENSVM_SERVE_MAGIC 0x4d565347
+
+/**
+ * Request flag for instances in compressed row format
+ */
+#define GENSVM_SERVE_SPARSE 1
+
+/**
+ * Maximum size of the data of a single request in bytes
+ */
+#ifndef GENSVM_SERVE_MAX_REQUEST
+  #define GENSVM_SERVE_MAX_REQUEST (1L << 30)
+#endif
+
+/**
+ * Status of a response, see @ref spec_serve_protocol
+ */
+typedef enum {
+	SERVE_OK=0, 		///< the request succeeded
+	SERVE_BAD_REQUEST=1, 	///< the request is malformed
+	SERVE_BAD_MODEL=2, 	///< the model index doesn't exist
+	SERVE_BAD_FEATURES=3, 	///< the number of features doesn't match
+	SERVE_BAD_INDEX=4 	///< the sparse row offsets or indices are invalid
+} ServeStatus;
+
+/**
+ * @brief Header of a prediction request
+ *
+ * @details
+ * See @ref spec_serve_protocol for the data that follows the header.
+ *
+ * @param magic 	#GENSVM_SERVE_MAGIC
+ * @param flags 	#GENSVM_SERVE_SPARSE for sparse instances, or 0
+ * @param model 	index of the model to predict with
+ * @param n 		number of instances
+ * @param m 		number of features of the instances
+ * @param nnz 		number of nonzeros of sparse instances
+ */
+struct GenServeRequest {
+	uint32_t magic;
+	///< #GENSVM_SERVE_MAGIC
+	uint32_t flags;
+	///< #GENSVM_SERVE_SPARSE for sparse instances, or 0
+	int64_t model;
+	///< index of the model to predict with
+	int64_t n;
+	///< number of instances
+	int64_t m;
+	///< number of features of the instances
+	int64_t nnz;
+	///< number of nonzeros of sparse instances
+};
+
+/**
+ * @brief Header of a prediction response
+ *
+ * @param magic 	#GENSVM_SERVE_MAGIC
+ * @param status 	a ServeStatus
+ * @param n 		number of instances, zero if the request failed
+ * @param K 		number of classes of the model
+ */
+struct GenServeResponse {
+	uint32_t magic;
+	///< #GENSVM_SERVE_MAGIC
+	int32_t status;
+	///< a ServeStatus
+	int64_t n;
+	///< number of instances, zero if the request failed
+	int64_t K;
+	///< number of classes of the model
+};
+
+/**
+ * @brief A model that is loaded by the server
+ *
+ * @param model 	the model, with the simplex matrix U
+ * @param traindata 	the training data after the kernel preprocessing for
+ * 			a nonlinear model, NULL for a linear model
+ * @param m 		number of features of the instances
+ */
+struct GenServeModel {
+	struct GenModel *model;
+	///< the model, with the simplex matrix U
+	struct GenData *traindata;
+	///< the training data of a nonlinear model, or NULL
+	long m;
+	///< number of features of the instances
+};
+
+/**
+ * @brief A server for the predictions of a set of models
+ *
+ * @details
+ * The server is created with gensvm_init_server(), which loads the models.
+ * With gensvm_serve_start() it listens on a Unix domain socket, and every
+ * worker thread handles one connection at a time. The models can be loaded
+ * again with gensvm_serve_reload() while the server is running.
+ *
+ * @param model_files 	filenames of the models
+ * @param n_models 	number of models
+ * @param kernel 	model with the kernel for text model files
+ * @param libsvm_format whether the training data of nonlinear models is in
+ * 			LibSVM/SVMlight format
+ * @param tolerance 	relative error of the decision values for compacting
+ * 			nonlinear models, or 0 to not compact the models
+ * @param models 	the loaded models
+ * @param lock 		lock for GenServer::models, which is held for
+ * 			writing while the models are replaced
+ * @param socket_path 	path of the socket
+ * @param listen_fd 	the listening socket, or -1
+ * @param n_workers 	number of worker threads
+ * @param workers 	the worker threads
+ * @param conns 	connection of every worker, or -1
+ * @param conn_lock 	lock for GenServer::conns and GenServer::stopping
+ * @param stopping 	whether the server is stopping
+ */
+struct GenServer {
+	char **model_files;
+	///< filenames of the models
+	long n_models;
+	///< number of models
+	struct GenModel *kernel;
+	///< model with the kernel for text model files
+	bool libsvm_format;
+	///< whether the training data is in LibSVM/SVMlight format
+	double tolerance;
+	///< relative error for compacting nonlinear models, or 0
+	struct GenServeModel *models;
+	///< the loaded models
+	pthread_rwlock_t lock;
+	///< lock for the models
+	char *socket_path;
+	///< path of the socket
+	int listen_fd;
+	///< the listening socket, or -1
+	long n_workers;
+	///< number of worker threads
+	pthread_t *workers;
+	///< the worker threads
+	int *conns;
+	///< connection of every worker, or -1
+	pthread_mutex_t conn_lock;
+	///< lock for the connections and the stopping flag
+	bool stopping;
+	///< whether the server is stopping
+};
+
+// function declarations
+struct GenServer *gensvm_init_server(char **model_files, long n_models,
+		struct GenModel *kernel, bool libsvm_format,
+		double tolerance);
+bool gensvm_serve_reload(struct GenServer *server);
+void gensvm_serve_start(struct GenServer *server, char *socket_path,
+		long n_workers);
+void gensvm_serve_stop(struct GenServer *server);
+void gensvm_free_server(struct GenServer *server);
+
+#endif
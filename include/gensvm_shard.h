@@ -0,0 +1,129 @@
+/**
+ * @file gensvm_shard.h
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Header file for gensvm_shard.c
+ *
+ * @details
+ * Contains the structure definition and function declarations for
+ * distributing a grid search over several processes through a shared
+ * directory.
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef GENSVM_SHARD_H
+#define GENSVM_SHARD_H
+
+// includes
+#include "gensvm_gridsearch.h"
+
+#include <pthread.h>
+
+/**
+ * Default number of tasks in a chunk of the queue
+ */
+#define GENSVM_SHARD_CHUNK_SIZE 8
+
+/**
+ * Default time in seconds after which a lease without activity expires
+ */
+#define GENSVM_SHARD_LEASE_TIME 1800
+
+/**
+ * Default time in seconds between scans of the shared directory
+ */
+#define GENSVM_SHARD_POLL_TIME 10
+
+/**
+ * @brief Settings of a worker in a sharded grid search
+ *
+ * @param dir 		the shared directory
+ * @param worker 	identifier of this worker (hostname and pid)
+ * @param seed 		seed for the RNG, must be the same for all workers
+ * @param chunk_size 	number of tasks in a chunk
+ * @param lease_time 	time in seconds after which a lease without activity
+ * 			expires
+ * @param poll_time 	time in seconds between scans of the directory
+ */
+struct GenShard {
+	char *dir;
+	///< the shared directory
+	char *worker;
+	///< identifier of this worker (hostname and pid)
+	long seed;
+	///< seed for the RNG, must be the same for all workers
+	long chunk_size;
+	///< number of tasks in a chunk
+	long lease_time;
+	///< time in seconds after which a lease without activity expires
+	long poll_time;
+	///< time in seconds between scans of the directory
+};
+
+/**
+ * @brief Heartbeat of a lease
+ *
+ * @details
+ * A thread that touches the lease file of this worker every quarter of
+ * GenShard::lease_time, such that the lease stays active while a task runs
+ * that takes longer than the lease time. See
+ * gensvm_shard_start_heartbeat().
+ *
+ * @param shard 	the GenShard
+ * @param lease 	path of the lease file
+ * @param thread 	the thread touching the lease
+ * @param lock 		lock for GenShardHeartbeat::stop
+ * @param cond 		condition signalled when the heartbeat is stopped
+ * @param stop 		whether the heartbeat should stop
+ */
+struct GenShardHeartbeat {
+	struct GenShard *shard;
+	///< the GenShard
+	char *lease;
+	///< path of the lease file
+	pthread_t thread;
+	///< the thread touching the lease
+	pthread_mutex_t lock;
+	///< lock for GenShardHeartbeat::stop
+	pthread_cond_t cond;
+	///< condition signalled when the heartbeat is stopped
+	bool stop;
+	///< whether the heartbeat should stop
+};
+
+// function declarations
+struct GenShard *gensvm_init_shard(char *dir, long seed);
+void gensvm_free_shard(struct GenShard *shard);
+char *gensvm_shard_path(struct GenShard *shard, long chunk, char *ext);
+bool gensvm_shard_is_done(struct GenShard *shard, long chunk);
+bool gensvm_shard_claim(struct GenShard *shard, long chunk);
+void gensvm_shard_finish(struct GenShard *shard, long chunk);
+struct GenShardHeartbeat *gensvm_shard_start_heartbeat(
+		struct GenShard *shard, char *lease);
+void gensvm_shard_stop_heartbeat(struct GenShardHeartbeat *hb);
+void gensvm_shard_train_chunk(struct GenShard *shard, struct GenQueue *q,
+		long chunk, struct GenContext *ctx);
+void gensvm_shard_work(struct GenShard *shard, struct GenQueue *q,
+		struct GenContext *ctx);
+bool gensvm_shard_merge(struct GenShard *shard, struct GenQueue *q,
+		struct GenContext *ctx);
+
+#endif
@@ -0,0 +1,42 @@
+/**
+ * @file gensvm_stream.h
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Header file for gensvm_stream.c
+ *
+ * @details
+ * Function declarations for streaming the rows of a memory mapped data
+ * matrix in blocks.
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef GENSVM_STREAM_H
+#define GENSVM_STREAM_H
+
+// includes
+#include "gensvm_base.h"
+#include "gensvm_parse.h"
+
+// function declarations
+void gensvm_stream_prefetch(struct GenData *data, long start, long end);
+void gensvm_stream_release(struct GenData *data, long start, long end);
+
+#endif
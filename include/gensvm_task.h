@@ -38,6 +38,7 @@
  * @brief A structure for a single task in the queue.
  *
  * @param folds 	number of folds in cross validation
+ * @param stratified 	whether to use a stratified cross validation split
  * @param ID 		numeric id of the task in the queue
  * @param weight_idx 	parameter for the GenModel
  * @param p 		parameter for the GenModel
@@ -51,6 +52,7 @@
  * @param train_data 	pointer to the training data
  * @param test_data 	pointer to the test data (if any)
  * @param performance 	performance after cross validation
+ * @param temperature 	temperature fitted in cross validation
  */
 struct GenTask {
 	KernelType kerneltype;
@@ -59,6 +61,8 @@ struct GenTask {
 	///< weight_idx parameter for the GenModel
 	long folds;
 	///< number of folds in cross validation
+	bool stratified;
+	///< whether to use a stratified cross validation split
 	long ID;
 	///< numeric id of the task in the queue
 	double p;
@@ -83,6 +87,8 @@ struct GenTask {
 	///< pointer to the test data (if any)
 	double performance;
 	///< performance after cross validation
+	double temperature;
+	///< temperature of the scores fitted in cross validation
 };
 
 struct GenTask *gensvm_init_task(void);
@@ -34,6 +34,6 @@
 
 // function declarations
 void gensvm_train(struct GenModel *model, struct GenData *data,
-		struct GenModel *seed_model);
+		struct GenModel *seed_model, struct GenContext *ctx);
 
 #endif
@@ -29,6 +29,7 @@
 
 #include "gensvm_base.h"
 #include "gensvm_print.h"
+#include "gensvm_stream.h"
 
 // function declarations
 double gensvm_calculate_omega(struct GenModel *model, struct GenData *data,
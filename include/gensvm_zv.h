@@ -25,6 +25,7 @@
  */
 
 #include "gensvm_base.h"
+#include "gensvm_stream.h"
 
 void gensvm_calculate_ZV(struct GenModel *model, struct GenData *data,
 		double *ZV);
@@ -0,0 +1,208 @@
+/**
+ * @file GenSVMconvert.c
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Command line interface for converting files to binary format
+ *
+ * @details
+ * This is a command line program for converting a data file in the default
+ * format or in LibSVM/SVMlight format to a binary data file (see @ref
+ * spec_binary_data_file). Binary data files are recognized automatically by
+ * the other programs, and can be loaded without parsing. With the @c -m
+ * flag a model file is converted instead, from the text format (see @ref
+ * spec_model_file) to the binary format (see @ref spec_binary_model_file) or
+ * back.
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "gensvm_cmdarg.h"
+#include "gensvm_codegen.h"
+#include "gensvm_io.h"
+
+/**
+ * Minimal number of command line arguments
+ */
+#define MINARGS 3
+
+extern FILE *GENSVM_OUTPUT_FILE;
+extern FILE *GENSVM_ERROR_FILE;
+
+// function declarations
+void exit_with_help(char **argv);
+void parse_command_line(int argc, char **argv, char **input_filename,
+		char **output_filename);
+
+/**
+ * @brief Help function
+ *
+ * @details
+ * Print help for this program and exit. Note that the VERSION is defined in
+ * the Makefile.
+ *
+ * @param[in] 	argv 	command line arguments
+ *
+ */
+void exit_with_help(char **argv)
+{
+	printf("This is GenSVM, version %s.\n", VERSION_STRING);
+	printf("Copyright (C) 2016, G.J.J. van den Burg.\n");
+	printf("This program is free software, see the LICENSE file "
+			"for details.\n\n");
+	printf("Usage: %s [options] data_file binary_file\n", argv[0]);
+	printf("       %s -m [options] model_file output_model_file\n",
+			argv[0]);
+	printf("       %s -c [options] model_file c_file\n\n", argv[0]);
+	printf("Options:\n");
+	printf("--------\n");
+	printf("-c         : write a standalone C predictor for a linear "
+			"model file\n");
+	printf("-h | -help : print this help.\n");
+	printf("-m         : convert a text model file to a binary model "
+			"file, or a binary\n"
+			"             model file to a text model file\n");
+	printf("-q         : quiet mode (no output, not even errors!)\n");
+	printf("-x         : data file is in LibSVM/SVMlight format\n");
+	printf("\n");
+
+	exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief Main interface function for GenSVMconvert
+ *
+ * @details
+ * Main interface for the GenSVMconvert commandline program.
+ *
+ * @param[in] 	argc 	number of command line arguments
+ * @param[in] 	argv 	array of command line arguments
+ *
+ * @return 		exit status
+ */
+int main(int argc, char **argv)
+{
+	bool libsvm_format = false;
+	char *input_filename = NULL,
+	     *output_filename = NULL;
+	struct GenData *data = NULL;
+	struct GenModel *model = NULL;
+
+	if (argc < MINARGS || gensvm_check_argv(argc, argv, "-help")
+			|| gensvm_check_argv_eq(argc, argv, "-h"))
+		exit_with_help(argv);
+
+	parse_command_line(argc, argv, &input_filename, &output_filename);
+	libsvm_format = gensvm_check_argv(argc, argv, "-x");
+
+	if (gensvm_check_argv_eq(argc, argv, "-c")) {
+		model = gensvm_init_model();
+		gensvm_read_model(model, input_filename);
+		gensvm_write_model_c(model, output_filename, NULL);
+		note("C predictor written to: %s\n", output_filename);
+		gensvm_free_model(model);
+		Free(input_filename);
+		Free(output_filename);
+		return 0;
+	}
+
+	if (gensvm_check_argv_eq(argc, argv, "-m")) {
+		model = gensvm_init_model();
+		gensvm_read_model(model, input_filename);
+		if (gensvm_is_binary_model(input_filename)) {
+			gensvm_write_model(model, output_filename);
+			note("Text model written to: %s\n", output_filename);
+		} else {
+			gensvm_write_model_binary(model, output_filename);
+			note("Binary model written to: %s\n",
+					output_filename);
+		}
+		gensvm_free_model(model);
+		Free(input_filename);
+		Free(output_filename);
+		return 0;
+	}
+
+	data = gensvm_init_data();
+	note("Reading data from %s\n", input_filename);
+	gensvm_load_data(data, input_filename, libsvm_format);
+
+	gensvm_write_data_binary(data, output_filename);
+	note("Binary data with %li instances and %li features written to: "
+			"%s\n", data->n, data->m, output_filename);
+
+	gensvm_free_data(data);
+	Free(input_filename);
+	Free(output_filename);
+
+	return 0;
+}
+
+/**
+ * @brief Parse the command line arguments
+ *
+ * @details
+ * For a full overview of the command line arguments and their meaning see
+ * exit_with_help(). This function furthermore sets the default output
+ * streams to stdout/stderr.
+ *
+ * @param[in] 	argc 			number of command line arguments
+ * @param[in] 	argv 			array of command line arguments
+ * @param[out] 	input_filename 		filename of the input file
+ * @param[out] 	output_filename 	filename of the output file
+ *
+ */
+void parse_command_line(int argc, char **argv, char **input_filename,
+		char **output_filename)
+{
+	int i;
+
+	GENSVM_OUTPUT_FILE = stdout;
+	GENSVM_ERROR_FILE = stderr;
+
+	for (i=1; i<argc; i++) {
+		if (argv[i][0] != '-') break;
+		switch (argv[i][1]) {
+			case 'q':
+				GENSVM_OUTPUT_FILE = NULL;
+				GENSVM_ERROR_FILE = NULL;
+				break;
+			case 'c':
+				break;
+			case 'm':
+				break;
+			case 'x':
+				break;
+			default:
+				// this one should always print explicitly to
+				// stderr, even if '-q' is supplied, because
+				// otherwise you can't debug cmdline flags.
+				fprintf(stderr, "Unknown option: -%c\n",
+						argv[i][1]);
+				exit_with_help(argv);
+		}
+	}
+	if (i+2 != argc)
+		exit_with_help(argv);
+
+	(*input_filename) = Malloc(char, strlen(argv[i])+1);
+	strcpy((*input_filename), argv[i]);
+	(*output_filename) = Malloc(char, strlen(argv[i+1])+1);
+	strcpy((*output_filename), argv[i+1]);
+}
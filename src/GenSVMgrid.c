@@ -42,6 +42,8 @@
 #include "gensvm_consistency.h"
 #include "gensvm_io.h"
 #include "gensvm_gridsearch.h"
+#include "gensvm_sample.h"
+#include "gensvm_shard.h"
 #include "gensvm_train.h"
 
 /**
@@ -55,7 +57,8 @@ extern FILE *GENSVM_ERROR_FILE;
 // function declarations
 void exit_with_help(char **argv);
 long parse_command_line(int argc, char **argv, char *input_filename,
-		char **prediction_outputfile);
+		char **prediction_outputfile, PredictionFormat *format,
+		char **journal_file, char **shard_dir, long *lease_time);
 void read_grid_from_file(char *input_filename, struct GenGrid *grid);
 
 /**
@@ -76,10 +79,27 @@ void exit_with_help(char **argv)
 			"for details.\n\n");
 	printf("Usage: %s [options] grid_file\n", argv[0]);
 	printf("Options:\n");
+	printf("-f format  : format of the prediction output (0 = data and "
+			"labels, 1 = labels,\n             2 = labels and "
+			"decision values, 3 = labels and class\n"
+			"             distances, 4 = labels and class "
+			"probabilities)\n");
 	printf("-h | -help : print this help.\n");
+	printf("-L limit   : memory limit, e.g. 4G (also --memory-limit). "
+			"Fail before\n             exceeding it and report "
+			"the memory use (0 = report only)\n");
+	printf("-j journal : keep a journal of completed tasks in this file "
+			"and skip\n             tasks that are already in it "
+			"(use with -z to resume)\n");
 	printf("-o prediction_output : write predictions of test data to "
 			"file (uses stdout if not provided)\n");
 	printf("-q         : quiet mode (no output, not even errors!)\n");
+	printf("-s shard_dir : share the grid search with other processes "
+			"through this\n             directory (requires the "
+			"same -z on all processes)\n");
+	printf("-t lease_time : seconds without activity after which "
+			"another process takes\n             over a chunk "
+			"of -s (default %i)\n", GENSVM_SHARD_LEASE_TIME);
 	printf("-x         : data files are in LibSVM/SVMlight format\n");
 	printf("-z         : seed for the random number generator\n");
 
@@ -107,39 +127,41 @@ void exit_with_help(char **argv)
 int main(int argc, char **argv)
 {
 	int i, best_ID = -1;
-	long seed;
+	long seed, lease_time = GENSVM_SHARD_LEASE_TIME;
 	bool libsvm_format = false;
 	char input_filename[GENSVM_MAX_LINE_LENGTH];
 	char *prediction_outputfile = NULL;
+	char *journal_file = NULL;
+	PredictionFormat format = P_DATA;
+	char *shard_dir = NULL;
 
 	struct GenGrid *grid = gensvm_init_grid();
 	struct GenData *train_data = gensvm_init_data();
 	struct GenData *test_data = gensvm_init_data();
 	struct GenQueue *q = gensvm_init_queue();
+	struct GenJournal *journal = NULL;
+	struct GenShard *shard = NULL;
+	struct GenContext *ctx = NULL;
+	struct GenContext *sample_ctx = NULL;
 
 	if (argc < MINARGS || gensvm_check_argv(argc, argv, "-help")
 			|| gensvm_check_argv_eq(argc, argv, "-h") )
 		exit_with_help(argv);
 	seed = parse_command_line(argc, argv, input_filename,
-			&prediction_outputfile);
+			&prediction_outputfile, &format, &journal_file,
+			&shard_dir, &lease_time);
 	libsvm_format = gensvm_check_argv(argc, argv, "-x");
 
 	note("Reading grid file\n");
 	read_grid_from_file(input_filename, grid);
 
 	note("Reading data from %s\n", grid->train_data_file);
-	if (libsvm_format)
-		gensvm_read_data_libsvm(train_data, grid->train_data_file);
-	else
-		gensvm_read_data(train_data, grid->train_data_file);
+	gensvm_load_data(train_data, grid->train_data_file, libsvm_format);
 
 	// Read the test data if present
 	if (grid->test_data_file != NULL) {
-		if (libsvm_format)
-			gensvm_read_data_libsvm(test_data,
-					grid->test_data_file);
-		else
-			gensvm_read_data(test_data, grid->test_data_file);
+		gensvm_load_data(test_data, grid->test_data_file,
+				libsvm_format);
 	} else {
 		gensvm_free_data(test_data);
 		test_data = NULL;
@@ -158,23 +180,102 @@ int main(int argc, char **argv)
 		err("[GenSVM Warning]: Sparse matrices with nonlinear kernels "
 				"are not yet supported. Dense matrices will "
 				"be used.\n");
-		train_data->RAW = gensvm_sparse_to_dense(train_data->spZ);
-		train_data->Z = train_data->RAW;
-		gensvm_free_sparse(train_data->spZ);
+		gensvm_data_to_dense(train_data);
 	}
 
+	ctx = gensvm_init_context(seed);
+	ctx->output = GENSVM_OUTPUT_FILE;
+	ctx->error = GENSVM_ERROR_FILE;
+
 	note("Creating queue\n");
-	gensvm_fill_queue(grid, q, train_data, test_data);
+	if (grid->search == S_GRID) {
+		gensvm_fill_queue(grid, q, train_data, test_data);
+	} else {
+		// sample with a generator of its own, such that the cross
+		// validation split drawn from ctx only depends on the seed and
+		// overlapping searches can reuse the journal
+		sample_ctx = gensvm_init_context(gensvm_rng_derive(seed, 1));
+		sample_ctx->output = ctx->output;
+		sample_ctx->error = ctx->error;
+		gensvm_sample_queue(grid, q, train_data, test_data,
+				sample_ctx);
+		gensvm_free_context(sample_ctx);
+	}
 
-	srand(seed);
+	if (shard_dir != NULL && !gensvm_check_argv_eq(argc, argv, "-z")) {
+		err("[GenSVM Error]: A seed must be supplied with -z when "
+				"using -s, and it must be the same for all "
+				"processes.\n");
+		exit(EXIT_FAILURE);
+	}
+	if (shard_dir != NULL && journal_file != NULL) {
+		err("[GenSVM Error]: The -j and -s options can't be "
+				"combined.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	if (journal_file != NULL) {
+		if (!gensvm_check_argv_eq(argc, argv, "-z"))
+			err("[GenSVM Warning]: No seed supplied with -z. The "
+					"cross validation split will differ "
+					"between runs and the journal can't "
+					"be reused.\n");
+		journal = gensvm_journal_open(journal_file);
+		note("Using journal %s with %li completed tasks\n",
+				journal_file, journal->N);
+	}
+
+	// fail before training if a kernel matrix doesn't fit in the memory
+	// limit. This is the kernel of the training folds, or of the full
+	// training data if the best model is trained on it afterwards.
+	for (i=0; i<q->N; i++) {
+		long n_kernel = train_data->n;
+		if (q->tasks[i]->kerneltype == K_LINEAR)
+			continue;
+		if (test_data == NULL)
+			n_kernel -= train_data->n / q->tasks[i]->folds;
+		if (!gensvm_memory_available(gensvm_kernel_memory(n_kernel))) {
+			err("[GenSVM Error]: The kernel matrix of %li "
+					"instances needs about %.1f MB, which "
+					"exceeds the memory limit of %.1f MB.\n",
+					n_kernel,
+					gensvm_kernel_memory(n_kernel) /
+					1048576.0,
+					gensvm_memory_limit() / 1048576.0);
+			exit(EXIT_FAILURE);
+		}
+		break;
+	}
+	// the consistency repeats keep the kernels of their folds, of which at
+	// least one per repeat has to fit
+	if (grid->repeats > 0 && q->N > 0 &&
+			!gensvm_memory_available(
+				gensvm_repeats_memory(q, 1, 1))) {
+		err("[GenSVM Error]: The kernels of the consistency repeats "
+				"need about %.1f MB, which exceeds the memory "
+				"limit of %.1f MB.\n",
+				gensvm_repeats_memory(q, 1, 1) / 1048576.0,
+				gensvm_memory_limit() / 1048576.0);
+		exit(EXIT_FAILURE);
+	}
 
 	note("Starting training\n");
-	gensvm_train_queue(q);
+	if (shard_dir != NULL) {
+		shard = gensvm_init_shard(shard_dir, seed);
+		shard->lease_time = lease_time;
+		gensvm_shard_work(shard, q, ctx);
+		if (!gensvm_shard_merge(shard, q, ctx)) {
+			note("Results are merged by another worker\n");
+			goto cleanup;
+		}
+	} else {
+		gensvm_train_queue(q, journal, ctx);
+	}
 	note("Training finished\n");
 
 	if (grid->repeats > 0) {
 		best_ID = gensvm_consistency_repeats(q, grid->repeats,
-				grid->percentile);
+				grid->percentile, ctx);
 	} else {
 		double maxperf = -1;
 		for (i=0; i<q->N; i++) {
@@ -191,7 +292,7 @@ int main(int argc, char **argv)
 		struct GenTask *best_task = NULL;
 		struct GenModel *best_model = NULL;
 		long *predy = NULL;
-		double performance = -1;
+		double performance = -1, *values = NULL;
 
 		for (i=0; i<q->N; i++)
 			if (q->tasks[i]->ID == best_ID)
@@ -200,7 +301,7 @@ int main(int argc, char **argv)
 		best_model = gensvm_init_model();
 		gensvm_task_to_model(best_task, best_model);
 
-		gensvm_train(best_model, train_data, NULL);
+		gensvm_train(best_model, train_data, NULL, ctx);
 
 		// check if we are sparse and want nonlinearity
 		if (test_data->Z == NULL &&
@@ -208,15 +309,19 @@ int main(int argc, char **argv)
 			err("[GenSVM Warning]: Sparse matrices with nonlinear "
 					"kernels are not yet supported. Dense "
 					"matrices will be used.\n");
-			test_data->Z = gensvm_sparse_to_dense(test_data->spZ);
-			gensvm_free_sparse(test_data->spZ);
+			gensvm_data_to_dense(test_data);
 		}
 
 		gensvm_kernel_postprocess(best_model, train_data, test_data);
 
-		// predict labels
+		// predict labels and the values of the output format, the
+		// temperature of the probabilities is taken from the cross
+		// validation of the best task
 		predy = Calloc(long, test_data->n);
-		gensvm_predict_labels(test_data, best_model, predy);
+		if (format >= P_DECISION)
+			values = Calloc(double, test_data->n*best_model->K);
+		gensvm_predict_values(test_data, best_model, format, predy,
+				values);
 
 		if (test_data->y != NULL) {
 			performance = gensvm_prediction_perf(test_data, predy);
@@ -225,8 +330,9 @@ int main(int argc, char **argv)
 
 		// if output file is specified, write predictions to it
 		if (gensvm_check_argv_eq(argc, argv, "-o")) {
-			gensvm_write_predictions(test_data, predy,
-				       	prediction_outputfile);
+			gensvm_write_predictions_format(test_data, predy,
+					values, best_model->K, format,
+					prediction_outputfile);
 			note("Prediction written to: %s\n",
 				       	prediction_outputfile);
 		} else {
@@ -236,13 +342,20 @@ int main(int argc, char **argv)
 		}
 
 		gensvm_free_model(best_model);
-		free(predy);
+		Free(predy);
+		Free(values);
 	}
 
+cleanup:
 	gensvm_free_queue(q);
 	gensvm_free_grid(grid);
 	gensvm_free_data(train_data);
 	gensvm_free_data(test_data);
+	gensvm_free_journal(journal);
+	gensvm_free_shard(shard);
+	gensvm_free_context(ctx);
+	Free(journal_file);
+	Free(shard_dir);
 
 	note("Done.\n");
 	return 0;
@@ -261,11 +374,18 @@ int main(int argc, char **argv)
  * @param[in] 	argv 		array of command line arguments
  * @param[in] 	input_filename 	pre-allocated buffer for the grid
  * 				filename.
+ * @param[out] 	prediction_outputfile 	filename for the predictions
+ * @param[out] 	format 		format of the predictions
+ * @param[out] 	journal_file 	filename of the journal
+ * @param[out] 	shard_dir 	shared directory for a sharded grid search
+ * @param[out] 	lease_time 	lease time in seconds of a sharded grid
+ * 				search
  * @returns 			seed for the RNG
  *
  */
 long parse_command_line(int argc, char **argv, char *input_filename,
-		char **prediction_outputfile)
+		char **prediction_outputfile, PredictionFormat *format,
+		char **journal_file, char **shard_dir, long *lease_time)
 {
 	long seed = time(NULL);
 	int i;
@@ -278,16 +398,60 @@ long parse_command_line(int argc, char **argv, char *input_filename,
 		if (++i>=argc)
 			exit_with_help(argv);
 		switch (argv[i-1][1]) {
+			case 'f':
+				*format = atoi(argv[i]);
+				if (*format < P_DATA ||
+						*format > P_PROBABILITIES) {
+					fprintf(stderr, "Invalid format: %s\n",
+							argv[i]);
+					exit_with_help(argv);
+				}
+				break;
 			case 'o':
 				(*prediction_outputfile) = Malloc(char,
 						strlen(argv[i]) + 1);
 				strcpy((*prediction_outputfile), argv[i]);
 				break;
+			case 'j':
+				(*journal_file) = Malloc(char,
+						strlen(argv[i]) + 1);
+				strcpy((*journal_file), argv[i]);
+				break;
+			case '-':
+				if (strcmp(argv[i-1], "--memory-limit") != 0) {
+					fprintf(stderr, "Unknown option: %s\n",
+							argv[i-1]);
+					exit_with_help(argv);
+				}
+				// fall through
+			case 'L':
+				if (str_to_bytes(argv[i]) == 0 &&
+						strcmp(argv[i], "0") != 0) {
+					fprintf(stderr, "Invalid memory limit: "
+							"%s\n", argv[i]);
+					exit_with_help(argv);
+				}
+				gensvm_memory_set_limit(str_to_bytes(argv[i]));
+				gensvm_memory_track(true);
+				break;
 			case 'q':
 				GENSVM_OUTPUT_FILE = NULL;
 				GENSVM_ERROR_FILE = NULL;
 				i--;
 				break;
+			case 's':
+				(*shard_dir) = Malloc(char,
+						strlen(argv[i]) + 1);
+				strcpy((*shard_dir), argv[i]);
+				break;
+			case 't':
+				*lease_time = atol(argv[i]);
+				if (*lease_time <= 0) {
+					fprintf(stderr, "Invalid lease time: "
+							"%s\n", argv[i]);
+					exit_with_help(argv);
+				}
+				break;
 			case 'x':
 				i--;
 				break;
@@ -338,6 +502,35 @@ KernelType parse_kernel_str(char *kernel_line)
 	}
 }
 
+/**
+ * @brief Parse the search string from the training file
+ *
+ * @details
+ * This is a utility function for the read_grid_from_file() function, similar
+ * to parse_kernel_str(). It reads the line from the given buffer and returns
+ * the corresponding SearchType.
+ *
+ * @param[in] 	search_line 	line from the file with the search
+ * 				specification
+ * @return 	the corresponding searchtype
+ */
+SearchType parse_search_str(char *search_line)
+{
+	if (str_endswith(search_line, "GRID\n")) {
+		return S_GRID;
+	} else if (str_endswith(search_line, "RANDOM\n")) {
+		return S_RANDOM;
+	} else if (str_endswith(search_line, "SOBOL\n")) {
+		return S_SOBOL;
+	} else if (str_endswith(search_line, "HALTON\n")) {
+		return S_HALTON;
+	} else {
+		fprintf(stderr, "Unknown search specified on line: %s\n",
+				search_line);
+		exit(EXIT_FAILURE);
+	}
+}
+
 /**
  * @brief Read the GenGrid struct from file
  *
@@ -420,6 +613,13 @@ void read_grid_from_file(char *input_filename, struct GenGrid *grid)
 				fprintf(stderr, "Field \"folds\" only takes "
 						"one value. Additional "
 						"fields are ignored.\n");
+		} else if (str_startswith(buffer, "stratified:")) {
+			nr = all_longs_str(buffer, 11, lparams);
+			grid->stratified = (lparams[0] != 0);
+			if (nr > 1)
+				fprintf(stderr, "Field \"stratified\" only "
+						"takes one value. Additional "
+						"fields are ignored.\n");
 		} else if (str_startswith(buffer, "repeats:")) {
 			nr = all_longs_str(buffer, 8, lparams);
 			grid->repeats = lparams[0];
@@ -434,6 +634,15 @@ void read_grid_from_file(char *input_filename, struct GenGrid *grid)
 				fprintf(stderr, "Field \"percentile\" only "
 						"takes one value. Additional "
 						"fields are ignored.\n");
+		} else if (str_startswith(buffer, "search:")) {
+			grid->search = parse_search_str(buffer);
+		} else if (str_startswith(buffer, "tasks:")) {
+			nr = all_longs_str(buffer, 6, lparams);
+			grid->n_tasks = lparams[0];
+			if (nr > 1)
+				fprintf(stderr, "Field \"tasks\" only takes "
+						"one value. Additional "
+						"fields are ignored.\n");
 		} else if (str_startswith(buffer, "kernel:")) {
 			grid->kerneltype = parse_kernel_str(buffer);
 		} else if (str_startswith(buffer, "gamma:")) {
@@ -479,7 +688,7 @@ void read_grid_from_file(char *input_filename, struct GenGrid *grid)
 		}
 	}
 
-	free(params);
-	free(lparams);
+	Free(params);
+	Free(lparams);
 	fclose(fid);
 }
@@ -0,0 +1,465 @@
+/**
+ * @file GenSVMpredict.c
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Command line interface for predicting with a saved model
+ *
+ * @details
+ * This is a command line program for predicting the class labels of a test
+ * dataset with a model that was saved by one of the other programs, without
+ * training it again. The model can be a text model file (see @ref
+ * spec_model_file) or a binary model file (see @ref spec_binary_model_file).
+ *
+ * The test data is read in blocks of instances and the predictions for a
+ * block are written before the next block is read, so the test set doesn't
+ * have to fit in memory. The test data can also be read from the standard
+ * input by using "-" as filename. Binary data files (see @ref
+ * spec_binary_data_file) are memory mapped instead.
+ *
+ * For nonlinear models the training data file that is stored in the model is
+ * read to compute the kernel between the training and the test instances.
+ * Text model files don't store the kernel, so it has to be given on the
+ * command line for these files.
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "gensvm_cmdarg.h"
+#include "gensvm_compact.h"
+#include "gensvm_io.h"
+#include "gensvm_kernel.h"
+#include "gensvm_predict.h"
+#include "gensvm_quantize.h"
+
+/**
+ * Minimal number of command line arguments
+ */
+#define MINARGS 3
+
+extern FILE *GENSVM_OUTPUT_FILE;
+extern FILE *GENSVM_ERROR_FILE;
+
+// function declarations
+void exit_with_help(char **argv);
+void exit_invalid_param(const char *label, char **argv);
+void parse_command_line(int argc, char **argv, struct GenModel *model,
+		char **model_inputfile, char **testing_inputfile,
+		char **prediction_outputfile, PredictionFormat *format,
+		double *tolerance, QuantizeType *quantize);
+struct GenData *load_training_data(struct GenModel *model,
+		bool libsvm_format);
+
+/**
+ * @brief Help function
+ *
+ * @details
+ * Print help for this program and exit. Note that the VERSION is defined in
+ * the Makefile.
+ *
+ * @param[in] 	argv 	command line arguments
+ *
+ */
+void exit_with_help(char **argv)
+{
+	printf("This is GenSVM, version %s.\n", VERSION_STRING);
+	printf("Copyright (C) 2016, G.J.J. van den Burg.\n");
+	printf("This program is free software, see the LICENSE file "
+			"for details.\n\n");
+	printf("Usage: %s [options] model_file test_data\n\n", argv[0]);
+	printf("Use - as test_data to read the test data from stdin.\n\n");
+	printf("Options:\n");
+	printf("--------\n");
+	printf("-c coef              : coefficient for the polynomial and "
+			"sigmoid kernel\n");
+	printf("-d degree            : degree for the polynomial kernel\n");
+	printf("-f format            : format of the prediction output (0 = "
+			"data and labels,\n"
+			"                       1 = labels, 2 = labels and "
+			"decision values,\n"
+			"                       3 = labels and class distances, "
+			"4 = labels and\n"
+			"                       class probabilities)\n");
+	printf("-g gamma             : parameter for the rbf, polynomial or "
+			"sigmoid kernel\n");
+	printf("-h | -help           : print this help.\n");
+	printf("-o prediction_output : write predictions of test data to "
+			"file (uses stdout if not provided)\n");
+	printf("-q                   : quiet mode (no output, not even "
+			"errors!)\n");
+	printf("-Q type              : predict with a quantized linear model "
+			"(1 = int8,\n"
+			"                       2 = float16) and compare it "
+			"with the double model\n");
+	printf("-r tolerance         : compact a nonlinear model to this "
+			"relative error of the\n"
+			"                       decision values (default: 0, "
+			"no compaction)\n");
+	printf("-t type              : kerneltype (0=LINEAR, 1=POLY, 2=RBF, "
+			"3=SIGMOID)\n");
+	printf("-x                   : data files are in LibSVM/SVMlight "
+			"format\n");
+	printf("\n");
+	printf("The kernel options are only used for text model files, "
+			"binary model files\n"
+			"store the kernel of the model.\n");
+	printf("\n");
+
+	exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief Exit with warning about invalid parameter value.
+ *
+ * @param[in] 	label 	name of the parameter
+ * @param[in] 	argv 	command line arguments
+ */
+void exit_invalid_param(const char *label, char **argv)
+{
+	fprintf(stderr, "Invalid parameter value for %s.\n\n", label);
+	exit_with_help(argv);
+}
+
+/**
+ * @brief Main interface function for GenSVMpredict
+ *
+ * @details
+ * Main interface for the GenSVMpredict commandline program.
+ *
+ * @param[in] 	argc 	number of command line arguments
+ * @param[in] 	argv 	array of command line arguments
+ *
+ * @return 		exit status
+ */
+int main(int argc, char **argv)
+{
+	bool libsvm_format = false;
+	long i, m, rows, n = 0, n_labeled = 0, n_correct = 0,
+	     *predy = NULL;
+	double error, tolerance = 0,
+	       *values = NULL;
+	PredictionFormat format = P_LABELS;
+	QuantizeType quantize = Q_NONE;
+	FILE *fid = NULL;
+
+	char *model_inputfile = NULL,
+	     *testing_inputfile = NULL,
+	     *prediction_outputfile = NULL;
+
+	struct GenModel *model = gensvm_init_model();
+	struct GenQuantModel *quant = NULL;
+	struct GenQuantReport *report = NULL;
+	struct GenData *traindata = NULL;
+	struct GenData *support = NULL;
+	struct GenData *block = NULL;
+	struct GenDataStream *stream = NULL;
+
+	if (argc < MINARGS || gensvm_check_argv(argc, argv, "-help")
+			|| gensvm_check_argv_eq(argc, argv, "-h"))
+		exit_with_help(argv);
+
+	parse_command_line(argc, argv, model, &model_inputfile,
+			&testing_inputfile, &prediction_outputfile, &format,
+			&tolerance, &quantize);
+	libsvm_format = gensvm_check_argv(argc, argv, "-x");
+
+	// read the model, the kernel of a binary model replaces the kernel
+	// from the command line
+	gensvm_read_model(model, model_inputfile);
+
+	// nonlinear models need the training data for the kernel
+	m = model->m;
+	if (model->kerneltype != K_LINEAR) {
+		traindata = load_training_data(model, libsvm_format);
+		m = traindata->m;
+	}
+
+	// quantize the model, predictions are made with the quantized model
+	// and compared with those of the double model
+	if (quantize != Q_NONE) {
+		if (model->kerneltype != K_LINEAR) {
+			err("[GenSVM Error]: Only linear models can be "
+					"quantized.\n");
+			exit(EXIT_FAILURE);
+		}
+		quant = gensvm_quantize_model(model, quantize);
+		report = gensvm_init_quant_report();
+	}
+
+	// replace the training data by a reduced set of instances
+	if (traindata != NULL && tolerance > 0) {
+		support = gensvm_init_data();
+		error = gensvm_compact(model, traindata, support, tolerance);
+		note("Compacted model to %li of %li training instances "
+				"(relative error %g)\n", support->n,
+				traindata->n, error);
+		gensvm_free_data(traindata);
+		traindata = support;
+	}
+
+	if (prediction_outputfile != NULL) {
+		fid = fopen(prediction_outputfile, "w");
+		if (fid == NULL) {
+			// LCOV_EXCL_START
+			err("[GenSVM Error]: Error opening output file %s\n",
+					prediction_outputfile);
+			exit(EXIT_FAILURE);
+			// LCOV_EXCL_STOP
+		}
+	} else {
+		fid = stdout;
+	}
+
+	if (gensvm_is_binary_data(testing_inputfile)) {
+		block = gensvm_init_data();
+		gensvm_read_data_binary(block, testing_inputfile);
+		rows = block->n;
+	} else {
+		stream = gensvm_open_data_stream(testing_inputfile,
+				libsvm_format, m);
+		if (format == P_DATA && stream->n < 0) {
+			err("[GenSVM Error]: Prediction format 0 needs the "
+					"number of instances, which LibSVM/"
+					"SVMlight files don't have.\n");
+			exit(EXIT_FAILURE);
+		}
+		block = gensvm_init_data();
+		rows = gensvm_read_data_stream(stream, block);
+	}
+
+	if (format == P_DATA)
+		fprintf(fid, "%li\n%li\n", stream != NULL ? stream->n :
+				block->n, block->m);
+
+	while (rows > 0) {
+		if (block->m != m) {
+			err("[GenSVM Error]: The test data has %li features, "
+					"but the model expects %li.\n",
+					block->m, m);
+			exit(EXIT_FAILURE);
+		}
+
+		// check if we are sparse and want nonlinearity
+		if (block->Z == NULL && model->kerneltype != K_LINEAR)
+			gensvm_data_to_dense(block);
+
+		gensvm_kernel_postprocess(model, traindata, block);
+
+		predy = Calloc(long, block->n);
+		if (format >= P_DECISION)
+			values = Calloc(double, block->n*model->K);
+		if (quant != NULL) {
+			gensvm_quant_predict_values(quant, block, format,
+					predy, values);
+			gensvm_quant_compare(report, quant, model, block);
+		} else {
+			gensvm_predict_values(block, model, format, predy,
+					values);
+		}
+		gensvm_write_predictions_stream(fid, block, predy, values,
+				model->K, format);
+
+		if (block->y != NULL) {
+			for (i=0; i<block->n; i++)
+				n_correct += (predy[i] == block->y[i]);
+			n_labeled += block->n;
+		}
+		n += block->n;
+
+		Free(predy);
+		Free(values);
+		predy = NULL;
+		values = NULL;
+		gensvm_free_data(block);
+		block = NULL;
+
+		if (stream == NULL)
+			break;
+		block = gensvm_init_data();
+		rows = gensvm_read_data_stream(stream, block);
+	}
+
+	if (fid != stdout)
+		fclose(fid);
+	else
+		fflush(fid);
+
+	if (report != NULL)
+		gensvm_quant_report(report, quant);
+	if (n_labeled > 0)
+		note("Predictive performance: %3.2f%%\n",
+				((double) n_correct)/((double) n_labeled)*100.0);
+	if (prediction_outputfile != NULL)
+		note("Predictions for %li instances written to: %s\n", n,
+				prediction_outputfile);
+
+	gensvm_close_data_stream(stream);
+	gensvm_free_data(block);
+	gensvm_free_data(traindata);
+	gensvm_free_quant_report(report);
+	gensvm_free_quant_model(quant);
+	gensvm_free_model(model);
+	Free(model_inputfile);
+	Free(testing_inputfile);
+	Free(prediction_outputfile);
+
+	return 0;
+}
+
+/**
+ * @brief Load the training data of a nonlinear model
+ *
+ * @details
+ * The kernel of a nonlinear model is computed from the training data, which
+ * is read from the GenModel::data_file of the model. The kernel
+ * decomposition is repeated here, and it should give the same number of
+ * dimensions as when the model was trained.
+ *
+ * @param[in] 	model 		the GenSVM model
+ * @param[in] 	libsvm_format 	whether the data is in LibSVM/SVMlight format
+ * @returns 			the training data, after the kernel
+ * 				preprocessing
+ */
+struct GenData *load_training_data(struct GenModel *model,
+		bool libsvm_format)
+{
+	struct GenData *traindata = gensvm_init_data();
+
+	note("Reading training data from %s\n", model->data_file);
+	gensvm_load_data(traindata, model->data_file, libsvm_format);
+	if (traindata->Z == NULL)
+		gensvm_data_to_dense(traindata);
+
+	gensvm_kernel_preprocess(model, traindata);
+	if (traindata->r != model->m) {
+		err("[GenSVM Error]: The kernel of the training data has %li "
+				"dimensions, but the model has %li. Is the "
+				"kernel specified correctly?\n",
+				traindata->r, model->m);
+		exit(EXIT_FAILURE);
+	}
+	return traindata;
+}
+
+/**
+ * @brief Parse the command line arguments
+ *
+ * @details
+ * For a full overview of the command line arguments and their meaning see
+ * exit_with_help(). This function furthermore sets the default output
+ * streams. When the predictions are written to stdout, the other output is
+ * written to stderr so it doesn't mix with the predictions.
+ *
+ * @param[in] 	argc 			number of command line arguments
+ * @param[in] 	argv 			array of command line arguments
+ * @param[in] 	model 			initialized model for the kernel
+ * 					parameters
+ * @param[out] 	model_inputfile 	filename of the model file
+ * @param[out] 	testing_inputfile 	filename of the test data
+ * @param[out] 	prediction_outputfile 	filename for the predictions, or
+ * 					NULL for stdout
+ * @param[out] 	format 			format of the predictions
+ * @param[out] 	tolerance 		relative error for compacting the
+ * 					model
+ * @param[out] 	quantize 		type of quantization of the model
+ *
+ */
+void parse_command_line(int argc, char **argv, struct GenModel *model,
+		char **model_inputfile, char **testing_inputfile,
+		char **prediction_outputfile, PredictionFormat *format,
+		double *tolerance, QuantizeType *quantize)
+{
+	int i;
+	bool quiet = false;
+
+	// parse options
+	// note: flags that don't have an argument should decrement i
+	for (i=1; i<argc; i++) {
+		if (argv[i][0] != '-' || argv[i][1] == '\0') break;
+		if (++i>=argc) {
+			exit_with_help(argv);
+		}
+		switch (argv[i-1][1]) {
+			case 'c':
+				model->coef = atof(argv[i]);
+				break;
+			case 'd':
+				model->degree = atof(argv[i]);
+				break;
+			case 'f':
+				*format = atoi(argv[i]);
+				if (*format < P_DATA ||
+						*format > P_PROBABILITIES)
+					exit_invalid_param("format", argv);
+				break;
+			case 'g':
+				model->gamma = atof(argv[i]);
+				break;
+			case 'o':
+				(*prediction_outputfile) = Malloc(char,
+						strlen(argv[i])+1);
+				strcpy((*prediction_outputfile), argv[i]);
+				break;
+			case 'Q':
+				*quantize = atoi(argv[i]);
+				if (*quantize < Q_NONE ||
+						*quantize > Q_FLOAT16)
+					exit_invalid_param("quantization type",
+							argv);
+				break;
+			case 'r':
+				*tolerance = atof(argv[i]);
+				if (*tolerance < 0)
+					exit_invalid_param("tolerance", argv);
+				break;
+			case 't':
+				model->kerneltype = atoi(argv[i]);
+				break;
+			case 'q':
+				quiet = true;
+				i--;
+				break;
+			case 'x':
+				i--;
+				break;
+			default:
+				// this one should always print explicitly to
+				// stderr, even if '-q' is supplied, because
+				// otherwise you can't debug cmdline flags.
+				fprintf(stderr, "Unknown option: -%c\n",
+						argv[i-1][1]);
+				exit_with_help(argv);
+		}
+	}
+	if (i+2 != argc)
+		exit_with_help(argv);
+
+	GENSVM_OUTPUT_FILE = (*prediction_outputfile == NULL) ? stderr :
+		stdout;
+	GENSVM_ERROR_FILE = stderr;
+	if (quiet) {
+		GENSVM_OUTPUT_FILE = NULL;
+		GENSVM_ERROR_FILE = NULL;
+	}
+
+	(*model_inputfile) = Malloc(char, strlen(argv[i])+1);
+	strcpy((*model_inputfile), argv[i]);
+	(*testing_inputfile) = Malloc(char, strlen(argv[i+1])+1);
+	strcpy((*testing_inputfile), argv[i+1]);
+}
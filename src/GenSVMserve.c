@@ -0,0 +1,246 @@
+/**
+ * @file GenSVMserve.c
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Command line interface for serving predictions over a socket
+ *
+ * @details
+ * This is a command line program that loads one or more models once and
+ * answers prediction requests on a Unix domain socket, see @ref
+ * spec_serve_protocol for the protocol. This avoids reading the model, and
+ * for nonlinear models the training data, for every prediction.
+ *
+ * The models are loaded again when the program receives SIGHUP, and the
+ * current models are kept if that fails. The program stops on SIGINT or
+ * SIGTERM. Text model files don't store the kernel, so it has to be given on
+ * the command line for these files.
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "gensvm_cmdarg.h"
+#include "gensvm_serve.h"
+
+#include <signal.h>
+
+/**
+ * Minimal number of command line arguments
+ */
+#define MINARGS 3
+
+extern FILE *GENSVM_OUTPUT_FILE;
+extern FILE *GENSVM_ERROR_FILE;
+
+// function declarations
+void exit_with_help(char **argv);
+void parse_command_line(int argc, char **argv, struct GenModel *kernel,
+		long *n_workers, double *tolerance, char **socket_path,
+		char ***model_files, long *n_models);
+
+/**
+ * @brief Help function
+ *
+ * @details
+ * Print help for this program and exit. Note that the VERSION is defined in
+ * the Makefile.
+ *
+ * @param[in] 	argv 	command line arguments
+ *
+ */
+void exit_with_help(char **argv)
+{
+	printf("This is GenSVM, version %s.\n", VERSION_STRING);
+	printf("Copyright (C) 2016, G.J.J. van den Burg.\n");
+	printf("This program is free software, see the LICENSE file "
+			"for details.\n\n");
+	printf("Usage: %s [options] socket_path model_file [model_file ...]"
+			"\n\n", argv[0]);
+	printf("Options:\n");
+	printf("--------\n");
+	printf("-c coef              : coefficient for the polynomial and "
+			"sigmoid kernel\n");
+	printf("-d degree            : degree for the polynomial kernel\n");
+	printf("-g gamma             : parameter for the rbf, polynomial or "
+			"sigmoid kernel\n");
+	printf("-h | -help           : print this help.\n");
+	printf("-q                   : quiet mode (no output, not even "
+			"errors!)\n");
+	printf("-r tolerance         : compact nonlinear models to this "
+			"relative error of the\n"
+			"                       decision values (default: 0, "
+			"no compaction)\n");
+	printf("-t type              : kerneltype (0=LINEAR, 1=POLY, 2=RBF, "
+			"3=SIGMOID)\n");
+	printf("-w workers           : number of worker threads (default: "
+			"number of processors)\n");
+	printf("-x                   : training data files are in "
+			"LibSVM/SVMlight format\n");
+	printf("\n");
+	printf("The kernel options are only used for text model files, "
+			"binary model files\n"
+			"store the kernel of the model. Models are numbered "
+			"from 0 in the order\n"
+			"they are given. Send SIGHUP to load the models again, "
+			"the current models\n"
+			"are kept if they can't be loaded.\n");
+	printf("\n");
+
+	exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief Main interface function for GenSVMserve
+ *
+ * @details
+ * Main interface for the GenSVMserve commandline program. The signals are
+ * blocked before the worker threads are started, so that they are only
+ * received by the main thread in sigwait().
+ *
+ * @param[in] 	argc 	number of command line arguments
+ * @param[in] 	argv 	array of command line arguments
+ *
+ * @return 		exit status
+ */
+int main(int argc, char **argv)
+{
+	int sig;
+	long n_workers = 0,
+	     n_models = 0;
+	double tolerance = 0;
+	char *socket_path = NULL,
+	     **model_files = NULL;
+	sigset_t signals;
+
+	struct GenModel *kernel = gensvm_init_model();
+	struct GenServer *server = NULL;
+
+	if (argc < MINARGS || gensvm_check_argv(argc, argv, "-help")
+			|| gensvm_check_argv_eq(argc, argv, "-h"))
+		exit_with_help(argv);
+
+	parse_command_line(argc, argv, kernel, &n_workers, &tolerance,
+			&socket_path, &model_files, &n_models);
+	if (n_workers <= 0)
+		n_workers = gensvm_context_threads(NULL, LONG_MAX);
+
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGHUP);
+	sigaddset(&signals, SIGINT);
+	sigaddset(&signals, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+	server = gensvm_init_server(model_files, n_models, kernel,
+			gensvm_check_argv(argc, argv, "-x"), tolerance);
+	gensvm_serve_start(server, socket_path, n_workers);
+	note("Serving %li model(s) on %s with %li worker(s)\n", n_models,
+			socket_path, n_workers);
+
+	while (sigwait(&signals, &sig) == 0 && sig == SIGHUP) {
+		note("Reloading models\n");
+		gensvm_serve_reload(server);
+	}
+
+	note("Stopping\n");
+	gensvm_free_server(server);
+	gensvm_free_model(kernel);
+	Free(model_files);
+
+	return 0;
+}
+
+/**
+ * @brief Parse the command line arguments
+ *
+ * @details
+ * For a full overview of the command line arguments and their meaning see
+ * exit_with_help(). This function furthermore sets the default output
+ * streams to stdout/stderr. The model filenames point into argv.
+ *
+ * @param[in] 	argc 		number of command line arguments
+ * @param[in] 	argv 		array of command line arguments
+ * @param[in] 	kernel 		initialized model for the kernel parameters
+ * @param[out] 	n_workers 	number of worker threads, 0 if not given
+ * @param[out] 	tolerance 	relative error for compacting the models, 0
+ * 				if not given
+ * @param[out] 	socket_path 	path of the socket
+ * @param[out] 	model_files 	array of model filenames
+ * @param[out] 	n_models 	number of models
+ *
+ */
+void parse_command_line(int argc, char **argv, struct GenModel *kernel,
+		long *n_workers, double *tolerance, char **socket_path,
+		char ***model_files, long *n_models)
+{
+	int i;
+
+	GENSVM_OUTPUT_FILE = stdout;
+	GENSVM_ERROR_FILE = stderr;
+
+	// parse options
+	// note: flags that don't have an argument should decrement i
+	for (i=1; i<argc; i++) {
+		if (argv[i][0] != '-') break;
+		if (++i>=argc) {
+			exit_with_help(argv);
+		}
+		switch (argv[i-1][1]) {
+			case 'c':
+				kernel->coef = atof(argv[i]);
+				break;
+			case 'd':
+				kernel->degree = atof(argv[i]);
+				break;
+			case 'g':
+				kernel->gamma = atof(argv[i]);
+				break;
+			case 'r':
+				*tolerance = atof(argv[i]);
+				break;
+			case 't':
+				kernel->kerneltype = atoi(argv[i]);
+				break;
+			case 'w':
+				*n_workers = atol(argv[i]);
+				break;
+			case 'q':
+				GENSVM_OUTPUT_FILE = NULL;
+				GENSVM_ERROR_FILE = NULL;
+				i--;
+				break;
+			case 'x':
+				i--;
+				break;
+			default:
+				// this one should always print explicitly to
+				// stderr, even if '-q' is supplied, because
+				// otherwise you can't debug cmdline flags.
+				fprintf(stderr, "Unknown option: -%c\n",
+						argv[i-1][1]);
+				exit_with_help(argv);
+		}
+	}
+	if (i+2 > argc)
+		exit_with_help(argv);
+
+	*socket_path = argv[i];
+	*n_models = argc - i - 1;
+	*model_files = Malloc(char *, *n_models);
+	memcpy(*model_files, &argv[i+1], (*n_models)*sizeof(char *));
+}
@@ -29,6 +29,7 @@
  */
 
 #include "gensvm_checks.h"
+#include "gensvm_codegen.h"
 #include "gensvm_cmdarg.h"
 #include "gensvm_io.h"
 #include "gensvm_train.h"
@@ -47,7 +48,8 @@ void exit_with_help(char **argv);
 void parse_command_line(int argc, char **argv, struct GenModel *model,
 		char **model_inputfile, char **training_inputfile,
 		char **testing_inputfile, char **model_outputfile,
-		char **prediction_outputfile);
+		char **binary_model_outputfile, char **codegen_outputfile,
+		char **prediction_outputfile, PredictionFormat *format);
 
 /**
  * @brief Help function
@@ -68,11 +70,22 @@ void exit_with_help(char **argv)
 	printf("Usage: %s [options] training_data [test_data]\n\n", argv[0]);
 	printf("Options:\n");
 	printf("--------\n");
+	printf("-b                   : stream the training data from disk "
+			"in blocks of rows\n"
+			"                       (binary data files only, see "
+			"gensvm_convert)\n");
 	printf("-c coef              : coefficient for the polynomial and "
 			"sigmoid kernel\n");
 	printf("-d degree            : degree for the polynomial kernel\n");
 	printf("-e epsilon           : set the value of the stopping "
 			"criterion (epsilon > 0)\n");
+	printf("-f format            : format of the prediction output (0 = "
+			"data and labels,\n"
+			"                       1 = labels, 2 = labels and "
+			"decision values,\n"
+			"                       3 = labels and class distances, "
+			"4 = labels and\n"
+			"                       class probabilities)\n");
 	printf("-g gamma             : parameter for the rbf, polynomial or "
 			"sigmoid kernel\n");
 	printf("-h | -help           : print this help.\n");
@@ -81,8 +94,19 @@ void exit_with_help(char **argv)
 			"Huber hinge (kappa > -1.0)\n");
 	printf("-l lambda            : set the value of lambda "
 			"(lambda > 0)\n");
+	printf("-L limit             : memory limit, e.g. 4G (also "
+			"--memory-limit). Fail before\n"
+			"                       exceeding it, stream binary "
+			"training data that doesn't\n"
+			"                       fit, and report the memory use "
+			"(0 = report only)\n");
 	printf("-m model_output_file : write model output to file "
 			"(not saved if no file provided)\n");
+	printf("-M model_output_file : write model output to file in binary "
+			"format\n");
+	printf("-C c_output_file     : write a standalone C predictor for "
+			"the model to file\n"
+			"                       (linear models only)\n");
 	printf("-o prediction_output : write predictions of test data to "
 			"file (uses stdout if not provided)\n");
 	printf("-p p-value           : set the value of p in the lp norm "
@@ -117,12 +141,15 @@ int main(int argc, char **argv)
 {
 	bool libsvm_format = false;
 	long i, *predy = NULL;
-	double performance;
+	double performance, *values = NULL;
+	PredictionFormat format = P_DATA;
 
 	char *training_inputfile = NULL,
 	     *testing_inputfile = NULL,
 	     *model_inputfile = NULL,
 	     *model_outputfile = NULL,
+	     *binary_model_outputfile = NULL,
+	     *codegen_outputfile = NULL,
 	     *prediction_outputfile = NULL;
 
 	struct GenModel *model = gensvm_init_model();
@@ -137,14 +164,18 @@ int main(int argc, char **argv)
 	// parse command line arguments
 	parse_command_line(argc, argv, model, &model_inputfile,
 		       	&training_inputfile, &testing_inputfile,
-		       	&model_outputfile, &prediction_outputfile);
+		       	&model_outputfile, &binary_model_outputfile,
+			&codegen_outputfile, &prediction_outputfile, &format);
 	libsvm_format = gensvm_check_argv(argc, argv, "-x");
+	traindata->out_of_core = gensvm_check_argv_eq(argc, argv, "-b");
+	if (codegen_outputfile != NULL && model->kerneltype != K_LINEAR) {
+		err("[GenSVM Error]: A C predictor can only be generated for "
+				"a linear model.\n");
+		exit(EXIT_FAILURE);
+	}
 
 	// read data from file
-	if (libsvm_format)
-		gensvm_read_data_libsvm(traindata, training_inputfile);
-	else
-		gensvm_read_data(traindata, training_inputfile);
+	gensvm_load_data(traindata, training_inputfile, libsvm_format);
 
 	// check labels for consistency
 	if (!gensvm_check_outcome_contiguous(traindata)) {
@@ -153,6 +184,14 @@ int main(int argc, char **argv)
 		exit(EXIT_FAILURE);
 	}
 
+	// stream a binary data file that doesn't fit in the memory limit
+	if (traindata->map != NULL && !traindata->out_of_core &&
+			!gensvm_memory_available(traindata->map->size)) {
+		note("Training data doesn't fit in the memory limit, "
+				"streaming it from disk\n");
+		traindata->out_of_core = true;
+	}
+
 	// save data filename to model
 	model->data_file = Calloc(char, GENSVM_MAX_LINE_LENGTH);
 	strcpy(model->data_file, training_inputfile);
@@ -162,9 +201,7 @@ int main(int argc, char **argv)
 		err("[GenSVM Warning]: Sparse matrices with nonlinear kernels "
 				"are not yet supported. Dense matrices will "
 				"be used.\n");
-		traindata->RAW = gensvm_sparse_to_dense(traindata->spZ);
-		traindata->Z = traindata->RAW;
-		gensvm_free_sparse(traindata->spZ);
+		gensvm_data_to_dense(traindata);
 	}
 
 	// load a seed model from file if it is specified
@@ -174,31 +211,29 @@ int main(int argc, char **argv)
 	}
 
 	// train the GenSVM model
-	gensvm_train(model, traindata, seed_model);
+	gensvm_train(model, traindata, seed_model, NULL);
 
 	// if we also have a test set, predict labels and write to predictions
 	// to an output file if specified
 	if (testing_inputfile != NULL) {
 		// read the test data
-		if (libsvm_format)
-			gensvm_read_data_libsvm(testdata, testing_inputfile);
-		else
-			gensvm_read_data(testdata, testing_inputfile);
+		gensvm_load_data(testdata, testing_inputfile, libsvm_format);
 
 		// check if we are sparse and want nonlinearity
 		if (testdata->Z == NULL && model->kerneltype != K_LINEAR) {
 			err("[GenSVM Warning]: Sparse matrices with nonlinear "
 					"kernels are not yet supported. Dense "
 					"matrices will be used.\n");
-			testdata->Z = gensvm_sparse_to_dense(testdata->spZ);
-			gensvm_free_sparse(testdata->spZ);
+			gensvm_data_to_dense(testdata);
 		}
 
 		gensvm_kernel_postprocess(model, traindata, testdata);
 
-		// predict labels
+		// predict labels and the values of the output format
 		predy = Calloc(long, testdata->n);
-		gensvm_predict_labels(testdata, model, predy);
+		if (format >= P_DECISION)
+			values = Calloc(double, testdata->n*model->K);
+		gensvm_predict_values(testdata, model, format, predy, values);
 
 		if (testdata->y != NULL) {
 			performance = gensvm_prediction_perf(testdata, predy);
@@ -207,8 +242,9 @@ int main(int argc, char **argv)
 
 		// if output file is specified, write predictions to it
 		if (gensvm_check_argv_eq(argc, argv, "-o")) {
-			gensvm_write_predictions(testdata, predy,
-				       	prediction_outputfile);
+			gensvm_write_predictions_format(testdata, predy, values,
+					model->K, format,
+					prediction_outputfile);
 			note("Prediction written to: %s\n",
 				       	prediction_outputfile);
 		} else {
@@ -218,24 +254,35 @@ int main(int argc, char **argv)
 		}
 	}
 
-	// write model to output file if necessary
+	// write model to output files if necessary
+	if (binary_model_outputfile != NULL) {
+		gensvm_write_model_binary(model, binary_model_outputfile);
+		note("Model written to: %s\n", binary_model_outputfile);
+	}
 	if (gensvm_check_argv_eq(argc, argv, "-m")) {
 		gensvm_write_model(model, model_outputfile);
 		note("Model written to: %s\n", model_outputfile);
 	}
+	if (codegen_outputfile != NULL) {
+		gensvm_write_model_c(model, codegen_outputfile, NULL);
+		note("C predictor written to: %s\n", codegen_outputfile);
+	}
 
 	// free everything
 	gensvm_free_model(model);
 	gensvm_free_model(seed_model);
 	gensvm_free_data(traindata);
 	gensvm_free_data(testdata);
-	free(training_inputfile);
-	free(testing_inputfile);
-	free(model_inputfile);
-	free(model_outputfile);
-	free(prediction_outputfile);
+	Free(training_inputfile);
+	Free(testing_inputfile);
+	Free(model_inputfile);
+	Free(model_outputfile);
+	Free(binary_model_outputfile);
+	Free(codegen_outputfile);
+	Free(prediction_outputfile);
 
-	free(predy);
+	Free(predy);
+	Free(values);
 
 	return 0;
 }
@@ -268,13 +315,18 @@ void exit_invalid_param(const char *label, char **argv)
  * @param[out] 	 training_inputfile 	filename for the training data
  * @param[out] 	 testing_inputfile 	filename for the test data
  * @param[out] 	 model_outputfile 	filename for the output model
+ * @param[out] 	 binary_model_outputfile 	filename for the binary
+ * 						output model
+ * @param[out] 	 codegen_outputfile 	filename for the C predictor
  * @param[out] 	 prediction_outputfile 	filename for the predictions
+ * @param[out] 	 format 		format of the predictions
  *
  */
 void parse_command_line(int argc, char **argv, struct GenModel *model,
 		char **model_inputfile, char **training_inputfile,
 	       	char **testing_inputfile, char **model_outputfile,
-	       	char **prediction_outputfile)
+		char **binary_model_outputfile, char **codegen_outputfile,
+		char **prediction_outputfile, PredictionFormat *format)
 {
 	int i;
 
@@ -289,6 +341,9 @@ void parse_command_line(int argc, char **argv, struct GenModel *model,
 			exit_with_help(argv);
 		}
 		switch (argv[i-1][1]) {
+			case 'b':
+				i--;
+				break;
 			case 'c':
 				model->coef = atof(argv[i]);
 				break;
@@ -300,6 +355,12 @@ void parse_command_line(int argc, char **argv, struct GenModel *model,
 				if (model->epsilon <= 0)
 					exit_invalid_param("epsilon", argv);
 				break;
+			case 'f':
+				*format = atoi(argv[i]);
+				if (*format < P_DATA ||
+						*format > P_PROBABILITIES)
+					exit_invalid_param("format", argv);
+				break;
 			case 'g':
 				model->gamma = atof(argv[i]);
 				break;
@@ -316,6 +377,21 @@ void parse_command_line(int argc, char **argv, struct GenModel *model,
 				if (model->lambda <= 0)
 					exit_invalid_param("lambda", argv);
 				break;
+			case '-':
+				if (strcmp(argv[i-1], "--memory-limit") != 0) {
+					fprintf(stderr, "Unknown option: %s\n",
+							argv[i-1]);
+					exit_with_help(argv);
+				}
+				// fall through
+			case 'L':
+				if (str_to_bytes(argv[i]) == 0 &&
+						strcmp(argv[i], "0") != 0)
+					exit_invalid_param("memory limit",
+							argv);
+				gensvm_memory_set_limit(str_to_bytes(argv[i]));
+				gensvm_memory_track(true);
+				break;
 			case 's':
 				(*model_inputfile) = Malloc(char,
 					       	strlen(argv[i])+1);
@@ -326,6 +402,16 @@ void parse_command_line(int argc, char **argv, struct GenModel *model,
 						strlen(argv[i])+1);
 				strcpy((*model_outputfile), argv[i]);
 				break;
+			case 'M':
+				(*binary_model_outputfile) = Malloc(char,
+						strlen(argv[i])+1);
+				strcpy((*binary_model_outputfile), argv[i]);
+				break;
+			case 'C':
+				(*codegen_outputfile) = Malloc(char,
+						strlen(argv[i])+1);
+				strcpy((*codegen_outputfile), argv[i]);
+				break;
 			case 'o':
 				(*prediction_outputfile) = Malloc(char,
 						strlen(argv[i])+1);
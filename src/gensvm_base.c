@@ -31,6 +31,7 @@
  */
 
 #include "gensvm_base.h"
+#include "gensvm_parse.h"
 
 /**
  * @brief Initialize a GenData structure
@@ -56,6 +57,9 @@ struct GenData *gensvm_init_data(void)
 	data->gamma = -1;
 	data->coef = -1;
 	data->degree = -1;
+	data->is_view = false;
+	data->map = NULL;
+	data->out_of_core = false;
 
 	return data;
 }
@@ -67,6 +71,14 @@ struct GenData *gensvm_init_data(void)
  * Simply free a previously allocated GenData struct by freeing all its
  * components. Note that the data struct itself is also freed here.
  *
+ * If the GenData is a view on another GenData (see GenData::is_view), only
+ * the memory owned by the view is freed. This is the kernel matrix
+ * GenData::Z (if it differs from GenData::RAW), GenData::Sigma, and the
+ * GenSparse struct itself.
+ *
+ * If the GenData was read from a binary data file (see GenData::map), the
+ * arrays that lie in the memory map are not freed, but the map is unmapped.
+ *
  * @param[in] 	data 	GenData struct to free
  *
  */
@@ -75,21 +87,78 @@ void gensvm_free_data(struct GenData *data)
 	if (data == NULL)
 		return;
 
+	if (data->is_view) {
+		if (data->Z != data->RAW)
+			Free(data->Z);
+		Free(data->spZ);
+		Free(data->Sigma);
+		Free(data);
+		return;
+	}
+
+	if (data->map != NULL) {
+		if (data->spZ != NULL) {
+			if (!gensvm_map_contains(data->map, data->spZ->values))
+				Free(data->spZ->values);
+			if (!gensvm_map_contains(data->map, data->spZ->ia))
+				Free(data->spZ->ia);
+			if (!gensvm_map_contains(data->map, data->spZ->ja))
+				Free(data->spZ->ja);
+			Free(data->spZ);
+		}
+		if (data->Z != data->RAW &&
+				!gensvm_map_contains(data->map, data->Z))
+			Free(data->Z);
+		if (!gensvm_map_contains(data->map, data->RAW))
+			Free(data->RAW);
+		if (!gensvm_map_contains(data->map, data->y))
+			Free(data->y);
+		Free(data->Sigma);
+		gensvm_unmap_file(data->map);
+		Free(data);
+		return;
+	}
+
 	if (data->spZ != NULL)
 		gensvm_free_sparse(data->spZ);
 
 	if (data->Z == data->RAW) {
-		free(data->Z);
+		Free(data->Z);
 	} else {
-		free(data->Z);
-		free(data->RAW);
+		Free(data->Z);
+		Free(data->RAW);
 	}
-	free(data->y);
-	free(data->Sigma);
-	free(data);
+	Free(data->y);
+	Free(data->Sigma);
+	Free(data);
 	data = NULL;
 }
 
+/**
+ * @brief Convert the data matrix of a GenData to a dense matrix
+ *
+ * @details
+ * If the data is stored in GenData::spZ, it is converted to a dense matrix
+ * which is stored in both GenData::RAW and GenData::Z. The sparse matrix is
+ * freed, unless its arrays belong to a memory map (see GenData::map). This
+ * function should not be used on a view.
+ *
+ * @param[in,out] 	data 	GenData to convert
+ */
+void gensvm_data_to_dense(struct GenData *data)
+{
+	if (data->spZ == NULL)
+		return;
+
+	data->RAW = gensvm_sparse_to_dense(data->spZ);
+	data->Z = data->RAW;
+	if (data->map == NULL)
+		gensvm_free_sparse(data->spZ);
+	else
+		Free(data->spZ);
+	data->spZ = NULL;
+}
+
 /**
  * @brief Initialize a GenModel structure
  *
@@ -123,6 +192,7 @@ struct GenModel *gensvm_init_model(void)
 	model->elapsed_iter = -1;
 	model->status = -1;
 	model->seed = -1;
+	model->temperature = 1.0;
 
 	model->V = NULL;
 	model->Vbar = NULL;
@@ -132,6 +202,7 @@ struct GenModel *gensvm_init_model(void)
 	model->H = NULL;
 	model->rho = NULL;
 	model->data_file = NULL;
+	model->map = NULL;
 
 	return model;
 }
@@ -141,7 +212,8 @@ struct GenModel *gensvm_init_model(void)
  *
  * @details
  * This function can be used to allocate the memory needed for a GenModel. All
- * arrays in the model are specified and initialized to 0.
+ * arrays in the model are specified and initialized to 0, and are aligned
+ * to #GENSVM_ALIGN bytes.
  *
  * @param[in] 	model 	GenModel to allocate
  *
@@ -152,13 +224,13 @@ void gensvm_allocate_model(struct GenModel *model)
 	long m = model->m;
 	long K = model->K;
 
-	model->V = Calloc(double, (m+1)*(K-1));
-	model->Vbar = Calloc(double, (m+1)*(K-1));
-	model->U = Calloc(double, K*(K-1));
-	model->UU = Calloc(double, K*K*(K-1));
-	model->Q = Calloc(double, n*K);
-	model->H = Calloc(double, n*K);
-	model->rho = Calloc(double, n);
+	model->V = AlignedCalloc(double, (m+1)*(K-1));
+	model->Vbar = AlignedCalloc(double, (m+1)*(K-1));
+	model->U = AlignedCalloc(double, K*(K-1));
+	model->UU = AlignedCalloc(double, K*K*(K-1));
+	model->Q = AlignedCalloc(double, n*K);
+	model->H = AlignedCalloc(double, n*K);
+	model->rho = AlignedCalloc(double, n);
 }
 
 /**
@@ -167,7 +239,8 @@ void gensvm_allocate_model(struct GenModel *model)
  * @details
  * This function can be used to reallocate existing memory for a GenModel,
  * upon a change in the model dimensions. This is used in combination with
- * kernels.
+ * kernels. Since the arrays are zeroed, they are allocated again instead of
+ * reallocated, which keeps them aligned.
  *
  * @param[in] 	model 	GenModel to reallocate
  * @param[in] 	n 	new value of GenModel->n
@@ -181,23 +254,25 @@ void gensvm_reallocate_model(struct GenModel *model, long n, long m)
 	if (model->n == n && model->m == m)
 		return;
 	if (model->n != n) {
-		model->Q = Realloc(model->Q, double, n*K);
-		Memset(model->Q, double, n*K);
+		Free(model->Q);
+		model->Q = AlignedCalloc(double, n*K);
 
-		model->H = Realloc(model->H, double, n*K);
-		Memset(model->H, double, n*K);
+		Free(model->H);
+		model->H = AlignedCalloc(double, n*K);
 
-		model->rho = Realloc(model->rho, double, n);
-		Memset(model->rho, double, n);
+		Free(model->rho);
+		model->rho = AlignedCalloc(double, n);
 
 		model->n = n;
 	}
 	if (model->m != m) {
-		model->V = Realloc(model->V, double, (m+1)*(K-1));
-		Memset(model->V, double, (m+1)*(K-1));
+		// V can't be freed if it lies in a memory map
+		if (!gensvm_map_contains(model->map, model->V))
+			Free(model->V);
+		model->V = AlignedCalloc(double, (m+1)*(K-1));
 
-		model->Vbar = Realloc(model->Vbar, double, (m+1)*(K-1));
-		Memset(model->Vbar, double, (m+1)*(K-1));
+		Free(model->Vbar);
+		model->Vbar = AlignedCalloc(double, (m+1)*(K-1));
 
 		model->m = m;
 	}
@@ -208,7 +283,9 @@ void gensvm_reallocate_model(struct GenModel *model, long n, long m)
  *
  * @details
  * Simply free a previously allocated GenModel by freeing all its component
- * arrays. Note that the model struct itself is also freed here.
+ * arrays. Note that the model struct itself is also freed here. If the model
+ * was read from a binary model file (see GenModel::map), V is not freed but
+ * the map is unmapped.
  *
  * @param[in] 	model 	GenModel to free
  *
@@ -218,19 +295,33 @@ void gensvm_free_model(struct GenModel *model)
 	if (model == NULL)
 		return;
 
-	free(model->V);
-	free(model->Vbar);
-	free(model->U);
-	free(model->UU);
-	free(model->Q);
-	free(model->H);
-	free(model->rho);
-	free(model->data_file);
-
-	free(model);
+	if (!gensvm_map_contains(model->map, model->V))
+		Free(model->V);
+	gensvm_unmap_file(model->map);
+	Free(model->Vbar);
+	Free(model->U);
+	Free(model->UU);
+	Free(model->Q);
+	Free(model->H);
+	Free(model->rho);
+	Free(model->data_file);
+
+	Free(model);
 	model = NULL;
 }
 
+/**
+ * @brief Number of rows of the GenWork::LZ matrix
+ *
+ * @param[in] 	work 	a GenWork instance with GenWork::n set
+ * @returns 		the number of rows in a block of the data matrix
+ */
+static long gensvm_work_rows(struct GenWork *work)
+{
+	long rows = minimum(work->n, GENSVM_BLOCK_SIZE);
+	return rows;
+}
+
 /**
  * @brief Initialize the workspace structure
  *
@@ -248,49 +339,124 @@ void gensvm_free_model(struct GenModel *model)
  *
  */
 struct GenWork *gensvm_init_work(struct GenModel *model)
+{
+	return gensvm_init_work_arena(model, NULL);
+}
+
+/**
+ * @brief Initialize the workspace structure in an arena
+ *
+ * @details
+ * This is gensvm_init_work() with the workspace taken from an arena. When
+ * several models are trained after each other, as in cross validation and
+ * grid search, the memory of the workspace is then reused for every model
+ * instead of allocated and freed again. The workspace is given back with
+ * gensvm_arena_release() or gensvm_arena_reset(). If @p arena is NULL this
+ * is equal to gensvm_init_work().
+ *
+ * @param[in] 	model 	a GenModel with the dimensionality of the problem
+ * @param[in] 	arena 	the arena to use, or NULL
+ * @returns 		an initialized GenWork instance
+ */
+struct GenWork *gensvm_init_work_arena(struct GenModel *model,
+		struct GenArena *arena)
 {
 	long n = model->n;
 	long m = model->m;
 	long K = model->K;
-
-	struct GenWork *work = Malloc(struct GenWork, 1);
-	work->n = n;
-	work->m = m;
-	work->K = K;
-
-	work->LZ = Calloc(double, n*(m+1));
-	work->ZB = Calloc(double, (m+1)*(K-1)),
-	work->ZBc = Calloc(double, (m+1)*(K-1)),
-	work->ZAZ = Calloc(double, (m+1)*(m+1)),
-	work->tmpZAZ = Calloc(double, (m+1)*(m+1)),
-	work->ZV = Calloc(double, n*(K-1));
-	work->beta = Calloc(double, K-1);
-	work->yhat = Calloc(long, n);
+	long ld = gensvm_padded_ld(m+1, sizeof(double));
+	struct GenWork *work = NULL;
+
+	if (arena == NULL) {
+		work = Malloc(struct GenWork, 1);
+		work->n = n;
+		work->m = m;
+		work->K = K;
+		work->ld = ld;
+
+		work->LZ = AlignedCalloc(double, gensvm_work_rows(work)*ld);
+		work->ZB = AlignedCalloc(double, (m+1)*(K-1)),
+		work->ZBc = AlignedCalloc(double, (K-1)*ld),
+		work->ZAZ = AlignedCalloc(double, (m+1)*ld),
+		work->tmpZAZ = AlignedCalloc(double, (m+1)*ld),
+		work->ZV = AlignedCalloc(double, n*(K-1));
+		work->beta = AlignedCalloc(double, K-1);
+		work->yhat = AlignedCalloc(long, n);
+	} else {
+		work = ArenaCalloc(arena, struct GenWork, 1);
+		work->n = n;
+		work->m = m;
+		work->K = K;
+		work->ld = ld;
+
+		work->LZ = ArenaCalloc(arena, double,
+				gensvm_work_rows(work)*ld);
+		work->ZB = ArenaCalloc(arena, double, (m+1)*(K-1));
+		work->ZBc = ArenaCalloc(arena, double, (K-1)*ld);
+		work->ZAZ = ArenaCalloc(arena, double, (m+1)*ld);
+		work->tmpZAZ = ArenaCalloc(arena, double, (m+1)*ld);
+		work->ZV = ArenaCalloc(arena, double, n*(K-1));
+		work->beta = ArenaCalloc(arena, double, K-1);
+		work->yhat = ArenaCalloc(arena, long, n);
+	}
+	work->arena = arena;
 
 	return work;
 }
 
+/**
+ * @brief Size of a workspace in an arena
+ *
+ * @details
+ * This gives the number of bytes that gensvm_init_work_arena() takes from
+ * an arena for a problem of the given size, including the padding of the
+ * arrays. It can be used to reserve an arena with gensvm_arena_reserve().
+ *
+ * @param[in] 	n 	number of instances
+ * @param[in] 	m 	number of features
+ * @param[in] 	K 	number of classes
+ * @returns 		number of bytes of the workspace in an arena
+ */
+size_t gensvm_work_size(long n, long m, long K)
+{
+	long rows = minimum(n, GENSVM_BLOCK_SIZE);
+	long ld = gensvm_padded_ld(m+1, sizeof(double));
+	size_t size = gensvm_arena_size(1, sizeof(struct GenWork));
+
+	size += gensvm_arena_size(rows*ld, sizeof(double));
+	size += gensvm_arena_size((m+1)*(K-1), sizeof(double));
+	size += gensvm_arena_size((K-1)*ld, sizeof(double));
+	size += 2*gensvm_arena_size((m+1)*ld, sizeof(double));
+	size += gensvm_arena_size(n*(K-1), sizeof(double));
+	size += gensvm_arena_size(K-1, sizeof(double));
+	size += gensvm_arena_size(n, sizeof(long));
+
+	return size;
+}
+
 /**
  * @brief Free an allocated GenWork instance
  *
  * @details
  * This function simply frees every matrix allocated for in the GenWork 
- * workspace.
+ * workspace. A workspace that is taken from an arena is left to the arena.
  *
  * @param[in] 	work 	a pointer to an allocated GenWork instance
  *
  */
 void gensvm_free_work(struct GenWork *work)
 {
-	free(work->LZ);
-	free(work->ZB);
-	free(work->ZBc);
-	free(work->ZAZ);
-	free(work->tmpZAZ);
-	free(work->ZV);
-	free(work->beta);
-	free(work->yhat);
-	free(work);
+	if (work->arena != NULL)
+		return;
+	Free(work->LZ);
+	Free(work->ZB);
+	Free(work->ZBc);
+	Free(work->ZAZ);
+	Free(work->tmpZAZ);
+	Free(work->ZV);
+	Free(work->beta);
+	Free(work->yhat);
+	Free(work);
 	work = NULL;
 }
 
@@ -311,12 +477,13 @@ void gensvm_reset_work(struct GenWork *work)
 	long n = work->n;
 	long m = work->m;
 	long K = work->K;
+	long ld = work->ld;
 
-	Memset(work->LZ, double, n*(m+1));
+	Memset(work->LZ, double, gensvm_work_rows(work)*ld);
 	Memset(work->ZB, double, (m+1)*(K-1)),
-	Memset(work->ZBc, double, (m+1)*(K-1)),
-	Memset(work->ZAZ, double, (m+1)*(m+1)),
-	Memset(work->tmpZAZ, double, (m+1)*(m+1)),
+	Memset(work->ZBc, double, (K-1)*ld),
+	Memset(work->ZAZ, double, (m+1)*ld),
+	Memset(work->tmpZAZ, double, (m+1)*ld),
 	Memset(work->ZV, double, n*(K-1));
 	Memset(work->beta, double, K-1);
 	Memset(work->yhat, long, n);
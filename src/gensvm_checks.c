@@ -71,7 +71,7 @@ bool gensvm_check_outcome_contiguous(struct GenData *data)
 		is_contiguous = false;
 	}
 
-	free(uniq_y);
+	Free(uniq_y);
 
 	return is_contiguous;
 }
@@ -0,0 +1,360 @@
+/**
+ * @file gensvm_codegen.c
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Functions for generating a standalone C predictor from a model
+ *
+ * @details
+ * A trained linear model can be written as a C source file that predicts
+ * with the model without GenSVM or BLAS. The weights, the bias and the
+ * simplex matrix are static constant arrays, and the number of features
+ * and classes are macros. The products with these arrays are written out
+ * term by term when they have at most #GENSVM_CODEGEN_MAX_UNROLL terms, and
+ * as loops with constant bounds otherwise, so that the compiler can fold
+ * the constants and vectorize the code for the model at hand.
+ *
+ * The generated file has functions for the labels and the decision values
+ * of dense and sparse instances, with names that start with a prefix. The
+ * output depends only on the model, so the file can be regenerated as part
+ * of a build.
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "gensvm_codegen.h"
+
+#include <ctype.h>
+
+/**
+ * @brief Derive the prefix of the generated functions from a filename
+ *
+ * @details
+ * The prefix is the name of the file without the directory and the
+ * extension, with all characters that can't be used in a C identifier
+ * replaced by an underscore. If the name is empty or starts with a digit,
+ * it is preceded by "gensvm_".
+ *
+ * @param[in] 	filename 	name of the generated file
+ * @param[out] 	prefix 		buffer of length #GENSVM_CODEGEN_MAX_PREFIX
+ */
+void gensvm_codegen_prefix(const char *filename, char *prefix)
+{
+	long i, len;
+	const char *base = strrchr(filename, '/'),
+	      *dot = NULL;
+
+	base = (base == NULL) ? filename : base + 1;
+	dot = strchr(base, '.');
+	len = (dot == NULL) ? (long) strlen(base) : dot - base;
+
+	if (len == 0 || isdigit((unsigned char) base[0])) {
+		strcpy(prefix, "gensvm_");
+	} else {
+		prefix[0] = '\0';
+	}
+	i = strlen(prefix);
+	len = minimum(len, GENSVM_CODEGEN_MAX_PREFIX - 1 - i);
+	strncat(prefix, base, len);
+	if (len == 0)
+		strcat(prefix, "model");
+
+	for (; prefix[i] != '\0'; i++) {
+		if (!isalnum((unsigned char) prefix[i]))
+			prefix[i] = '_';
+	}
+}
+
+/**
+ * @brief Write a constant array with the rows of a matrix
+ *
+ * @param[in] 	fid 	the output file
+ * @param[in] 	prefix 	prefix of the generated names
+ * @param[in] 	name 	name of the array
+ * @param[in] 	A 	the matrix
+ * @param[in] 	rows 	number of rows of A
+ * @param[in] 	cols 	number of columns of A
+ * @param[in] 	trans 	whether to write the transpose of A
+ */
+static void gensvm_codegen_matrix(FILE *fid, const char *prefix,
+		const char *name, const double *A, long rows, long cols,
+		bool trans)
+{
+	long i, j,
+	     out_rows = trans ? cols : rows,
+	     out_cols = trans ? rows : cols;
+
+	fprintf(fid, "static const double %s_%s[%li][%li] = {\n", prefix,
+			name, out_rows, out_cols);
+	for (i=0; i<out_rows; i++) {
+		fprintf(fid, "\t{\n");
+		for (j=0; j<out_cols; j++)
+			fprintf(fid, "\t\t%.17g,\n", trans ?
+					matrix_get(A, cols, j, i) :
+					matrix_get(A, cols, i, j));
+		fprintf(fid, "\t},\n");
+	}
+	fprintf(fid, "};\n\n");
+}
+
+/**
+ * @brief Write the function for the decision values of a dense instance
+ *
+ * @param[in] 	fid 	the output file
+ * @param[in] 	prefix 	prefix of the generated names
+ * @param[in] 	macro 	prefix of the generated macros
+ * @param[in] 	m 	number of features
+ * @param[in] 	K 	number of classes
+ */
+static void gensvm_codegen_decision(FILE *fid, const char *prefix,
+		const char *macro, long m, long K)
+{
+	long j, k;
+
+	fprintf(fid, "void %s_decision(const double *x, double *zv)\n{\n",
+			prefix);
+	if (m*(K-1) > GENSVM_CODEGEN_MAX_UNROLL) {
+		fprintf(fid, "\tlong j, k;\n\tdouble z;\n\n");
+		fprintf(fid, "\tfor (k=0; k<%s_K-1; k++) {\n", macro);
+		fprintf(fid, "\t\tz = %s_bias[k];\n", prefix);
+		fprintf(fid, "\t\tfor (j=0; j<%s_M; j++)\n", macro);
+		fprintf(fid, "\t\t\tz += %s_W[k][j] * x[j];\n", prefix);
+		fprintf(fid, "\t\tzv[k] = z;\n\t}\n}\n\n");
+		return;
+	}
+	for (k=0; k<K-1; k++) {
+		fprintf(fid, "\tzv[%li] = %s_bias[%li]", k, prefix, k);
+		for (j=0; j<m; j++)
+			fprintf(fid, "\n\t\t+ %s_W[%li][%li] * x[%li]", prefix,
+					k, j, j);
+		fprintf(fid, ";\n");
+	}
+	fprintf(fid, "}\n\n");
+}
+
+/**
+ * @brief Write the function for the decision values of a sparse instance
+ *
+ * @param[in] 	fid 	the output file
+ * @param[in] 	prefix 	prefix of the generated names
+ * @param[in] 	macro 	prefix of the generated macros
+ * @param[in] 	K 	number of classes
+ */
+static void gensvm_codegen_decision_sparse(FILE *fid, const char *prefix,
+		const char *macro, long K)
+{
+	long k;
+	bool unroll = (K-1 <= GENSVM_CODEGEN_MAX_UNROLL);
+
+	fprintf(fid, "void %s_decision_sparse(const long *idx, "
+			"const double *val, long nnz,\n\t\tdouble *zv)\n{\n",
+			prefix);
+	fprintf(fid, "\tlong jj, j%s;\n\n", unroll ? "" : ", k");
+	if (unroll) {
+		for (k=0; k<K-1; k++)
+			fprintf(fid, "\tzv[%li] = %s_bias[%li];\n", k, prefix,
+					k);
+	} else {
+		fprintf(fid, "\tfor (k=0; k<%s_K-1; k++)\n", macro);
+		fprintf(fid, "\t\tzv[k] = %s_bias[k];\n", prefix);
+	}
+	fprintf(fid, "\tfor (jj=0; jj<nnz; jj++) {\n");
+	fprintf(fid, "\t\tj = idx[jj];\n");
+	fprintf(fid, "\t\tif (j < 0 || j >= %s_M)\n\t\t\tcontinue;\n", macro);
+	if (unroll) {
+		for (k=0; k<K-1; k++)
+			fprintf(fid, "\t\tzv[%li] += %s_W[%li][j] * val[jj];\n",
+					k, prefix, k);
+	} else {
+		fprintf(fid, "\t\tfor (k=0; k<%s_K-1; k++)\n", macro);
+		fprintf(fid, "\t\t\tzv[k] += %s_W[k][j] * val[jj];\n",
+				prefix);
+	}
+	fprintf(fid, "\t}\n}\n\n");
+}
+
+/**
+ * @brief Write the function that assigns the label of the nearest vertex
+ *
+ * @details
+ * As in gensvm_predict_assign_rows(), the nearest vertex of the simplex is
+ * the vertex with the largest inner product, and ties go to the smallest
+ * label.
+ *
+ * @param[in] 	fid 	the output file
+ * @param[in] 	prefix 	prefix of the generated names
+ * @param[in] 	macro 	prefix of the generated macros
+ * @param[in] 	K 	number of classes
+ */
+static void gensvm_codegen_assign(FILE *fid, const char *prefix,
+		const char *macro, long K)
+{
+	long j, k;
+
+	fprintf(fid, "static long %s_assign(const double *zv)\n{\n", prefix);
+	if (K*(K-1) > GENSVM_CODEGEN_MAX_UNROLL) {
+		fprintf(fid, "\tlong j, k, label = 0;\n");
+		fprintf(fid, "\tdouble dot, best = 0;\n\n");
+		fprintf(fid, "\tfor (j=0; j<%s_K; j++) {\n", macro);
+		fprintf(fid, "\t\tdot = 0;\n");
+		fprintf(fid, "\t\tfor (k=0; k<%s_K-1; k++)\n", macro);
+		fprintf(fid, "\t\t\tdot += %s_U[j][k] * zv[k];\n", prefix);
+		fprintf(fid, "\t\tif (j == 0 || dot > best) {\n");
+		fprintf(fid, "\t\t\tbest = dot;\n\t\t\tlabel = j;\n\t\t}\n");
+		fprintf(fid, "\t}\n\treturn label + 1;\n}\n\n");
+		return;
+	}
+	fprintf(fid, "\tlong label = 1;\n\tdouble dot, best;\n\n");
+	for (j=0; j<K; j++) {
+		fprintf(fid, "\t%s = %s_U[%li][0] * zv[0]", j ? "dot" : "best",
+				prefix, j);
+		for (k=1; k<K-1; k++)
+			fprintf(fid, "\n\t\t+ %s_U[%li][%li] * zv[%li]",
+					prefix, j, k, k);
+		fprintf(fid, ";\n");
+		if (j == 0)
+			continue;
+		fprintf(fid, "\tif (dot > best) {\n\t\tbest = dot;\n");
+		fprintf(fid, "\t\tlabel = %li;\n\t}\n", j+1);
+	}
+	fprintf(fid, "\treturn label;\n}\n\n");
+}
+
+/**
+ * @brief Write a standalone C predictor for a linear model
+ *
+ * @details
+ * The generated file defines the following functions, where @c P is the
+ * prefix and @c M and @c K are the number of features and classes:
+ *
+ * - @c long @c P_predict(const double *x) predicts the label (1 to K) of
+ *   an instance with M features.
+ * - @c long @c P_predict_sparse(const long *idx, const double *val,
+ *   long nnz) predicts the label of an instance with nnz nonzero features,
+ *   with indices from 0 to M-1. Other indices are ignored.
+ * - @c void @c P_decision(const double *x, double *zv) and
+ *   @c P_decision_sparse(idx, val, nnz, zv) compute the K-1 decision
+ *   values of an instance.
+ *
+ * The file also defines the macros @c P_M and @c P_K, with the prefix in
+ * upper case.
+ *
+ * @param[in] 	model 			a trained linear GenModel
+ * @param[in] 	output_filename 	filename of the C file
+ * @param[in] 	prefix 			prefix of the generated names, or NULL
+ * 					to derive it from the filename with
+ * 					gensvm_codegen_prefix()
+ */
+void gensvm_write_model_c(struct GenModel *model, char *output_filename,
+		const char *prefix)
+{
+	long i,
+	     m = model->m,
+	     K = model->K;
+	char name[GENSVM_CODEGEN_MAX_PREFIX],
+	     macro[GENSVM_CODEGEN_MAX_PREFIX];
+	double *U = NULL;
+	struct GenModel *simplex = NULL;
+	FILE *fid = NULL;
+
+	if (model->kerneltype != K_LINEAR) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: A C predictor can only be generated for "
+				"a linear model.\n");
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
+
+	if (prefix == NULL) {
+		gensvm_codegen_prefix(output_filename, name);
+	} else {
+		strncpy(name, prefix, GENSVM_CODEGEN_MAX_PREFIX - 1);
+		name[GENSVM_CODEGEN_MAX_PREFIX - 1] = '\0';
+	}
+	for (i=0; name[i] != '\0'; i++)
+		macro[i] = toupper((unsigned char) name[i]);
+	macro[i] = '\0';
+
+	// generate the simplex matrix without changing the model
+	U = Calloc(double, K*(K-1));
+	simplex = gensvm_init_model();
+	simplex->K = K;
+	simplex->U = U;
+	gensvm_simplex(simplex);
+	simplex->U = NULL;
+	gensvm_free_model(simplex);
+
+	fid = fopen(output_filename, "w");
+	if (fid == NULL) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: Error opening output file %s\n",
+				output_filename);
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
+
+	fprintf(fid, "/*\n");
+	fprintf(fid, " * Standalone predictor for a linear GenSVM model with "
+			"%li features and %li\n * classes, generated by GenSVM "
+			"(version %s).\n *\n", m, K, VERSION_STRING);
+	fprintf(fid, " * long %s_predict(const double *x)\n", name);
+	fprintf(fid, " * \tlabel (1 to %s_K) of an instance with %s_M "
+			"features\n", macro, macro);
+	fprintf(fid, " * long %s_predict_sparse(const long *idx, "
+			"const double *val, long nnz)\n", name);
+	fprintf(fid, " * \tlabel of an instance with nnz nonzero features, "
+			"with indices from 0\n * \tto %s_M-1 (other indices "
+			"are ignored)\n", macro);
+	fprintf(fid, " * void %s_decision(const double *x, double *zv)\n",
+			name);
+	fprintf(fid, " * void %s_decision_sparse(const long *idx, "
+			"const double *val, long nnz,\n * \t\tdouble *zv)\n",
+			name);
+	fprintf(fid, " * \tthe %s_K-1 decision values of an instance\n",
+			macro);
+	fprintf(fid, " */\n\n");
+
+	fprintf(fid, "#define %s_M %li\n", macro, m);
+	fprintf(fid, "#define %s_K %li\n\n", macro, K);
+
+	fprintf(fid, "static const double %s_bias[%li] = {\n", name, K-1);
+	for (i=0; i<K-1; i++)
+		fprintf(fid, "\t%.17g,\n", model->V[i]);
+	fprintf(fid, "};\n\n");
+	gensvm_codegen_matrix(fid, name, "W", &model->V[K-1], m, K-1, true);
+	gensvm_codegen_matrix(fid, name, "U", U, K, K-1, false);
+
+	gensvm_codegen_decision(fid, name, macro, m, K);
+	gensvm_codegen_decision_sparse(fid, name, macro, K);
+	gensvm_codegen_assign(fid, name, macro, K);
+
+	fprintf(fid, "long %s_predict(const double *x)\n{\n", name);
+	fprintf(fid, "\tdouble zv[%s_K-1];\n\n", macro);
+	fprintf(fid, "\t%s_decision(x, zv);\n", name);
+	fprintf(fid, "\treturn %s_assign(zv);\n}\n\n", name);
+
+	fprintf(fid, "long %s_predict_sparse(const long *idx, "
+			"const double *val, long nnz)\n{\n", name);
+	fprintf(fid, "\tdouble zv[%s_K-1];\n\n", macro);
+	fprintf(fid, "\t%s_decision_sparse(idx, val, nnz, zv);\n", name);
+	fprintf(fid, "\treturn %s_assign(zv);\n}\n", name);
+
+	fclose(fid);
+	Free(U);
+}
@@ -0,0 +1,405 @@
+/**
+ * @file gensvm_compact.c
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Functions for expressing a kernel model with fewer instances
+ *
+ * @details
+ * A kernel model predicts the decision values of a test instance @f$ x @f$
+ * as @f$ v_0 + \sum_i k(x, x_i) \alpha_i @f$, where the sum runs over all n
+ * training instances and the coefficients are @f$ \boldsymbol{\alpha} =
+ * \textbf{M}\boldsymbol{\Sigma}^{-2}\textbf{W} @f$ (see
+ * gensvm_kernel_testfactor()). The cross kernel with all training instances
+ * is therefore needed for prediction, even though only part of the
+ * instances are support vectors.
+ *
+ * The functions in this file replace the training data by a reduced set of
+ * s instances with new coefficients @f$ \boldsymbol{\beta} @f$, such that
+ * @f$ \textbf{K}_{\cdot S} \boldsymbol{\beta} @f$ approximates the decision
+ * values of the model on the training data up to a given relative error.
+ * The instances are added to the reduced set in order of importance: the
+ * support vectors first, and then by the size of their coefficients. The
+ * reduced set grows until the error is small enough.
+ *
+ * The result is expressed in the form of a kernel model, such that
+ * prediction with gensvm_kernel_postprocess() and gensvm_predict_labels()
+ * works unchanged, but the cross kernel is computed with s instances instead
+ * of n.
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "gensvm_compact.h"
+
+/**
+ * @brief Compare two candidate instances for the reduced set
+ *
+ * @details
+ * Support vectors come first, and within these groups the instances with
+ * the largest coefficients come first. Ties are broken by the index of the
+ * instance, such that the order is deterministic.
+ *
+ * @param[in] 	a 	pointer to a GenCompactRow
+ * @param[in] 	b 	pointer to a GenCompactRow
+ * @returns 		negative if a comes first, positive otherwise
+ */
+static int gensvm_compact_compare(const void *a, const void *b)
+{
+	const struct GenCompactRow *x = a,
+	      *y = b;
+
+	if (x->sv != y->sv)
+		return x->sv ? -1 : 1;
+	if (x->weight != y->weight)
+		return (x->weight > y->weight) ? -1 : 1;
+	return (x->idx < y->idx) ? -1 : 1;
+}
+
+/**
+ * @brief Order the training instances for the reduced set
+ *
+ * @details
+ * The coefficients of the instances are @f$ \boldsymbol{\alpha} =
+ * \textbf{M}\boldsymbol{\Sigma}^{-2}\textbf{W} @f$, where @f$ \textbf{W}
+ * @f$ is GenModel::V without the first row. If the labels of the training
+ * data are known, an instance is a support vector if it has an error
+ * @f$ q \leq 1 @f$ with respect to one of the other classes, as in
+ * gensvm_num_sv().
+ *
+ * @param[in] 	model 		the kernel model
+ * @param[in] 	data 		training data after the kernel preprocessing
+ * @param[in] 	F 		decision values of the training instances
+ * 				without the bias (n x (K-1))
+ * @returns 			the training instances in the order in which
+ * 				they are added to the reduced set
+ */
+static struct GenCompactRow *gensvm_compact_order(struct GenModel *model,
+		struct GenData *data, const double *F)
+{
+	long i, j, k, y, num_correct,
+	     n = data->n,
+	     r = data->r,
+	     K = model->K;
+	double q, value;
+	double *W = Malloc(double, r*(K-1)),
+	       *alpha = Malloc(double, n*(K-1)),
+	       *zv = Malloc(double, K-1);
+	struct GenCompactRow *rows = Malloc(struct GenCompactRow, n);
+
+	// alpha = M * Sigma^{-2} * W
+	for (j=0; j<r; j++) {
+		value = pow(data->Sigma[j], -2.0);
+		for (k=0; k<K-1; k++)
+			matrix_set(W, K-1, j, k, value *
+					matrix_get(model->V, K-1, j+1, k));
+	}
+	cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, n, K-1, r,
+			1.0, &data->Z[1], r+1, W, K-1, 0.0, alpha, K-1);
+
+	for (i=0; i<n; i++) {
+		rows[i].idx = i;
+		rows[i].weight = cblas_ddot(K-1, &alpha[i*(K-1)], 1,
+				&alpha[i*(K-1)], 1);
+		rows[i].sv = false;
+		if (data->y == NULL)
+			continue;
+
+		// errors with respect to the other classes, see
+		// gensvm_calculate_errors()
+		y = data->y[i] - 1;
+		for (k=0; k<K-1; k++)
+			zv[k] = model->V[k] + matrix_get(F, K-1, i, k);
+		num_correct = 0;
+		for (j=0; j<K; j++) {
+			if (j == y)
+				continue;
+			q = 0;
+			for (k=0; k<K-1; k++)
+				q += zv[k] * (matrix_get(model->U, K-1, y, k) -
+						matrix_get(model->U, K-1, j, k));
+			num_correct += (q > 1);
+		}
+		rows[i].sv = (num_correct < K - 1);
+	}
+
+	qsort(rows, n, sizeof(struct GenCompactRow), gensvm_compact_compare);
+
+	Free(W);
+	Free(alpha);
+	Free(zv);
+
+	return rows;
+}
+
+/**
+ * @brief Compute columns of the kernel between the training data and the
+ * reduced set
+ *
+ * @details
+ * The columns @p start to @p end of the n x s matrix @f$ \textbf{K}_{\cdot
+ * S} @f$ are computed with gensvm_kernel_cross() and stored in column-major
+ * order, as needed by LAPACK.
+ *
+ * @param[in] 	model 	the kernel model
+ * @param[in] 	data 	the training data
+ * @param[in] 	rows 	the training instances in the order of the reduced
+ * 			set
+ * @param[in] 	start 	first column to compute
+ * @param[in] 	end 	end of the columns to compute (exclusive)
+ * @param[out] 	A 	column-major matrix with n rows
+ */
+static void gensvm_compact_columns(struct GenModel *model,
+		struct GenData *data, struct GenCompactRow *rows, long start,
+		long end, double *A)
+{
+	long i, j,
+	     n = data->n,
+	     m = data->m,
+	     s = end - start;
+	double *K2 = NULL;
+	struct GenData *set = gensvm_init_data();
+
+	set->n = s;
+	set->m = m;
+	set->RAW = Malloc(double, s*(m+1));
+	for (j=0; j<s; j++)
+		memcpy(&set->RAW[j*(m+1)], &data->RAW[rows[start+j].idx*(m+1)],
+				(m+1)*sizeof(double));
+	set->Z = set->RAW;
+
+	// K2 is n x s in row-major order
+	K2 = gensvm_kernel_cross(model, set, data);
+	for (j=0; j<s; j++)
+		for (i=0; i<n; i++)
+			A[i + (start+j)*n] = K2[i*s + j];
+
+	Free(K2);
+	gensvm_free_data(set);
+}
+
+/**
+ * @brief Fit the coefficients of the reduced set
+ *
+ * @details
+ * The coefficients @f$ \boldsymbol{\beta} @f$ minimize
+ * @f$ \|\textbf{K}_{\cdot S}\boldsymbol{\beta} - \textbf{F}\|_F @f$, which
+ * is solved with the LAPACK function dgelsy. This handles a rank deficient
+ * kernel matrix, for instance when the reduced set contains duplicate
+ * instances.
+ *
+ * @param[in] 	A 	n x s column-major kernel between the training data
+ * 			and the reduced set
+ * @param[in] 	F 	decision values of the training instances without
+ * 			the bias (n x (K-1))
+ * @param[in] 	n 	number of training instances
+ * @param[in] 	s 	size of the reduced set
+ * @param[in] 	K 	number of classes
+ * @param[out] 	beta 	coefficients of the reduced set (s x (K-1))
+ * @returns 		relative error @f$ \|\textbf{K}_{\cdot
+ * 			S}\boldsymbol{\beta} - \textbf{F}\|_F /
+ * 			\|\textbf{F}\|_F @f$
+ */
+static double gensvm_compact_fit(const double *A, const double *F, long n,
+		long s, long K, double *beta)
+{
+	int status, rank, LWORK;
+	long i, k;
+	double value, norm_F = 0, norm_R = 0;
+	double *QR = Malloc(double, n*s),
+	       *B = Malloc(double, n*(K-1)),
+	       *WORK = Malloc(double, 1);
+	int *JPVT = Calloc(int, s);
+
+	memcpy(QR, A, n*s*sizeof(double));
+	for (i=0; i<n; i++)
+		for (k=0; k<K-1; k++)
+			B[i + k*n] = matrix_get(F, K-1, i, k);
+
+	// workspace query
+	status = dgelsy(n, s, K-1, QR, n, B, n, JPVT, 1e-12, &rank, WORK, -1);
+	LWORK = WORK[0];
+	WORK = Realloc(WORK, double, LWORK);
+	status = dgelsy(n, s, K-1, QR, n, B, n, JPVT, 1e-12, &rank, WORK,
+			LWORK);
+	if (status != 0) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: Nonzero exit status from dgelsy.\n");
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
+
+	for (i=0; i<s; i++)
+		for (k=0; k<K-1; k++)
+			matrix_set(beta, K-1, i, k, B[i + k*n]);
+
+	// residual of the fit
+	for (i=0; i<n; i++) {
+		for (k=0; k<K-1; k++) {
+			value = cblas_ddot(s, &A[i], n, &beta[k], K-1);
+			value -= matrix_get(F, K-1, i, k);
+			norm_R += value * value;
+			norm_F += pow(matrix_get(F, K-1, i, k), 2.0);
+		}
+	}
+
+	Free(QR);
+	Free(B);
+	Free(WORK);
+	Free(JPVT);
+
+	return (norm_F > 0) ? sqrt(norm_R/norm_F) : 0.0;
+}
+
+/**
+ * @brief Express a kernel model in terms of a reduced set of instances
+ *
+ * @details
+ * The reduced set starts with the K most important instances (see
+ * gensvm_compact_order()) and is doubled until the relative error of the
+ * decision values on the training data is at most @p tolerance, see
+ * gensvm_compact_fit(). The reduced set can therefore be smaller than the
+ * set of support vectors if the tolerance allows it. With a tolerance of
+ * zero all training instances are used.
+ *
+ * On exit, @p support holds the instances of the reduced set and the model
+ * is changed such that gensvm_kernel_postprocess() with @p support as
+ * training data gives the approximated decision values directly:
+ * GenData::Z of the support data is @f$ [\textbf{1} \,
+ * \boldsymbol{\beta}] @f$ with GenData::Sigma equal to one, and
+ * GenModel::V is the bias followed by the identity matrix. The training
+ * data is not changed and is no longer needed for prediction.
+ *
+ * @param[in,out] 	model 		a trained kernel model, on exit the
+ * 					model for the reduced set
+ * @param[in] 		traindata 	the training data after
+ * 					gensvm_kernel_preprocess()
+ * @param[out] 		support 	an initialized GenData, on exit the
+ * 					reduced set of instances
+ * @param[in] 		tolerance 	maximum relative error of the decision
+ * 					values on the training data
+ * @returns 				the relative error of the reduced set
+ */
+double gensvm_compact(struct GenModel *model, struct GenData *traindata,
+		struct GenData *support, double tolerance)
+{
+	long i, k, s,
+	     start = 0,
+	     n = traindata->n,
+	     m = traindata->m,
+	     r = traindata->r,
+	     K = model->K;
+	double error;
+	double *F = Malloc(double, n*(K-1)),
+	       *A = NULL,
+	       *beta = NULL,
+	       *V = NULL;
+	struct GenCompactRow *rows = NULL;
+
+	// the simplex is needed to find the support vectors
+	if (model->U == NULL)
+		model->U = Calloc(double, K*(K-1));
+	gensvm_simplex(model);
+
+	// F = M * W are the decision values without the bias
+	cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, n, K-1, r,
+			1.0, &traindata->Z[1], r+1, &model->V[K-1], K-1, 0.0,
+			F, K-1);
+
+	rows = gensvm_compact_order(model, traindata, F);
+
+	s = minimum(n, K);
+	while (true) {
+		A = Realloc(A, double, n*s);
+		beta = Realloc(beta, double, s*(K-1));
+		gensvm_compact_columns(model, traindata, rows, start, s, A);
+		error = gensvm_compact_fit(A, F, n, s, K, beta);
+		if (error <= tolerance || s == n)
+			break;
+		start = s;
+		s = minimum(n, 2*s);
+	}
+
+	// the reduced set with Z = [1 beta]
+	support->n = s;
+	support->m = m;
+	support->r = K-1;
+	support->K = K;
+	support->RAW = Malloc(double, s*(m+1));
+	support->Z = Malloc(double, s*K);
+	support->Sigma = Malloc(double, K-1);
+	if (traindata->y != NULL)
+		support->y = Malloc(long, s);
+	for (i=0; i<s; i++) {
+		memcpy(&support->RAW[i*(m+1)],
+				&traindata->RAW[rows[i].idx*(m+1)],
+				(m+1)*sizeof(double));
+		matrix_set(support->Z, K, i, 0, 1.0);
+		for (k=0; k<K-1; k++)
+			matrix_set(support->Z, K, i, k+1,
+					matrix_get(beta, K-1, i, k));
+		if (support->y != NULL)
+			support->y[i] = traindata->y[rows[i].idx];
+	}
+	for (k=0; k<K-1; k++)
+		support->Sigma[k] = 1.0;
+	gensvm_kernel_copy_kernelparam_to_data(model, support);
+
+	// V = [v_0; I]
+	V = Calloc(double, K*(K-1));
+	for (k=0; k<K-1; k++) {
+		matrix_set(V, K-1, 0, k, model->V[k]);
+		matrix_set(V, K-1, k+1, k, 1.0);
+	}
+	if (!gensvm_map_contains(model->map, model->V))
+		Free(model->V);
+	model->V = V;
+	model->m = K-1;
+
+	Free(F);
+	Free(A);
+	Free(beta);
+	Free(rows);
+
+	return error;
+}
+
+/**
+ * @brief Solve a linear least squares problem with a complete orthogonal
+ * factorization
+ *
+ * @details
+ * This is a wrapper function around the external LAPACK function.
+ *
+ * See the LAPACK documentation at:
+ * http://www.netlib.org/lapack/explore-html/dc/d8b/dgelsy_8f.html
+ *
+ */
+int dgelsy(int M, int N, int NRHS, double *A, int LDA, double *B, int LDB,
+		int *JPVT, double RCOND, int *RANK, double *WORK, int LWORK)
+{
+	extern void dgelsy_(int *Mp, int *Np, int *NRHSp, double *A,
+			int *LDAp, double *B, int *LDBp, int *JPVT,
+			double *RCONDp, int *RANK, double *WORK, int *LWORKp,
+			int *INFOp);
+	int INFO;
+	dgelsy_(&M, &N, &NRHS, A, &LDA, B, &LDB, JPVT, &RCOND, RANK, WORK,
+			&LWORK, &INFO);
+	return INFO;
+}
@@ -51,12 +51,14 @@
  *
  * @param[in] 	q 		a complete GenQueue struct
  * @param[in] 	percentile 	the desired percentile
+ * @param[in] 	ctx 		the GenContext for the output, or NULL
  *
  * @return 			a GenQueue struct with GenTasks which are at
  * 				or above the desired percentile of performance
  *
  */
-struct GenQueue *gensvm_top_queue(struct GenQueue *q, double percentile)
+struct GenQueue *gensvm_top_queue(struct GenQueue *q, double percentile,
+		struct GenContext *ctx)
 {
 	long i, k, N = 0;
 	double boundary,
@@ -68,8 +70,8 @@ struct GenQueue *gensvm_top_queue(struct GenQueue *q, double percentile)
 		perf[i] = q->tasks[i]->performance;
 	}
 	boundary = gensvm_percentile(perf, q->N, percentile);
-	note("Boundary of the %g-th percentile determined at: %f\n",
-			percentile, boundary);
+	gensvm_note(ctx, "Boundary of the %g-th percentile determined at: "
+			"%f\n", percentile, boundary);
 
 	// find the number of tasks that perform at or above the boundary
 	for (i=0; i<q->N; i++) {
@@ -87,10 +89,372 @@ struct GenQueue *gensvm_top_queue(struct GenQueue *q, double percentile)
 	nq->N = N;
 	nq->i = 0;
 
-	free(perf);
+	Free(perf);
 	return nq;
 }
 
+/**
+ * @brief Find or compute the kernel of the folds for a task
+ *
+ * @details
+ * The kernel cache of a consistency repeat holds the folds with up to
+ * @p cache_size kernels, keyed on the kernel parameters. If an
+ * entry has the kernel of @p task it is returned. Otherwise the least
+ * recently used entry is replaced by the kernel of @p task, which is
+ * computed with gensvm_kernel_folds(). The kernel parameters of @p model
+ * must be those of @p task.
+ *
+ * @param[in,out] 	cache 		the kernel cache
+ * @param[in] 		cache_size 	number of entries of the cache
+ * @param[in] 		task 	the task to find the kernel for
+ * @param[in] 		model 	GenModel with the parameters of @p task
+ * @param[in] 		folds 	number of folds
+ * @param[in] 		i 	index of the task in the queue
+ * @param[in] 		ctx 	the GenContext
+ * @returns 			entry of the cache with the kernel of @p task
+ */
+struct GenKernelFolds *gensvm_kernel_cache_get(struct GenKernelFolds *cache,
+		long cache_size, struct GenTask *task, struct GenModel *model,
+		long folds, long i, struct GenContext *ctx)
+{
+	long c, lru = 0;
+
+	for (c=0; c<cache_size; c++) {
+		if (cache[c].task != NULL &&
+				!gensvm_kernel_changed(task, cache[c].task)) {
+			cache[c].used = i;
+			return &cache[c];
+		}
+		if (cache[c].used < cache[lru].used)
+			lru = c;
+	}
+
+	gensvm_kernel_folds(folds, model, cache[lru].train_folds,
+			cache[lru].test_folds, ctx);
+	cache[lru].task = task;
+	cache[lru].used = i;
+	return &cache[lru];
+}
+
+/**
+ * @brief Memory needed for the kernels of the consistency repeats
+ *
+ * @details
+ * Every thread running the repeats keeps @p cache_size kernels of the folds
+ * of a repeat, and computes one kernel at a time. A kept kernel has the
+ * kernel features of every instance of a fold for at most the number of
+ * training instances of the fold, and the computation of a kernel needs
+ * gensvm_kernel_memory() for the training instances of a fold. If all tasks
+ * have a linear kernel, no kernel is computed.
+ *
+ * @param[in] 	nq 		GenQueue with the tasks to repeat
+ * @param[in] 	n_threads 	number of threads running the repeats
+ * @param[in] 	cache_size 	number of kernels in the cache of a repeat
+ * @returns 			approximate number of bytes of the kernels
+ */
+size_t gensvm_repeats_memory(struct GenQueue *nq, long n_threads,
+		long cache_size)
+{
+	long i, n, n_train, folds;
+	size_t kept;
+
+	for (i=0; i<nq->N; i++)
+		if (nq->tasks[i]->kerneltype != K_LINEAR)
+			break;
+	if (i == nq->N)
+		return 0;
+
+	n = nq->tasks[0]->train_data->n;
+	folds = nq->tasks[0]->folds;
+	n_train = n - n / folds;
+	kept = ((size_t) folds) * n * (n_train + 1) * sizeof(double);
+	return n_threads * (cache_size * kept + gensvm_kernel_memory(n_train));
+}
+
+/**
+ * @brief Fit the kernels of the consistency repeats in the memory limit
+ *
+ * @details
+ * The kernels of the repeats take the memory given by
+ * gensvm_repeats_memory(), which grows with both the size of the kernel
+ * cache and the number of threads. If this doesn't fit in the memory limit
+ * (see gensvm_memory_available()), fewer kernels are kept per repeat, down
+ * to a single one, and then fewer threads are used, down to a single one.
+ *
+ * @param[in] 		nq 		GenQueue with the tasks to repeat
+ * @param[in,out] 	n_threads 	number of threads for the repeats,
+ * 					reduced if the kernels don't fit
+ * @returns 				number of kernels to keep per repeat
+ */
+long gensvm_repeats_cache_size(struct GenQueue *nq, long *n_threads)
+{
+	long cache_size = GENSVM_KERNEL_CACHE_SIZE;
+
+	while (cache_size > 1 && !gensvm_memory_available(
+				gensvm_repeats_memory(nq, *n_threads,
+					cache_size)))
+		cache_size--;
+	while (*n_threads > 1 && !gensvm_memory_available(
+				gensvm_repeats_memory(nq, *n_threads, 1)))
+		(*n_threads)--;
+	return cache_size;
+}
+
+/**
+ * @brief Run a single consistency repeat for all tasks
+ *
+ * @details
+ * The folds of the repeat are created once from the cross validation split
+ * of the repeat as views on a reordered copy of the data (see
+ * gensvm_make_fold_data()), and are reused for all tasks. The kernels of the
+ * folds are kept in a cache keyed on the kernel parameters (see
+ * gensvm_kernel_cache_get()) of GenRepeats::cache_size entries, such that
+ * a kernel is computed once per repeat even if the tasks that use it are
+ * not consecutive in the queue, as long as the cache is large enough.
+ * Every task starts from the same initial GenModel::V of the repeat, such
+ * that no solution of a previous task is used as a warm start. This is
+ * needed because otherwise it wouldn't be a consistency check.
+ *
+ * The splits and initial values are precomputed in GenRepeats, and no output
+ * is written other than through a copy of the silent GenRepeats::ctx. This
+ * copy has its own generator, derived from GenRepeats::seed and the index of
+ * the repeat, and its own GenArena for the temporary arrays of the cross
+ * validation, which is reset before every task. Its thread budget is a
+ * single thread, since the repeats already run in parallel. The function
+ * can therefore be run for several repeats in parallel, with results that
+ * don't depend on the number of threads.
+ *
+ * @param[in,out] 	reps 	GenRepeats with the tasks and the results
+ * @param[in] 		r 	index of the repeat
+ */
+void gensvm_consistency_repeat(struct GenRepeats *reps, long r)
+{
+	long c, i, f;
+	long folds = reps->q->tasks[0]->folds;
+	struct GenData *data = reps->q->tasks[0]->train_data;
+	struct GenData *fold_data = NULL;
+	struct GenKernelFolds cache[GENSVM_KERNEL_CACHE_SIZE];
+	struct GenKernelFolds *entry = NULL;
+	struct GenModel *model = gensvm_init_model();
+	struct GenTask *task = NULL;
+	struct GenArena *arena = gensvm_init_arena(0);
+	struct GenContext cv_ctx;
+	struct timespec loop_s, loop_e;
+	long V_size = (data->m+1)*(data->K-1);
+
+	gensvm_context_silence(reps->ctx, &cv_ctx);
+	cv_ctx.rng = gensvm_init_rng(gensvm_rng_derive(reps->seed,
+				reps->repeats + r));
+	cv_ctx.arena = arena;
+	cv_ctx.n_threads = 1;
+
+	model->n = 0;
+	model->m = data->m;
+	model->K = data->K;
+	gensvm_allocate_model(model);
+
+	fold_data = gensvm_make_fold_data(data, reps->cv_idx + r*data->n,
+			folds);
+	for (c=0; c<reps->cache_size; c++) {
+		cache[c].task = NULL;
+		cache[c].used = -1;
+		cache[c].train_folds = Malloc(struct GenData *, folds);
+		cache[c].test_folds = Malloc(struct GenData *, folds);
+		for (f=0; f<folds; f++) {
+			cache[c].train_folds[f] = gensvm_init_data();
+			cache[c].test_folds[f] = gensvm_init_data();
+			gensvm_get_tt_view(fold_data, cache[c].train_folds[f],
+					cache[c].test_folds[f],
+					reps->cv_idx + r*data->n, f);
+		}
+	}
+
+	for (i=0; i<reps->q->N; i++) {
+		task = reps->q->tasks[i];
+		gensvm_task_to_model(task, model);
+		entry = gensvm_kernel_cache_get(cache, reps->cache_size, task,
+				model, folds, i, &cv_ctx);
+		memcpy(model->V, reps->V + r*V_size, V_size*sizeof(double));
+		gensvm_arena_reset(arena);
+		gensvm_arena_reserve(arena, gensvm_cross_validation_size(
+					model, entry->train_folds,
+					entry->test_folds, folds));
+
+		Timer(loop_s);
+		matrix_set(reps->perf, reps->repeats, i, r,
+				gensvm_cross_validation(model,
+					entry->train_folds, entry->test_folds,
+					folds, data->n, &cv_ctx));
+		Timer(loop_e);
+		matrix_set(reps->time, reps->repeats, i, r,
+				gensvm_elapsed_time(&loop_s, &loop_e));
+	}
+
+	for (c=0; c<reps->cache_size; c++) {
+		for (f=0; f<folds; f++) {
+			gensvm_free_data(cache[c].train_folds[f]);
+			gensvm_free_data(cache[c].test_folds[f]);
+		}
+		Free(cache[c].train_folds);
+		Free(cache[c].test_folds);
+	}
+	gensvm_free_data(fold_data);
+	gensvm_free_model(model);
+	gensvm_free_arena(arena);
+	gensvm_free_rng(cv_ctx.rng);
+}
+
+/**
+ * @brief Thread function for the consistency repeats
+ *
+ * @details
+ * Thread @c id of @c n_threads runs the repeats @c id, @c id + @c n_threads,
+ * etc. with gensvm_consistency_repeat().
+ *
+ * @param[in] 	arg 	pointer to a GenRepeatThread
+ * @returns 		NULL
+ */
+void *gensvm_consistency_thread(void *arg)
+{
+	long r;
+	struct GenRepeatThread *thread = arg;
+	struct GenRepeats *reps = thread->reps;
+
+	for (r=thread->id; r<reps->repeats; r+=reps->n_threads)
+		gensvm_consistency_repeat(reps, r);
+	return NULL;
+}
+
+/**
+ * @brief Initialize the consistency repeats of a queue
+ *
+ * @details
+ * The cross validation split and the initial GenModel::V of every repeat
+ * are generated once, before the repeats are started. Every repeat has its
+ * own generator for the split, derived from a single draw of the generator
+ * of the context, such that the split of a repeat doesn't depend on the
+ * others. The repeats use a silent copy of the context, and run on at most
+ * GenContext::n_threads threads. The number of threads and the size of the
+ * kernel cache of a repeat are reduced if the kernels don't fit in the
+ * memory limit (see gensvm_repeats_cache_size()).
+ *
+ * @param[in] 	nq 		GenQueue with the tasks to repeat
+ * @param[in] 	repeats 	number of repeats
+ * @param[in] 	ctx 		the GenContext, or NULL to use the global
+ * 				state
+ * @returns 			initialized GenRepeats
+ */
+struct GenRepeats *gensvm_init_repeats(struct GenQueue *nq, long repeats,
+		struct GenContext *ctx)
+{
+	long r, N = nq->N,
+	     n_threads = gensvm_context_threads(ctx, repeats),
+	     cache_size = gensvm_repeats_cache_size(nq, &n_threads);
+	struct GenData *data = nq->tasks[0]->train_data;
+	long n = data->n,
+	     V_size = (data->m+1)*(data->K-1);
+	struct GenModel *model = gensvm_init_model();
+	struct GenRepeats *reps = Malloc(struct GenRepeats, 1);
+	struct GenRNG *rng = gensvm_init_rng(0);
+
+	model->n = n;
+	model->m = data->m;
+	model->K = data->K;
+	gensvm_allocate_model(model);
+
+	reps->q = nq;
+	reps->repeats = repeats;
+	reps->n_threads = n_threads;
+	reps->cache_size = cache_size;
+	reps->ctx = Malloc(struct GenContext, 1);
+	gensvm_context_silence(ctx, reps->ctx);
+	reps->seed = gensvm_context_random(ctx);
+	reps->cv_idx = Calloc(long, repeats*n);
+	reps->V = Calloc(double, repeats*V_size);
+	reps->perf = Calloc(double, N*repeats);
+	reps->time = Calloc(double, N*repeats);
+	for (r=0; r<repeats; r++) {
+		gensvm_rng_seed(rng, gensvm_rng_derive(reps->seed, r));
+		if (nq->tasks[0]->stratified)
+			gensvm_make_stratified_cv_split(n,
+					nq->tasks[0]->folds, data->y,
+					reps->cv_idx + r*n, rng);
+		else
+			gensvm_make_cv_split_rng(n, nq->tasks[0]->folds,
+					reps->cv_idx + r*n, rng);
+		gensvm_init_V(NULL, model, data, ctx);
+		memcpy(reps->V + r*V_size, model->V, V_size*sizeof(double));
+	}
+
+	gensvm_free_model(model);
+	gensvm_free_rng(rng);
+	return reps;
+}
+
+/**
+ * @brief Free a GenRepeats structure
+ *
+ * @details
+ * The queue of the repeats is not freed.
+ *
+ * @param[in] 	reps 	GenRepeats to free
+ */
+void gensvm_free_repeats(struct GenRepeats *reps)
+{
+	if (reps == NULL)
+		return;
+	Free(reps->ctx);
+	Free(reps->cv_idx);
+	Free(reps->V);
+	Free(reps->perf);
+	Free(reps->time);
+	Free(reps);
+	reps = NULL;
+}
+
+/**
+ * @brief Run the consistency repeats in parallel
+ *
+ * @details
+ * The repeats are divided over GenRepeats::n_threads threads, which run
+ * gensvm_consistency_thread(). The results are stored in GenRepeats::perf
+ * and GenRepeats::time.
+ *
+ * @param[in,out] 	reps 	GenRepeats initialized with
+ * 				gensvm_init_repeats()
+ * @param[in] 		ctx 	the GenContext, or NULL to use the global
+ * 				state
+ */
+void gensvm_run_repeats(struct GenRepeats *reps, struct GenContext *ctx)
+{
+	long i;
+	pthread_t *threads = Malloc(pthread_t, reps->n_threads);
+	struct GenRepeatThread *args = Malloc(struct GenRepeatThread,
+			reps->n_threads);
+
+	gensvm_note(ctx, "Running %li repeats on %li thread(s)\n",
+			reps->repeats, reps->n_threads);
+
+	for (i=0; i<reps->n_threads; i++) {
+		args[i].reps = reps;
+		args[i].id = i;
+		if (pthread_create(&threads[i], NULL,
+					gensvm_consistency_thread,
+					&args[i]) != 0) {
+			// LCOV_EXCL_START
+			gensvm_error(ctx, "[GenSVM Error]: Couldn't create "
+					"thread\n");
+			exit(EXIT_FAILURE);
+			// LCOV_EXCL_STOP
+		}
+	}
+	for (i=0; i<reps->n_threads; i++)
+		pthread_join(threads[i], NULL);
+
+	Free(threads);
+	Free(args);
+}
+
 /**
  * @brief Run repeats of the GenTask structs in GenQueue to find the best
  * configuration
@@ -102,6 +466,10 @@ struct GenQueue *gensvm_top_queue(struct GenQueue *q, double percentile)
  * in a new GenQueue. For each of the tasks in this new GenQueue the cross 
  * validation run is repeated a number of times.
  *
+ * The cross validation splits and the initial values of the repeats are
+ * generated with gensvm_init_repeats(), and the repeats are run in parallel
+ * with gensvm_run_repeats().
+ *
  * For each of the GenTask configurations that are repeated the mean 
  * performance, standard deviation of the performance and the mean computation 
  * time are reported.
@@ -124,94 +492,47 @@ struct GenQueue *gensvm_top_queue(struct GenQueue *q, double percentile)
  * 				configurations for consistency
  * @param[in] 	percentile 	percentile of performance to determine which
  * 				tasks to repeat
+ * @param[in] 	ctx 		the GenContext, or NULL to use the global
+ * 				state
  *
  * @return 			ID of the best task
  *
  */
 int gensvm_consistency_repeats(struct GenQueue *q, long repeats,
-		double percentile)
+		double percentile, struct GenContext *ctx)
 {
 	bool breakout;
-	long i, f, r, N, *cv_idx = NULL;
+	long i, r, N;
 	double p, pi, pr, pt,
 	       *time = NULL,
 	       *std = NULL,
-	       *mean = NULL,
-	       *perf = NULL;
+	       *mean = NULL;
 	struct GenQueue *nq = NULL;
-	struct GenData **train_folds = NULL,
-		       **test_folds = NULL;
-	struct GenModel *model = gensvm_init_model();
-	struct GenTask *task = NULL;
-	struct timespec loop_s, loop_e;
+	struct GenRepeats *reps = NULL;
 
-	nq = gensvm_top_queue(q, percentile);
+	nq = gensvm_top_queue(q, percentile, ctx);
 	N = nq->N;
 
-	note("Number of items to check: %li\n", nq->N);
+	gensvm_note(ctx, "Number of items to check: %li\n", nq->N);
 	std = Calloc(double, N);
 	mean = Calloc(double, N);
 	time = Calloc(double, N);
-	perf = Calloc(double, N*repeats);
-
-	task = get_next_task(nq);
-
-	model->n = 0;
-	model->m = task->train_data->m;
-	model->K = task->train_data->K;
-	gensvm_allocate_model(model);
-	gensvm_init_V(NULL, model, task->train_data);
-
-	cv_idx = Calloc(long, task->train_data->n);
 
-	train_folds = Malloc(struct GenData *, task->folds);
-	test_folds = Malloc(struct GenData *, task->folds);
+	reps = gensvm_init_repeats(nq, repeats, ctx);
+	gensvm_run_repeats(reps, ctx);
 
-	i = 0;
-	while (task) {
-		gensvm_task_to_model(task, model);
-
-		time[i] = 0.0;
-		note("(%02li/%02li:%03li)\t", i+1, N, task->ID);
+	for (i=0; i<N; i++) {
+		gensvm_note(ctx, "(%02li/%02li:%03li)\t", i+1, N,
+				nq->tasks[i]->ID);
 		for (r=0; r<repeats; r++) {
-			Memset(cv_idx, long, task->train_data->n);
-			gensvm_make_cv_split(task->train_data->n, task->folds, cv_idx);
-			train_folds = Malloc(struct GenData *, task->folds);
-			test_folds = Malloc(struct GenData *, task->folds);
-			for (f=0; f<task->folds; f++) {
-				train_folds[f] = gensvm_init_data();
-				test_folds[f] = gensvm_init_data();
-				gensvm_get_tt_split(task->train_data, train_folds[f],
-						test_folds[f], cv_idx, f);
-				gensvm_kernel_preprocess(model, train_folds[f]);
-				gensvm_kernel_postprocess(model, train_folds[f],
-						test_folds[f]);
-			}
-
-			Timer(loop_s);
-			p = gensvm_cross_validation(model, train_folds, test_folds,
-					task->folds, task->train_data->n);
-			Timer(loop_e);
-			time[i] += gensvm_elapsed_time(&loop_s, &loop_e);
-			matrix_set(perf, repeats, i, r, p);
+			p = matrix_get(reps->perf, repeats, i, r);
 			mean[i] += p/((double) repeats);
-			note("%3.3f\t", p);
-			// this is done because if we reuse the V it's not a
-			// consistency check
-			gensvm_init_V(NULL, model, task->train_data);
-			for (f=0; f<task->folds; f++) {
-				gensvm_free_data(train_folds[f]);
-				gensvm_free_data(test_folds[f]);
-			}
-			free(train_folds);
-			train_folds = NULL;
-
-			free(test_folds);
-			test_folds = NULL;
+			time[i] += matrix_get(reps->time, repeats, i, r);
+			gensvm_note(ctx, "%3.3f\t", p);
 		}
 		for (r=0; r<repeats; r++) {
-			std[i] += pow(matrix_get(perf, repeats, i, r) - mean[i],
-					2.0);
+			std[i] += pow(matrix_get(reps->perf, repeats, i, r) -
+					mean[i], 2.0);
 		}
 		if (r > 1) {
 			std[i] /= ((double) repeats) - 1.0;
@@ -219,16 +540,14 @@ int gensvm_consistency_repeats(struct GenQueue *q, long repeats,
 		} else {
 			std[i] = 0.0;
 		}
-		note("(m = %3.3f, s = %3.3f, t = %3.3f)\n", mean[i], std[i],
-				time[i]);
-		task = get_next_task(nq);
-		i++;
+		gensvm_note(ctx, "(m = %3.3f, s = %3.3f, t = %3.3f)\n",
+				mean[i], std[i], time[i]);
 	}
 
 	// find the best overall configurations: those with high average
 	// performance and low deviation in the performance
-	note("\nBest overall configuration(s):\n");
-	note("ID\tweights\tepsilon\t\tp\t\tkappa\t\tlambda\t\t"
+	gensvm_note(ctx, "\nBest overall configuration(s):\n");
+	gensvm_note(ctx, "ID\tweights\tepsilon\t\tp\t\tkappa\t\tlambda\t\t"
 			"mean_perf\tstd_perf\ttime_perf\n");
 	p = 0.0;
 	breakout = false;
@@ -241,7 +560,7 @@ int gensvm_consistency_repeats(struct GenQueue *q, long repeats,
 			if ((pi - mean[i] < 0.0001) &&
 					(std[i] - pr < 0.0001) &&
 					(time[i] - pt < 0.0001)) {
-				note("(%li)\tw = %li\te = %f\tp = %f\t"
+				gensvm_note(ctx, "(%li)\tw = %li\te = %f\tp = %f\t"
 						"k = %f\tl = %f\t"
 						"mean: %3.3f\tstd: %3.3f\t"
 						"time: %3.3f\n",
@@ -262,14 +581,12 @@ int gensvm_consistency_repeats(struct GenQueue *q, long repeats,
 		p += 1.0;
 	}
 
-	free(cv_idx);
-	gensvm_free_model(model);
+	gensvm_free_repeats(reps);
 	gensvm_free_queue(nq);
 
-	free(perf);
-	free(std);
-	free(mean);
-	free(time);
+	Free(std);
+	Free(mean);
+	Free(time);
 
 	return best_id;
 }
@@ -320,7 +637,7 @@ double gensvm_percentile(double *values, long N, double p)
 	pr = maximum(minimum(p - pi, 1), 0);
 	boundary = (1 - pr)*local[((long) pi)-1] + pr*local[((long) pi)];
 
-	free(local);
+	Free(local);
 
 	return boundary;
 }
@@ -0,0 +1,250 @@
+/**
+ * @file gensvm_context.c
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Functions for the library context
+ *
+ * @details
+ * The library context replaces the global state of the library while
+ * training: the output streams used by note() and err(), and the generator
+ * of rand(). Every function in this file accepts a NULL context, in which
+ * case it falls back on this global state. This keeps the behavior of the
+ * command line programs unchanged, while allowing applications to train
+ * models concurrently with a context per training.
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+
+#include "gensvm_context.h"
+
+extern FILE *GENSVM_OUTPUT_FILE;
+extern FILE *GENSVM_ERROR_FILE;
+
+/**
+ * @brief Initialize a GenContext structure
+ *
+ * @details
+ * The new context writes errors and warnings to stderr and suppresses all
+ * other output. Set GenContext::output to change this. The thread budget
+ * is initialized to all processors, and no arena is used.
+ *
+ * @param[in] 	seed 	seed of the random number generator
+ * @returns 		initialized GenContext
+ */
+struct GenContext *gensvm_init_context(uint64_t seed)
+{
+	struct GenContext *ctx = Malloc(struct GenContext, 1);
+
+	ctx->output = NULL;
+	ctx->error = stderr;
+	ctx->rng = gensvm_init_rng(seed);
+	ctx->n_threads = 0;
+	ctx->arena = NULL;
+
+	return ctx;
+}
+
+/**
+ * @brief Free a GenContext structure
+ *
+ * @details
+ * The output streams are not closed, since they are not owned by the
+ * context.
+ *
+ * @param[in] 	ctx 	GenContext to free
+ */
+void gensvm_free_context(struct GenContext *ctx)
+{
+	if (ctx == NULL)
+		return;
+	gensvm_free_rng(ctx->rng);
+	Free(ctx);
+	ctx = NULL;
+}
+
+/**
+ * @brief Create a silent copy of a context
+ *
+ * @details
+ * The copy @p quiet shares the error stream, the generator, the thread
+ * budget and the arena of @p ctx, but suppresses regular output. This is
+ * used to prevent that gensvm_optimize() prints its progress for every fold
+ * of a cross validation, without changing any global state. If @p ctx is
+ * NULL, the copy uses #GENSVM_ERROR_FILE and the generator of rand().
+ *
+ * Since the generator and the arena are shared, a copy that is used in
+ * another thread than @p ctx must be given its own (see
+ * gensvm_consistency_repeat()).
+ *
+ * @param[in] 	ctx 	the GenContext to copy, or NULL
+ * @param[out] 	quiet 	the silent copy
+ */
+void gensvm_context_silence(struct GenContext *ctx, struct GenContext *quiet)
+{
+	if (ctx == NULL) {
+		quiet->error = GENSVM_ERROR_FILE;
+		quiet->rng = NULL;
+		quiet->n_threads = 0;
+		quiet->arena = NULL;
+	} else {
+		*quiet = *ctx;
+	}
+	quiet->output = NULL;
+}
+
+/**
+ * @brief Write a formatted string to a stream
+ *
+ * @param[in] 	fid 	the stream, nothing is written if it is NULL
+ * @param[in] 	fmt 	string format
+ * @param[in] 	ap 	variable argument list for the string format
+ */
+static void gensvm_vwrite(FILE *fid, const char *fmt, va_list ap)
+{
+	char buf[BUFSIZ];
+
+	if (fid == NULL)
+		return;
+	vsnprintf(buf, BUFSIZ, fmt, ap);
+	fputs(buf, fid);
+	fflush(fid);
+}
+
+/**
+ * @brief Write a formatted string to the output stream of a context
+ *
+ * @details
+ * This is the counterpart of note() for a GenContext. If @p ctx is NULL,
+ * the output is written to #GENSVM_OUTPUT_FILE.
+ *
+ * @param[in] 	ctx 	the GenContext, or NULL
+ * @param[in] 	fmt 	string format
+ * @param[in] 	... 	variable argument list for the string format
+ */
+void gensvm_note(struct GenContext *ctx, const char *fmt, ...)
+{
+	va_list ap;
+	va_start(ap, fmt);
+	gensvm_vwrite(ctx == NULL ? GENSVM_OUTPUT_FILE : ctx->output, fmt,
+			ap);
+	va_end(ap);
+}
+
+/**
+ * @brief Write a formatted string to the error stream of a context
+ *
+ * @details
+ * This is the counterpart of err() for a GenContext. If @p ctx is NULL,
+ * the output is written to #GENSVM_ERROR_FILE.
+ *
+ * @param[in] 	ctx 	the GenContext, or NULL
+ * @param[in] 	fmt 	string format
+ * @param[in] 	... 	variable argument list for the string format
+ */
+void gensvm_error(struct GenContext *ctx, const char *fmt, ...)
+{
+	va_list ap;
+	va_start(ap, fmt);
+	gensvm_vwrite(ctx == NULL ? GENSVM_ERROR_FILE : ctx->error, fmt, ap);
+	va_end(ap);
+}
+
+/**
+ * @brief Seed the random number generator of a context
+ *
+ * @param[in] 	ctx 	the GenContext, or NULL to seed rand() with srand()
+ * @param[in] 	seed 	the seed
+ */
+void gensvm_context_seed(struct GenContext *ctx, uint64_t seed)
+{
+	if (ctx == NULL || ctx->rng == NULL)
+		srand(seed);
+	else
+		gensvm_rng_seed(ctx->rng, seed);
+}
+
+/**
+ * @brief Draw a random integer from a context
+ *
+ * @details
+ * This is mainly used to seed other generators from the generator of the
+ * context.
+ *
+ * @param[in] 	ctx 	the GenContext, or NULL to use rand()
+ * @returns 		a random integer
+ */
+uint64_t gensvm_context_random(struct GenContext *ctx)
+{
+	if (ctx == NULL || ctx->rng == NULL)
+		return rand();
+	return gensvm_rng_next(ctx->rng);
+}
+
+/**
+ * @brief Draw a random number in [0, 1] from a context
+ *
+ * @details
+ * Note that rand() can return RAND_MAX, so without a generator in the
+ * context the upper bound is included.
+ *
+ * @param[in] 	ctx 	the GenContext, or NULL to use rand()
+ * @returns 		a random number between 0 and 1
+ */
+double gensvm_context_uniform(struct GenContext *ctx)
+{
+	if (ctx == NULL || ctx->rng == NULL)
+		return ((double) rand()) / ((double) RAND_MAX);
+	return gensvm_rng_uniform(ctx->rng);
+}
+
+/**
+ * @brief Determine the number of threads to use for a parallel section
+ *
+ * @details
+ * The number of threads is given by the thread budget of the context, or
+ * the number of processors online if the context doesn't limit it. The
+ * result is never more than @p max_threads, which is typically the number
+ * of independent jobs, and never less than one.
+ *
+ * @param[in] 	ctx 		the GenContext, or NULL
+ * @param[in] 	max_threads 	maximum useful number of threads
+ * @returns 			number of threads to use
+ */
+long gensvm_context_threads(struct GenContext *ctx, long max_threads)
+{
+	long n_threads = sysconf(_SC_NPROCESSORS_ONLN);
+
+	if (ctx != NULL && ctx->n_threads > 0)
+		n_threads = ctx->n_threads;
+	n_threads = minimum(n_threads, max_threads);
+	return maximum(n_threads, 1);
+}
+
+/**
+ * @brief Get the arena of a context
+ *
+ * @param[in] 	ctx 	the GenContext, or NULL
+ * @returns 		the arena of the context, or NULL if there is none
+ */
+struct GenArena *gensvm_context_arena(struct GenContext *ctx)
+{
+	return (ctx == NULL) ? NULL : ctx->arena;
+}
@@ -42,6 +42,7 @@
  *  - GenModel::degree
  *  - GenModel::max_iter
  *  - GenModel::seed
+ *  - GenModel::temperature
  *
  * @param[in] 		from 	GenModel to copy parameters from
  * @param[in,out] 	to 	GenModel to copy parameters to
@@ -61,4 +62,5 @@ void gensvm_copy_model(struct GenModel *from, struct GenModel *to)
 
 	to->max_iter = from->max_iter;
 	to->seed = from->seed;
+	to->temperature = from->temperature;
 }
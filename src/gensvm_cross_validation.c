@@ -26,7 +26,48 @@
 
 #include "gensvm_cross_validation.h"
 
-extern FILE *GENSVM_OUTPUT_FILE;
+/**
+ * @brief Size of the arena needed for a cross validation
+ *
+ * @details
+ * This gives the number of bytes that gensvm_cross_validation() takes from
+ * the arena of the context: the distances and labels of all test
+ * instances, and for the largest fold either the workspace of
+ * gensvm_optimize() with the work arrays of gensvm_predict_assign() for the
+ * training accuracy, or the predictions of the test instances with these
+ * work arrays. With an arena of this size, the cross validation doesn't
+ * allocate any of these arrays.
+ *
+ * @param[in] 	model 		GenModel with the configuration to train
+ * @param[in] 	train_folds 	array of training datasets
+ * @param[in] 	test_folds 	array of test datasets
+ * @param[in] 	folds 		number of folds
+ * @returns 			number of bytes to reserve in the arena
+ */
+size_t gensvm_cross_validation_size(struct GenModel *model,
+		struct GenData **train_folds, struct GenData **test_folds,
+		long folds)
+{
+	long f, n_test = 0, K = model->K;
+	size_t size, fold_size, max_size = 0;
+
+	for (f=0; f<folds; f++) {
+		n_test += test_folds[f]->n;
+		fold_size = gensvm_work_size(train_folds[f]->n,
+				train_folds[f]->r, K);
+		fold_size += gensvm_predict_assign_size(train_folds[f]->n, K);
+		max_size = maximum(max_size, fold_size);
+		fold_size = gensvm_arena_size(test_folds[f]->n, sizeof(long));
+		fold_size += gensvm_arena_size(test_folds[f]->n*(K-1),
+				sizeof(double));
+		fold_size += gensvm_predict_assign_size(test_folds[f]->n, K);
+		max_size = maximum(max_size, fold_size);
+	}
+	size = gensvm_arena_size(n_test, sizeof(long));
+	size += gensvm_arena_size(n_test*K, sizeof(double));
+
+	return size + max_size;
+}
 
 /**
  * @brief Run cross validation with a given set of train/test folds
@@ -37,8 +78,22 @@ extern FILE *GENSVM_OUTPUT_FILE;
  * for GenModel::V of the next fold.
  *
  * @note
- * This function always sets the output stream defined in GENSVM_OUTPUT_FILE
- * to NULL, to ensure gensvm_optimize() doesn't print too much.
+ * The folds are trained with a silent copy of the context (see
+ * gensvm_context_silence()), to ensure gensvm_optimize() doesn't print too
+ * much. No global state is changed.
+ *
+ * The temporary arrays of the folds, including the workspace of
+ * gensvm_optimize(), are taken from the arena of the context and given
+ * back after every fold, such that all folds use the same memory. If the
+ * context has no arena, an arena is created for the duration of this
+ * function, with the size given by gensvm_cross_validation_size().
+ *
+ * After this function returns, GenModel::elapsed_iter contains the total
+ * number of iterations over all folds. The distances of the test instances
+ * to the simplex vertices are computed along with the predictions, and the
+ * temperature of the class probabilities is fitted on the distances of all
+ * folds with gensvm_fit_temperature(). The result is stored in
+ * GenModel::temperature.
  *
  * @param[in] 	model 		GenModel with the configuration to train
  * @param[in] 	train_folds 	array of training datasets
@@ -46,20 +101,42 @@ extern FILE *GENSVM_OUTPUT_FILE;
  * @param[in] 	folds 		number of folds
  * @param[in] 	n_total 	number of objects in the union of the train
  * 				datasets
+ * @param[in] 	ctx 		the GenContext, or NULL to use the global
+ * 				state
  * @return 			performance (hitrate) of the configuration on
  * 				cross validation
  */
 double gensvm_cross_validation(struct GenModel *model,
 		struct GenData **train_folds, struct GenData **test_folds,
-		long folds, long n_total)
+		long folds, long n_total, struct GenContext *ctx)
 {
-	long f;
-	long *predy = NULL;
+	long f, i, n_test = 0, total_iter = 0;
+	long *predy = NULL,
+	     *y = NULL;
 	double performance, total_perf = 0;
+	double *dist = NULL,
+	       *ZV = NULL;
+	size_t start, mark;
+	struct GenContext quiet;
+	struct GenArena *own = NULL,
+			*arena = gensvm_context_arena(ctx);
+
+	// make sure that gensvm_optimize() is silent and uses the arena
+	gensvm_context_silence(ctx, &quiet);
+	if (arena == NULL) {
+		own = gensvm_init_arena(gensvm_cross_validation_size(model,
+					train_folds, test_folds, folds));
+		arena = own;
+		quiet.arena = own;
+	}
+	start = gensvm_arena_mark(arena);
 
-	// make sure that gensvm_optimize() is silent.
-	FILE *fid = GENSVM_OUTPUT_FILE;
-	GENSVM_OUTPUT_FILE = NULL;
+	// the distances of the test instances of all folds
+	for (f=0; f<folds; f++)
+		n_test += test_folds[f]->n;
+	y = ArenaCalloc(arena, long, n_test);
+	dist = ArenaCalloc(arena, double, n_test*model->K);
+	n_test = 0;
 
 	// run cross-validation
 	for (f=0; f<folds; f++) {
@@ -71,21 +148,36 @@ double gensvm_cross_validation(struct GenModel *model,
 		gensvm_initialize_weights(train_folds[f], model);
 
 		// train the model (surpressing output)
-		gensvm_optimize(model, train_folds[f]);
-
-		// calculate prediction performance on test set
-		predy = Calloc(long, test_folds[f]->n);
-		gensvm_predict_labels(test_folds[f], model, predy);
+		gensvm_optimize(model, train_folds[f], &quiet);
+		total_iter += model->elapsed_iter;
+
+		// calculate prediction performance on test set. The simplex
+		// matrix GenModel::U is computed by gensvm_optimize().
+		mark = gensvm_arena_mark(arena);
+		predy = ArenaCalloc(arena, long, test_folds[f]->n);
+		ZV = ArenaCalloc(arena, double,
+				test_folds[f]->n*(model->K-1));
+		gensvm_calculate_ZV(model, test_folds[f], ZV);
+		gensvm_predict_assign(ZV, model->U, test_folds[f]->n,
+				model->K, predy, &dist[n_test*model->K],
+				&quiet);
 		performance = gensvm_prediction_perf(test_folds[f], predy);
 		total_perf += performance * test_folds[f]->n;
 
-		free(predy);
+		for (i=0; i<test_folds[f]->n; i++)
+			y[n_test + i] = test_folds[f]->y[i];
+		n_test += test_folds[f]->n;
+
+		gensvm_arena_release(arena, mark);
 	}
 
 	total_perf /= ((double) n_total);
+	model->elapsed_iter = total_iter;
+	model->temperature = gensvm_fit_temperature(dist, y, n_test,
+			model->K);
 
-	// reset the output stream
-	GENSVM_OUTPUT_FILE = fid;
+	gensvm_arena_release(arena, start);
+	gensvm_free_arena(own);
 
 	return total_perf;
 }
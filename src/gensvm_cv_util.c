@@ -38,12 +38,13 @@
  *
  * @details
  * A pre-allocated vector of length N is created which can be used to define
- * cross validation splits. The folds are contain between
+ * cross validation splits. The folds contain between
  * @f$ \lfloor N / folds \rfloor @f$ and @f$ \lceil N / folds \rceil @f$
- * instances. An instance is mapped to a partition randomly until all folds
- * contain @f$ N \% folds @f$ instances. The zero fold then contains
- * @f$ N / folds + N \% folds @f$ instances. These remaining @f$ N \% folds @f$
- * instances are then distributed over the first @f$ N \% folds @f$ folds.
+ * instances, where the first @f$ N \% folds @f$ folds are the larger ones.
+ *
+ * This is a wrapper around gensvm_make_cv_split_rng(), which uses a
+ * generator that is seeded with rand(). The split is therefore determined
+ * by the seed given to srand().
  *
  * @param[in] 		N 	number of instances
  * @param[in] 		folds 	number of folds
@@ -53,33 +54,122 @@
  */
 void gensvm_make_cv_split(long N, long folds, long *cv_idx)
 {
-	long i, j, idx;
+	struct GenRNG *rng = gensvm_init_rng(rand());
+	gensvm_make_cv_split_rng(N, folds, cv_idx, rng);
+	gensvm_free_rng(rng);
+}
+
+/**
+ * @brief Shuffle an array of indices
+ *
+ * @details
+ * This is the Fisher-Yates shuffle, which gives a uniformly random
+ * permutation in linear time.
+ *
+ * @param[in,out] 	idx 	array of indices
+ * @param[in] 		N 	length of the array
+ * @param[in,out] 	rng 	the random number generator
+ */
+static void gensvm_shuffle(long *idx, long N, struct GenRNG *rng)
+{
+	long i, j, tmp;
+
+	for (i=N-1; i>0; i--) {
+		j = gensvm_rng_bounded(rng, i+1);
+		tmp = idx[i];
+		idx[i] = idx[j];
+		idx[j] = tmp;
+	}
+}
+
+/**
+ * @brief Create a cross validation split vector with a given generator
+ *
+ * @details
+ * The instances are shuffled with the Fisher-Yates shuffle, and the
+ * instances are dealt to the folds in the shuffled order. This takes linear
+ * time. The folds contain between @f$ \lfloor N / folds \rfloor @f$ and
+ * @f$ \lceil N / folds \rceil @f$ instances, where the first
+ * @f$ N \% folds @f$ folds are the larger ones.
+ *
+ * @param[in] 		N 	number of instances
+ * @param[in] 		folds 	number of folds
+ * @param[in,out] 	cv_idx 	array of size N which contains the fold index
+ * 				for each observation on exit
+ * @param[in,out] 	rng 	the random number generator
+ */
+void gensvm_make_cv_split_rng(long N, long folds, long *cv_idx,
+		struct GenRNG *rng)
+{
+	long i;
+	long *perm = Malloc(long, N);
 
 	for (i=0; i<N; i++)
-		cv_idx[i] = 0;
-
-	long big_folds = N%folds;
-	long small_fold_size = N/folds;
-
-	j = 0;
-	for (i=0; i<small_fold_size*folds; i++)
-		while (1) {
-			idx = rand()%N;
-			if (cv_idx[idx] == 0) {
-				cv_idx[idx] = j;
-				j++;
-				j%=folds;
-				break;
-			}
-		}
-	j = 0;
-	i = 0;
-	while (i < big_folds) {
-		if (cv_idx[j] == 0) {
-			cv_idx[j] = i++;
-		}
-		j++;
+		perm[i] = i;
+	gensvm_shuffle(perm, N, rng);
+	for (i=0; i<N; i++)
+		cv_idx[perm[i]] = i % folds;
+
+	Free(perm);
+}
+
+/**
+ * @brief Create a stratified cross validation split vector
+ *
+ * @details
+ * A stratified split has the same distribution of the classes in every
+ * fold, up to rounding. This reduces the variance of the cross validation
+ * performance between splits, in particular with small classes. The
+ * instances are grouped by class with a counting sort, the instances of
+ * every class are shuffled, and all instances are then dealt to the folds
+ * in this order. Since dealing continues from one class to the next, the
+ * sizes of the folds are the same as for gensvm_make_cv_split_rng(). This
+ * takes linear time. If no class labels are given, this function is equal
+ * to gensvm_make_cv_split_rng().
+ *
+ * @param[in] 		N 	number of instances
+ * @param[in] 		folds 	number of folds
+ * @param[in] 		y 	class labels of the instances (1..K), or NULL
+ * @param[in,out] 	cv_idx 	array of size N which contains the fold index
+ * 				for each observation on exit
+ * @param[in,out] 	rng 	the random number generator
+ */
+void gensvm_make_stratified_cv_split(long N, long folds, long *y,
+		long *cv_idx, struct GenRNG *rng)
+{
+	long i, k, K = 0;
+	long *start = NULL,
+	     *order = NULL;
+
+	if (y == NULL) {
+		gensvm_make_cv_split_rng(N, folds, cv_idx, rng);
+		return;
+	}
+
+	for (i=0; i<N; i++)
+		K = maximum(K, y[i]);
+
+	// counting sort of the instances by class
+	start = Calloc(long, K+2);
+	order = Malloc(long, N);
+	for (i=0; i<N; i++)
+		start[y[i]+1]++;
+	for (k=1; k<K+2; k++)
+		start[k] += start[k-1];
+	for (i=0; i<N; i++)
+		order[start[y[i]]++] = i;
+
+	// start[k] now holds the end of class k, shuffle within each class
+	for (k=0; k<K+1; k++) {
+		i = (k == 0) ? 0 : start[k-1];
+		gensvm_shuffle(order + i, start[k] - i, rng);
 	}
+
+	for (i=0; i<N; i++)
+		cv_idx[order[i]] = i % folds;
+
+	Free(start);
+	Free(order);
 }
 
 /**
@@ -169,8 +259,8 @@ void gensvm_get_tt_split_dense(struct GenData *full_data,
 	train_data->y = Calloc(long, train_n);
 	test_data->y = Calloc(long, test_n);
 
-	train_data->RAW = Calloc(double, train_n*(m+1));
-	test_data->RAW = Calloc(double, test_n*(m+1));
+	train_data->RAW = AlignedCalloc(double, train_n*(m+1));
+	test_data->RAW = AlignedCalloc(double, test_n*(m+1));
 
 	k = 0;
 	l = 0;
@@ -321,3 +411,165 @@ void gensvm_get_tt_split_sparse(struct GenData *full_data,
 		}
 	}
 }
+
+/**
+ * @brief Reorder a dataset by fold for zero-copy cross validation
+ *
+ * @details
+ * The instances of the dataset are ordered by fold (with the original order
+ * kept within a fold), and the reordered dataset is stored twice in
+ * succession. In this layout, the test set of every fold is a contiguous
+ * block of rows, and so is the training set, which consists of the folds
+ * following the test fold, wrapping around to the second copy. The train and
+ * test datasets of a fold can therefore be views on the returned dataset
+ * (see gensvm_get_tt_view()), which need twice the memory of the full
+ * dataset for all folds together instead of @p folds times the memory of the
+ * full dataset for gensvm_get_tt_split().
+ *
+ * Only GenData::y and GenData::RAW or GenData::spZ are copied. The returned
+ * GenData has twice the number of instances of the full dataset, and should
+ * be freed with gensvm_free_data() after all views on it are freed.
+ *
+ * @param[in] 	full_data 	a GenData structure for the entire dataset
+ * @param[in] 	cv_idx 		a vector of cv partitions created by
+ * 				gensvm_make_cv_split()
+ * @param[in] 	folds 		number of folds
+ * @returns 			GenData with the reordered dataset stored
+ * 				twice
+ */
+struct GenData *gensvm_make_fold_data(struct GenData *full_data,
+		long *cv_idx, long folds)
+{
+	long c, f, i, jj, k, nnz = 0;
+	long n = full_data->n;
+	long m = full_data->m;
+	struct GenSparse *sp = NULL;
+	struct GenData *fold_data = gensvm_init_data();
+
+	fold_data->n = 2*n;
+	fold_data->m = m;
+	fold_data->r = full_data->r;
+	fold_data->K = full_data->K;
+	fold_data->y = Malloc(long, 2*n);
+
+	if (full_data->Z != NULL) {
+		fold_data->RAW = AlignedMalloc(double, 2*n*(m+1));
+		fold_data->Z = fold_data->RAW;
+	} else {
+		fold_data->spZ = gensvm_init_sparse();
+		fold_data->spZ->nnz = 2*full_data->spZ->nnz;
+		fold_data->spZ->n_row = 2*n;
+		fold_data->spZ->n_col = full_data->spZ->n_col;
+		fold_data->spZ->values = Malloc(double, 2*full_data->spZ->nnz);
+		fold_data->spZ->ia = Malloc(long, 2*n+1);
+		fold_data->spZ->ja = Malloc(long, 2*full_data->spZ->nnz);
+		fold_data->spZ->ia[0] = 0;
+	}
+
+	k = 0;
+	for (c=0; c<2; c++) {
+		for (f=0; f<folds; f++) {
+			for (i=0; i<n; i++) {
+				if (cv_idx[i] != f)
+					continue;
+				fold_data->y[k] = full_data->y[i];
+				if (full_data->Z != NULL) {
+					memcpy(&fold_data->RAW[k*(m+1)],
+						&full_data->RAW[i*(m+1)],
+						(m+1)*sizeof(double));
+				} else {
+					sp = full_data->spZ;
+					for (jj=sp->ia[i]; jj<sp->ia[i+1]; jj++) {
+						fold_data->spZ->values[nnz] =
+							sp->values[jj];
+						fold_data->spZ->ja[nnz] =
+							sp->ja[jj];
+						nnz++;
+					}
+					fold_data->spZ->ia[k+1] = nnz;
+				}
+				k++;
+			}
+		}
+	}
+
+	return fold_data;
+}
+
+/**
+ * @brief Make a GenData a view on a block of rows of another GenData
+ *
+ * @param[in] 		parent 	the GenData that owns the data
+ * @param[in,out] 	view 	an initialized GenData which on exit is a
+ * 				view on the rows of the parent
+ * @param[in] 		start 	index of the first row of the view
+ * @param[in] 		n 	number of rows of the view
+ */
+static void gensvm_set_view(struct GenData *parent, struct GenData *view,
+		long start, long n)
+{
+	view->is_view = true;
+	view->n = n;
+	view->m = parent->m;
+	view->K = parent->K;
+	view->y = parent->y + start;
+
+	if (parent->RAW != NULL) {
+		view->RAW = parent->RAW + start*(parent->m+1);
+		view->Z = view->RAW;
+	} else {
+		view->spZ = gensvm_init_sparse();
+		view->spZ->n_row = n;
+		view->spZ->n_col = parent->spZ->n_col;
+		view->spZ->ia = parent->spZ->ia + start;
+		view->spZ->nnz = view->spZ->ia[n] - view->spZ->ia[0];
+		view->spZ->ja = parent->spZ->ja;
+		view->spZ->values = parent->spZ->values;
+	}
+}
+
+/**
+ * @brief Create train and test views for a CV split without copying
+ *
+ * @details
+ * This function is the zero-copy alternative to gensvm_get_tt_split(). The
+ * train and test datasets of the fold are views on the rows of a dataset
+ * created with gensvm_make_fold_data() (see GenData::is_view). For sparse
+ * data, the row pointers of the view point into the row pointers of the
+ * parent, such that they index the nonzero elements of the parent directly.
+ * Note that the instances in the training set are ordered by fold, starting
+ * with the fold after the test fold.
+ *
+ * The views must be freed with gensvm_free_data() before @p fold_data is
+ * freed. A kernel matrix computed for a view (GenData::Z) is owned by the
+ * view.
+ *
+ * @param[in] 		fold_data 	dataset created by
+ * 					gensvm_make_fold_data()
+ * @param[in,out] 	train_data 	an initialized GenData structure which
+ * 					on exit is a view on the training
+ * 					dataset
+ * @param[in,out] 	test_data 	an initialized GenData structure which
+ * 					on exit is a view on the test dataset
+ * @param[in] 		cv_idx 		the vector of cv partitions used for
+ * 					creating @p fold_data
+ * @param[in] 		fold_idx 	index of the fold which becomes the
+ * 					test dataset
+ */
+void gensvm_get_tt_view(struct GenData *fold_data,
+		struct GenData *train_data, struct GenData *test_data,
+		long *cv_idx, long fold_idx)
+{
+	long i, start = 0, test_n = 0;
+	long n = fold_data->n/2;
+
+	for (i=0; i<n; i++) {
+		if (cv_idx[i] < fold_idx)
+			start++;
+		else if (cv_idx[i] == fold_idx)
+			test_n++;
+	}
+
+	gensvm_set_view(fold_data, test_data, start, test_n);
+	gensvm_set_view(fold_data, train_data, start + test_n, n - test_n);
+}
@@ -47,8 +47,11 @@ struct GenGrid *gensvm_init_grid(void)
 
 	// initialize to defaults
 	grid->traintype = CV;
+	grid->search = S_GRID;
+	grid->n_tasks = 0;
 	grid->kerneltype = K_LINEAR;
 	grid->folds = 10;
+	grid->stratified = false;
 	grid->repeats = 0;
 	grid->percentile = 95.0;
 	grid->Np = 0;
@@ -87,16 +90,16 @@ struct GenGrid *gensvm_init_grid(void)
  */
 void gensvm_free_grid(struct GenGrid *grid)
 {
-	free(grid->weight_idxs);
-	free(grid->ps);
-	free(grid->lambdas);
-	free(grid->kappas);
-	free(grid->epsilons);
-	free(grid->gammas);
-	free(grid->coefs);
-	free(grid->degrees);
-	free(grid->train_data_file);
-	free(grid->test_data_file);
-	free(grid);
+	Free(grid->weight_idxs);
+	Free(grid->ps);
+	Free(grid->lambdas);
+	Free(grid->kappas);
+	Free(grid->epsilons);
+	Free(grid->gammas);
+	Free(grid->coefs);
+	Free(grid->degrees);
+	Free(grid->train_data_file);
+	Free(grid->test_data_file);
+	Free(grid);
 	grid = NULL;
 }
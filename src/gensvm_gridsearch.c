@@ -79,6 +79,7 @@ void gensvm_fill_queue(struct GenGrid *grid, struct GenQueue *queue,
 		task->train_data = train_data;
 		task->test_data = test_data;
 		task->folds = grid->folds;
+		task->stratified = grid->stratified;
 		task->kerneltype = grid->kerneltype;
 		queue->tasks[i] = task;
 	}
@@ -233,26 +234,28 @@ bool gensvm_kernel_changed(struct GenTask *newtask, struct GenTask *oldtask)
  * @param[in] 		model 		GenModel with new kernel parameters
  * @param[in,out] 	train_folds 	array of train datasets
  * @param[in,out] 	test_folds 	array of test datasets
+ * @param[in] 		ctx 		the GenContext for the output, or NULL
  *
  */
 void gensvm_kernel_folds(long folds, struct GenModel *model,
-		struct GenData **train_folds, struct GenData **test_folds)
+		struct GenData **train_folds, struct GenData **test_folds,
+		struct GenContext *ctx)
 {
 	long f;
 
 	if (model->kerneltype != K_LINEAR)
-		note("Computing kernel ... ");
+		gensvm_note(ctx, "Computing kernel ... ");
 	for (f=0; f<folds; f++) {
 		if (train_folds[f]->Z != train_folds[f]->RAW)
-			free(train_folds[f]->Z);
+			Free(train_folds[f]->Z);
 		if (test_folds[f]->Z != test_folds[f]->RAW)
-			free(test_folds[f]->Z);
+			Free(test_folds[f]->Z);
 		gensvm_kernel_preprocess(model, train_folds[f]);
 		gensvm_kernel_postprocess(model, train_folds[f],
 				test_folds[f]);
 	}
 	if (model->kerneltype != K_LINEAR)
-		note("done.\n");
+		gensvm_note(ctx, "done.\n");
 }
 
 /**
@@ -269,73 +272,150 @@ void gensvm_kernel_folds(long folds, struct GenModel *model,
  *
  * The performance found by cross validation is stored in the GenTask struct.
  *
- * @param[in,out] 	q 	GenQueue with GenTask instances to run
+ * If a GenJournal is supplied, tasks which are already in the journal are not
+ * trained again, but their stored performance is used. Every task that is
+ * trained is appended to the journal, such that an interrupted grid search
+ * can be resumed. Tasks are identified in the journal by a hash of the
+ * dataset, the cross validation split, and the task parameters (see
+ * gensvm_journal_task_key()). Since the split is drawn from the generator
+ * of the GenContext, the same seed should be used to resume a grid search. Note
+ * that skipped tasks don't provide a warm start for the next task, so the
+ * number of iterations of the resumed tasks may differ slightly from an
+ * uninterrupted run. The journal is synchronized to disk after every group
+ * of tasks with the same kernel and at the end (see gensvm_journal_sync()).
+ *
+ * The temporary arrays of the cross validation are taken from a single
+ * GenArena, which is reset before every task and reserved for the largest
+ * fold of the task. After the first task, no memory is allocated for these
+ * arrays unless the kernel changes the size of the folds. If memory use is
+ * tracked (see gensvm_memory_track()), a report of the memory use is
+ * written at the end.
+ *
+ * @param[in,out] 	q 		GenQueue with GenTask instances to run
+ * @param[in,out] 	journal 	GenJournal of completed tasks, or NULL
+ * 					if no journal should be kept
+ * @param[in] 		ctx 		the GenContext, or NULL to use the
+ * 					global state
  */
-void gensvm_train_queue(struct GenQueue *q)
+void gensvm_train_queue(struct GenQueue *q, struct GenJournal *journal,
+		struct GenContext *ctx)
 {
 	long f, folds;
+	uint64_t key = 0,
+		 split_hash = 0;
 	double perf, duration, current_max = 0;
 	struct GenTask *task = get_next_task(q);
 	struct GenTask *prevtask = NULL;
+	struct GenJournalEntry *entry = NULL;
+	struct GenRNG *rng = NULL;
 	struct GenModel *model = gensvm_init_model();
+	struct GenArena *arena = gensvm_init_arena(0);
+	struct GenContext cv_ctx;
 	struct timespec main_s, main_e, loop_s, loop_e;
 
 	folds = task->folds;
+	gensvm_context_silence(ctx, &cv_ctx);
+	cv_ctx.arena = arena;
 
 	model->n = 0;
 	model->m = task->train_data->m;
 	model->K = task->train_data->K;
 	gensvm_allocate_model(model);
-	gensvm_init_V(NULL, model, task->train_data);
+	gensvm_init_V(NULL, model, task->train_data, ctx);
 
 	long *cv_idx = Calloc(long, task->train_data->n);
-	gensvm_make_cv_split(task->train_data->n, task->folds, cv_idx);
-
+	rng = gensvm_init_rng(gensvm_context_random(ctx));
+	if (task->stratified)
+		gensvm_make_stratified_cv_split(task->train_data->n, folds,
+				task->train_data->y, cv_idx, rng);
+	else
+		gensvm_make_cv_split_rng(task->train_data->n, folds, cv_idx,
+				rng);
+	gensvm_free_rng(rng);
+
+	struct GenData *fold_data = gensvm_make_fold_data(task->train_data,
+			cv_idx, folds);
 	struct GenData **train_folds = Malloc(struct GenData *, task->folds);
 	struct GenData **test_folds = Malloc(struct GenData *, task->folds);
 	for (f=0; f<folds; f++) {
 		train_folds[f] = gensvm_init_data();
 		test_folds[f] = gensvm_init_data();
-		gensvm_get_tt_split(task->train_data, train_folds[f],
-				test_folds[f], cv_idx, f);
+		gensvm_get_tt_view(fold_data, train_folds[f], test_folds[f],
+				cv_idx, f);
 	}
 
+	if (journal != NULL)
+		split_hash = gensvm_journal_split_hash(task->train_data,
+				cv_idx);
+
 	Timer(main_s);
 	while (task) {
+		if (journal != NULL) {
+			key = gensvm_journal_task_key(task, split_hash);
+			entry = gensvm_journal_find(journal, key);
+			if (entry != NULL) {
+				perf = entry->performance;
+				current_max = maximum(current_max, perf);
+				gensvm_gridsearch_progress(task, q->N, perf,
+						entry->duration, current_max,
+						ctx);
+				task->performance = perf;
+				task->temperature = entry->temperature;
+				task = get_next_task(q);
+				continue;
+			}
+		}
+
 		gensvm_task_to_model(task, model);
 		if (gensvm_kernel_changed(task, prevtask)) {
+			// the previous group of tasks is done
+			gensvm_journal_sync(journal);
 			gensvm_kernel_folds(task->folds, model, train_folds,
-					test_folds);
+					test_folds, ctx);
 		}
 
+		gensvm_arena_reset(arena);
+		gensvm_arena_reserve(arena, gensvm_cross_validation_size(
+					model, train_folds, test_folds, folds));
+
 		Timer(loop_s);
 		perf = gensvm_cross_validation(model, train_folds, test_folds,
-				folds, task->train_data->n);
+				folds, task->train_data->n, &cv_ctx);
 		Timer(loop_e);
 
 		current_max = maximum(current_max, perf);
 		duration = gensvm_elapsed_time(&loop_s, &loop_e);
 
 		gensvm_gridsearch_progress(task, q->N, perf, duration,
-				current_max);
+				current_max, ctx);
+
+		if (journal != NULL)
+			gensvm_journal_append(journal, key, perf,
+					model->elapsed_iter, duration,
+					model->temperature);
 
-		q->tasks[task->ID]->performance = perf;
+		task->performance = perf;
+		task->temperature = model->temperature;
 		prevtask = task;
 		task = get_next_task(q);
 	}
 	Timer(main_e);
+	gensvm_journal_sync(journal);
 
-	note("\nTotal elapsed training time: %8.8f seconds\n",
+	gensvm_note(ctx, "\nTotal elapsed training time: %8.8f seconds\n",
 			gensvm_elapsed_time(&main_s, &main_e));
+	gensvm_memory_report(ctx);
 
 	gensvm_free_model(model);
+	gensvm_free_arena(arena);
 	for (f=0; f<folds; f++) {
 		gensvm_free_data(train_folds[f]);
 		gensvm_free_data(test_folds[f]);
 	}
-	free(train_folds);
-	free(test_folds);
-	free(cv_idx);
+	Free(train_folds);
+	Free(test_folds);
+	gensvm_free_data(fold_data);
+	Free(cv_idx);
 }
 
 /**
@@ -343,7 +423,7 @@ void gensvm_train_queue(struct GenQueue *q)
  *
  * @details
  * To track the progress of the grid search the parameters of the current task
- * are written to the output specified in GENSVM_OUTPUT_FILE. Since the
+ * are written to the output stream of the GenContext. Since the
  * parameters differ with the specified kernel, this function writes a
  * parameter string depending on which kernel is used.
  *
@@ -352,10 +432,12 @@ void gensvm_train_queue(struct GenQueue *q)
  * @param[in] 	perf 		performance of the current task
  * @param[in] 	duration 	time duration of the current task
  * @param[in] 	current_max 	current best performance
+ * @param[in] 	ctx 		the GenContext, or NULL to write to
+ * 				#GENSVM_OUTPUT_FILE
  *
  */
 void gensvm_gridsearch_progress(struct GenTask *task, long N, double perf, 
-		double duration, double current_max)
+		double duration, double current_max, struct GenContext *ctx)
 {
 	char buffer[GENSVM_MAX_LINE_LENGTH];
 	sprintf(buffer, "(%03li/%03li)\t", task->ID+1, N);
@@ -369,7 +451,7 @@ void gensvm_gridsearch_progress(struct GenTask *task, long N, double perf,
 	sprintf(buffer + strlen(buffer), "eps = %g\tw = %i\tk = %2.2f\t"
 			"l = %f\tp = %2.2f\t", task->epsilon,
 			task->weight_idx, task->kappa, task->lambda, task->p);
-	note(buffer);
-	note("\t%3.3f%% (%3.3fs)\t(best = %3.3f%%)\n", perf, duration, 
-			current_max);
+	gensvm_note(ctx, "%s", buffer);
+	gensvm_note(ctx, "\t%3.3f%% (%3.3fs)\t(best = %3.3f%%)\n", perf,
+			duration, current_max);
 }
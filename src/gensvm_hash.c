@@ -0,0 +1,101 @@
+/**
+ * @file gensvm_hash.c
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Functions for hashing memory blocks and datasets
+ *
+ * @details
+ * The hashes computed here are used to recognize a dataset (or a dataset in
+ * combination with a cross validation split and a set of parameters) across
+ * different runs of the program. The 64-bit FNV-1a hash is used, since it is
+ * simple, fast, and has no dependencies. It is not a cryptographic hash.
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "gensvm_hash.h"
+
+/**
+ * @brief Update a 64-bit FNV-1a hash with a block of memory
+ *
+ * @details
+ * This function continues the FNV-1a hash given in @p hash with the @p len
+ * bytes at @p buf. To start a new hash, supply #GENSVM_HASH_INIT as the
+ * initial value. Since the hash can be continued, several memory blocks can
+ * be combined into a single hash by repeatedly calling this function.
+ *
+ * @param[in] 	hash 	the current value of the hash
+ * @param[in] 	buf 	pointer to the memory to hash
+ * @param[in] 	len 	number of bytes to hash
+ * @return 		the updated hash value
+ */
+uint64_t gensvm_hash_bytes(uint64_t hash, const void *buf, size_t len)
+{
+	size_t i;
+	const unsigned char *bytes = buf;
+
+	for (i=0; i<len; i++) {
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+/**
+ * @brief Compute the hash of a dataset
+ *
+ * @details
+ * The hash covers the dimensions of the dataset, the class labels (if
+ * present), and the raw data. For dense data the augmented matrix
+ * GenData::RAW is hashed, for sparse data the CSR arrays of GenData::spZ are
+ * hashed. Note that the same dataset thus has a different hash depending on
+ * whether it is stored as a dense or a sparse matrix. The kernel
+ * transformation in GenData::Z is not included in the hash.
+ *
+ * @param[in] 	data 	a GenData structure
+ * @return 		the hash of the dataset
+ */
+uint64_t gensvm_hash_data(struct GenData *data)
+{
+	long n = data->n;
+	long m = data->m;
+	uint64_t hash = GENSVM_HASH_INIT;
+
+	hash = gensvm_hash_bytes(hash, &data->n, sizeof(long));
+	hash = gensvm_hash_bytes(hash, &data->m, sizeof(long));
+	hash = gensvm_hash_bytes(hash, &data->K, sizeof(long));
+
+	if (data->y != NULL)
+		hash = gensvm_hash_bytes(hash, data->y, n*sizeof(long));
+
+	if (data->RAW != NULL) {
+		hash = gensvm_hash_bytes(hash, data->RAW,
+				n*(m+1)*sizeof(double));
+	} else if (data->spZ != NULL) {
+		hash = gensvm_hash_bytes(hash, data->spZ->ia,
+				(n+1)*sizeof(long));
+		hash = gensvm_hash_bytes(hash, data->spZ->ja,
+				data->spZ->nnz*sizeof(long));
+		hash = gensvm_hash_bytes(hash, data->spZ->values,
+				data->spZ->nnz*sizeof(double));
+	}
+
+	return hash;
+}
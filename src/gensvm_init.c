@@ -48,16 +48,19 @@
  * When no seed model is supplied, the rows of V are seeded with random 
  * numbers between the inverse of the minimum and the inverse of the maximum 
  * of the corresponding column of Z. This is done to center the product of the 
- * two in the simplex space.
+ * two in the simplex space. The random numbers are drawn from the generator
+ * of the GenContext.
  *
  * @param[in] 		from_model 	GenModel from which to copy V
  * @param[in,out] 	to_model 	GenModel to which V will be copied
  * @param[in] 		data 		GenData structure with the data
+ * @param[in] 		ctx 		the GenContext, or NULL to use rand()
  */
 void gensvm_init_V(struct GenModel *from_model,
-	       	struct GenModel *to_model, struct GenData *data)
+	       	struct GenModel *to_model, struct GenData *data,
+		struct GenContext *ctx)
 {
-	long i, j, k, jj_start, jj_end, jj;
+	long i, j, k, jj_start, jj_end, jj, blk_start, blk_end;
 	double cmin, cmax, value, rnd;
 	double *col_min = NULL,
 	       *col_max = NULL;
@@ -76,17 +79,27 @@ void gensvm_init_V(struct GenModel *from_model,
 		if (data->Z == NULL) {
 			// sparse matrix
 			long *visit_count = Calloc(long, to_model->m+1);
-			for (i=0; i<data->spZ->n_row; i++) {
-				jj_start = data->spZ->ia[i];
-				jj_end = data->spZ->ia[i+1];
-				for (jj=jj_start; jj<jj_end; jj++) {
-					j = data->spZ->ja[jj];
-					value = data->spZ->values[jj];
+			for (blk_start=0; blk_start<data->spZ->n_row;
+					blk_start+=GENSVM_BLOCK_SIZE) {
+				blk_end = minimum(data->spZ->n_row,
+						blk_start + GENSVM_BLOCK_SIZE);
+				gensvm_stream_prefetch(data, blk_end,
+						blk_end + GENSVM_BLOCK_SIZE);
+				for (i=blk_start; i<blk_end; i++) {
+					jj_start = data->spZ->ia[i];
+					jj_end = data->spZ->ia[i+1];
+					for (jj=jj_start; jj<jj_end; jj++) {
+						j = data->spZ->ja[jj];
+						value = data->spZ->values[jj];
 
-					col_min[j] = minimum(col_min[j], value);
-					col_max[j] = maximum(col_max[j], value);
-					visit_count[j]++;
+						col_min[j] = minimum(col_min[j],
+								value);
+						col_max[j] = maximum(col_max[j],
+								value);
+						visit_count[j]++;
+					}
 				}
+				gensvm_stream_release(data, blk_start, blk_end);
 			}
 			// correction in case the minimum or maximum is 0
 			for (j=0; j<to_model->m+1; j++) {
@@ -95,29 +108,39 @@ void gensvm_init_V(struct GenModel *from_model,
 					col_max[j] = maximum(col_max[j], 0.0);
 				}
 			}
-			free(visit_count);
+			Free(visit_count);
 		} else {
 			// dense matrix
-			for (i=0; i<to_model->n; i++) {
-				for (j=0; j<to_model->m+1; j++) {
-					value = matrix_get(data->Z, 
+			for (blk_start=0; blk_start<to_model->n;
+					blk_start+=GENSVM_BLOCK_SIZE) {
+				blk_end = minimum(to_model->n,
+						blk_start + GENSVM_BLOCK_SIZE);
+				gensvm_stream_prefetch(data, blk_end,
+						blk_end + GENSVM_BLOCK_SIZE);
+				for (i=blk_start; i<blk_end; i++) {
+					for (j=0; j<to_model->m+1; j++) {
+						value = matrix_get(data->Z,
 							to_model->m+1, i, j);
-					col_min[j] = minimum(col_min[j], value);
-					col_max[j] = maximum(col_max[j], value);
+						col_min[j] = minimum(col_min[j],
+								value);
+						col_max[j] = maximum(col_max[j],
+								value);
+					}
 				}
+				gensvm_stream_release(data, blk_start, blk_end);
 			}
 		}
 		for (j=0; j<to_model->m+1; j++) {
 			cmin = (fabs(col_min[j]) < 1e-10) ? -1 : col_min[j];
 			cmax = (fabs(col_max[j]) < 1e-10) ? 1 : col_max[j];
 			for (k=0; k<to_model->K-1; k++) {
-				rnd = ((double) rand()) / ((double) RAND_MAX);
+				rnd = gensvm_context_uniform(ctx);
 				value = 1.0/cmin + (1.0/cmax - 1.0/cmin)*rnd;
 				matrix_set(to_model->V, to_model->K-1, j, k, value);
 			}
 		}
-		free(col_min);
-		free(col_max);
+		Free(col_min);
+		Free(col_max);
 	} else {
 		for (i=0; i<to_model->m+1; i++) {
 			for (j=0; j<to_model->K-1; j++) {
@@ -174,5 +197,5 @@ void gensvm_initialize_weights(struct GenData *data, struct GenModel *model)
 		exit(EXIT_FAILURE);
 		// LCOV_EXCL_STOP
 	}
-	free(groups);
+	Free(groups);
 }
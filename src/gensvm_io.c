@@ -31,6 +31,334 @@
 
 #include "gensvm_io.h"
 
+/**
+ * @brief Add an instance to a GenLibSVMChunk
+ *
+ * @param[in,out] 	chunk 	a GenLibSVMChunk, of which the arrays grow
+ * 				geometrically
+ * @param[in] 		label 	label of the instance, or 0
+ */
+static void gensvm_chunk_add_row(struct GenLibSVMChunk *chunk, long label)
+{
+	if (chunk->rows == chunk->size_rows) {
+		chunk->size_rows = maximum(1024, 2*chunk->size_rows);
+		chunk->y = Realloc(chunk->y, long, chunk->size_rows);
+		chunk->row_nnz = Realloc(chunk->row_nnz, long,
+				chunk->size_rows);
+	}
+	chunk->y[chunk->rows] = label;
+	chunk->row_nnz[chunk->rows] = 0;
+	chunk->rows++;
+}
+
+/**
+ * @brief Add an index:value pair to the last instance of a GenLibSVMChunk
+ *
+ * @param[in,out] 	chunk 	a GenLibSVMChunk, of which the arrays grow
+ * 				geometrically
+ * @param[in] 		index 	index of the feature
+ * @param[in] 		value 	value of the feature
+ */
+static void gensvm_chunk_add_value(struct GenLibSVMChunk *chunk, long index,
+		double value)
+{
+	if (chunk->nnz == chunk->size_nnz) {
+		chunk->size_nnz = maximum(1024, 2*chunk->size_nnz);
+		chunk->ja = Realloc(chunk->ja, long, chunk->size_nnz);
+		chunk->values = Realloc(chunk->values, double,
+				chunk->size_nnz);
+	}
+	chunk->ja[chunk->nnz] = index;
+	chunk->values[chunk->nnz] = value;
+	chunk->nnz++;
+	chunk->row_nnz[chunk->rows-1]++;
+	chunk->min_index = minimum(chunk->min_index, index);
+	chunk->max_index = maximum(chunk->max_index, index);
+}
+
+/**
+ * @brief Count the instances in a chunk of a data file
+ *
+ * @details
+ * Every line with a character other than whitespace is an instance. This is
+ * the first pass of gensvm_read_data(), which is needed to know where the
+ * instances of every chunk are stored in the data matrix.
+ *
+ * @param[in,out] 	arg 	pointer to a GenReadChunk, of which
+ * 				GenReadChunk::rows is set
+ * @returns 		NULL
+ */
+void *gensvm_read_count_rows(void *arg)
+{
+	struct GenReadChunk *chunk = arg;
+	const char *p = chunk->start;
+
+	chunk->rows = 0;
+	while (p < chunk->end) {
+		p = gensvm_skip_blank(p, chunk->end);
+		if (p < chunk->end && *p != '\n')
+			chunk->rows++;
+		p = gensvm_next_line(p, chunk->end);
+	}
+	return NULL;
+}
+
+/**
+ * @brief Parse the instances in a chunk of a data file
+ *
+ * @details
+ * This is the second pass of gensvm_read_data(). The instances of the chunk
+ * are parsed into rows GenReadChunk::first and onwards of GenReadChunk::RAW,
+ * and the labels into GenReadChunk::y. If GenReadChunk::RAW is NULL, the
+ * nonzero features and the labels are added to GenReadChunk::csr instead,
+ * and GenReadChunk::y only indicates whether the file has labels.
+ * Instances beyond the number given in the header of the file are ignored.
+ * Every line must contain exactly the right number of values.
+ *
+ * @param[in,out] 	arg 	pointer to a GenReadChunk
+ * @returns 		NULL
+ */
+void *gensvm_read_chunk(void *arg)
+{
+	long i, j, label;
+	double value;
+	struct GenReadChunk *chunk = arg;
+	const char *p = chunk->start;
+	long m = chunk->m;
+
+	chunk->K = 0;
+	i = chunk->first;
+	while (p < chunk->end && i < chunk->n) {
+		p = gensvm_skip_blank(p, chunk->end);
+		if (p == chunk->end || *p == '\n') {
+			p = gensvm_next_line(p, chunk->end);
+			continue;
+		}
+		if (chunk->csr != NULL)
+			gensvm_chunk_add_row(chunk->csr, 0);
+		for (j=1; j<m+1; j++) {
+			if (!gensvm_parse_double(&p, chunk->end, &value)) {
+				// LCOV_EXCL_START
+				err("[GenSVM Error]: not enough data found "
+						"for instance %li in %s\n",
+						i+1, chunk->filename);
+				exit(EXIT_FAILURE);
+				// LCOV_EXCL_STOP
+			}
+			if (chunk->csr == NULL)
+				matrix_set(chunk->RAW, m+1, i, j, value);
+			else if (value != 0)
+				gensvm_chunk_add_value(chunk->csr, j, value);
+		}
+		if (chunk->y != NULL) {
+			if (!gensvm_parse_double(&p, chunk->end, &value)) {
+				// LCOV_EXCL_START
+				err("[GenSVM Error]: No label found for "
+						"instance %li in %s\n", i+1,
+						chunk->filename);
+				exit(EXIT_FAILURE);
+				// LCOV_EXCL_STOP
+			}
+			label = (long) value;
+			if (chunk->csr == NULL)
+				chunk->y[i] = label;
+			else
+				chunk->csr->y[chunk->csr->rows-1] = label;
+			chunk->K = maximum(chunk->K, label);
+		}
+		p = gensvm_skip_blank(p, chunk->end);
+		if (p < chunk->end && *p != '\n') {
+			// LCOV_EXCL_START
+			err("[GenSVM Error]: Too many values for instance %li "
+					"in %s\n", i+1, chunk->filename);
+			exit(EXIT_FAILURE);
+			// LCOV_EXCL_STOP
+		}
+		p = gensvm_next_line(p, chunk->end);
+		i++;
+	}
+	return NULL;
+}
+
+/**
+ * @brief Run a function on all chunks of a data file in parallel
+ *
+ * @param[in,out] 	chunks 		array of chunks
+ * @param[in] 		size 		size of a single chunk in bytes
+ * @param[in] 		n_chunks 	number of chunks
+ * @param[in] 		func 		function to run on every chunk
+ */
+static void gensvm_read_run(void *chunks, size_t size, long n_chunks,
+		void *(*func)(void *))
+{
+	long t;
+	char *chunk = chunks;
+	pthread_t *threads = NULL;
+
+	if (n_chunks == 1) {
+		func(chunk);
+		return;
+	}
+
+	threads = Malloc(pthread_t, n_chunks);
+	for (t=0; t<n_chunks; t++) {
+		if (pthread_create(&threads[t], NULL, func,
+					chunk + t*size) != 0) {
+			// LCOV_EXCL_START
+			err("[GenSVM Error]: Couldn't create thread\n");
+			exit(EXIT_FAILURE);
+			// LCOV_EXCL_STOP
+		}
+	}
+	for (t=0; t<n_chunks; t++)
+		pthread_join(threads[t], NULL);
+	Free(threads);
+}
+
+/**
+ * @brief Split a data file into chunks that start at a line
+ *
+ * @details
+ * The data is split in chunks of at least #GENSVM_READ_CHUNK_SIZE bytes,
+ * with at most one chunk per processor. Every chunk ends after a newline,
+ * such that no line is split over two chunks.
+ *
+ * @param[in] 	p 		start of the data, at the start of a line
+ * @param[in] 	end 		end of the data
+ * @param[out] 	n_chunks 	number of chunks
+ * @returns 			array of length n_chunks + 1 with the
+ * 				boundaries of the chunks
+ */
+static const char **gensvm_read_split(const char *p, const char *end,
+		long *n_chunks)
+{
+	long i, n = gensvm_context_threads(NULL,
+			1 + (end - p) / GENSVM_READ_CHUNK_SIZE);
+	const char *q = NULL;
+	const char **bounds = Malloc(const char *, n+1);
+
+	bounds[0] = p;
+	for (i=1; i<n; i++) {
+		q = p + i * ((end - p) / n);
+		bounds[i] = gensvm_next_line(maximum(q, bounds[i-1]), end);
+	}
+	bounds[n] = end;
+
+	*n_chunks = n;
+	return bounds;
+}
+
+/**
+ * @brief Store the parsed chunks of a data file in a dataset
+ *
+ * @details
+ * The instances in the arrays of the chunks are copied in parallel to the
+ * dataset with gensvm_read_libsvm_copy(). A sparse matrix is used if this
+ * saves memory according to gensvm_nnz_comparison(), and a dense matrix
+ * otherwise. The arrays of the chunks and the chunks themselves are freed.
+ *
+ * @param[in,out] 	data 		GenData with GenData::n and GenData::m
+ * 					set, and GenData::y allocated if the
+ * 					file has labels
+ * @param[in] 		chunks 		parsed chunks
+ * @param[in] 		n_chunks 	number of chunks
+ */
+static void gensvm_read_store_chunks(struct GenData *data,
+		struct GenLibSVMChunk *chunks, long n_chunks)
+{
+	long i, n = data->n,
+	     m = data->m,
+	     nnz = 0;
+
+	// the offsets include the column of ones
+	for (i=0; i<n_chunks; i++) {
+		chunks[i].data = data;
+		chunks[i].first = (i == 0) ? 0 :
+			chunks[i-1].first + chunks[i-1].rows;
+		chunks[i].offset = nnz + chunks[i].first;
+		nnz += chunks[i].nnz;
+	}
+	nnz += n;
+
+	if (gensvm_nnz_comparison(nnz, n, m+1)) {
+		data->spZ = gensvm_init_sparse();
+		data->spZ->nnz = nnz;
+		data->spZ->n_row = n;
+		data->spZ->n_col = m+1;
+		data->spZ->values = Malloc(double, nnz);
+		data->spZ->ia = Malloc(long, n+1);
+		data->spZ->ja = Malloc(long, nnz);
+		data->spZ->ia[0] = 0;
+	} else {
+		data->RAW = AlignedCalloc(double, n*(m+1));
+		data->Z = data->RAW;
+	}
+
+	gensvm_read_run(chunks, sizeof(struct GenLibSVMChunk), n_chunks,
+			gensvm_read_libsvm_copy);
+
+	for (i=0; i<n_chunks; i++) {
+		Free(chunks[i].y);
+		Free(chunks[i].row_nnz);
+		Free(chunks[i].ja);
+		Free(chunks[i].values);
+	}
+	Free(chunks);
+}
+
+/**
+ * @brief Estimate the fraction of nonzero features in a data file
+ *
+ * @details
+ * In total about #GENSVM_READ_SAMPLE_LINES lines are read, in 32 blocks of
+ * consecutive lines that are spread evenly over the file. Lines that can not
+ * be parsed are skipped, since errors are reported when the file is read.
+ *
+ * @param[in] 	p 	start of the data, at the start of a line
+ * @param[in] 	end 	end of the data
+ * @param[in] 	m 	number of features
+ * @returns 		estimated fraction of nonzero features
+ */
+static double gensvm_read_sample_density(const char *p, const char *end,
+		long m)
+{
+	long b, l, j, nonzero = 0,
+	     total = 0;
+	double value;
+	const char *q = NULL;
+
+	for (b=0; b<32; b++) {
+		q = p + b * ((end - p) / 32);
+		if (b > 0)
+			q = gensvm_next_line(q, end);
+		for (l=0; l<GENSVM_READ_SAMPLE_LINES/32 && q < end; l++) {
+			for (j=0; j<m; j++) {
+				if (!gensvm_parse_double(&q, end, &value))
+					break;
+				nonzero += (value != 0);
+			}
+			total += j;
+			q = gensvm_next_line(q, end);
+		}
+	}
+
+	return (total > 0) ? ((double) nonzero) / total : 1.0;
+}
+
+/**
+ * @brief Skip all whitespace, including newlines
+ *
+ * @param[in] 	p 	current position
+ * @param[in] 	end 	end of the data
+ * @returns 		position of the first character that is not whitespace
+ */
+static const char *gensvm_skip_space(const char *p, const char *end)
+{
+	while (p < end && isspace((unsigned char) *p))
+		p++;
+	return p;
+}
+
 /**
  * @brief Read data from file
  *
@@ -41,71 +369,98 @@
  * The class labels are assumed to be in the interval [1 .. K], which can be
  * checked using the function gensvm_check_outcome_contiguous().
  *
+ * The file is mapped into memory with gensvm_map_file() and the numbers are
+ * parsed with gensvm_parse_double(). Whether the file contains labels is
+ * determined from the number of values on the first line. The rest of the
+ * file is split into line-aligned chunks, see gensvm_read_split(), which are
+ * read in two parallel passes: the instances of every chunk are counted with
+ * gensvm_read_count_rows(), after which every chunk knows its first row in
+ * the data matrix and is parsed with gensvm_read_chunk().
+ *
+ * Before the second pass, the density of the data is estimated from a
+ * sample of the file (see gensvm_read_sample_density()). If the data is
+ * likely to be sparse, the nonzero features are read into the arrays of the
+ * chunks and stored directly in a sparse matrix, such that the memory that
+ * is needed is proportional to the number of nonzeros. Otherwise the
+ * features are read into a dense matrix, which is converted to a sparse
+ * matrix if the sample turns out to be wrong.
+ *
  * @param[in,out] 	dataset 	initialized GenData struct
  * @param[in] 		data_file 	filename of the data file.
  */
 void gensvm_read_data(struct GenData *dataset, char *data_file)
 {
-	FILE *fid = NULL;
-	long i, j, n, m,
-	     nr = 0,
-	     K = 0;
+	long i, j, n = 0,
+	     m = 0,
+	     K = 0,
+	     n_chunks,
+	     total = 0;
 	double value;
-	char buf[GENSVM_MAX_LINE_LENGTH];
-
-	if ((fid = fopen(data_file, "r")) == NULL) {
+	bool has_label = false,
+	     sparse = false;
+	const char *p = NULL,
+	      *end = NULL,
+	      *q = NULL,
+	      **bounds = NULL;
+	struct GenFileMap *map = NULL;
+	struct GenReadChunk *chunks = NULL;
+	struct GenLibSVMChunk *csr = NULL;
+
+	if ((map = gensvm_map_file(data_file, false)) == NULL) {
 		// LCOV_EXCL_START
 		err("[GenSVM Error]: Datafile %s could not be opened.\n",
 				data_file);
 		exit(EXIT_FAILURE);
 		// LCOV_EXCL_STOP
 	}
+	p = map->data;
+	end = map->data + map->size;
 
 	// Read data dimensions
-	nr += fscanf(fid, "%ld", &n);
-	nr += fscanf(fid, "%ld", &m);
-
-	// Allocate memory
-	dataset->RAW = Malloc(double, n*(m+1));
-
-	// Read first line of data
-	for (j=1; j<m+1; j++) {
-		nr += fscanf(fid, "%lf", &value);
-		matrix_set(dataset->RAW, m+1, 0, j, value);
+	p = gensvm_skip_space(p, end);
+	if (!gensvm_parse_long(&p, end, &n) ||
+			!gensvm_parse_long((p = gensvm_skip_space(p, end), &p),
+				end, &m) || n < 1 || m < 1) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: not enough data found in %s\n",
+				data_file);
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
 	}
-
-	if (fgets(buf, GENSVM_MAX_LINE_LENGTH, fid) == NULL) {
+	p = gensvm_skip_space(gensvm_next_line(p, end), end);
+
+	// Check if there is a label at the end of the first line
+	q = p;
+	for (j=0; j<m+1; j++)
+		if (!gensvm_parse_double(&q, end, &value))
+			break;
+	if (j < m) {
 		// LCOV_EXCL_START
-		err("[GenSVM Error]: No label found on first line.\n");
+		err("[GenSVM Error]: not enough data found in %s\n",
+				data_file);
 		exit(EXIT_FAILURE);
 		// LCOV_EXCL_STOP
 	}
-
-	// Check if there is a label at the end of the line
-	if (sscanf(buf, "%lf", &value) > 0) {
-		dataset->y = Malloc(long, n);
-		dataset->y[0] = value;
-		K = 1;
-	} else {
-		free(dataset->y);
-		dataset->y = NULL;
+	has_label = (j == m+1);
+
+	// Split the data into chunks that start at a line
+	bounds = gensvm_read_split(p, end, &n_chunks);
+	chunks = Malloc(struct GenReadChunk, n_chunks);
+	for (i=0; i<n_chunks; i++) {
+		chunks[i].filename = data_file;
+		chunks[i].start = bounds[i];
+		chunks[i].end = bounds[i+1];
 	}
-
-	// Read the rest of the file
-	for (i=1; i<n; i++) {
-		for (j=1; j<m+1; j++) {
-			nr += fscanf(fid, "%lf", &value);
-			matrix_set(dataset->RAW, m+1, i, j, value);
-		}
-		if (dataset->y != NULL) {
-			nr += fscanf(fid, "%lf", &value);
-			dataset->y[i] = (long) value;
-			K = maximum(K, dataset->y[i]);
-		}
+	Free(bounds);
+
+	// Count the instances of every chunk
+	gensvm_read_run(chunks, sizeof(struct GenReadChunk), n_chunks,
+			gensvm_read_count_rows);
+	for (i=0; i<n_chunks; i++) {
+		chunks[i].first = total;
+		total += chunks[i].rows;
 	}
-	fclose(fid);
-
-	if (nr < n * m) {
+	if (total < n) {
 		// LCOV_EXCL_START
 		err("[GenSVM Error]: not enough data found in %s\n",
 				data_file);
@@ -113,21 +468,59 @@ void gensvm_read_data(struct GenData *dataset, char *data_file)
 		// LCOV_EXCL_STOP
 	}
 
-	// Set the column of ones
-	for (i=0; i<n; i++)
-		matrix_set(dataset->RAW, m+1, i, 0, 1.0);
+	// Choose the storage format based on a sample of the data
+	sparse = gensvm_nnz_comparison(
+			gensvm_read_sample_density(p, end, m) * n * m + n,
+			n, m+1);
+
+	// Allocate memory
+	Free(dataset->y);
+	dataset->y = has_label ? Malloc(long, n) : NULL;
+	if (sparse) {
+		csr = Calloc(struct GenLibSVMChunk, n_chunks);
+		for (i=0; i<n_chunks; i++)
+			csr[i].min_index = 1;
+	} else {
+		dataset->RAW = AlignedMalloc(double, n*(m+1));
+	}
+
+	// Read the instances of every chunk
+	for (i=0; i<n_chunks; i++) {
+		chunks[i].n = n;
+		chunks[i].m = m;
+		chunks[i].RAW = dataset->RAW;
+		chunks[i].y = dataset->y;
+		chunks[i].csr = sparse ? &csr[i] : NULL;
+	}
+	gensvm_read_run(chunks, sizeof(struct GenReadChunk), n_chunks,
+			gensvm_read_chunk);
+	for (i=0; i<n_chunks; i++)
+		K = maximum(K, chunks[i].K);
+
+	Free(chunks);
+	gensvm_unmap_file(map);
 
 	dataset->n = n;
 	dataset->m = m;
 	dataset->r = m;
 	dataset->K = K;
+
+	if (sparse) {
+		gensvm_read_store_chunks(dataset, csr, n_chunks);
+		return;
+	}
+
+	// Set the column of ones
+	for (i=0; i<n; i++)
+		matrix_set(dataset->RAW, m+1, i, 0, 1.0);
 	dataset->Z = dataset->RAW;
 
+	// The sample can overestimate the density
 	if (gensvm_could_sparse(dataset->Z, n, m+1)) {
 		note("Converting to sparse ... ");
 		dataset->spZ = gensvm_dense_to_sparse(dataset->Z, n, m+1);
 		note("done.\n");
-		free(dataset->RAW);
+		Free(dataset->RAW);
 		dataset->RAW = NULL;
 		dataset->Z = NULL;
 	}
@@ -145,6 +538,130 @@ void exit_input_error(int line_num)
 	exit(EXIT_FAILURE);
 }
 
+/**
+ * @brief Parse the lines in a chunk of a LibSVM data file
+ *
+ * @details
+ * This is the first pass of gensvm_read_data_libsvm(). The instances in the
+ * chunk are parsed into the arrays of the chunk, which grow geometrically.
+ * The first token of a line is a label if it doesn't contain a colon. Other
+ * tokens without a colon are ignored, as are blank lines. If a line can not
+ * be parsed, GenLibSVMChunk::error is set and the function returns, such that
+ * the line number can be reported once all chunks are done.
+ *
+ * @param[in,out] 	arg 	pointer to a GenLibSVMChunk
+ * @returns 		NULL
+ */
+void *gensvm_read_libsvm_chunk(void *arg)
+{
+	bool first;
+	long index, label;
+	double value;
+	struct GenLibSVMChunk *chunk = arg;
+	const char *p = chunk->start,
+	      *end = chunk->end,
+	      *stop = NULL,
+	      *colon = NULL,
+	      *q = NULL;
+
+	while (p < end) {
+		chunk->lines++;
+		p = gensvm_skip_blank(p, end);
+		if (p == end || *p == '\n') {
+			p = gensvm_next_line(p, end);
+			continue;
+		}
+
+		gensvm_chunk_add_row(chunk, 0);
+
+		first = true;
+		while (p < end && *p != '\n') {
+			colon = NULL;
+			for (stop=p; stop < end &&
+					!isspace((unsigned char) *stop); stop++)
+				if (*stop == ':' && colon == NULL)
+					colon = stop;
+
+			if (colon != NULL) {
+				q = p;
+				if (!gensvm_parse_long(&q, colon, &index) ||
+						index < 0)
+					goto error;
+				q = colon + 1;
+				if (!gensvm_parse_double(&q, stop, &value))
+					goto error;
+				gensvm_chunk_add_value(chunk, index, value);
+			} else if (first) {
+				q = p;
+				if (!gensvm_parse_long(&q, stop, &label))
+					goto error;
+				chunk->y[chunk->rows-1] = label;
+				chunk->num_labels++;
+				chunk->K = maximum(chunk->K, label);
+			}
+			first = false;
+			p = gensvm_skip_blank(stop, end);
+		}
+		p = gensvm_next_line(p, end);
+	}
+	return NULL;
+
+error:
+	chunk->error = true;
+	return NULL;
+}
+
+/**
+ * @brief Copy a parsed chunk of a LibSVM data file to the dataset
+ *
+ * @details
+ * This is the second pass of gensvm_read_data_libsvm(). The instances of the
+ * chunk are copied to GenLibSVMChunk::data, either to the sparse matrix
+ * GenData::spZ or to the dense matrix GenData::RAW, whichever is allocated.
+ * The column of ones is added as well.
+ *
+ * @param[in,out] 	arg 	pointer to a GenLibSVMChunk
+ * @returns 		NULL
+ */
+void *gensvm_read_libsvm_copy(void *arg)
+{
+	long i, j, row, cnt = 0;
+	struct GenLibSVMChunk *chunk = arg;
+	struct GenData *data = chunk->data;
+	struct GenSparse *spZ = data->spZ;
+	long m = data->m;
+	long jj = chunk->offset;
+
+	if (data->y != NULL)
+		memcpy(data->y + chunk->first, chunk->y,
+				chunk->rows*sizeof(long));
+
+	for (i=0; i<chunk->rows; i++) {
+		row = chunk->first + i;
+		if (spZ != NULL) {
+			spZ->values[jj] = 1.0;
+			spZ->ja[jj] = 0;
+			jj++;
+			for (j=0; j<chunk->row_nnz[i]; j++) {
+				spZ->values[jj] = chunk->values[cnt];
+				spZ->ja[jj] = chunk->ja[cnt] + chunk->shift;
+				jj++;
+				cnt++;
+			}
+			spZ->ia[row+1] = jj;
+		} else {
+			matrix_set(data->RAW, m+1, row, 0, 1.0);
+			for (j=0; j<chunk->row_nnz[i]; j++) {
+				matrix_set(data->RAW, m+1, row,
+						chunk->ja[cnt] + chunk->shift,
+						chunk->values[cnt]);
+				cnt++;
+			}
+		}
+	}
+	return NULL;
+}
+
 /**
  * @brief Read data from a file in LibSVM/SVMlight format
  *
@@ -158,10 +675,17 @@ void exit_input_error(int line_num)
  * which are too large for memory when kept in dense format can be loaded
  * efficiently into GenSVM.
  *
+ * The file is mapped into memory and split into line-aligned chunks, which
+ * are parsed in parallel with gensvm_read_libsvm_chunk(). The file is
+ * therefore read only once, there is no limit on the length of a line, and
+ * no memory is allocated for individual tokens. Once the size of the dataset
+ * is known, the chunks are copied to the dataset in parallel with
+ * gensvm_read_store_chunks().
+ *
  * @note
- * This code is based on the read_problem() function in the svm-train.c
- * file of LibSVM. It has however been expanded to be able to handle data 
- * files without labels.
+ * This code was originally based on the read_problem() function in the
+ * svm-train.c file of LibSVM. It has however been expanded to be able to
+ * handle data files without labels.
  *
  * @note
  * This file tries to detect whether 1-based or 0-based indexing is used in 
@@ -177,20 +701,18 @@ void exit_input_error(int line_num)
  */
 void gensvm_read_data_libsvm(struct GenData *data, char *data_file)
 {
-	bool do_sparse, zero_based = false;
-	long i, j, n, m, K, nnz, cnt, tmp, index, row_cnt, num_labels, 
+	long i, n = 0,
+	     m = 0,
+	     K = 0,
+	     lines = 0,
+	     n_chunks,
+	     num_labels = 0,
 	     min_index = 1;
-	int n_big, n_small, big_start;
-	double value;
-	FILE *fid = NULL;
-	char *label = NULL,
-	     *endptr = NULL,
-	     **big_parts = NULL,
-	     **small_parts = NULL;
-	char buf[GENSVM_MAX_LINE_LENGTH];
+	const char **bounds = NULL;
+	struct GenFileMap *map = NULL;
+	struct GenLibSVMChunk *chunks = NULL;
 
-	fid = fopen(data_file, "r");
-	if (fid == NULL) {
+	if ((map = gensvm_map_file(data_file, false)) == NULL) {
 		// LCOV_EXCL_START
 		err("[GenSVM Error]: Datafile %s could not be opened.\n",
 				data_file);
@@ -198,200 +720,595 @@ void gensvm_read_data_libsvm(struct GenData *data, char *data_file)
 		// LCOV_EXCL_STOP
 	}
 
-	// first count the number of elements
-	n = 0;
-	m = -1;
+	// parse the chunks of the file
+	bounds = gensvm_read_split(map->data, map->data + map->size,
+			&n_chunks);
+	chunks = Calloc(struct GenLibSVMChunk, n_chunks);
+	for (i=0; i<n_chunks; i++) {
+		chunks[i].filename = data_file;
+		chunks[i].start = bounds[i];
+		chunks[i].end = bounds[i+1];
+		chunks[i].min_index = 1;
+		chunks[i].data = data;
+	}
+	Free(bounds);
+	gensvm_read_run(chunks, sizeof(struct GenLibSVMChunk), n_chunks,
+			gensvm_read_libsvm_chunk);
+
+	// combine the results of the chunks
+	for (i=0; i<n_chunks; i++) {
+		if (chunks[i].error)
+			exit_input_error(lines + chunks[i].lines);
+		lines += chunks[i].lines;
+		n += chunks[i].rows;
+		num_labels += chunks[i].num_labels;
+		m = maximum(m, chunks[i].max_index);
+		min_index = minimum(min_index, chunks[i].min_index);
+		K = maximum(K, chunks[i].K);
+	}
+	gensvm_unmap_file(map);
+
+	if (n == 0) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: not enough data found in %s\n",
+				data_file);
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
 
-	num_labels = 0;
-	nnz = 0;
+	// check if we have enough labels
+	if (num_labels > 0 && num_labels != n) {
+		err("[GenSVM Error]: There are some lines with missing "
+				"labels. Please fix this before "
+				"continuing.\n");
+		exit(EXIT_FAILURE);
+	}
 
-	while (fgets(buf, GENSVM_MAX_LINE_LENGTH, fid) != NULL) {
-		// split the string in labels and/or index:value pairs
-		big_parts = str_split(buf, " \t", &n_big);
+	// deal with 0-based or 1-based indexing in the LibSVM file
+	if (min_index == 0) {
+		m++;
+		for (i=0; i<n_chunks; i++)
+			chunks[i].shift = 1;
+	}
 
-		// record if this line has a label (first part has no colon)
-		num_labels += (!str_contains_char(big_parts[0], ':'));
+	data->n = n;
+	data->m = m;
+	data->r = m;
+	data->K = K;
+	if (num_labels > 0)
+		data->y = Malloc(long, n);
 
-		// check for each part if it is a index:value pair
-		for (i=0; i<n_big; i++) {
-			if (!str_contains_char(big_parts[i], ':'))
-				continue;
+	// copy the chunks to the dataset
+	gensvm_read_store_chunks(data, chunks, n_chunks);
+}
 
-			// split the index:value pair
-			small_parts = str_split(big_parts[i], ":", &n_small);
+/**
+ * @brief Round a size up to a multiple of #GENSVM_BINARY_ALIGN
+ *
+ * @param[in] 	size 	size in bytes
+ * @returns 		the padded size
+ */
+static size_t gensvm_binary_pad(size_t size)
+{
+	return (size + GENSVM_BINARY_ALIGN - 1) / GENSVM_BINARY_ALIGN *
+		GENSVM_BINARY_ALIGN;
+}
 
-			// convert the index to a number
-			index = strtol(small_parts[0], &endptr, 10);
+/**
+ * @brief Write an array to a binary data file and pad it with zeros
+ *
+ * @param[in] 	fid 	file to write to
+ * @param[in] 	buf 	array to write
+ * @param[in] 	size 	size of the array in bytes
+ */
+static void gensvm_binary_write_array(FILE *fid, const void *buf, size_t size)
+{
+	char zeros[GENSVM_BINARY_ALIGN] = {0};
 
-			// catch conversion errors
-			if (endptr == small_parts[0] || errno != 0 ||
-					*endptr != '\0')
-				exit_input_error(n+1);
+	fwrite(buf, 1, size, fid);
+	fwrite(zeros, 1, gensvm_binary_pad(size) - size, fid);
+}
 
-			// update the maximum index
-			m = maximum(m, index);
+/**
+ * @brief Check if a file starts with a magic string
+ *
+ * @param[in] 	filename 	name of the file
+ * @param[in] 	magic 		magic string of 8 characters
+ * @returns 			whether the file starts with @p magic
+ */
+static bool gensvm_file_has_magic(char *filename, const char *magic)
+{
+	char buffer[8];
+	size_t nr;
+	FILE *fid = fopen(filename, "rb");
 
-			// update the minimum index
-			min_index = minimum(min_index, index);
+	if (fid == NULL)
+		return false;
+	nr = fread(buffer, 1, 8, fid);
+	fclose(fid);
 
-			// free the small parts
-			for (j=0; j<n_small; j++) free(small_parts[j]);
-			free(small_parts);
+	return nr == 8 && memcmp(buffer, magic, 8) == 0;
+}
 
-			// increment the nonzero counter
-			nnz++;
-		}
+/**
+ * @brief Check if a file is a binary data file
+ *
+ * @param[in] 	data_file 	filename of the data file
+ * @returns 			whether the file starts with
+ * 				#GENSVM_BINARY_MAGIC
+ */
+bool gensvm_is_binary_data(char *data_file)
+{
+	return gensvm_file_has_magic(data_file, GENSVM_BINARY_MAGIC);
+}
 
-		// free the big parts
-		for (i=0; i<n_big; i++) {
-			free(big_parts[i]);
-		}
-		free(big_parts);
+/**
+ * @brief Read data from a binary data file
+ *
+ * @details
+ * The binary data file is described in @ref spec_binary_data_file. Such a
+ * file can be written with gensvm_write_data_binary(), for instance with the
+ * gensvm_convert program. The file is mapped into memory and the arrays of
+ * the GenData point directly into the map, such that no data is copied or
+ * parsed and concurrent programs reading the same file share the page cache.
+ * The map is stored in GenData::map and is released by gensvm_free_data().
+ *
+ * @param[in,out] 	dataset 	initialized GenData struct
+ * @param[in] 		data_file 	filename of the binary data file
+ */
+void gensvm_read_data_binary(struct GenData *dataset, char *data_file)
+{
+	long n, m, nnz;
+	size_t size, offset;
+	struct GenBinaryHeader *header = NULL;
+	struct GenFileMap *map = NULL;
 
-		// increment the number of observations
-		n++;
+	if (sizeof(long) != sizeof(int64_t)) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: Binary data files are not supported on "
+				"this platform.\n");
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
+	if ((map = gensvm_map_file(data_file, true)) == NULL) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: Datafile %s could not be opened.\n",
+				data_file);
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
+	header = (struct GenBinaryHeader *) map->data;
+	if (map->size < sizeof(struct GenBinaryHeader) ||
+			memcmp(header->magic, GENSVM_BINARY_MAGIC, 8) != 0) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: %s is not a binary data file.\n",
+				data_file);
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
+	if (header->version != GENSVM_BINARY_VERSION ||
+			header->byte_order != GENSVM_BINARY_BYTE_ORDER) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: Binary data file %s has an unsupported "
+				"version or byte order.\n", data_file);
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
 	}
 
-	// rewind the file pointer
-	rewind(fid);
-
-	// check if we have enough labels
-	if (num_labels > 0 && num_labels != n) {
-		err("[GenSVM Error]: There are some lines with missing "
-				"labels. Please fix this before "
-				"continuing.\n");
+	n = header->n;
+	m = header->m;
+	nnz = header->nnz;
+
+	size = sizeof(struct GenBinaryHeader);
+	if (header->flags & GENSVM_BINARY_LABELS)
+		size += gensvm_binary_pad(n*sizeof(long));
+	if (header->flags & GENSVM_BINARY_SPARSE)
+		size += gensvm_binary_pad((n+1)*sizeof(long)) +
+			gensvm_binary_pad(nnz*sizeof(long)) +
+			gensvm_binary_pad(nnz*sizeof(double));
+	else
+		size += gensvm_binary_pad(n*(m+1)*sizeof(double));
+	if (n < 1 || m < 0 || nnz < 0 || size > map->size) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: Binary data file %s is corrupt.\n",
+				data_file);
 		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
 	}
+	if (map->mapped)
+		madvise(map->data, map->size, MADV_WILLNEED);
 
-	// don't forget the column of ones
-	nnz += n;
+	dataset->n = n;
+	dataset->m = m;
+	dataset->r = m;
+	dataset->K = header->K;
+	dataset->map = map;
 
-	// deal with 0-based or 1-based indexing in the LibSVM file
-	if (min_index == 0) {
-		m++;
-		zero_based = true;
+	offset = sizeof(struct GenBinaryHeader);
+	if (header->flags & GENSVM_BINARY_LABELS) {
+		dataset->y = (long *) (map->data + offset);
+		offset += gensvm_binary_pad(n*sizeof(long));
 	}
-
-	// check if sparsity is worth it
-	do_sparse = gensvm_nnz_comparison(nnz, n, m+1);
-	if (do_sparse) {
-		data->spZ = gensvm_init_sparse();
-		data->spZ->nnz = nnz;
-		data->spZ->n_row = n;
-		data->spZ->n_col = m+1;
-		data->spZ->values = Calloc(double, nnz);
-		data->spZ->ia = Calloc(long, n+1);
-		data->spZ->ja = Calloc(long, nnz);
-		data->spZ->ia[0] = 0;
+	if (header->flags & GENSVM_BINARY_SPARSE) {
+		dataset->spZ = gensvm_init_sparse();
+		dataset->spZ->nnz = nnz;
+		dataset->spZ->n_row = n;
+		dataset->spZ->n_col = m+1;
+		dataset->spZ->ia = (long *) (map->data + offset);
+		offset += gensvm_binary_pad((n+1)*sizeof(long));
+		dataset->spZ->ja = (long *) (map->data + offset);
+		offset += gensvm_binary_pad(nnz*sizeof(long));
+		dataset->spZ->values = (double *) (map->data + offset);
 	} else {
-		data->RAW = Calloc(double, n*(m+1));
-		data->Z = data->RAW;
+		dataset->RAW = (double *) (map->data + offset);
+		dataset->Z = dataset->RAW;
 	}
-	if (num_labels > 0)
-		data->y = Calloc(long, n);
+}
 
-	K = 0;
-	cnt = 0;
-	for (i=0; i<n; i++) {
-		fgets(buf, GENSVM_MAX_LINE_LENGTH, fid);
+/**
+ * @brief Write data to a binary data file
+ *
+ * @details
+ * The labels and the augmented data matrix of the dataset are written to a
+ * binary data file, which can be read with gensvm_read_data_binary(). The
+ * data matrix is written in sparse format if GenData::spZ is used, and in
+ * dense format otherwise. See @ref spec_binary_data_file for the format.
+ *
+ * @param[in] 	dataset 	GenData with the data to write
+ * @param[in] 	data_file 	filename of the binary data file
+ */
+void gensvm_write_data_binary(struct GenData *dataset, char *data_file)
+{
+	long n = dataset->n;
+	long m = dataset->m;
+	FILE *fid = NULL;
+	struct GenBinaryHeader header;
 
-		// split the string in labels and/or index:value pairs
-		big_parts = str_split(buf, " \t", &n_big);
+	if (dataset->spZ == NULL && dataset->RAW == NULL) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: No data to write to %s\n", data_file);
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
 
-		big_start = 0;
-		// get the label from the first part if it exists
-		if (!str_contains_char(big_parts[0], ':')) {
-			label = strtok(big_parts[0], " \t\n");
-			if (label == NULL) // empty line
-				exit_input_error(i+1);
+	memset(&header, 0, sizeof(struct GenBinaryHeader));
+	memcpy(header.magic, GENSVM_BINARY_MAGIC, 8);
+	header.version = GENSVM_BINARY_VERSION;
+	header.byte_order = GENSVM_BINARY_BYTE_ORDER;
+	header.flags = (dataset->y != NULL ? GENSVM_BINARY_LABELS : 0) |
+		(dataset->spZ != NULL ? GENSVM_BINARY_SPARSE : 0);
+	header.n = n;
+	header.m = m;
+	header.K = dataset->K;
+	header.nnz = (dataset->spZ != NULL) ? dataset->spZ->nnz : 0;
+
+	fid = fopen(data_file, "wb");
+	if (fid == NULL) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: Error opening output file %s\n",
+				data_file);
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
 
-			// convert the label part to a number exit if there
-			// are errors
-			tmp = strtol(label, &endptr, 10);
-			if (endptr == label || *endptr != '\0')
-				exit_input_error(i+1);
+	fwrite(&header, sizeof(struct GenBinaryHeader), 1, fid);
+	if (dataset->y != NULL)
+		gensvm_binary_write_array(fid, dataset->y, n*sizeof(long));
+	if (dataset->spZ != NULL) {
+		gensvm_binary_write_array(fid, dataset->spZ->ia,
+				(n+1)*sizeof(long));
+		gensvm_binary_write_array(fid, dataset->spZ->ja,
+				dataset->spZ->nnz*sizeof(long));
+		gensvm_binary_write_array(fid, dataset->spZ->values,
+				dataset->spZ->nnz*sizeof(double));
+	} else {
+		gensvm_binary_write_array(fid, dataset->RAW,
+				n*(m+1)*sizeof(double));
+	}
 
-			// assign label to y
-			data->y[i] = tmp;
+	if (ferror(fid) || fclose(fid) != 0) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: Error writing to file %s\n", data_file);
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
+}
 
-			// keep track of maximum K
-			K = maximum(K, data->y[i]);
+/**
+ * @brief Read data from a file in any of the supported formats
+ *
+ * @details
+ * Binary data files are recognized automatically and read with
+ * gensvm_read_data_binary(). Other files are read with
+ * gensvm_read_data_libsvm() or gensvm_read_data(), depending on
+ * @p libsvm_format.
+ *
+ * @param[in,out] 	dataset 	initialized GenData struct
+ * @param[in] 		data_file 	filename of the data file
+ * @param[in] 		libsvm_format 	whether a text file is in LibSVM
+ * 					format
+ */
+void gensvm_load_data(struct GenData *dataset, char *data_file,
+		bool libsvm_format)
+{
+	if (gensvm_is_binary_data(data_file))
+		gensvm_read_data_binary(dataset, data_file);
+	else if (libsvm_format)
+		gensvm_read_data_libsvm(dataset, data_file);
+	else
+		gensvm_read_data(dataset, data_file);
+}
 
-			// increment big part index
-			big_start++;
-		}
+/**
+ * @brief Read the next line of a data stream that isn't blank
+ *
+ * @param[in,out] 	stream 	the data stream
+ * @param[out] 		start 	start of the line, after leading blanks
+ * @param[out] 		end 	end of the line
+ * @returns 			whether a line was read
+ */
+static bool gensvm_data_stream_line(struct GenDataStream *stream,
+		const char **start, const char **end)
+{
+	ssize_t len;
+
+	while ((len = getline(&stream->line, &stream->line_size,
+					stream->fid)) >= 0) {
+		stream->line_nr++;
+		*end = stream->line + len;
+		*start = gensvm_skip_blank(stream->line, *end);
+		if (*start < *end && **start != '\n')
+			return true;
+	}
+	return false;
+}
 
-		row_cnt = 0;
-		// set the first element in the row to 1
-		if (do_sparse) {
-			data->spZ->values[cnt] = 1.0;
-			data->spZ->ja[cnt] = 0;
-			cnt++;
-			row_cnt++;
-		} else {
-			matrix_set(data->RAW, m+1, i, 0, 1.0);
-		}
+/**
+ * @brief Check that only blanks are left on a line
+ *
+ * @param[in] 	p 	current position
+ * @param[in] 	end 	end of the line
+ * @returns 		whether the rest of the line is blank
+ */
+static bool gensvm_line_done(const char *p, const char *end)
+{
+	p = gensvm_skip_blank(p, end);
+	return p == end || *p == '\n';
+}
 
-		// read the rest of the line
-		for (j=big_start; j<n_big; j++) {
-			if (!str_contains_char(big_parts[j], ':'))
-				continue;
-
-			// split the index:value pair
-			small_parts = str_split(big_parts[j], ":", &n_small);
-			if (n_small != 2)
-				exit_input_error(n+1);
-
-			// convert the index to a long
-			errno = 0;
-			index = strtol(small_parts[0], &endptr, 10);
-
-			// catch conversion errors
-			if (endptr == small_parts[0] || errno != 0 ||
-					*endptr != '\0')
-				exit_input_error(n+1);
-
-			// convert the value to a double
-			errno = 0;
-			value = strtod(small_parts[1], &endptr);
-			if (endptr == small_parts[1] || errno != 0 ||
-					(*endptr != '\0' && !isspace(*endptr)))
-				exit_input_error(n+1);
-
-			if (do_sparse) {
-				data->spZ->values[cnt] = value;
-				data->spZ->ja[cnt] = index + zero_based;
-				cnt++;
-				row_cnt++;
-			} else {
-				matrix_set(data->RAW, m+1, i, 
-						index + zero_based, value);
-			}
+/**
+ * @brief Open a data file for reading in blocks
+ *
+ * @details
+ * The file is expected in the default format (see @ref spec_data_file) or in
+ * LibSVM/SVMlight format (see @ref spec_libsvm_data_file). The filename "-"
+ * denotes the standard input. For the default format the number of instances
+ * and features are read from the start of the file. LibSVM/SVMlight files
+ * have no such header, so the number of features must be given and the
+ * indices must be one-based, as the full file can't be scanned in advance.
+ *
+ * @param[in] 	data_file 	filename of the data file, or "-"
+ * @param[in] 	libsvm_format 	whether the file is in LibSVM/SVMlight format
+ * @param[in] 	m 		number of features of a LibSVM/SVMlight file
+ * @returns 			the data stream, to be closed with
+ * 				gensvm_close_data_stream()
+ */
+struct GenDataStream *gensvm_open_data_stream(char *data_file,
+		bool libsvm_format, long m)
+{
+	const char *p = NULL,
+	      *end = NULL;
+	struct GenDataStream *stream = Malloc(struct GenDataStream, 1);
 
-			// free the small parts
-			free(small_parts[0]);
-			free(small_parts[1]);
-			free(small_parts);
+	stream->fid = (strcmp(data_file, "-") == 0) ? stdin :
+		fopen(data_file, "r");
+	if (stream->fid == NULL) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: Datafile %s could not be opened.\n",
+				data_file);
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
+	stream->filename = data_file;
+	stream->libsvm_format = libsvm_format;
+	stream->n = -1;
+	stream->m = m;
+	stream->rows = 0;
+	stream->line_nr = 0;
+	stream->labels = -1;
+	stream->line = NULL;
+	stream->line_size = 0;
+
+	if (!libsvm_format) {
+		if (!gensvm_data_stream_line(stream, &p, &end) ||
+				!gensvm_parse_long(&p, end, &stream->n) ||
+				!gensvm_data_stream_line(stream, &p, &end) ||
+				!gensvm_parse_long(&p, end, &stream->m) ||
+				stream->n < 0 || stream->m < 1) {
+			// LCOV_EXCL_START
+			err("[GenSVM Error]: Couldn't read the number of "
+					"instances and features from %s.\n",
+					data_file);
+			exit(EXIT_FAILURE);
+			// LCOV_EXCL_STOP
 		}
+	}
+	return stream;
+}
 
-		if (do_sparse) {
-			data->spZ->ia[i+1] = data->spZ->ia[i] + row_cnt;
+/**
+ * @brief Read the next block of instances from a data stream
+ *
+ * @details
+ * Instances are read until about #GENSVM_READ_CHUNK_SIZE bytes of the file
+ * are read, or until the end of the file. The block is stored in an
+ * initialized GenData, with the data matrix in GenData::RAW for the default
+ * format and in GenData::spZ for LibSVM/SVMlight files. GenData::y is set if
+ * the instances have labels. The caller should free the block with
+ * gensvm_free_data() before reading the next one.
+ *
+ * @param[in,out] 	stream 	the data stream
+ * @param[in,out] 	block 	initialized GenData for the instances
+ * @returns 			the number of instances read, zero at the end
+ * 				of the file
+ */
+long gensvm_read_data_stream(struct GenDataStream *stream,
+		struct GenData *block)
+{
+	long j, index, label, rows = 0, cap = 0, nnz = 0, nnz_cap = 0;
+	long m = stream->m;
+	size_t bytes = 0;
+	bool labeled;
+	char *q = NULL;
+	const char *p = NULL,
+	      *end = NULL;
+	long *y = NULL,
+	     *ia = NULL,
+	     *ja = NULL;
+	double value,
+	       *RAW = NULL,
+	       *values = NULL;
+
+	while (bytes < GENSVM_READ_CHUNK_SIZE) {
+		if (stream->n >= 0 && stream->rows + rows >= stream->n)
+			break;
+		if (!gensvm_data_stream_line(stream, &p, &end)) {
+			if (stream->n >= 0) {
+				// LCOV_EXCL_START
+				err("[GenSVM Error]: Datafile %s has fewer "
+						"than %li instances.\n",
+						stream->filename, stream->n);
+				exit(EXIT_FAILURE);
+				// LCOV_EXCL_STOP
+			}
+			break;
+		}
+		bytes += end - stream->line;
+
+		if (rows == cap) {
+			cap = (cap == 0) ? 64 : 2*cap;
+			y = Realloc(y, long, cap);
+			if (stream->libsvm_format)
+				ia = Realloc(ia, long, cap+1);
+			else
+				RAW = Realloc(RAW, double, cap*(m+1));
 		}
 
-		// free the big parts
-		for (j=0; j<n_big; j++) {
-			free(big_parts[j]);
+		if (stream->libsvm_format) {
+			// the label is the first token if it has no colon
+			q = (char *) p;
+			while (q < end && *q != ':' && *q != ' ' &&
+					*q != '\t' && *q != '\n')
+				q++;
+			labeled = (q == end || *q != ':');
+			if (labeled && !gensvm_parse_long(&p, end, &label))
+				goto error;
+
+			ia[rows] = nnz;
+			for (j=0; ; j++) {
+				if (nnz + 1 >= nnz_cap) {
+					nnz_cap = (nnz_cap == 0) ? 1024 :
+						2*nnz_cap;
+					ja = Realloc(ja, long, nnz_cap);
+					values = Realloc(values, double,
+							nnz_cap);
+				}
+				if (j == 0) {
+					// the column of ones
+					ja[nnz] = 0;
+					values[nnz++] = 1.0;
+					continue;
+				}
+				p = gensvm_skip_blank(p, end);
+				if (p == end || *p == '\n')
+					break;
+				index = strtol(p, &q, 10);
+				if (q == p || *q != ':' || index < 1 ||
+						index > m)
+					goto error;
+				p = q + 1;
+				if (!gensvm_parse_double(&p, end, &value))
+					goto error;
+				ja[nnz] = index;
+				values[nnz++] = value;
+			}
+			ia[rows+1] = nnz;
+		} else {
+			RAW[rows*(m+1)] = 1.0;
+			for (j=1; j<m+1; j++) {
+				if (!gensvm_parse_double(&p, end,
+							&RAW[rows*(m+1)+j]))
+					goto error;
+			}
+			labeled = !gensvm_line_done(p, end);
+			if (labeled && !gensvm_parse_long(&p, end, &label))
+				goto error;
+			if (!gensvm_line_done(p, end))
+				goto error;
 		}
-		free(big_parts);
+
+		if (stream->labels < 0)
+			stream->labels = labeled;
+		if (stream->labels != labeled)
+			goto error;
+		if (labeled)
+			y[rows] = label;
+		rows++;
 	}
 
-	fclose(fid);
+	if (rows == 0) {
+		Free(y);
+		Free(ia);
+		Free(ja);
+		Free(values);
+		Free(RAW);
+		return 0;
+	}
 
-	data->n = n;
-	data->m = m;
-	data->r = m;
-	data->K = K;
+	block->n = rows;
+	block->m = m;
+	block->r = m;
+	if (stream->labels) {
+		block->y = y;
+	} else {
+		Free(y);
+	}
+	if (stream->libsvm_format) {
+		block->spZ = gensvm_init_sparse();
+		block->spZ->nnz = nnz;
+		block->spZ->n_row = rows;
+		block->spZ->n_col = m+1;
+		block->spZ->ia = ia;
+		block->spZ->ja = ja;
+		block->spZ->values = values;
+	} else {
+		block->RAW = RAW;
+		block->Z = RAW;
+	}
+	stream->rows += rows;
+	return rows;
 
+error:
+	// LCOV_EXCL_START
+	err("[GenSVM Error]: Couldn't read line %li of datafile %s.\n",
+			stream->line_nr, stream->filename);
+	exit(EXIT_FAILURE);
+	// LCOV_EXCL_STOP
+}
+
+/**
+ * @brief Close a data stream
+ *
+ * @param[in] 	stream 	the data stream to close
+ */
+void gensvm_close_data_stream(struct GenDataStream *stream)
+{
+	if (stream == NULL)
+		return;
+	if (stream->fid != stdin)
+		fclose(stream->fid);
+	Free(stream->line);
+	Free(stream);
 }
 
 /**
@@ -402,6 +1319,8 @@ void gensvm_read_data_libsvm(struct GenData *data, char *data_file)
  * initalized elswhere. The model file is expected to follow the @ref
  * spec_model_file. The easiest way to generate a model file is through
  * gensvm_write_model(), which can for instance be used in trainGenSVM.c.
+ * Binary model files (see @ref spec_binary_model_file) are recognized
+ * automatically and read with gensvm_read_model_binary().
  *
  * @param[in,out] 	model 		initialized GenModel
  * @param[in] 		model_filename 	filename of the model file
@@ -415,6 +1334,11 @@ void gensvm_read_model(struct GenModel *model, char *model_filename)
 	char data_filename[GENSVM_MAX_LINE_LENGTH];
 	double value = 0;
 
+	if (gensvm_is_binary_model(model_filename)) {
+		gensvm_read_model_binary(model, model_filename);
+		return;
+	}
+
 	fid = fopen(model_filename, "r");
 	if (fid == NULL) {
 		// LCOV_EXCL_START
@@ -538,12 +1462,213 @@ void gensvm_write_model(struct GenModel *model, char *output_filename)
 	fclose(fid);
 }
 
+/**
+ * @brief Compute the checksum of a binary model file
+ *
+ * @details
+ * The checksum is the hash (see gensvm_hash_bytes()) of the header with
+ * GenBinaryModelHeader::checksum set to zero, the filename of the training
+ * data, and the matrix V.
+ *
+ * @param[in] 	header 	header of the binary model file
+ * @param[in] 	name 	filename of the training data
+ * @param[in] 	V 	the matrix V
+ * @returns 		the checksum
+ */
+static uint64_t gensvm_binary_model_checksum(
+		struct GenBinaryModelHeader *header, const char *name,
+		const double *V)
+{
+	uint64_t hash;
+	struct GenBinaryModelHeader copy = *header;
+
+	copy.checksum = 0;
+	hash = gensvm_hash_bytes(GENSVM_HASH_INIT, &copy,
+			sizeof(struct GenBinaryModelHeader));
+	hash = gensvm_hash_bytes(hash, name, header->name_length);
+	return gensvm_hash_bytes(hash, V,
+			(header->m+1)*(header->K-1)*sizeof(double));
+}
+
+/**
+ * @brief Check if a file is a binary model file
+ *
+ * @param[in] 	model_filename 	filename of the model file
+ * @returns 			whether the file starts with
+ * 				#GENSVM_BINARY_MODEL_MAGIC
+ */
+bool gensvm_is_binary_model(char *model_filename)
+{
+	return gensvm_file_has_magic(model_filename,
+			GENSVM_BINARY_MODEL_MAGIC);
+}
+
+/**
+ * @brief Read model from a binary model file
+ *
+ * @details
+ * The binary model file is described in @ref spec_binary_model_file. Such a
+ * file can be written with gensvm_write_model_binary(), for instance with
+ * the gensvm_convert program. The file is mapped into memory and
+ * GenModel::V points directly into the map, so the weights are not parsed or
+ * copied. The checksum of the file is verified before the model is used. The
+ * map is stored in GenModel::map and is released by gensvm_free_model().
+ *
+ * @param[in,out] 	model 		initialized GenModel
+ * @param[in] 		model_filename 	filename of the binary model file
+ */
+void gensvm_read_model_binary(struct GenModel *model, char *model_filename)
+{
+	size_t size, name_size;
+	char *name = NULL;
+	double *V = NULL;
+	struct GenBinaryModelHeader *header = NULL;
+	struct GenFileMap *map = NULL;
+
+	if ((map = gensvm_map_file(model_filename, true)) == NULL) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: Couldn't open model file %s\n",
+				model_filename);
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
+	header = (struct GenBinaryModelHeader *) map->data;
+	if (map->size < sizeof(struct GenBinaryModelHeader) ||
+			memcmp(header->magic, GENSVM_BINARY_MODEL_MAGIC,
+				8) != 0) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: %s is not a binary model file.\n",
+				model_filename);
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
+	if (header->version != GENSVM_BINARY_MODEL_VERSION ||
+			header->byte_order != GENSVM_BINARY_BYTE_ORDER) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: Binary model file %s has an unsupported "
+				"version or byte order.\n", model_filename);
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
+
+	name_size = gensvm_binary_pad(header->name_length);
+	size = sizeof(struct GenBinaryModelHeader) + name_size +
+		gensvm_binary_pad((header->m+1)*(header->K-1)*sizeof(double));
+	if (header->m < 0 || header->K < 2 || header->name_length < 0 ||
+			size > map->size) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: Binary model file %s is corrupt.\n",
+				model_filename);
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
+	name = map->data + sizeof(struct GenBinaryModelHeader);
+	V = (double *) (name + name_size);
+	if (gensvm_binary_model_checksum(header, name, V) !=
+			header->checksum) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: Checksum of binary model file %s doesn't "
+				"match.\n", model_filename);
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
+
+	model->weight_idx = header->weight_idx;
+	model->kerneltype = header->kerneltype;
+	model->n = header->n;
+	model->m = header->m;
+	model->K = header->K;
+	model->max_iter = header->max_iter;
+	model->elapsed_iter = header->elapsed_iter;
+	model->seed = header->seed;
+	model->p = header->p;
+	model->lambda = header->lambda;
+	model->kappa = header->kappa;
+	model->epsilon = header->epsilon;
+	model->gamma = header->gamma;
+	model->coef = header->coef;
+	model->degree = header->degree;
+	model->kernel_eigen_cutoff = header->kernel_eigen_cutoff;
+	model->training_error = header->training_error;
+	if (header->temperature > 0)
+		model->temperature = header->temperature;
+
+	model->data_file = Calloc(char, header->name_length+1);
+	memcpy(model->data_file, name, header->name_length);
+
+	model->map = map;
+	model->V = V;
+}
+
+/**
+ * @brief Write model to a binary model file
+ *
+ * @details
+ * The matrix V, the parameters of the model and the filename of the
+ * training data are written to a binary model file, which can be read with
+ * gensvm_read_model_binary(). See @ref spec_binary_model_file for the
+ * format.
+ *
+ * @param[in] 	model 		GenModel which contains an estimate for
+ * 				GenModel::V
+ * @param[in] 	output_filename the output file to write the model to
+ */
+void gensvm_write_model_binary(struct GenModel *model, char *output_filename)
+{
+	FILE *fid = NULL;
+	char *name = (model->data_file != NULL) ? model->data_file : "";
+	struct GenBinaryModelHeader header;
+
+	memset(&header, 0, sizeof(struct GenBinaryModelHeader));
+	memcpy(header.magic, GENSVM_BINARY_MODEL_MAGIC, 8);
+	header.version = GENSVM_BINARY_MODEL_VERSION;
+	header.byte_order = GENSVM_BINARY_BYTE_ORDER;
+	header.weight_idx = model->weight_idx;
+	header.kerneltype = model->kerneltype;
+	header.n = model->n;
+	header.m = model->m;
+	header.K = model->K;
+	header.max_iter = model->max_iter;
+	header.elapsed_iter = model->elapsed_iter;
+	header.seed = model->seed;
+	header.name_length = strlen(name);
+	header.p = model->p;
+	header.lambda = model->lambda;
+	header.kappa = model->kappa;
+	header.epsilon = model->epsilon;
+	header.gamma = model->gamma;
+	header.coef = model->coef;
+	header.degree = model->degree;
+	header.kernel_eigen_cutoff = model->kernel_eigen_cutoff;
+	header.training_error = model->training_error;
+	header.temperature = model->temperature;
+	header.checksum = gensvm_binary_model_checksum(&header, name,
+			model->V);
+
+	fid = fopen(output_filename, "wb");
+	if (fid == NULL) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: Error opening output file %s\n",
+				output_filename);
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
+
+	fwrite(&header, sizeof(struct GenBinaryModelHeader), 1, fid);
+	gensvm_binary_write_array(fid, name, header.name_length);
+	gensvm_binary_write_array(fid, model->V,
+			(model->m+1)*(model->K-1)*sizeof(double));
+
+	fclose(fid);
+}
+
 /**
  * @brief Write predictions to file
  *
  * @details
  * Write the given predictions to an output file, such that the resulting file
- * corresponds to the @ref spec_data_file.
+ * corresponds to the @ref spec_data_file. See
+ * gensvm_write_predictions_format() for other output formats.
  *
  * @param[in] 	data 		GenData with the original instances
  * @param[in] 	predy 		predictions of the class labels of the
@@ -556,7 +1681,119 @@ void gensvm_write_model(struct GenModel *model, char *output_filename)
 void gensvm_write_predictions(struct GenData *data, long *predy,
 		char *output_filename)
 {
-	long i, j;
+	gensvm_write_predictions_format(data, predy, NULL, 0, P_DATA,
+			output_filename);
+}
+
+/**
+ * @brief Make room in the output buffer of the prediction writer
+ *
+ * @details
+ * The buffer is written to the file if there is no room for a number and a
+ * separator after the current position.
+ *
+ * @param[in] 	fid 	file to write to
+ * @param[in] 	buffer 	output buffer of #GENSVM_WRITE_BUFFER_SIZE bytes
+ * @param[in] 	p 	current position in the buffer
+ * @returns 		position in the buffer to continue writing at
+ */
+static char *gensvm_write_reserve(FILE *fid, char *buffer, char *p)
+{
+	if (p - buffer + GENSVM_MAX_DOUBLE_LENGTH + 1 <=
+			GENSVM_WRITE_BUFFER_SIZE)
+		return p;
+	fwrite(buffer, 1, p - buffer, fid);
+	return buffer;
+}
+
+/**
+ * @brief Write the features of an instance to the prediction output
+ *
+ * @details
+ * The raw features are used, such that the output doesn't depend on the
+ * kernel. For sparse data the zeros are written explicitly. The features
+ * are taken from GenData::RAW if available, from GenData::spZ otherwise, and
+ * from GenData::Z as a last resort.
+ *
+ * @param[in] 	fid 	file to write to
+ * @param[in] 	data 	GenData with the instances
+ * @param[in] 	i 	index of the instance
+ * @param[in] 	buffer 	output buffer of #GENSVM_WRITE_BUFFER_SIZE bytes
+ * @param[in] 	p 	current position in the buffer
+ * @returns 		position in the buffer after the features
+ */
+static char *gensvm_write_features(FILE *fid, struct GenData *data, long i,
+		char *buffer, char *p)
+{
+	long j, jj, next;
+	long m = data->m;
+	double *X = (data->RAW != NULL) ? data->RAW : data->Z;
+	struct GenSparse *spZ = data->spZ;
+
+	if (data->RAW == NULL && spZ != NULL) {
+		jj = spZ->ia[i];
+		for (j=1; j<m+1; j++) {
+			while (jj < spZ->ia[i+1] && spZ->ja[jj] < j)
+				jj++;
+			next = (jj < spZ->ia[i+1] && spZ->ja[jj] == j);
+			p = gensvm_write_reserve(fid, buffer, p);
+			p += gensvm_format_double(p, next ? spZ->values[jj] :
+					0.0);
+			*p++ = ' ';
+		}
+		return p;
+	}
+
+	for (j=1; j<m+1; j++) {
+		p = gensvm_write_reserve(fid, buffer, p);
+		p += gensvm_format_double(p, matrix_get(X, m+1, i, j));
+		*p++ = ' ';
+	}
+	return p;
+}
+
+/**
+ * @brief Write predictions to file in a given format
+ *
+ * @details
+ * The predictions are written in one of the following formats:
+ *
+ * - #P_DATA: the @ref spec_data_file, with the instances followed by their
+ *   predicted label. This is the format of gensvm_write_predictions().
+ * - #P_LABELS: the predicted label of every instance on a separate line.
+ * - #P_DECISION: the predicted label of every instance followed by its
+ *   decision values, the K-1 coordinates of the instance in the simplex
+ *   space (see gensvm_calculate_ZV()).
+ * - #P_DISTANCES: the predicted label of every instance followed by the K
+ *   distances of the instance to the simplex vertices of the classes.
+ * - #P_PROBABILITIES: the predicted label of every instance followed by the
+ *   K class probabilities (see gensvm_predict_softmax()).
+ *
+ * The values for the last three formats are computed together with the
+ * labels by gensvm_predict_values().
+ *
+ * Numbers are formatted with gensvm_format_double() and
+ * gensvm_format_long() into a buffer of #GENSVM_WRITE_BUFFER_SIZE bytes,
+ * which is written to the file when it is full. For the #P_DATA format the
+ * raw features of the instances are written, also for sparse data and for
+ * data that is transformed by a kernel. The instances are written with
+ * gensvm_write_predictions_stream().
+ *
+ * @param[in] 	data 		GenData with the instances
+ * @param[in] 	predy 		predicted class labels of the instances
+ * @param[in] 	values 		n x (K-1) matrix of decision values for
+ * 				#P_DECISION, n x K matrix of distances or
+ * 				probabilities for #P_DISTANCES and
+ * 				#P_PROBABILITIES, NULL otherwise
+ * @param[in] 	K 		number of classes, only used for the
+ * 				formats with values
+ * @param[in] 	format 		format of the output file
+ * @param[in] 	output_filename the file to which the predictions are written
+ */
+void gensvm_write_predictions_format(struct GenData *data, long *predy,
+		double *values, long K, PredictionFormat format,
+		char *output_filename)
+{
 	FILE *fid = NULL;
 
 	fid = fopen(output_filename, "w");
@@ -568,17 +1805,69 @@ void gensvm_write_predictions(struct GenData *data, long *predy,
 		// LCOV_EXCL_STOP
 	}
 
-	fprintf(fid, "%li\n", data->n);
-	fprintf(fid, "%li\n", data->m);
+	if (format == P_DATA)
+		fprintf(fid, "%li\n%li\n", data->n, data->m);
+	gensvm_write_predictions_stream(fid, data, predy, values, K, format);
+
+	fclose(fid);
+}
+
+/**
+ * @brief Write predictions to an open file
+ *
+ * @details
+ * This writes a line for every instance in the format given by @p format,
+ * see gensvm_write_predictions_format(). For the #P_DATA format the two
+ * header lines are not written, such that the predictions for a dataset can
+ * be written in several parts.
+ *
+ * @param[in] 	fid 		file to write to
+ * @param[in] 	data 		GenData with the instances
+ * @param[in] 	predy 		predicted class labels of the instances
+ * @param[in] 	values 		values of the format, see
+ * 				gensvm_write_predictions_format()
+ * @param[in] 	K 		number of classes, only used for the
+ * 				formats with values
+ * @param[in] 	format 		format of the output
+ */
+void gensvm_write_predictions_stream(FILE *fid, struct GenData *data,
+		long *predy, double *values, long K, PredictionFormat format)
+{
+	long i, j, width = 0;
+	char *buffer = NULL,
+	     *p = NULL;
+
+	if (format == P_DECISION)
+		width = K-1;
+	else if (format == P_DISTANCES || format == P_PROBABILITIES)
+		width = K;
+
+	if (width > 0 && values == NULL) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: No decision values to write\n");
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
+
+	buffer = Malloc(char, GENSVM_WRITE_BUFFER_SIZE);
+	p = buffer;
 
 	for (i=0; i<data->n; i++) {
-		for (j=0; j<data->m; j++)
-			fprintf(fid, "%.16f ", matrix_get(data->Z, data->m+1, i,
-						j+1));
-		fprintf(fid, "%li\n", predy[i]);
+		if (format == P_DATA)
+			p = gensvm_write_features(fid, data, i, buffer, p);
+		p = gensvm_write_reserve(fid, buffer, p);
+		p += gensvm_format_long(p, predy[i]);
+		for (j=0; j<width; j++) {
+			*p++ = ' ';
+			p = gensvm_write_reserve(fid, buffer, p);
+			p += gensvm_format_double(p,
+					matrix_get(values, width, i, j));
+		}
+		*p++ = '\n';
 	}
+	fwrite(buffer, 1, p - buffer, fid);
 
-	fclose(fid);
+	Free(buffer);
 }
 
 /**
@@ -0,0 +1,395 @@
+/**
+ * @file gensvm_journal.c
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Functions for the persistent journal of the grid search
+ *
+ * @details
+ * A grid search can take a long time, and without a record of the completed
+ * tasks all work is lost when the program is interrupted. The journal
+ * defined here is an append-only text file in which a line is written for
+ * every completed task. Each line is identified by a key, which is a hash of
+ * the dataset, the cross validation split, and the parameters of the task.
+ * When the grid search is restarted with the same journal, tasks that are
+ * found in the journal are not trained again. Since the key does not depend
+ * on the position of the task in the queue, a different grid on the same
+ * dataset and with the same cross validation split can also reuse the
+ * results. See @ref spec_journal_file for the file format.
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "gensvm_journal.h"
+
+#include <inttypes.h>
+#include <unistd.h>
+
+/**
+ * @brief Initialize an empty GenJournal structure
+ *
+ * @details
+ * The journal is not associated with a file. Use gensvm_journal_open() to
+ * create a journal that is backed by a file.
+ *
+ * @returns 	initialized GenJournal
+ */
+struct GenJournal *gensvm_init_journal(void)
+{
+	struct GenJournal *journal = Malloc(struct GenJournal, 1);
+
+	journal->filename = NULL;
+	journal->fid = NULL;
+	journal->N = 0;
+	journal->size = 0;
+	journal->entries = NULL;
+	journal->index_size = GENSVM_JOURNAL_INDEX_SIZE;
+	journal->index = Malloc(long, journal->index_size);
+	memset(journal->index, -1, journal->index_size*sizeof(long));
+	journal->unsynced = 0;
+
+	return journal;
+}
+
+/**
+ * @brief Free a GenJournal structure
+ *
+ * @details
+ * The journal file is synchronized to disk and closed if it is open, and all
+ * memory of the journal is freed. The journal file itself is left on disk.
+ *
+ * @param[in] 	journal 	GenJournal to free
+ */
+void gensvm_free_journal(struct GenJournal *journal)
+{
+	if (journal == NULL)
+		return;
+
+	if (journal->fid != NULL) {
+		gensvm_journal_sync(journal);
+		fclose(journal->fid);
+	}
+	Free(journal->filename);
+	Free(journal->entries);
+	Free(journal->index);
+	Free(journal);
+	journal = NULL;
+}
+
+/**
+ * @brief Find the slot of a key in the hash table of a journal
+ *
+ * @details
+ * The keys are FNV-1a hashes, so the lowest bits of the key are used as the
+ * first slot directly. Collisions are resolved with linear probing.
+ *
+ * @param[in] 	journal 	the GenJournal
+ * @param[in] 	key 		the key to look for
+ * @returns 			slot of the hash table with the position of
+ * 				the key, or the empty slot where it belongs
+ */
+static long gensvm_journal_slot(struct GenJournal *journal, uint64_t key)
+{
+	long i, mask = journal->index_size - 1;
+
+	i = key & mask;
+	while (journal->index[i] >= 0 &&
+			journal->entries[journal->index[i]].key != key)
+		i = (i + 1) & mask;
+	return i;
+}
+
+/**
+ * @brief Double the length of the hash table of a journal
+ *
+ * @param[in,out] 	journal 	the GenJournal
+ */
+static void gensvm_journal_grow_index(struct GenJournal *journal)
+{
+	long i;
+
+	journal->index_size *= 2;
+	journal->index = Realloc(journal->index, long, journal->index_size);
+	memset(journal->index, -1, journal->index_size*sizeof(long));
+	for (i=0; i<journal->N; i++)
+		journal->index[gensvm_journal_slot(journal,
+				journal->entries[i].key)] = i;
+}
+
+/**
+ * @brief Add an entry to the in-memory journal
+ *
+ * @details
+ * The entry is only added to GenJournal::entries, it is not written to the
+ * journal file. If the key already exists, the existing entry is
+ * overwritten. The array of entries grows geometrically, and the position
+ * of a new entry is stored in the hash table GenJournal::index.
+ *
+ * @param[in,out] 	journal 	the GenJournal
+ * @param[in] 		key 		key of the task
+ * @param[in] 		performance 	cross validation performance
+ * @param[in] 		iter 		number of iterations
+ * @param[in] 		duration 	training time in seconds
+ * @param[in] 		temperature 	temperature fitted in cross validation
+ */
+void gensvm_journal_add(struct GenJournal *journal, uint64_t key,
+		double performance, long iter, double duration,
+		double temperature)
+{
+	long slot;
+	struct GenJournalEntry *entry = gensvm_journal_find(journal, key);
+
+	if (entry == NULL) {
+		if (journal->N == journal->size) {
+			journal->size = maximum(16, 2*journal->size);
+			journal->entries = Realloc(journal->entries,
+					struct GenJournalEntry,	journal->size);
+		}
+		if (2*(journal->N + 1) > journal->index_size)
+			gensvm_journal_grow_index(journal);
+		entry = &journal->entries[journal->N];
+		entry->key = key;
+		slot = gensvm_journal_slot(journal, key);
+		journal->index[slot] = journal->N++;
+	}
+
+	entry->key = key;
+	entry->performance = performance;
+	entry->iter = iter;
+	entry->duration = duration;
+	entry->temperature = temperature;
+}
+
+/**
+ * @brief Read all entries of a journal file
+ *
+ * @details
+ * All entries in the journal file are added to the journal with
+ * gensvm_journal_add(). Lines starting with a '#' are comments. Lines that
+ * can not be parsed are skipped. This is intentional: if the program is
+ * killed while writing a line, the last line of the journal may be
+ * incomplete. Such a task is simply trained again. If the file doesn't exist
+ * nothing is read. Journals written before the temperature was added have
+ * four fields per line, for these entries the temperature is 1.0.
+ *
+ * @param[in,out] 	journal 	the GenJournal to add the entries to
+ * @param[in] 		filename 	the journal file to read
+ */
+void gensvm_journal_read(struct GenJournal *journal, char *filename)
+{
+	long iter;
+	double performance, duration, temperature;
+	uint64_t key;
+	char buffer[GENSVM_MAX_LINE_LENGTH];
+	FILE *fid = fopen(filename, "r");
+
+	if (fid == NULL)
+		return;
+
+	while (fgets(buffer, GENSVM_MAX_LINE_LENGTH, fid) != NULL) {
+		if (buffer[0] == '#')
+			continue;
+		if (!str_endswith(buffer, "\n"))
+			continue;
+		temperature = 1.0;
+		if (sscanf(buffer, "%" SCNx64 " %lf %ld %lf %lf", &key,
+					&performance, &iter, &duration,
+					&temperature) < 4)
+			continue;
+		gensvm_journal_add(journal, key, performance, iter, duration,
+				temperature);
+	}
+
+	fclose(fid);
+}
+
+/**
+ * @brief Open a journal file for reading and appending
+ *
+ * @details
+ * The existing entries of the journal file are read with
+ * gensvm_journal_read() and the file is opened for appending. If the file
+ * doesn't exist it is created. If the file doesn't end with a newline (which
+ * can happen if the program was killed while writing to it) a newline is
+ * written first, such that new entries are not appended to an incomplete
+ * line.
+ *
+ * @param[in] 	filename 	the journal file
+ * @return 			the GenJournal with the entries of the file
+ */
+struct GenJournal *gensvm_journal_open(char *filename)
+{
+	int c;
+	struct GenJournal *journal = gensvm_init_journal();
+
+	gensvm_journal_read(journal, filename);
+
+	journal->filename = Malloc(char, strlen(filename)+1);
+	strcpy(journal->filename, filename);
+
+	journal->fid = fopen(filename, "a+");
+	if (journal->fid == NULL) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: Couldn't open journal file %s\n",
+				filename);
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
+
+	fseek(journal->fid, 0, SEEK_END);
+	if (ftell(journal->fid) == 0) {
+		fprintf(journal->fid, "# GenSVM journal (version %s)\n",
+				VERSION_STRING);
+	} else {
+		fseek(journal->fid, -1, SEEK_END);
+		c = fgetc(journal->fid);
+		fseek(journal->fid, 0, SEEK_END);
+		if (c != '\n')
+			fputc('\n', journal->fid);
+	}
+	fflush(journal->fid);
+
+	return journal;
+}
+
+/**
+ * @brief Find a task in the journal
+ *
+ * @details
+ * The key is looked up in the hash table GenJournal::index, so the time
+ * needed doesn't depend on the number of entries.
+ *
+ * @param[in] 	journal 	the GenJournal
+ * @param[in] 	key 		the key of the task
+ * @return 			pointer to the entry with the given key, or NULL
+ * 				if the key is not in the journal
+ */
+struct GenJournalEntry *gensvm_journal_find(struct GenJournal *journal,
+		uint64_t key)
+{
+	long i = journal->index[gensvm_journal_slot(journal, key)];
+
+	return (i < 0) ? NULL : &journal->entries[i];
+}
+
+/**
+ * @brief Add a completed task to the journal and write it to disk
+ *
+ * @details
+ * The entry is added to the journal with gensvm_journal_add() and a line is
+ * appended to the journal file. The file is flushed before this function
+ * returns, such that the entry survives a crash of the program. The
+ * synchronization to disk is batched: the entries are only guaranteed to
+ * survive a crash of the machine after gensvm_journal_sync(), which
+ * gensvm_train_queue() calls after every group of tasks with the same
+ * kernel, and which is also called when the journal is freed.
+ *
+ * @param[in,out] 	journal 	an opened GenJournal
+ * @param[in] 		key 		key of the task
+ * @param[in] 		performance 	cross validation performance
+ * @param[in] 		iter 		number of iterations
+ * @param[in] 		duration 	training time in seconds
+ * @param[in] 		temperature 	temperature fitted in cross validation
+ */
+void gensvm_journal_append(struct GenJournal *journal, uint64_t key,
+		double performance, long iter, double duration,
+		double temperature)
+{
+	gensvm_journal_add(journal, key, performance, iter, duration,
+			temperature);
+
+	if (journal->fid == NULL)
+		return;
+
+	fprintf(journal->fid, "%016" PRIx64 " %.17g %li %.17g %.17g\n", key,
+			performance, iter, duration, temperature);
+	fflush(journal->fid);
+	journal->unsynced++;
+}
+
+/**
+ * @brief Synchronize the appended entries of a journal to disk
+ *
+ * @details
+ * The journal file is synchronized with fsync() if entries were appended
+ * since the last synchronization. Nothing is done for a journal without a
+ * file.
+ *
+ * @param[in,out] 	journal 	the GenJournal
+ */
+void gensvm_journal_sync(struct GenJournal *journal)
+{
+	if (journal == NULL || journal->fid == NULL || journal->unsynced == 0)
+		return;
+	fflush(journal->fid);
+	fsync(fileno(journal->fid));
+	journal->unsynced = 0;
+}
+
+/**
+ * @brief Compute the hash of a dataset and a cross validation split
+ *
+ * @details
+ * This hash is the basis of the keys of the tasks in the journal, see
+ * gensvm_journal_task_key(). It combines the hash of the dataset (see
+ * gensvm_hash_data()) with the fold assignment of every instance.
+ *
+ * @param[in] 	data 	the full training dataset
+ * @param[in] 	cv_idx 	the cross validation split of the dataset
+ * @return 		hash of the dataset and the split
+ */
+uint64_t gensvm_journal_split_hash(struct GenData *data, long *cv_idx)
+{
+	uint64_t hash = gensvm_hash_data(data);
+	return gensvm_hash_bytes(hash, cv_idx, data->n*sizeof(long));
+}
+
+/**
+ * @brief Compute the journal key of a task
+ *
+ * @details
+ * The key of a task is the hash of all parameters of the task which
+ * influence the cross validation performance, continued from the hash of
+ * the dataset and the cross validation split. Note that the task ID is not
+ * part of the key, such that different grids can share results.
+ *
+ * @param[in] 	task 		the GenTask
+ * @param[in] 	split_hash 	result of gensvm_journal_split_hash()
+ * @return 			the key of the task
+ */
+uint64_t gensvm_journal_task_key(struct GenTask *task, uint64_t split_hash)
+{
+	uint64_t hash = split_hash;
+
+	hash = gensvm_hash_bytes(hash, &task->kerneltype, sizeof(KernelType));
+	hash = gensvm_hash_bytes(hash, &task->weight_idx, sizeof(int));
+	hash = gensvm_hash_bytes(hash, &task->folds, sizeof(long));
+	hash = gensvm_hash_bytes(hash, &task->p, sizeof(double));
+	hash = gensvm_hash_bytes(hash, &task->kappa, sizeof(double));
+	hash = gensvm_hash_bytes(hash, &task->lambda, sizeof(double));
+	hash = gensvm_hash_bytes(hash, &task->epsilon, sizeof(double));
+	hash = gensvm_hash_bytes(hash, &task->max_iter, sizeof(long));
+	if (task->kerneltype != K_LINEAR) {
+		hash = gensvm_hash_bytes(hash, &task->gamma, sizeof(double));
+		hash = gensvm_hash_bytes(hash, &task->coef, sizeof(double));
+		hash = gensvm_hash_bytes(hash, &task->degree, sizeof(double));
+	}
+
+	return hash;
+}
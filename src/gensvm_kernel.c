@@ -52,6 +52,26 @@ void gensvm_kernel_copy_kernelparam_to_data(struct GenModel *model,
 	data->degree = model->degree;
 }
 
+/**
+ * @brief Memory needed to compute the kernel of a dataset
+ *
+ * @details
+ * The kernel matrix and the eigenvectors of gensvm_kernel_eigendecomp()
+ * each take @f$ n^2 @f$ doubles, and the eigendecomposition needs a
+ * workspace of a few dozen doubles per instance. The eigenvectors that are
+ * kept come on top of this, but they are usually a small part of it.
+ *
+ * @param[in] 	n 	number of instances
+ * @returns 		estimate of the number of bytes needed
+ */
+size_t gensvm_kernel_memory(long n)
+{
+	size_t size = 2 * ((size_t) n) * n * sizeof(double);
+	size += 40 * ((size_t) n) * sizeof(double);
+	size += 6 * ((size_t) n) * sizeof(int);
+	return size;
+}
+
 /**
  * @brief Do the preprocessing steps needed to perform kernel GenSVM
  *
@@ -62,6 +82,10 @@ void gensvm_kernel_copy_kernelparam_to_data(struct GenModel *model,
  * = \textbf{P}\boldsymbol{\Sigma}@f$ which takes the role as data matrix in
  * the optimization algorithm.
  *
+ * If the memory needed for this (see gensvm_kernel_memory()) exceeds the
+ * memory limit (see gensvm_memory_set_limit()), an error is printed and the
+ * program exits before the kernel matrix is allocated.
+ *
  * @sa
  * gensvm_kernel_compute(), gensvm_kernel_eigendecomp(), 
  * gensvm_kernel_trainfactor(), gensvm_kernel_postprocess()
@@ -84,6 +108,19 @@ void gensvm_kernel_preprocess(struct GenModel *model, struct GenData *data)
 	       *Sigma = NULL,
 	       *K = NULL;
 
+	// fail early if the kernel matrix doesn't fit in the memory limit
+	if (!gensvm_memory_available(gensvm_kernel_memory(n))) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: The kernel matrix of %li instances needs "
+				"about %.1f MB, which exceeds the memory limit "
+				"of %.1f MB. Use a linear kernel or fewer "
+				"instances.\n", n,
+				gensvm_kernel_memory(n) / 1048576.0,
+				gensvm_memory_limit() / 1048576.0);
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
+
 	// build the kernel matrix
 	K = Calloc(double, n*n);
 	gensvm_kernel_compute(model, data, K);
@@ -97,7 +134,7 @@ void gensvm_kernel_preprocess(struct GenModel *model, struct GenData *data)
 
 	// Set Sigma to data->Sigma (need it again for prediction)
 	if (data->Sigma != NULL) {
-		free(data->Sigma);
+		Free(data->Sigma);
 		data->Sigma = NULL;
 	}
 	data->Sigma = Sigma;
@@ -105,8 +142,8 @@ void gensvm_kernel_preprocess(struct GenModel *model, struct GenData *data)
 	// write kernel params to data
 	gensvm_kernel_copy_kernelparam_to_data(model, data);
 
-	free(K);
-	free(P);
+	Free(K);
+	Free(P);
 }
 
 /**
@@ -136,7 +173,7 @@ void gensvm_kernel_postprocess(struct GenModel *model,
 	// generate the data matrix N = K2 * M * Sigma^{-2}
 	gensvm_kernel_testfactor(testdata, traindata, K2);
 
-	free(K2);
+	Free(K2);
 }
 
 /**
@@ -239,7 +276,7 @@ long gensvm_kernel_eigendecomp(double *K, long n, double cutoff, double **P_ret,
 	LWORK = WORK[0];
 
 	// allocate the requested memory for the eigendecomposition
-	WORK = (double *)realloc(WORK, LWORK*sizeof(double));
+	WORK = Realloc(WORK, double, LWORK);
 	status = dsyevx('V', 'A', 'U', n, K, n, 0, 0, 0, 0, abstol, &M,
 			tempSigma, tempP, n, WORK, LWORK, IWORK, IFAIL);
 
@@ -281,11 +318,11 @@ long gensvm_kernel_eigendecomp(double *K, long n, double cutoff, double **P_ret,
 		}
 	}
 
-	free(tempSigma);
-	free(tempP);
-	free(IWORK);
-	free(IFAIL);
-	free(WORK);
+	Free(tempSigma);
+	Free(tempP);
+	Free(IWORK);
+	Free(IFAIL);
+	Free(WORK);
 
 	*Sigma_ret = Sigma;
 	*P_ret = P;
@@ -452,8 +489,8 @@ void gensvm_kernel_testfactor(struct GenData *testdata,
 	// Set r to testdata
 	testdata->r = r;
 
-	free(M);
-	free(N);
+	Free(M);
+	Free(N);
 }
 
 /**
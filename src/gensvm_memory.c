@@ -25,6 +25,293 @@
  */
 
 #include "gensvm_globals.h" // imports gensvm_memory.h
+#include "gensvm_context.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <sys/resource.h>
+
+/**
+ * Initial number of slots of the table of recorded blocks
+ */
+#define GENSVM_MEMORY_BLOCKS 1024
+
+/**
+ * @brief A recorded block of memory
+ *
+ * @param ptr 		the block, NULL for an empty slot
+ * @param size 		number of bytes requested for the block
+ * @param site 		index of the allocation site in the site table, -1 if
+ * 			the site isn't recorded separately
+ */
+struct GenMemoryBlock {
+	void *ptr;
+	///< the block, NULL for an empty slot
+	size_t size;
+	///< number of bytes requested for the block
+	long site;
+	///< index of the allocation site in the site table
+};
+
+/**
+ * Whether allocations are recorded, see gensvm_memory_track()
+ */
+static bool gensvm_memory_tracking = false;
+
+/**
+ * Memory limit in bytes, 0 for no limit
+ */
+static size_t gensvm_memory_max = 0;
+
+/**
+ * Number of bytes in the recorded blocks
+ */
+static size_t gensvm_memory_in_use = 0;
+
+/**
+ * Largest number of bytes in the recorded blocks
+ */
+static size_t gensvm_memory_max_live = 0;
+
+/**
+ * Allocation sites, in a hash table with linear probing
+ */
+static struct GenMemorySite gensvm_memory_table[GENSVM_MEMORY_SITES];
+
+/**
+ * Recorded blocks, in a hash table on the address with linear probing
+ */
+static struct GenMemoryBlock *gensvm_memory_blocks = NULL;
+
+/**
+ * Number of slots of the table of recorded blocks, a power of two
+ */
+static size_t gensvm_memory_blocks_size = 0;
+
+/**
+ * Number of recorded blocks
+ */
+static size_t gensvm_memory_n_blocks = 0;
+
+/**
+ * Lock for the memory accounting, since allocations are done by several
+ * threads
+ */
+static pthread_mutex_t gensvm_memory_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Slot of a block in the table of recorded blocks
+ *
+ * @details
+ * The table must have at least one empty slot. The lock must be held.
+ *
+ * @param[in] 	ptr 	address of the block
+ * @returns 		the slot of the block, or the empty slot where it
+ * 			would be stored
+ */
+static size_t gensvm_memory_block_slot(void *ptr)
+{
+	size_t mask = gensvm_memory_blocks_size - 1;
+	// the low bits of an address are zero by alignment
+	size_t i = (((uintptr_t) ptr) >> 4) * 2654435761u & mask;
+
+	while (gensvm_memory_blocks[i].ptr != NULL &&
+			gensvm_memory_blocks[i].ptr != ptr)
+		i = (i + 1) & mask;
+	return i;
+}
+
+/**
+ * @brief Double the size of the table of recorded blocks
+ *
+ * @details
+ * The table is allocated with calloc() directly, such that it isn't
+ * recorded itself. The lock must be held.
+ */
+static void gensvm_memory_grow_blocks(void)
+{
+	size_t i, old_size = gensvm_memory_blocks_size;
+	struct GenMemoryBlock *old = gensvm_memory_blocks;
+
+	gensvm_memory_blocks_size = old_size ? 2*old_size :
+		GENSVM_MEMORY_BLOCKS;
+	gensvm_memory_blocks = calloc(gensvm_memory_blocks_size,
+			sizeof(struct GenMemoryBlock));
+	if (gensvm_memory_blocks == NULL) {
+		// LCOV_EXCL_START
+		fprintf(stderr, "[GenSVM Error]: Couldn't allocate memory "
+				"for the memory accounting.\n");
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
+	for (i=0; i<old_size; i++)
+		if (old[i].ptr != NULL)
+			gensvm_memory_blocks[gensvm_memory_block_slot(
+					old[i].ptr)] = old[i];
+	free(old);
+}
+
+/**
+ * @brief Remove a block from the table of recorded blocks
+ *
+ * @details
+ * The size of the block is subtracted from the bytes in use, in total and
+ * for its allocation site. Nothing happens if the block isn't recorded.
+ * The lock must be held.
+ *
+ * @param[in] 	ptr 	address of the block
+ */
+static void gensvm_memory_remove(void *ptr)
+{
+	size_t i, j, k, mask = gensvm_memory_blocks_size - 1;
+	struct GenMemoryBlock *block = NULL;
+
+	if (gensvm_memory_n_blocks == 0)
+		return;
+	i = gensvm_memory_block_slot(ptr);
+	block = &gensvm_memory_blocks[i];
+	if (block->ptr == NULL)
+		return;
+
+	gensvm_memory_in_use -= block->size;
+	if (block->site >= 0)
+		gensvm_memory_table[block->site].live -= block->size;
+	gensvm_memory_n_blocks--;
+
+	// shift the following blocks back such that no probe sequence is
+	// broken by the empty slot
+	j = i;
+	for (;;) {
+		gensvm_memory_blocks[i].ptr = NULL;
+		do {
+			j = (j + 1) & mask;
+			if (gensvm_memory_blocks[j].ptr == NULL)
+				return;
+			k = (((uintptr_t) gensvm_memory_blocks[j].ptr) >> 4) *
+				2654435761u & mask;
+		} while (i <= j ? (i < k && k <= j) : (i < k || k <= j));
+		gensvm_memory_blocks[i] = gensvm_memory_blocks[j];
+		i = j;
+	}
+}
+
+/**
+ * @brief Forget a block that is freed or reallocated
+ *
+ * @param[in] 	ptr 	address of the block, can be NULL
+ */
+static void gensvm_memory_forget(void *ptr)
+{
+	// nothing is recorded unless tracking was on or a limit was set
+	if (ptr == NULL || gensvm_memory_n_blocks == 0)
+		return;
+	pthread_mutex_lock(&gensvm_memory_lock);
+	gensvm_memory_remove(ptr);
+	pthread_mutex_unlock(&gensvm_memory_lock);
+}
+
+/**
+ * @brief Check an allocation against the memory limit
+ *
+ * @details
+ * If a memory limit is set with gensvm_memory_set_limit() and the
+ * allocation would increase the memory in use (see gensvm_memory_live())
+ * beyond it, an error is printed and the program exits. This fails before
+ * the allocation instead of when the operating system kills the process.
+ *
+ * @param[in] 	file 	filename used for error printing
+ * @param[in] 	line 	line number used for error printing
+ * @param[in] 	size 	number of bytes to allocate
+ */
+static void gensvm_memory_admit(const char *file, int line, size_t size)
+{
+	size_t live;
+
+	if (gensvm_memory_max == 0)
+		return;
+	live = gensvm_memory_live();
+	if (live + size > gensvm_memory_max) {
+		// LCOV_EXCL_START
+		fprintf(stderr, "[GenSVM Error]: Allocating %lu bytes (%s:%d) "
+				"would exceed the memory limit of %lu bytes "
+				"(%lu bytes in use).\n", (unsigned long) size,
+				file, line, (unsigned long) gensvm_memory_max,
+				(unsigned long) live);
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
+}
+
+/**
+ * @brief Record an allocation
+ *
+ * @details
+ * Allocations are recorded if memory use is tracked or if a memory limit
+ * is set. The block is added to the table of recorded blocks, and its size
+ * to the bytes in use in total and for its allocation site.
+ *
+ * @param[in] 	file 	filename of the allocation site
+ * @param[in] 	line 	line number of the allocation site
+ * @param[in] 	ptr 	the allocated block
+ * @param[in] 	size 	number of bytes allocated
+ */
+static void gensvm_memory_record(const char *file, int line, void *ptr,
+		size_t size)
+{
+	unsigned long h = 5381;
+	long i, idx = -1;
+	const char *c = NULL;
+	struct GenMemorySite *site = NULL;
+	struct GenMemoryBlock *block = NULL;
+
+	if (!gensvm_memory_tracking && gensvm_memory_max == 0)
+		return;
+
+	for (c=file; *c; c++)
+		h = 33*h + (unsigned char) *c;
+	h = 33*h + (unsigned long) line;
+
+	pthread_mutex_lock(&gensvm_memory_lock);
+	// a block at the same address was freed without Free()
+	gensvm_memory_remove(ptr);
+
+	for (i=0; i<GENSVM_MEMORY_SITES; i++) {
+		idx = (h + i) % GENSVM_MEMORY_SITES;
+		site = &gensvm_memory_table[idx];
+		if (site->file == NULL) {
+			site->file = file;
+			site->line = line;
+			break;
+		}
+		if (site->line == line && strcmp(site->file, file) == 0)
+			break;
+	}
+	// sites that don't fit in the table are not recorded separately
+	if (i < GENSVM_MEMORY_SITES) {
+		site->count++;
+		site->bytes += size;
+		if (size > site->largest)
+			site->largest = size;
+		site->live += size;
+		if (site->live > site->peak)
+			site->peak = site->live;
+	} else {
+		idx = -1;
+	}
+
+	if (2*(gensvm_memory_n_blocks + 1) > gensvm_memory_blocks_size)
+		gensvm_memory_grow_blocks();
+	block = &gensvm_memory_blocks[gensvm_memory_block_slot(ptr)];
+	block->ptr = ptr;
+	block->size = size;
+	block->site = idx;
+	gensvm_memory_n_blocks++;
+
+	gensvm_memory_in_use += size;
+	if (gensvm_memory_in_use > gensvm_memory_max_live)
+		gensvm_memory_max_live = gensvm_memory_in_use;
+	pthread_mutex_unlock(&gensvm_memory_lock);
+}
 
 /**
  * @brief Wrapper for calloc() which warns when allocation fails
@@ -36,6 +323,12 @@
  * file and linenumber and size failed to allocate. After this, the program
  * exits. See also the defines in gensvm_memory.h.
  *
+ * The allocation fails in the same way if it would exceed the memory limit
+ * (see gensvm_memory_set_limit()), and it is recorded if memory use is
+ * tracked (see gensvm_memory_track()). This holds for all allocation
+ * functions in this file. Memory from these functions is freed with
+ * Free(), such that it no longer counts as in use.
+ *
  * @note
  * This function should not be used directly. Calloc() should be used.
  *
@@ -48,8 +341,10 @@
 void *mycalloc(const char *file, int line, unsigned long size,
 	       	size_t typesize)
 {
-	void *ptr = calloc(size, typesize);
+	void *ptr = NULL;
 
+	gensvm_memory_admit(file, line, size*typesize);
+	ptr = calloc(size, typesize);
 	if (!ptr) {
 		// LCOV_EXCL_START
 		fprintf(stderr, "[GenSVM Error]: Couldn't allocate memory: "
@@ -57,6 +352,7 @@ void *mycalloc(const char *file, int line, unsigned long size,
 		exit(EXIT_FAILURE);
 		// LCOV_EXCL_STOP
 	}
+	gensvm_memory_record(file, line, ptr, size*typesize);
 	return ptr;
 }
 
@@ -80,7 +376,10 @@ void *mycalloc(const char *file, int line, unsigned long size,
  */
 void *mymalloc(const char *file, int line, unsigned long size)
 {
-	void *ptr = malloc(size);
+	void *ptr = NULL;
+
+	gensvm_memory_admit(file, line, size);
+	ptr = malloc(size);
 	if (!ptr) {
 		// LCOV_EXCL_START
 		fprintf(stderr, "[GenSVM Error]: Couldn't allocate memory: "
@@ -88,6 +387,7 @@ void *mymalloc(const char *file, int line, unsigned long size)
 		exit(EXIT_FAILURE);
 		// LCOV_EXCL_STOP
 	}
+	gensvm_memory_record(file, line, ptr, size);
 	return ptr;
 }
 
@@ -112,7 +412,12 @@ void *mymalloc(const char *file, int line, unsigned long size)
  */
 void *myrealloc(const char *file, int line, unsigned long size, void *var)
 {
-	void *ptr = realloc(var, size);
+	void *ptr = NULL;
+
+	// the old block no longer counts, whether it's moved or not
+	gensvm_memory_forget(var);
+	gensvm_memory_admit(file, line, size);
+	ptr = realloc(var, size);
 	if (!ptr) {
 		// LCOV_EXCL_START
 		fprintf(stderr, "[GenSVM Error]: Couldn't reallocate memory: "
@@ -120,5 +425,487 @@ void *myrealloc(const char *file, int line, unsigned long size, void *var)
 		exit(EXIT_FAILURE);
 		// LCOV_EXCL_STOP
 	}
+	gensvm_memory_record(file, line, ptr, size);
+	return ptr;
+}
+
+/**
+ * @brief Wrapper for posix_memalign() which warns when allocation fails
+ *
+ * @details
+ * This is mymalloc() for memory that is aligned to #GENSVM_ALIGN bytes. The
+ * memory is freed with Free(), but shouldn't be passed to Realloc()
+ * since the alignment is then lost.
+ *
+ * @note
+ * This function should not be used directly. AlignedMalloc() should be
+ * used.
+ *
+ * @param[in] 	file 		filename used for error printing
+ * @param[in] 	line 		line number used for error printing
+ * @param[in] 	size 		the size to allocate
+ * @return 			the pointer to the memory allocated
+ */
+void *myaligned_malloc(const char *file, int line, unsigned long size)
+{
+	void *ptr = NULL;
+
+	gensvm_memory_admit(file, line, size);
+	// posix_memalign() may return NULL or a unique pointer for size 0
+	if (posix_memalign(&ptr, GENSVM_ALIGN, size > 0 ? size : 1) != 0) {
+		// LCOV_EXCL_START
+		fprintf(stderr, "[GenSVM Error]: Couldn't allocate memory: "
+				"%lu bytes (%s:%d)\n", size, file, line);
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
+	gensvm_memory_record(file, line, ptr, size);
+	return ptr;
+}
+
+/**
+ * @brief Aligned version of mycalloc()
+ *
+ * @details
+ * This is mycalloc() for memory that is aligned to #GENSVM_ALIGN bytes, see
+ * myaligned_malloc().
+ *
+ * @note
+ * This function should not be used directly. AlignedCalloc() should be
+ * used.
+ *
+ * @param[in] 	file 		filename used for error printing
+ * @param[in] 	line 		line number used for error printing
+ * @param[in] 	size 		the size to allocate
+ * @param[in] 	typesize 	the size of the type to allocate
+ * @return 			the pointer to the memory allocated
+ */
+void *myaligned_calloc(const char *file, int line, unsigned long size,
+		size_t typesize)
+{
+	void *ptr = myaligned_malloc(file, line, size*typesize);
+	memset(ptr, 0, size*typesize);
+	return ptr;
+}
+
+/**
+ * @brief Wrapper for free() which updates the memory accounting
+ *
+ * @details
+ * If the memory was recorded when it was allocated (see
+ * gensvm_memory_track() and gensvm_memory_set_limit()), its size is
+ * subtracted from the bytes in use of its allocation site and in total.
+ * Any pointer that can be passed to free() can be passed to this function.
+ *
+ * @note
+ * This function should not be used directly. Free() should be used.
+ *
+ * @param[in] 	ptr 	the memory to free, can be NULL
+ */
+void gensvm_free(void *ptr)
+{
+	gensvm_memory_forget(ptr);
+	free(ptr);
+}
+
+/**
+ * @brief Padded leading dimension of a row-major matrix
+ *
+ * @details
+ * The number of columns is rounded up to a multiple of #GENSVM_ALIGN bytes,
+ * such that every row of an aligned matrix starts on a cache line. The
+ * padding is not used in computations, it only changes the leading
+ * dimension that is passed to matrix_get() and the BLAS and LAPACK calls.
+ * If #GENSVM_PAD_LD is 0, the number of columns is returned.
+ *
+ * @param[in] 	cols 		number of columns of the matrix
+ * @param[in] 	typesize 	size of an element of the matrix
+ * @returns 			leading dimension of the matrix
+ */
+long gensvm_padded_ld(long cols, size_t typesize)
+{
+	long per_line = GENSVM_ALIGN / typesize;
+
+	if (!GENSVM_PAD_LD || per_line < 2)
+		return cols;
+	return (cols + per_line - 1) / per_line * per_line;
+}
+
+/**
+ * @brief Number of bytes an array takes in an arena
+ *
+ * @details
+ * Arrays in an arena are padded to a multiple of #GENSVM_ARENA_ALIGN
+ * bytes, such that every array is aligned. This function can be used to
+ * compute the size to reserve for a number of arrays.
+ *
+ * @param[in] 	size 		number of elements of the array
+ * @param[in] 	typesize 	size of an element
+ * @returns 			number of bytes of the array in an arena
+ */
+size_t gensvm_arena_size(unsigned long size, size_t typesize)
+{
+	size_t bytes = size * typesize;
+	return (bytes + GENSVM_ARENA_ALIGN - 1) / GENSVM_ARENA_ALIGN *
+		GENSVM_ARENA_ALIGN;
+}
+
+/**
+ * @brief Initialize an arena
+ *
+ * @param[in] 	size 	initial size of the arena in bytes, can be 0
+ * @returns 		the arena, to be freed with gensvm_free_arena()
+ */
+struct GenArena *gensvm_init_arena(size_t size)
+{
+	struct GenArena *arena = Malloc(struct GenArena, 1);
+
+	arena->block = NULL;
+	arena->base = NULL;
+	arena->size = 0;
+	arena->used = 0;
+	arena->peak = 0;
+	arena->extra = NULL;
+	arena->n_extra = 0;
+	arena->extra_bytes = 0;
+	gensvm_arena_reserve(arena, size);
+
+	return arena;
+}
+
+/**
+ * @brief Free an arena and all arrays taken from it
+ *
+ * @param[in] 	arena 	the arena to free, can be NULL
+ */
+void gensvm_free_arena(struct GenArena *arena)
+{
+	if (arena == NULL)
+		return;
+	gensvm_arena_reset(arena);
+	Free(arena->block);
+	Free(arena);
+}
+
+/**
+ * @brief Make sure that an arena has at least a given size
+ *
+ * @details
+ * The block of the arena is replaced by a larger one, so this may only be
+ * done when no arrays are taken from the block.
+ *
+ * @param[in] 	arena 	the arena, with no arrays in use
+ * @param[in] 	size 	required size of the arena in bytes
+ */
+void gensvm_arena_reserve(struct GenArena *arena, size_t size)
+{
+	if (size <= arena->size)
+		return;
+	if (arena->used > 0) {
+		// LCOV_EXCL_START
+		fprintf(stderr, "[GenSVM Error]: Can't enlarge an arena that "
+				"is in use.\n");
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
+
+	// round up to the alignment such that all offsets stay aligned
+	size = gensvm_arena_size(size, 1);
+	Free(arena->block);
+	arena->block = Malloc(char, size + GENSVM_ARENA_ALIGN);
+	arena->base = arena->block + GENSVM_ARENA_ALIGN -
+		((size_t) arena->block) % GENSVM_ARENA_ALIGN;
+	arena->size = size;
+}
+
+/**
+ * @brief Take a zeroed array from an arena
+ *
+ * @details
+ * The array is aligned to #GENSVM_ARENA_ALIGN bytes and is zeroed, as with
+ * Calloc(). It must not be freed, but is given back with
+ * gensvm_arena_release() or gensvm_arena_reset(). If the array doesn't fit
+ * in the arena it is allocated with Calloc(), and freed on the next reset.
+ *
+ * @note
+ * This function should not be used directly. ArenaCalloc() should be used.
+ *
+ * @param[in] 	arena 		the arena
+ * @param[in] 	file 		filename used for error printing
+ * @param[in] 	line 		line number used for error printing
+ * @param[in] 	size 		number of elements of the array
+ * @param[in] 	typesize 	size of an element
+ * @returns 			the zeroed array
+ */
+void *gensvm_arena_calloc(struct GenArena *arena, const char *file, int line,
+		unsigned long size, size_t typesize)
+{
+	void *ptr = NULL;
+	size_t bytes = gensvm_arena_size(size, typesize);
+
+	if (arena->used + bytes <= arena->size) {
+		ptr = arena->base + arena->used;
+		arena->used += bytes;
+		memset(ptr, 0, bytes);
+	} else {
+		ptr = mycalloc(file, line, bytes, 1);
+		arena->extra = myrealloc(file, line,
+				(arena->n_extra + 1) * sizeof(void *),
+				arena->extra);
+		arena->extra[arena->n_extra++] = ptr;
+		arena->extra_bytes += bytes;
+	}
+	if (arena->used + arena->extra_bytes > arena->peak)
+		arena->peak = arena->used + arena->extra_bytes;
+
 	return ptr;
 }
+
+/**
+ * @brief Mark the current position of an arena
+ *
+ * @param[in] 	arena 	the arena
+ * @returns 		the position, for gensvm_arena_release()
+ */
+size_t gensvm_arena_mark(struct GenArena *arena)
+{
+	return arena->used;
+}
+
+/**
+ * @brief Give back the arrays taken from an arena after a mark
+ *
+ * @details
+ * The arrays taken from the block of the arena since the call to
+ * gensvm_arena_mark() that returned @p mark can be reused. Separately
+ * allocated arrays are kept until gensvm_arena_reset().
+ *
+ * @param[in] 	arena 	the arena
+ * @param[in] 	mark 	the position returned by gensvm_arena_mark()
+ */
+void gensvm_arena_release(struct GenArena *arena, size_t mark)
+{
+	arena->used = mark;
+}
+
+/**
+ * @brief Give back all arrays of an arena
+ *
+ * @details
+ * The separately allocated arrays are freed, and the block is enlarged to
+ * the largest amount of memory used since the previous reset, such that
+ * the same arrays fit in the block the next time.
+ *
+ * @param[in] 	arena 	the arena
+ */
+void gensvm_arena_reset(struct GenArena *arena)
+{
+	long i;
+
+	for (i=0; i<arena->n_extra; i++)
+		Free(arena->extra[i]);
+	Free(arena->extra);
+	arena->extra = NULL;
+	arena->n_extra = 0;
+	arena->extra_bytes = 0;
+
+	arena->used = 0;
+	gensvm_arena_reserve(arena, arena->peak);
+	arena->peak = 0;
+}
+
+/**
+ * @brief Turn the recording of allocations on or off
+ *
+ * @details
+ * When allocations are recorded, the size and allocation site of every
+ * block are kept until it is freed with Free(). This gives the number of
+ * allocations, the bytes requested, and the bytes in use and their peak
+ * for every allocation site and in total (see gensvm_memory_sites() and
+ * gensvm_memory_peak()). Recording costs a lock per allocation and per
+ * free, so it is off by default. Allocations are also recorded when a
+ * memory limit is set.
+ *
+ * @param[in] 	track 	whether to record allocations
+ */
+void gensvm_memory_track(bool track)
+{
+	gensvm_memory_tracking = track;
+}
+
+/**
+ * @brief Set the memory limit
+ *
+ * @details
+ * Allocations that would increase the number of bytes in use (see
+ * gensvm_memory_live()) beyond the limit fail with an error. Only
+ * allocations made after the limit is set count towards it. Large
+ * allocations can be checked beforehand with gensvm_memory_available(), to
+ * choose a different strategy or to fail with a clear message.
+ *
+ * @param[in] 	limit 	the memory limit in bytes, 0 for no limit
+ */
+void gensvm_memory_set_limit(size_t limit)
+{
+	gensvm_memory_max = limit;
+}
+
+/**
+ * @brief Get the memory limit
+ *
+ * @returns 	the memory limit in bytes, 0 if there is no limit
+ */
+size_t gensvm_memory_limit(void)
+{
+	return gensvm_memory_max;
+}
+
+/**
+ * @brief Number of bytes in use
+ *
+ * @details
+ * This is the number of bytes in the recorded allocations that aren't yet
+ * freed with Free(). Memory that isn't allocated through the functions in
+ * this file, or that was allocated while nothing was recorded, isn't
+ * included.
+ *
+ * @returns 	number of bytes in use
+ */
+size_t gensvm_memory_live(void)
+{
+	size_t live;
+
+	pthread_mutex_lock(&gensvm_memory_lock);
+	live = gensvm_memory_in_use;
+	pthread_mutex_unlock(&gensvm_memory_lock);
+
+	return live;
+}
+
+/**
+ * @brief Largest number of bytes in use
+ *
+ * @details
+ * This is the peak of gensvm_memory_live() since recording was turned on
+ * or since the last call to gensvm_memory_reset().
+ *
+ * @returns 	the largest number of bytes in use
+ */
+size_t gensvm_memory_peak(void)
+{
+	size_t peak;
+
+	pthread_mutex_lock(&gensvm_memory_lock);
+	peak = gensvm_memory_max_live;
+	pthread_mutex_unlock(&gensvm_memory_lock);
+
+	return peak;
+}
+
+/**
+ * @brief Check if an allocation fits in the memory limit
+ *
+ * @param[in] 	size 	number of bytes to allocate
+ * @returns 		whether @p size bytes can be allocated without
+ * 			exceeding the memory limit
+ */
+bool gensvm_memory_available(size_t size)
+{
+	if (gensvm_memory_max == 0)
+		return true;
+	return gensvm_memory_live() + size <= gensvm_memory_max;
+}
+
+/**
+ * @brief Get the recorded allocation sites
+ *
+ * @details
+ * The sites are stored in a hash table, so the returned array has
+ * #GENSVM_MEMORY_SITES elements of which the unused ones have a NULL
+ * GenMemorySite::file.
+ *
+ * @param[out] 	n_sites 	number of elements of the array
+ * @returns 			the array of allocation sites
+ */
+struct GenMemorySite *gensvm_memory_sites(long *n_sites)
+{
+	*n_sites = GENSVM_MEMORY_SITES;
+	return gensvm_memory_table;
+}
+
+/**
+ * @brief Clear the recorded allocations and the peak memory use
+ *
+ * @details
+ * Blocks that were recorded before the reset no longer count as in use,
+ * and freeing them doesn't change the accounting.
+ */
+void gensvm_memory_reset(void)
+{
+	pthread_mutex_lock(&gensvm_memory_lock);
+	memset(gensvm_memory_table, 0, sizeof(gensvm_memory_table));
+	free(gensvm_memory_blocks);
+	gensvm_memory_blocks = NULL;
+	gensvm_memory_blocks_size = 0;
+	gensvm_memory_n_blocks = 0;
+	gensvm_memory_in_use = 0;
+	gensvm_memory_max_live = 0;
+	pthread_mutex_unlock(&gensvm_memory_lock);
+}
+
+/**
+ * @brief Write a report of the memory use to the output of a context
+ *
+ * @details
+ * The report gives the number of bytes in use, the peak number of bytes in
+ * use, the peak resident set size of the process, and the allocation sites
+ * with the highest peak number of bytes in use. Nothing is written if
+ * allocations aren't recorded.
+ *
+ * @param[in] 	ctx 	the GenContext, or NULL to use the global output
+ */
+void gensvm_memory_report(struct GenContext *ctx)
+{
+	long i, j, n_top = 0, top[5];
+	double mb = 1024.0 * 1024.0;
+	struct rusage usage;
+	struct GenMemorySite *site = NULL;
+
+	if (!gensvm_memory_tracking)
+		return;
+
+	getrusage(RUSAGE_SELF, &usage);
+	gensvm_note(ctx, "Memory use: %.1f MB in use, %.1f MB peak, "
+			"%.1f MB peak resident", gensvm_memory_live() / mb,
+			gensvm_memory_peak() / mb, usage.ru_maxrss / 1024.0);
+	if (gensvm_memory_max > 0)
+		gensvm_note(ctx, ", %.1f MB limit", gensvm_memory_max / mb);
+	gensvm_note(ctx, "\n");
+
+	// select the five sites with the highest peak by insertion
+	pthread_mutex_lock(&gensvm_memory_lock);
+	for (i=0; i<GENSVM_MEMORY_SITES; i++) {
+		site = &gensvm_memory_table[i];
+		if (site->file == NULL)
+			continue;
+		for (j=n_top; j>0; j--) {
+			if (gensvm_memory_table[top[j-1]].peak >= site->peak)
+				break;
+			if (j < 5)
+				top[j] = top[j-1];
+		}
+		if (j < 5)
+			top[j] = i;
+		if (n_top < 5)
+			n_top++;
+	}
+	for (i=0; i<n_top; i++) {
+		site = &gensvm_memory_table[top[i]];
+		gensvm_note(ctx, "\t%s:%i: %.1f MB peak, %.1f MB in use, "
+				"%lu allocations, %.1f MB total, %.1f MB "
+				"largest\n", site->file, site->line,
+				site->peak / mb, site->live / mb, site->count,
+				site->bytes / mb, site->largest / mb);
+	}
+	pthread_mutex_unlock(&gensvm_memory_lock);
+}
@@ -49,34 +49,46 @@
  * In this function, step doubling is used in the majorization algorithm after
  * a burn-in of 50 iterations.
  *
+ * If the context has an arena, the workspace is taken from the arena and
+ * given back to it on return, such that consecutive calls reuse the same
+ * memory. The training accuracy is predicted from the matrix ZV of the
+ * workspace, with the threads and arena of the context, such that a
+ * context with one thread, as used in the repeats of the consistency
+ * check, doesn't start threads for the prediction.
+ *
  * @param[in,out] 	model 	the GenModel to be trained. Contains optimal
  * 				V on exit.
  * @param[in] 		data 	the GenData to train the model with.
+ * @param[in] 		ctx 	the GenContext for the output, or NULL to use
+ * 				the global output streams
  */
-void gensvm_optimize(struct GenModel *model, struct GenData *data)
+void gensvm_optimize(struct GenModel *model, struct GenData *data,
+		struct GenContext *ctx)
 {
 	long it = 0;
 	double L, Lbar, acc;
+	struct GenArena *arena = gensvm_context_arena(ctx);
+	size_t mark = (arena == NULL) ? 0 : gensvm_arena_mark(arena);
 
 	long n = model->n;
 	long m = model->m;
 	long K = model->K;
 
 	// initialize the workspace
-	struct GenWork *work = gensvm_init_work(model);
+	struct GenWork *work = gensvm_init_work_arena(model, arena);
 
 	// print some info on the dataset and model configuration
-	note("Starting main loop.\n");
-	note("Dataset:\n");
-	note("\tn = %i\n", n);
-	note("\tm = %i\n", m);
-	note("\tK = %i\n", K);
-	note("Parameters:\n");
-	note("\tkappa = %f\n", model->kappa);
-	note("\tp = %f\n", model->p);
-	note("\tlambda = %15.16f\n", model->lambda);
-	note("\tepsilon = %g\n", model->epsilon);
-	note("\n");
+	gensvm_note(ctx, "Starting main loop.\n");
+	gensvm_note(ctx, "Dataset:\n");
+	gensvm_note(ctx, "\tn = %i\n", n);
+	gensvm_note(ctx, "\tm = %i\n", m);
+	gensvm_note(ctx, "\tK = %i\n", K);
+	gensvm_note(ctx, "Parameters:\n");
+	gensvm_note(ctx, "\tkappa = %f\n", model->kappa);
+	gensvm_note(ctx, "\tp = %f\n", model->p);
+	gensvm_note(ctx, "\tlambda = %15.16f\n", model->lambda);
+	gensvm_note(ctx, "\tepsilon = %g\n", model->epsilon);
+	gensvm_note(ctx, "\n");
 
 	// compute necessary simplex vectors
 	gensvm_simplex(model);
@@ -99,11 +111,14 @@ void gensvm_optimize(struct GenModel *model, struct GenData *data)
 		L = gensvm_get_loss(model, data, work);
 
 		if (it % GENSVM_PRINT_ITER == 0) {
-			gensvm_predict_labels(data, model, work->yhat);
+			// ZV is computed for the current V by the loss
+			gensvm_predict_assign(work->ZV, model->U, n, K,
+					work->yhat, NULL, ctx);
 			acc = gensvm_prediction_perf(data, work->yhat);
-			note("iter = %li, L = %15.16f, Lbar = %15.16f, "
-			     "reldiff = %15.16f, acc = %.2f\n", it, L, Lbar,
-			     (Lbar - L)/L, acc);
+			gensvm_note(ctx, "iter = %li, L = %15.16f, "
+					"Lbar = %15.16f, reldiff = %15.16f, "
+					"acc = %.2f\n", it, L, Lbar,
+					(Lbar - L)/L, acc);
 		}
 
 		it++;
@@ -114,28 +129,30 @@ void gensvm_optimize(struct GenModel *model, struct GenData *data)
 
 	// print warnings if necessary
 	if (L > Lbar) {
-		err("[GenSVM Warning]: Negative step occurred in "
-				"majorization.\n");
+		gensvm_error(ctx, "[GenSVM Warning]: Negative step occurred "
+				"in majorization.\n");
 		model->status = 1;
 	}
 
 	if (it >= model->max_iter) {
-		err("[GenSVM Warning]: maximum number of iterations "
-				"reached.\n");
+		gensvm_error(ctx, "[GenSVM Warning]: maximum number of "
+				"iterations reached.\n");
 		model->status = 2;
 	}
 
 	// compute final training accuracy
-	gensvm_predict_labels(data, model, work->yhat);
+	gensvm_predict_assign(work->ZV, model->U, n, K, work->yhat, NULL,
+			ctx);
 	acc = gensvm_prediction_perf(data, work->yhat);
 
 	// print final iteration count and loss
-	note("Optimization finished, iter = %li, loss = %15.16f, "
-			"rel. diff. = %15.16f, acc = %.2f\n", it-1, L,
-			(Lbar - L)/L, acc);
+	gensvm_note(ctx, "Optimization finished, iter = %li, "
+			"loss = %15.16f, rel. diff. = %15.16f, acc = %.2f\n",
+			it-1, L, (Lbar - L)/L, acc);
 
 	// compute and print the number of SVs in the model
-	note("Number of support vectors: %li\n", gensvm_num_sv(model));
+	gensvm_note(ctx, "Number of support vectors: %li\n",
+			gensvm_num_sv(model));
 
 	// store the training error in the model
 	model->training_error = (Lbar - L)/L;
@@ -145,6 +162,8 @@ void gensvm_optimize(struct GenModel *model, struct GenData *data)
 
 	// free the workspace
 	gensvm_free_work(work);
+	if (arena != NULL)
+		gensvm_arena_release(arena, mark);
 }
 
 /**
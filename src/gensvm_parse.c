@@ -0,0 +1,454 @@
+/**
+ * @file gensvm_parse.c
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Functions for parsing and formatting numbers in memory
+ *
+ * @details
+ * Reading large text files with fscanf() is slow, since every value goes
+ * through the locale-aware formatted input machinery of the C library. The
+ * functions in this file are used by the readers in gensvm_io.c instead. A
+ * file is mapped into memory once, after which numbers are parsed directly
+ * from memory. Since the mapping is shared, different parts of a file can be
+ * parsed by different threads.
+ *
+ * Floating point numbers are parsed with the fast path of Clinger (1990),
+ * <em>How to read floating point numbers accurately</em>: if the decimal
+ * significand has at most 19 digits and fits in 53 bits, and the decimal
+ * exponent is at most 22 in absolute value, the result of a single
+ * multiplication or division by an exact power of ten is correctly rounded.
+ * This covers the numbers written by GenSVM and most other programs. All
+ * other numbers are passed to strtod(), so the result is always the same as
+ * that of strtod().
+ *
+ * For writing large files, numbers are formatted into a buffer with
+ * gensvm_format_double() and gensvm_format_long(), which give the same
+ * output as the "%.16f" and "%li" formats of printf(). A double is formatted
+ * exactly with 128-bit integer arithmetic if the compiler supports it and
+ * the number is not too large or too small, and with snprintf() otherwise.
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+
+#include "gensvm_parse.h"
+
+/**
+ * Powers of ten that are exactly representable as a double
+ */
+static const double gensvm_pow10[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/**
+ * @brief Read a file into memory
+ *
+ * @details
+ * A regular file is mapped into memory with mmap(). If the file can't be
+ * mapped (for instance because it is a pipe or it is empty), it is read into
+ * an allocated buffer. Text files are mapped read-only, since they are only
+ * parsed. Binary files are used in place, so their mapping is private and
+ * writable if @p writable is true, such that changes to the data are not
+ * written to the file but copied on write.
+ *
+ * @param[in] 	filename 	name of the file
+ * @param[in] 	writable 	whether the mapped data can be changed
+ * @returns 			GenFileMap with the contents of the file, or
+ * 				NULL if the file can't be opened
+ */
+struct GenFileMap *gensvm_map_file(char *filename, bool writable)
+{
+	int fd;
+	size_t size = 0;
+	ssize_t nr;
+	struct stat st;
+	struct GenFileMap *map = NULL;
+
+	if ((fd = open(filename, O_RDONLY)) < 0)
+		return NULL;
+
+	map = Malloc(struct GenFileMap, 1);
+	map->data = NULL;
+	map->size = 0;
+	map->mapped = false;
+
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+		map->data = mmap(NULL, st.st_size, writable ?
+				PROT_READ | PROT_WRITE : PROT_READ,
+				MAP_PRIVATE, fd, 0);
+		if (map->data != MAP_FAILED) {
+			map->size = st.st_size;
+			map->mapped = true;
+			madvise(map->data, map->size, MADV_SEQUENTIAL);
+			close(fd);
+			return map;
+		}
+		map->data = NULL; // LCOV_EXCL_LINE
+	}
+
+	// fall back on reading the file
+	size = BUFSIZ;
+	map->data = Malloc(char, size);
+	while ((nr = read(fd, map->data + map->size,
+					size - map->size)) > 0) {
+		map->size += nr;
+		if (map->size == size) {
+			size *= 2;
+			map->data = Realloc(map->data, char, size);
+		}
+	}
+	close(fd);
+
+	return map;
+}
+
+/**
+ * @brief Release a file read with gensvm_map_file()
+ *
+ * @param[in] 	map 	the GenFileMap to release
+ */
+void gensvm_unmap_file(struct GenFileMap *map)
+{
+	if (map == NULL)
+		return;
+	if (map->mapped)
+		munmap(map->data, map->size);
+	else
+		Free(map->data);
+	Free(map);
+	map = NULL;
+}
+
+/**
+ * @brief Check if a pointer lies in a GenFileMap
+ *
+ * @param[in] 	map 	a GenFileMap
+ * @param[in] 	ptr 	a pointer
+ * @returns 		whether ptr points to the contents of the map
+ */
+bool gensvm_map_contains(struct GenFileMap *map, const void *ptr)
+{
+	const char *p = ptr;
+
+	if (map == NULL || p == NULL)
+		return false;
+	return p >= map->data && p < map->data + map->size;
+}
+
+/**
+ * @brief Check if a character separates numbers on a line
+ *
+ * @param[in] 	c 	the character
+ * @returns 		whether the character is a space, tab or carriage
+ * 			return
+ */
+static inline bool gensvm_is_blank(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+/**
+ * @brief Skip spaces and tabs, but not newlines
+ *
+ * @param[in] 	p 	current position
+ * @param[in] 	end 	end of the data
+ * @returns 		position of the first character that is not blank
+ */
+const char *gensvm_skip_blank(const char *p, const char *end)
+{
+	while (p < end && gensvm_is_blank(*p))
+		p++;
+	return p;
+}
+
+/**
+ * @brief Find the start of the next line
+ *
+ * @param[in] 	p 	current position
+ * @param[in] 	end 	end of the data
+ * @returns 		position after the next newline, or @p end
+ */
+const char *gensvm_next_line(const char *p, const char *end)
+{
+	const char *nl = memchr(p, '\n', end - p);
+	return nl == NULL ? end : nl + 1;
+}
+
+/**
+ * @brief Parse a number with strtod()
+ *
+ * @details
+ * The token is copied such that it is null terminated. This is the slow
+ * path of gensvm_parse_double().
+ *
+ * @param[in] 	start 	start of the token
+ * @param[in] 	len 	length of the token
+ * @param[out] 	value 	the parsed number
+ * @returns 		whether the full token is a number
+ */
+static bool gensvm_parse_double_slow(const char *start, size_t len,
+		double *value)
+{
+	char buf[GENSVM_MAX_NUMBER_LENGTH];
+	char *copy = (len < GENSVM_MAX_NUMBER_LENGTH) ? buf :
+		Malloc(char, len+1);
+	char *stop = NULL;
+	bool ok;
+
+	memcpy(copy, start, len);
+	copy[len] = '\0';
+	*value = strtod(copy, &stop);
+	ok = (len > 0 && stop == copy + len);
+	if (copy != buf)
+		Free(copy);
+	return ok;
+}
+
+/**
+ * @brief Parse a floating point number from memory
+ *
+ * @details
+ * Leading spaces and tabs are skipped, and the number must be followed by
+ * whitespace or the end of the data. The result equals that of strtod(), but
+ * the common case is handled without it (see the file description).
+ *
+ * @param[in,out] 	str 	current position, set to the end of the
+ * 				number on success
+ * @param[in] 		end 	end of the data
+ * @param[out] 		value 	the parsed number
+ * @returns 			whether a number was parsed
+ */
+bool gensvm_parse_double(const char **str, const char *end, double *value)
+{
+	const char *start = gensvm_skip_blank(*str, end);
+	const char *stop = start;
+	const char *p = start;
+	bool neg = false,
+	     exact = true,
+	     any = false,
+	     eneg = false;
+	int nd = 0;
+	long exp10 = 0,
+	     e = 0;
+	uint64_t mant = 0;
+	double v;
+
+	while (stop < end && !gensvm_is_blank(*stop) && *stop != '\n')
+		stop++;
+	if (stop == start)
+		return false;
+
+	if (*p == '-' || *p == '+')
+		neg = (*p++ == '-');
+	for (; p < stop && *p >= '0' && *p <= '9'; p++) {
+		any = true;
+		if (nd < 19) {
+			mant = 10*mant + (*p - '0');
+			nd += (mant > 0);
+		} else {
+			exact &= (*p == '0');
+			exp10++;
+		}
+	}
+	if (p < stop && *p == '.') {
+		for (p++; p < stop && *p >= '0' && *p <= '9'; p++) {
+			any = true;
+			if (nd < 19) {
+				mant = 10*mant + (*p - '0');
+				nd += (mant > 0);
+				exp10--;
+			} else {
+				exact &= (*p == '0');
+			}
+		}
+	}
+	if (any && p < stop && (*p == 'e' || *p == 'E')) {
+		p++;
+		if (p < stop && (*p == '-' || *p == '+'))
+			eneg = (*p++ == '-');
+		if (p == stop)
+			any = false;
+		for (; p < stop && *p >= '0' && *p <= '9'; p++)
+			if (e < 100000)
+				e = 10*e + (*p - '0');
+		exp10 += eneg ? -e : e;
+	}
+
+	if (any && p == stop && exact && mant <= (1ULL << 53) &&
+			exp10 >= -22 && exp10 <= 22) {
+		v = (double) mant;
+		v = (exp10 < 0) ? v / gensvm_pow10[-exp10] :
+			v * gensvm_pow10[exp10];
+		*value = neg ? -v : v;
+	} else if (!gensvm_parse_double_slow(start, stop - start, value)) {
+		return false;
+	}
+
+	*str = stop;
+	return true;
+}
+
+/**
+ * @brief Parse an integer from memory
+ *
+ * @details
+ * Leading spaces and tabs are skipped, and the number must be followed by
+ * whitespace or the end of the data.
+ *
+ * @param[in,out] 	str 	current position, set to the end of the
+ * 				number on success
+ * @param[in] 		end 	end of the data
+ * @param[out] 		value 	the parsed number
+ * @returns 			whether a number was parsed
+ */
+bool gensvm_parse_long(const char **str, const char *end, long *value)
+{
+	const char *p = gensvm_skip_blank(*str, end);
+	bool neg = false,
+	     any = false;
+	long v = 0;
+
+	if (p < end && (*p == '-' || *p == '+'))
+		neg = (*p++ == '-');
+	for (; p < end && *p >= '0' && *p <= '9'; p++) {
+		v = 10*v + (*p - '0');
+		any = true;
+	}
+	if (!any || (p < end && !gensvm_is_blank(*p) && *p != '\n'))
+		return false;
+
+	*value = neg ? -v : v;
+	*str = p;
+	return true;
+}
+
+/**
+ * @brief Format an integer
+ *
+ * @details
+ * The output equals that of the "%li" format of printf(). The string is not
+ * null terminated.
+ *
+ * @param[out] 	buf 	buffer with room for #GENSVM_MAX_NUMBER_LENGTH
+ * 			characters
+ * @param[in] 	value 	the number to format
+ * @returns 		the number of characters written
+ */
+size_t gensvm_format_long(char *buf, long value)
+{
+	char digits[24];
+	size_t i, len = 0, nd = 0;
+	unsigned long v = value;
+
+	if (value < 0)
+		v = -v;
+
+	do {
+		digits[nd++] = '0' + v % 10;
+		v /= 10;
+	} while (v > 0);
+
+	if (value < 0)
+		buf[len++] = '-';
+	for (i=0; i<nd; i++)
+		buf[len++] = digits[nd-1-i];
+	return len;
+}
+
+/**
+ * @brief Format a floating point number with 16 decimals
+ *
+ * @details
+ * The output equals that of the "%.16f" format of printf(). The string is
+ * not null terminated. A finite double is an integer times a power of two,
+ * so the number times 10^16 is computed exactly as an integer and rounded
+ * to nearest with ties to even, as printf() does. This is done for numbers
+ * between about 1e-18 and 2^59, and snprintf() is used for all other
+ * numbers.
+ *
+ * @param[out] 	buf 	buffer with room for #GENSVM_MAX_DOUBLE_LENGTH
+ * 			characters
+ * @param[in] 	value 	the number to format
+ * @returns 		the number of characters written
+ */
+size_t gensvm_format_double(char *buf, double value)
+{
+#ifdef __SIZEOF_INT128__
+	int i, shift;
+	size_t len = 0;
+	uint64_t bits, mant, ip, fp;
+	unsigned __int128 q, rem, half;
+	const uint64_t pow5_16 = 152587890625ULL;
+	const uint64_t pow10_16 = 10000000000000000ULL;
+	char digits[24];
+	int nd = 0;
+
+	memcpy(&bits, &value, sizeof(double));
+	mant = bits & ((1ULL << 52) - 1);
+	shift = (int) ((bits >> 52) & 0x7ff);
+
+	if (shift == 0 && mant == 0) {
+		q = 0;
+	} else if (shift == 0 || shift == 0x7ff) {
+		// subnormal, infinite or NaN
+		return snprintf(buf, GENSVM_MAX_DOUBLE_LENGTH, "%.16f",
+				value);
+	} else {
+		// value = mant * 2^(shift - 1075), and value * 10^16 equals
+		// mant * 5^16 * 2^(shift - 1075 + 16)
+		mant |= (1ULL << 52);
+		shift = shift - 1075 + 16;
+		if (shift > 22 || shift <= -128)
+			return snprintf(buf, GENSVM_MAX_DOUBLE_LENGTH, "%.16f",
+					value);
+		q = (unsigned __int128) mant * pow5_16;
+		if (shift >= 0) {
+			q <<= shift;
+		} else {
+			rem = q & ((((unsigned __int128) 1) << -shift) - 1);
+			half = ((unsigned __int128) 1) << (-shift - 1);
+			q >>= -shift;
+			if (rem > half || (rem == half && (q & 1)))
+				q++;
+		}
+	}
+
+	ip = (uint64_t) (q / pow10_16);
+	fp = (uint64_t) (q % pow10_16);
+
+	if (bits >> 63)
+		buf[len++] = '-';
+	do {
+		digits[nd++] = '0' + ip % 10;
+		ip /= 10;
+	} while (ip > 0);
+	while (nd > 0)
+		buf[len++] = digits[--nd];
+	buf[len++] = '.';
+	for (i=15; i>=0; i--) {
+		buf[len + i] = '0' + fp % 10;
+		fp /= 10;
+	}
+	return len + 16;
+#else
+	return snprintf(buf, GENSVM_MAX_DOUBLE_LENGTH, "%.16f", value);
+#endif
+}
@@ -32,61 +32,415 @@
 #include "gensvm_predict.h"
 
 /**
- * @brief Predict class labels of data given and output in predy
+ * @brief Assign labels to instances with a given work array
+ *
+ * @details
+ * The inner products of the simplex space vectors with the simplex vertices
+ * are computed with a matrix product for a block of #GENSVM_BLOCK_SIZE
+ * instances at a time, after which the label of every instance is the
+ * vertex with the largest inner product. If @p dist is not NULL, the
+ * Euclidean distances to all vertices are computed from the same inner
+ * products. This function doesn't allocate memory, see
+ * gensvm_predict_assign() for the details.
+ *
+ * @param[in] 	ZV 	simplex space vectors of the instances (n x (K-1))
+ * @param[in] 	U 	simplex matrix (K x (K-1))
+ * @param[in] 	n 	number of instances
+ * @param[in] 	K 	number of classes
+ * @param[in] 	S 	work array of length #GENSVM_BLOCK_SIZE * K
+ * @param[out] 	predy 	vector for the predicted labels
+ * @param[out] 	dist 	n x K matrix for the distances to the simplex
+ * 			vertices, or NULL
+ */
+void gensvm_predict_assign_rows(const double *ZV, const double *U, long n,
+		long K, double *S, long *predy, double *dist)
+{
+	long i, j, label, blk_start, blk_end;
+	double max_dot, z_norm, *row = NULL;
+	double u_norm = cblas_ddot(K-1, U, 1, U, 1);
+
+	for (blk_start=0; blk_start<n; blk_start+=GENSVM_BLOCK_SIZE) {
+		blk_end = minimum(n, blk_start + GENSVM_BLOCK_SIZE);
+
+		// S = ZV * U' for the instances in the block
+		cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasTrans,
+				blk_end - blk_start, K, K-1, 1.0,
+				&ZV[blk_start*(K-1)], K-1, U, K-1, 0.0, S, K);
+
+		for (i=blk_start; i<blk_end; i++) {
+			row = &S[(i - blk_start)*K];
+			label = 0;
+			max_dot = row[0];
+			for (j=1; j<K; j++) {
+				if (row[j] > max_dot) {
+					label = j;
+					max_dot = row[j];
+				}
+			}
+			predy[i] = label + 1;
+
+			if (dist == NULL)
+				continue;
+			z_norm = cblas_ddot(K-1, &ZV[i*(K-1)], 1,
+					&ZV[i*(K-1)], 1);
+			for (j=0; j<K; j++)
+				dist[i*K+j] = sqrt(maximum(0.0,
+							z_norm - 2*row[j] +
+							u_norm));
+		}
+	}
+}
+
+/**
+ * @brief Assign labels to a range of instances
+ *
+ * @param[in,out] 	arg 	the GenPredictChunk to assign labels for
+ * @returns 			NULL
+ */
+static void *gensvm_predict_assign_chunk(void *arg)
+{
+	struct GenPredictChunk *chunk = arg;
+
+	gensvm_predict_assign_rows(&chunk->ZV[chunk->start*(chunk->K-1)],
+			chunk->U, chunk->end - chunk->start, chunk->K,
+			chunk->S, &chunk->predy[chunk->start],
+			(chunk->dist != NULL) ?
+			&chunk->dist[chunk->start*chunk->K] : NULL);
+
+	return NULL;
+}
+
+/**
+ * @brief Size of the arena needed to assign labels
+ *
+ * @details
+ * This gives the number of bytes that gensvm_predict_assign() takes from
+ * the arena of the context for @p n instances, when it uses the largest
+ * number of threads it would use for @p n instances.
+ *
+ * @param[in] 	n 	number of instances
+ * @param[in] 	K 	number of classes
+ * @returns 		number of bytes to reserve in the arena
+ */
+size_t gensvm_predict_assign_size(long n, long K)
+{
+	long n_threads = 1 + n / GENSVM_PREDICT_MIN_ROWS;
+
+	return gensvm_arena_size(n_threads, sizeof(struct GenPredictChunk)) +
+		gensvm_arena_size(n_threads, sizeof(pthread_t)) +
+		gensvm_arena_size(n_threads*GENSVM_BLOCK_SIZE*K,
+				sizeof(double));
+}
+
+/**
+ * @brief Assign class labels to the nearest simplex vertex
+ *
+ * @details
+ * All vertices of the simplex have the same norm, so the squared distance
+ * @f$ \|z - u_j\|^2 = \|z\|^2 - 2 z'u_j + \|u_j\|^2 @f$ is smallest for
+ * the vertex with the largest inner product @f$ z'u_j @f$. These inner
+ * products are computed with a matrix product, and large sets of instances
+ * are split over several threads. The distances themselves are only
+ * computed if @p dist is not NULL.
+ *
+ * The ranges of the threads start at a multiple of #GENSVM_ALIGN /
+ * sizeof(long) instances, such that threads don't write to the same cache
+ * line of @p predy or @p dist if these are aligned.
+ *
+ * The number of threads is limited by the thread budget of the context, so
+ * a caller that already runs in a worker thread should pass a context with
+ * GenContext::n_threads set to 1. The work arrays of the threads are taken
+ * from the arena of the context if it has one (see
+ * gensvm_predict_assign_size()), and are given back before returning.
+ *
+ * @param[in] 	ZV 	simplex space vectors of the instances (n x (K-1))
+ * @param[in] 	U 	simplex matrix (K x (K-1))
+ * @param[in] 	n 	number of instances
+ * @param[in] 	K 	number of classes
+ * @param[out] 	predy 	pre-allocated vector for the predicted labels
+ * @param[out] 	dist 	pre-allocated n x K matrix for the distances to the
+ * 			simplex vertices, or NULL
+ * @param[in] 	ctx 	the GenContext, or NULL to use all processors
+ */
+void gensvm_predict_assign(double *ZV, double *U, long n, long K,
+		long *predy, double *dist, struct GenContext *ctx)
+{
+	long t, step = GENSVM_ALIGN / sizeof(long),
+	     n_threads = gensvm_context_threads(ctx,
+			1 + n / GENSVM_PREDICT_MIN_ROWS);
+	size_t mark = 0;
+	double *S = NULL;
+	pthread_t *threads = NULL;
+	struct GenPredictChunk *chunks = NULL;
+	struct GenArena *arena = gensvm_context_arena(ctx);
+
+	if (arena != NULL) {
+		mark = gensvm_arena_mark(arena);
+		chunks = ArenaCalloc(arena, struct GenPredictChunk,
+				n_threads);
+		threads = ArenaCalloc(arena, pthread_t, n_threads);
+		S = ArenaCalloc(arena, double,
+				n_threads*GENSVM_BLOCK_SIZE*K);
+	} else {
+		chunks = Malloc(struct GenPredictChunk, n_threads);
+		threads = Malloc(pthread_t, n_threads);
+		S = AlignedMalloc(double, n_threads*GENSVM_BLOCK_SIZE*K);
+	}
+
+	for (t=0; t<n_threads; t++) {
+		chunks[t].ZV = ZV;
+		chunks[t].U = U;
+		chunks[t].K = K;
+		chunks[t].start = (t * n / n_threads) / step * step;
+		chunks[t].end = (t + 1 == n_threads) ? n :
+			((t + 1) * n / n_threads) / step * step;
+		chunks[t].predy = predy;
+		chunks[t].dist = dist;
+		chunks[t].S = S + t*GENSVM_BLOCK_SIZE*K;
+	}
+
+	if (n_threads == 1) {
+		gensvm_predict_assign_chunk(&chunks[0]);
+	} else {
+		for (t=0; t<n_threads; t++) {
+			if (pthread_create(&threads[t], NULL,
+						gensvm_predict_assign_chunk,
+						&chunks[t]) != 0) {
+				// LCOV_EXCL_START
+				gensvm_error(ctx, "[GenSVM Error]: Couldn't "
+						"create thread\n");
+				exit(EXIT_FAILURE);
+				// LCOV_EXCL_STOP
+			}
+		}
+		for (t=0; t<n_threads; t++)
+			pthread_join(threads[t], NULL);
+	}
+
+	if (arena != NULL) {
+		gensvm_arena_release(arena, mark);
+	} else {
+		Free(threads);
+		Free(chunks);
+		Free(S);
+	}
+}
+
+/**
+ * @brief Convert distances to the simplex vertices to class probabilities
+ *
+ * @details
+ * The probability of class @f$ k @f$ is the softmax over the negative
+ * distances, @f$ p_k = \exp(-d_k/T) / \sum_j \exp(-d_j/T) @f$, where
+ * @f$ T @f$ is the temperature (see gensvm_fit_temperature()). The
+ * smallest distance is subtracted before the exponent is taken, to avoid
+ * underflow. The conversion is done in place.
+ *
+ * @param[in,out] 	P 		n x K matrix of distances, on exit the
+ * 					class probabilities
+ * @param[in] 		n 		number of instances
+ * @param[in] 		K 		number of classes
+ * @param[in] 		temperature 	temperature of the softmax
+ */
+void gensvm_predict_softmax(double *P, long n, long K, double temperature)
+{
+	long i, j;
+	double d_min, sum, *row = NULL;
+
+	for (i=0; i<n; i++) {
+		row = &P[i*K];
+		d_min = row[0];
+		for (j=1; j<K; j++)
+			d_min = minimum(d_min, row[j]);
+		sum = 0;
+		for (j=0; j<K; j++) {
+			row[j] = exp(-(row[j] - d_min)/temperature);
+			sum += row[j];
+		}
+		for (j=0; j<K; j++)
+			row[j] /= sum;
+	}
+}
+
+/**
+ * @brief Derivatives of the negative log-likelihood of the temperature
+ *
+ * @details
+ * See gensvm_fit_temperature().
+ *
+ * @param[in] 	dist 	n x K matrix of distances to the simplex vertices
+ * @param[in] 	y 	true class labels of the instances (1..K)
+ * @param[in] 	n 	number of instances
+ * @param[in] 	K 	number of classes
+ * @param[in] 	beta 	inverse of the temperature
+ * @param[out] 	hess 	second derivative with respect to beta
+ * @returns 		first derivative with respect to beta
+ */
+static double gensvm_temperature_grad(const double *dist, const long *y,
+		long n, long K, double beta, double *hess)
+{
+	long i, j;
+	double d_min, sum, mean, sq, e, grad = 0;
+	const double *row = NULL;
+
+	*hess = 0;
+	for (i=0; i<n; i++) {
+		row = &dist[i*K];
+		d_min = row[0];
+		for (j=1; j<K; j++)
+			d_min = minimum(d_min, row[j]);
+		sum = mean = sq = 0;
+		for (j=0; j<K; j++) {
+			e = exp(-beta*(row[j] - d_min));
+			sum += e;
+			mean += e*row[j];
+			sq += e*row[j]*row[j];
+		}
+		mean /= sum;
+		sq /= sum;
+		grad += row[y[i]-1] - mean;
+		*hess += sq - mean*mean;
+	}
+	return grad;
+}
+
+/**
+ * @brief Fit the temperature of the class probabilities
+ *
+ * @details
+ * The temperature @f$ T @f$ of gensvm_predict_softmax() is chosen to
+ * minimize the negative log-likelihood of the true labels of held-out
+ * instances. In terms of @f$ \beta = 1/T @f$ this function is convex,
+ * with first derivative @f$ \sum_i (d_{i,y_i} - E_p[d_i]) @f$ and second
+ * derivative @f$ \sum_i \textrm{Var}_p[d_i] @f$, where the expectation
+ * and variance are taken over the class probabilities of instance @f$ i
+ * @f$. The root of the first derivative is found with Newton's method,
+ * starting from @f$ T = 1 @f$, and a bisection step is taken whenever the
+ * Newton step leaves the bracket of the root.
+ *
+ * The temperature is kept between #GENSVM_MIN_TEMPERATURE and
+ * #GENSVM_MAX_TEMPERATURE. The minimum is returned for instance when all
+ * held-out instances are clearly classified correctly. If the distances of
+ * every instance to all vertices are equal the temperature doesn't matter,
+ * and 1.0 is returned.
+ *
+ * @param[in] 	dist 	n x K matrix of distances to the simplex vertices
+ * @param[in] 	y 	true class labels of the instances (1..K)
+ * @param[in] 	n 	number of instances
+ * @param[in] 	K 	number of classes
+ * @returns 		the fitted temperature
+ */
+double gensvm_fit_temperature(const double *dist, const long *y, long n,
+		long K)
+{
+	long iter;
+	double beta = 1.0, beta_new, grad, hess,
+	       lo = 1.0/GENSVM_MAX_TEMPERATURE,
+	       hi = 1.0/GENSVM_MIN_TEMPERATURE;
+
+	// all distances are equal
+	gensvm_temperature_grad(dist, y, n, K, beta, &hess);
+	if (hess <= 0)
+		return 1.0;
+
+	// the minimum is at one of the bounds
+	if (gensvm_temperature_grad(dist, y, n, K, hi, &hess) <= 0)
+		return 1.0/hi;
+	if (gensvm_temperature_grad(dist, y, n, K, lo, &hess) >= 0)
+		return 1.0/lo;
+
+	for (iter=0; iter<100; iter++) {
+		grad = gensvm_temperature_grad(dist, y, n, K, beta, &hess);
+		if (grad == 0)
+			break;
+		if (grad < 0)
+			lo = beta;
+		else
+			hi = beta;
+
+		beta_new = (hess > 0) ? beta - grad/hess : 0;
+		if (beta_new <= lo || beta_new >= hi)
+			beta_new = sqrt(lo*hi);
+		if (fabs(beta_new - beta) <= 1e-12*beta) {
+			beta = beta_new;
+			break;
+		}
+		beta = beta_new;
+	}
+
+	return 1.0/beta;
+}
+
+/**
+ * @brief Predict class labels and the values of a prediction format
  *
  * @details
  * The labels are predicted by mapping each instance in data to the
  * simplex space using the matrix V in the given model. Next, for each
  * instance the nearest simplex vertex is determined using an Euclidean
- * norm. The nearest simplex vertex determines the predicted class label,
- * which is recorded in predy.
+ * norm, see gensvm_predict_assign(). The nearest simplex vertex determines
+ * the predicted class label, which is recorded in predy.
+ *
+ * Depending on the format, the following values are written to @p values
+ * in the same pass over the data:
+ *
+ * - #P_DECISION: the n x (K-1) simplex space vectors of the instances.
+ * - #P_DISTANCES: the n x K distances to the simplex vertices.
+ * - #P_PROBABILITIES: the n x K class probabilities, computed from the
+ *   distances with gensvm_predict_softmax() and GenModel::temperature.
+ *
+ * For the other formats no values are computed and @p values can be NULL.
  *
  * @param[in] 	testdata 	GenData to predict labels for
  * @param[in] 	model 		GenModel with optimized V
+ * @param[in] 	format 		format of the prediction output
  * @param[out] 	predy 		pre-allocated vector to record predictions in
+ * @param[out] 	values 		pre-allocated matrix for the values of the
+ * 				format, or NULL
  */
-void gensvm_predict_labels(struct GenData *testdata, struct GenModel *model,
-		long *predy)
+void gensvm_predict_values(struct GenData *testdata, struct GenModel *model,
+		PredictionFormat format, long *predy, double *values)
 {
-	long i, j, k, n, K, label;
-	double norm, min_dist,
-	       *S = NULL,
-	       *ZV = NULL;
-
-	n = testdata->n;
-	K = model->K;
+	long n = testdata->n,
+	     K = model->K;
+	bool want_dist = (format == P_DISTANCES ||
+			format == P_PROBABILITIES);
+	double *ZV = (format == P_DECISION) ? values :
+		AlignedCalloc(double, n*(K-1));
 
-	// allocate necessary memory
-	S = Calloc(double, K-1);
-	ZV = Calloc(double, n*(K-1));
-
-	// Generate the simplex matrix
+	// Generate the simplex matrix, a model read from file has no U yet
+	if (model->U == NULL)
+		model->U = Calloc(double, K*(K-1));
 	gensvm_simplex(model);
 
 	// Generate the simplex space vectors
 	gensvm_calculate_ZV(model, testdata, ZV);
 
-	// Calculate the distance to each of the vertices of the simplex.
-	// The closest vertex defines the class label
-	for (i=0; i<n; i++) {
-		label = 0;
-		min_dist = INFINITY;
-		for (j=0; j<K; j++) {
-			for (k=0; k<K-1; k++) {
-				S[k] = matrix_get(ZV, K-1, i, k) -
-					matrix_get(model->U, K-1, j, k);
-			}
-			norm = cblas_dnrm2(K-1, S, 1);
-			if (norm < min_dist) {
-				label = j+1;
-				min_dist = norm;
-			}
-		}
-		predy[i] = label;
-	}
+	// The closest simplex vertex defines the class label
+	gensvm_predict_assign(ZV, model->U, n, K, predy,
+			want_dist ? values : NULL, NULL);
 
-	free(ZV);
-	free(S);
+	if (format == P_PROBABILITIES)
+		gensvm_predict_softmax(values, n, K, model->temperature);
+
+	if (format != P_DECISION)
+		Free(ZV);
+}
+
+/**
+ * @brief Predict class labels of data given and output in predy
+ *
+ * @details
+ * This is gensvm_predict_values() without any values besides the labels.
+ *
+ * @param[in] 	testdata 	GenData to predict labels for
+ * @param[in] 	model 		GenModel with optimized V
+ * @param[out] 	predy 		pre-allocated vector to record predictions in
+ */
+void gensvm_predict_labels(struct GenData *testdata, struct GenModel *model,
+		long *predy)
+{
+	gensvm_predict_values(testdata, model, P_LABELS, predy, NULL);
 }
 
 /**
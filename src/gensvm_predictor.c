@@ -0,0 +1,232 @@
+/**
+ * @file gensvm_predictor.c
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Functions for predicting batches of instances
+ *
+ * @details
+ * Predicting with gensvm_predict_labels() requires a GenData for the
+ * instances, and computes the simplex matrix and allocates its work arrays
+ * on every call. The GenPredictor is meant for serving predictions instead:
+ * it is prepared once from a trained model, after which batches of instances
+ * are predicted directly from arrays of rows without allocating memory.
+ *
+ * Dense instances are given as rows of m features, without the column of
+ * ones. Sparse instances are given in compressed row format, with column
+ * indices from 0 to m-1 that refer to the same features.
+ *
+ * Only linear models are supported, because the kernel of a nonlinear model
+ * would need the training data.
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "gensvm_predictor.h"
+
+/**
+ * @brief Create a predictor for a trained model
+ *
+ * @details
+ * The model coefficients are copied, so the model can be freed while the
+ * predictor is in use. Batches larger than max_rows are predicted in parts
+ * of max_rows instances.
+ *
+ * @param[in] 	model 		a trained linear GenModel
+ * @param[in] 	max_rows 	number of instances that are predicted at
+ * 				once, or a nonpositive value for
+ * 				#GENSVM_BLOCK_SIZE
+ * @returns 			the predictor, to be freed with
+ * 				gensvm_free_predictor(), or NULL if the
+ * 				model isn't a trained linear model
+ */
+struct GenPredictor *gensvm_init_predictor(struct GenModel *model,
+		long max_rows)
+{
+	long K = model->K,
+	     m = model->m;
+	struct GenModel *simplex = NULL;
+	struct GenPredictor *predictor = NULL;
+
+	if (model->kerneltype != K_LINEAR) {
+		err("[GenSVM Error]: A predictor can only be created for a "
+				"linear model.\n");
+		return NULL;
+	}
+	if (model->V == NULL || K < 2) {
+		err("[GenSVM Error]: A predictor needs a trained model.\n");
+		return NULL;
+	}
+
+	predictor = Malloc(struct GenPredictor, 1);
+	predictor->m = m;
+	predictor->K = K;
+	predictor->max_rows = (max_rows > 0) ? max_rows : GENSVM_BLOCK_SIZE;
+
+	predictor->V = Malloc(double, (m+1)*(K-1));
+	memcpy(predictor->V, model->V, (m+1)*(K-1)*sizeof(double));
+
+	predictor->U = Calloc(double, K*(K-1));
+	predictor->ZV = Calloc(double, predictor->max_rows*(K-1));
+	predictor->S = Calloc(double, GENSVM_BLOCK_SIZE*K);
+
+	// generate the simplex matrix without changing the model
+	simplex = gensvm_init_model();
+	simplex->K = K;
+	simplex->U = predictor->U;
+	gensvm_simplex(simplex);
+	simplex->U = NULL;
+	gensvm_free_model(simplex);
+
+	return predictor;
+}
+
+/**
+ * @brief Free a predictor
+ *
+ * @param[in] 	predictor 	the predictor to free, can be NULL
+ */
+void gensvm_free_predictor(struct GenPredictor *predictor)
+{
+	if (predictor == NULL)
+		return;
+	Free(predictor->V);
+	Free(predictor->U);
+	Free(predictor->ZV);
+	Free(predictor->S);
+	Free(predictor);
+}
+
+/**
+ * @brief Initialize the simplex space vectors with the bias
+ *
+ * @param[in] 	predictor 	the predictor
+ * @param[in] 	n 		number of instances
+ */
+static void gensvm_predictor_bias(struct GenPredictor *predictor, long n)
+{
+	long i, K = predictor->K;
+
+	for (i=0; i<n; i++)
+		memcpy(&predictor->ZV[i*(K-1)], predictor->V,
+				(K-1)*sizeof(double));
+}
+
+/**
+ * @brief Predict the labels of a batch of dense instances
+ *
+ * @details
+ * The simplex space vectors @f$ ZV @f$ are computed for at most
+ * GenPredictor::max_rows instances at a time, with a matrix-vector product
+ * for a single instance and a matrix product otherwise. The labels are then
+ * assigned with gensvm_predict_assign_rows().
+ *
+ * @param[in] 	predictor 	the predictor
+ * @param[in] 	rows 		instances in row-major order (n x m), without
+ * 				the column of ones
+ * @param[in] 	n 		number of instances
+ * @param[out] 	predy 		vector of length n for the predicted labels
+ */
+void gensvm_predict_batch(struct GenPredictor *predictor,
+		const double *rows, long n, long *predy)
+{
+	long start, size,
+	     m = predictor->m,
+	     K = predictor->K;
+
+	for (start=0; start<n; start+=predictor->max_rows) {
+		size = minimum(n - start, predictor->max_rows);
+		gensvm_predictor_bias(predictor, size);
+
+		if (size == 1) {
+			cblas_dgemv(CblasRowMajor, CblasTrans, m, K-1, 1.0,
+					&predictor->V[K-1], K-1,
+					&rows[start*m], 1, 1.0,
+					predictor->ZV, 1);
+		} else {
+			cblas_dgemm(CblasRowMajor, CblasNoTrans,
+					CblasNoTrans, size, K-1, m, 1.0,
+					&rows[start*m], m,
+					&predictor->V[K-1], K-1, 1.0,
+					predictor->ZV, K-1);
+		}
+
+		gensvm_predict_assign_rows(predictor->ZV, predictor->U, size,
+				K, predictor->S, &predy[start], NULL);
+	}
+}
+
+/**
+ * @brief Predict the labels of a batch of sparse instances
+ *
+ * @details
+ * The instances are given in compressed row format, as in GenSparse but
+ * without the column of ones. The simplex space vector of an instance is
+ * computed from the rows of the weight matrix of its nonzero features.
+ *
+ * The column indices are checked before anything is predicted, so that a
+ * batch with an index out of range can be rejected by the caller. In that
+ * case an error is printed and predy is left unchanged.
+ *
+ * @param[in] 	predictor 	the predictor
+ * @param[in] 	ia 		row offsets (length n+1), starting at ia[0]
+ * @param[in] 	ja 		column indices of the nonzeros, from 0 to m-1
+ * @param[in] 	values 		values of the nonzeros
+ * @param[in] 	n 		number of instances
+ * @param[out] 	predy 		vector of length n for the predicted labels
+ * @returns 			whether the labels were predicted
+ */
+bool gensvm_predict_batch_sparse(struct GenPredictor *predictor,
+		const long *ia, const long *ja, const double *values, long n,
+		long *predy)
+{
+	long i, j, jj, k, start, size,
+	     m = predictor->m,
+	     K = predictor->K;
+	double value, *zv = NULL,
+	       *v = NULL;
+
+	for (jj=ia[0]; jj<ia[n]; jj++) {
+		if (ja[jj] < 0 || ja[jj] >= m) {
+			err("[GenSVM Error]: Feature index %li is out of "
+					"range for %li features.\n", ja[jj], m);
+			return false;
+		}
+	}
+
+	for (start=0; start<n; start+=predictor->max_rows) {
+		size = minimum(n - start, predictor->max_rows);
+		gensvm_predictor_bias(predictor, size);
+
+		for (i=0; i<size; i++) {
+			zv = &predictor->ZV[i*(K-1)];
+			for (jj=ia[start+i]; jj<ia[start+i+1]; jj++) {
+				j = ja[jj];
+				value = values[jj];
+				v = &predictor->V[(j+1)*(K-1)];
+				for (k=0; k<K-1; k++)
+					zv[k] += value * v[k];
+			}
+		}
+
+		gensvm_predict_assign_rows(predictor->ZV, predictor->U, size,
+				K, predictor->S, &predy[start], NULL);
+	}
+	return true;
+}
@@ -0,0 +1,535 @@
+/**
+ * @file gensvm_quantize.c
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Functions for linear models with quantized coefficients
+ *
+ * @details
+ * Predicting with a linear model computes @f$ ZV @f$ and assigns every
+ * instance to the nearest simplex vertex. When a large number of instances
+ * is scored, the weights are read for every block of instances. The
+ * functions in this file store the weights as 8-bit integers with a scale
+ * for every column, or as 16-bit floating point numbers, which reduces the
+ * memory of the weights by a factor of eight or four.
+ *
+ * The weights are stored transposed, such that the decision value of an
+ * instance for a column of V is a dot product of two contiguous arrays. The
+ * dot products are written with independent partial sums, so that the
+ * compiler can vectorize them without reassociating a single sum. The
+ * scale of a column is applied once to the result of the dot product.
+ *
+ * gensvm_quant_compare() compares the predictions of a quantized model with
+ * those of the double precision model, for instance on a held-out test set.
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "gensvm_quantize.h"
+
+/**
+ * Largest finite half precision number
+ */
+#define GENSVM_HALF_MAX 65504.0
+
+/**
+ * @brief Quantize a linear model
+ *
+ * @details
+ * The bias and the simplex matrix are kept in double precision, and the
+ * weights are quantized as described in GenQuantModel. The model is not
+ * changed and can be freed while the quantized model is in use.
+ *
+ * @param[in] 	model 	a trained linear GenModel
+ * @param[in] 	type 	type of the quantization, #Q_INT8 or #Q_FLOAT16
+ * @returns 		the quantized model, to be freed with
+ * 			gensvm_free_quant_model()
+ */
+struct GenQuantModel *gensvm_quantize_model(struct GenModel *model,
+		QuantizeType type)
+{
+	long j, k,
+	     m = model->m,
+	     K = model->K;
+	double value, max_abs;
+	struct GenModel *simplex = NULL;
+	struct GenQuantModel *q = NULL;
+
+	if (model->kerneltype != K_LINEAR) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: Only linear models can be quantized.\n");
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
+	if (type != Q_INT8 && type != Q_FLOAT16) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: Unknown quantization type %i.\n", type);
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
+
+	q = Malloc(struct GenQuantModel, 1);
+	q->type = type;
+	q->m = m;
+	q->K = K;
+	q->temperature = model->temperature;
+	q->bias = Malloc(double, K-1);
+	q->scale = Malloc(double, K-1);
+	q->W8 = NULL;
+	q->W16 = NULL;
+	memcpy(q->bias, model->V, (K-1)*sizeof(double));
+
+	if (type == Q_INT8)
+		q->W8 = Malloc(int8_t, (K-1)*m);
+	else
+		q->W16 = Malloc(uint16_t, (K-1)*m);
+
+	for (k=0; k<K-1; k++) {
+		q->scale[k] = 1.0;
+		if (type == Q_FLOAT16) {
+			for (j=0; j<m; j++) {
+				value = matrix_get(model->V, K-1, j+1, k);
+				q->W16[k*m+j] = gensvm_double_to_half(value);
+			}
+			continue;
+		}
+
+		max_abs = 0;
+		for (j=0; j<m; j++) {
+			value = fabs(matrix_get(model->V, K-1, j+1, k));
+			max_abs = maximum(max_abs, value);
+		}
+		if (max_abs > 0)
+			q->scale[k] = max_abs/127.0;
+		for (j=0; j<m; j++) {
+			value = matrix_get(model->V, K-1, j+1, k);
+			q->W8[k*m+j] = (int8_t) round(value/q->scale[k]);
+		}
+	}
+
+	// generate the simplex matrix without changing the model
+	q->U = Calloc(double, K*(K-1));
+	simplex = gensvm_init_model();
+	simplex->K = K;
+	simplex->U = q->U;
+	gensvm_simplex(simplex);
+	simplex->U = NULL;
+	gensvm_free_model(simplex);
+
+	return q;
+}
+
+/**
+ * @brief Free a quantized model
+ *
+ * @param[in] 	q 	the quantized model to free, can be NULL
+ */
+void gensvm_free_quant_model(struct GenQuantModel *q)
+{
+	if (q == NULL)
+		return;
+	Free(q->bias);
+	Free(q->scale);
+	Free(q->W8);
+	Free(q->W16);
+	Free(q->U);
+	Free(q);
+}
+
+/**
+ * @brief Convert a number to half precision
+ *
+ * @details
+ * The number is rounded to the nearest half precision number, with ties to
+ * even. Numbers outside the range of half precision saturate to the largest
+ * finite number, because an infinite weight would make the model useless.
+ * NaN is kept.
+ *
+ * @param[in] 	value 	the number to convert
+ * @returns 		the bits of the half precision number
+ */
+uint16_t gensvm_double_to_half(double value)
+{
+	int exp, shift;
+	uint16_t sign = 0;
+	uint32_t bits, mant, half, rem;
+	float f;
+
+	if (isnan(value))
+		return 0x7e00;
+	if (value < 0) {
+		sign = 0x8000;
+		value = -value;
+	}
+	if (value >= GENSVM_HALF_MAX)
+		return sign | 0x7bff;
+
+	f = (float) value;
+	memcpy(&bits, &f, sizeof(bits));
+	exp = (int) ((bits >> 23) & 0xff) - 127 + 15;
+	mant = bits & 0x7fffff;
+
+	if (exp <= 0) {
+		// subnormal or zero
+		if (exp < -10)
+			return sign;
+		mant |= 0x800000;
+		shift = 14 - exp;
+		half = mant >> shift;
+		rem = mant & ((1u << shift) - 1);
+		if (rem > (1u << (shift - 1)) ||
+				(rem == (1u << (shift - 1)) && (half & 1)))
+			half++;
+		return sign | half;
+	}
+
+	half = ((uint32_t) exp << 10) | (mant >> 13);
+	rem = mant & 0x1fff;
+	if (rem > 0x1000 || (rem == 0x1000 && (half & 1)))
+		half++;
+	if (half >= 0x7c00)
+		half = 0x7bff;
+	return sign | half;
+}
+
+/**
+ * @brief Convert a half precision number to a float
+ *
+ * @details
+ * Normal numbers are converted by moving the exponent and the mantissa to
+ * their place in a float, the other numbers are rare in model weights.
+ *
+ * @param[in] 	half 	the bits of the half precision number
+ * @returns 		the number
+ */
+static inline float gensvm_half_to_float(uint16_t half)
+{
+	uint32_t bits,
+		 exp = (half >> 10) & 0x1f,
+		 mant = half & 0x3ff;
+	float f;
+
+	if (exp == 0) {
+		f = ldexpf((float) mant, -24);
+		return (half & 0x8000) ? -f : f;
+	}
+	if (exp == 31)
+		bits = ((uint32_t) (half & 0x8000) << 16) | 0x7f800000 |
+			(mant << 13);
+	else
+		bits = ((uint32_t) (half & 0x8000) << 16) |
+			((exp + 112) << 23) | (mant << 13);
+	memcpy(&f, &bits, sizeof(f));
+	return f;
+}
+
+/**
+ * @brief Convert a half precision number to double
+ *
+ * @param[in] 	half 	the bits of the half precision number
+ * @returns 		the number
+ */
+double gensvm_half_to_double(uint16_t half)
+{
+	return gensvm_half_to_float(half);
+}
+
+/**
+ * @brief Dot product of a row of data with int8 weights
+ *
+ * @param[in] 	x 	the row of data
+ * @param[in] 	w 	the weights
+ * @param[in] 	m 	length of the arrays
+ * @returns 		the dot product
+ */
+static double gensvm_quant_dot_int8(const double *x, const int8_t *w,
+		long m)
+{
+	long j;
+	double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+
+	for (j=0; j+3<m; j+=4) {
+		s0 += x[j] * w[j];
+		s1 += x[j+1] * w[j+1];
+		s2 += x[j+2] * w[j+2];
+		s3 += x[j+3] * w[j+3];
+	}
+	for (; j<m; j++)
+		s0 += x[j] * w[j];
+	return (s0 + s1) + (s2 + s3);
+}
+
+/**
+ * @brief Dot product of a row of data with float16 weights
+ *
+ * @param[in] 	x 	the row of data
+ * @param[in] 	w 	the weights
+ * @param[in] 	m 	length of the arrays
+ * @returns 		the dot product
+ */
+static double gensvm_quant_dot_half(const double *x, const uint16_t *w,
+		long m)
+{
+	long j;
+	double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+
+	for (j=0; j+3<m; j+=4) {
+		s0 += x[j] * gensvm_half_to_float(w[j]);
+		s1 += x[j+1] * gensvm_half_to_float(w[j+1]);
+		s2 += x[j+2] * gensvm_half_to_float(w[j+2]);
+		s3 += x[j+3] * gensvm_half_to_float(w[j+3]);
+	}
+	for (; j<m; j++)
+		s0 += x[j] * gensvm_half_to_float(w[j]);
+	return (s0 + s1) + (s2 + s3);
+}
+
+/**
+ * @brief Compute the decision values of one sparse instance
+ *
+ * @param[in] 	q 	the quantized model
+ * @param[in] 	sp 	the sparse data, with the column of ones
+ * @param[in] 	i 	index of the instance
+ * @param[out] 	zv 	the K-1 decision values of the instance
+ */
+static void gensvm_quant_zv_sparse(struct GenQuantModel *q,
+		struct GenSparse *sp, long i, double *zv)
+{
+	long j, jj, k,
+	     m = q->m,
+	     K = q->K;
+	double value, z_ij;
+
+	for (k=0; k<K-1; k++) {
+		value = 0;
+		for (jj=sp->ia[i]; jj<sp->ia[i+1]; jj++) {
+			j = sp->ja[jj];
+			z_ij = sp->values[jj];
+			if (j == 0)
+				zv[k] += z_ij * q->bias[k];
+			else if (q->type == Q_INT8)
+				value += z_ij * q->W8[k*m+j-1];
+			else
+				value += z_ij * gensvm_half_to_float(
+						q->W16[k*m+j-1]);
+		}
+		zv[k] += q->scale[k] * value;
+	}
+}
+
+/**
+ * @brief Compute the decision values with a quantized model
+ *
+ * @details
+ * This is the equivalent of gensvm_calculate_ZV() for a quantized model.
+ * The data is processed in blocks of #GENSVM_BLOCK_SIZE rows, such that a
+ * streamed data file (see GenData::out_of_core) is read once.
+ *
+ * @param[in] 	q 	the quantized model
+ * @param[in] 	data 	the data, with the column of ones
+ * @param[out] 	ZV 	pre-allocated matrix for the decision values
+ * 			(n x (K-1))
+ */
+void gensvm_quant_calculate_ZV(struct GenQuantModel *q,
+		struct GenData *data, double *ZV)
+{
+	long i, k, blk_start, blk_end,
+	     n = data->n,
+	     m = q->m,
+	     K = q->K;
+	double value, *x = NULL,
+	       *zv = NULL;
+
+	for (blk_start=0; blk_start<n; blk_start+=GENSVM_BLOCK_SIZE) {
+		blk_end = minimum(n, blk_start + GENSVM_BLOCK_SIZE);
+		gensvm_stream_prefetch(data, blk_end,
+				blk_end + GENSVM_BLOCK_SIZE);
+
+		for (i=blk_start; i<blk_end; i++) {
+			zv = &ZV[i*(K-1)];
+			if (data->Z == NULL) {
+				memset(zv, 0, (K-1)*sizeof(double));
+				gensvm_quant_zv_sparse(q, data->spZ, i, zv);
+				continue;
+			}
+			x = &data->Z[i*(m+1)];
+			for (k=0; k<K-1; k++) {
+				if (q->type == Q_INT8)
+					value = gensvm_quant_dot_int8(&x[1],
+							&q->W8[k*m], m);
+				else
+					value = gensvm_quant_dot_half(&x[1],
+							&q->W16[k*m], m);
+				zv[k] = x[0] * q->bias[k] + q->scale[k] * value;
+			}
+		}
+
+		gensvm_stream_release(data, blk_start, blk_end);
+	}
+}
+
+/**
+ * @brief Predict class labels and the values of a prediction format with a
+ * quantized model
+ *
+ * @details
+ * This is the equivalent of gensvm_predict_values() for a quantized model,
+ * see that function for the values that are computed for every format.
+ *
+ * @param[in] 	q 		the quantized model
+ * @param[in] 	testdata 	GenData to predict labels for
+ * @param[in] 	format 		format of the prediction output
+ * @param[out] 	predy 		pre-allocated vector to record predictions in
+ * @param[out] 	values 		pre-allocated matrix for the values of the
+ * 				format, or NULL
+ */
+void gensvm_quant_predict_values(struct GenQuantModel *q,
+		struct GenData *testdata, PredictionFormat format, long *predy,
+		double *values)
+{
+	long n = testdata->n,
+	     K = q->K;
+	bool want_dist = (format == P_DISTANCES ||
+			format == P_PROBABILITIES);
+	double *ZV = (format == P_DECISION) ? values :
+		Calloc(double, n*(K-1));
+
+	gensvm_quant_calculate_ZV(q, testdata, ZV);
+	gensvm_predict_assign(ZV, q->U, n, K, predy,
+			want_dist ? values : NULL, NULL);
+
+	if (format == P_PROBABILITIES)
+		gensvm_predict_softmax(values, n, K, q->temperature);
+
+	if (format != P_DECISION)
+		Free(ZV);
+}
+
+/**
+ * @brief Initialize a comparison report of a quantized model
+ *
+ * @returns 	an empty report
+ */
+struct GenQuantReport *gensvm_init_quant_report(void)
+{
+	struct GenQuantReport *report = Malloc(struct GenQuantReport, 1);
+
+	report->n = 0;
+	report->n_agree = 0;
+	report->n_labeled = 0;
+	report->n_correct = 0;
+	report->n_correct_quant = 0;
+	report->max_error = 0;
+	report->sum_sq_error = 0;
+
+	return report;
+}
+
+/**
+ * @brief Free a comparison report
+ *
+ * @param[in] 	report 	the report to free, can be NULL
+ */
+void gensvm_free_quant_report(struct GenQuantReport *report)
+{
+	Free(report);
+}
+
+/**
+ * @brief Compare the predictions of a quantized model with the double
+ * precision model
+ *
+ * @details
+ * The labels and the decision values of both models are computed for the
+ * data and the differences are added to the report. If the data has labels,
+ * the number of correct labels of both models is counted as well.
+ *
+ * @param[in,out] 	report 	the report to add the data to
+ * @param[in] 		q 	the quantized model
+ * @param[in] 		model 	the model that was quantized
+ * @param[in] 		data 	the data, with the column of ones
+ */
+void gensvm_quant_compare(struct GenQuantReport *report,
+		struct GenQuantModel *q, struct GenModel *model,
+		struct GenData *data)
+{
+	long i, k,
+	     n = data->n,
+	     K = q->K;
+	double diff;
+	long *predy = Calloc(long, n),
+	     *quant_predy = Calloc(long, n);
+	double *ZV = Calloc(double, n*(K-1)),
+	       *quant_ZV = Calloc(double, n*(K-1));
+
+	gensvm_predict_values(data, model, P_DECISION, predy, ZV);
+	gensvm_quant_predict_values(q, data, P_DECISION, quant_predy,
+			quant_ZV);
+
+	for (i=0; i<n; i++) {
+		report->n_agree += (predy[i] == quant_predy[i]);
+		for (k=0; k<K-1; k++) {
+			diff = fabs(ZV[i*(K-1)+k] - quant_ZV[i*(K-1)+k]);
+			report->max_error = maximum(report->max_error, diff);
+			report->sum_sq_error += diff * diff;
+		}
+		if (data->y == NULL)
+			continue;
+		report->n_labeled++;
+		report->n_correct += (predy[i] == data->y[i]);
+		report->n_correct_quant += (quant_predy[i] == data->y[i]);
+	}
+	report->n += n;
+
+	Free(predy);
+	Free(quant_predy);
+	Free(ZV);
+	Free(quant_ZV);
+}
+
+/**
+ * @brief Print a comparison report
+ *
+ * @param[in] 	report 	the report
+ * @param[in] 	q 	the quantized model
+ */
+void gensvm_quant_report(struct GenQuantReport *report,
+		struct GenQuantModel *q)
+{
+	double rms = 0;
+
+	if (report->n == 0)
+		return;
+	rms = sqrt(report->sum_sq_error / (report->n * (q->K - 1)));
+
+	note("Quantized model (%s, %li bytes of weights instead of %li):\n",
+			(q->type == Q_INT8) ? "int8" : "float16",
+			q->m * (q->K - 1) * ((q->type == Q_INT8) ? 1 : 2),
+			q->m * (q->K - 1) * (long) sizeof(double));
+	note("  labels agree with the double model for %3.2f%% of %li "
+			"instances\n", 100.0 * report->n_agree / report->n,
+			report->n);
+	note("  decision values differ by at most %g (RMS %g)\n",
+			report->max_error, rms);
+	if (report->n_labeled > 0)
+		note("  predictive performance %3.2f%% (double model: "
+				"%3.2f%%)\n", 100.0 *
+				report->n_correct_quant / report->n_labeled,
+				100.0 * report->n_correct / report->n_labeled);
+}
@@ -62,8 +62,8 @@ void gensvm_free_queue(struct GenQueue *q)
 	for (i=0; i<q->N; i++) {
 		gensvm_free_task(q->tasks[i]);
 	}
-	free(q->tasks);
-	free(q);
+	Free(q->tasks);
+	Free(q);
 	q = NULL;
 }
 
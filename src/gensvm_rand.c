@@ -0,0 +1,193 @@
+/**
+ * @file gensvm_rand.c
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Functions for generating random numbers
+ *
+ * @details
+ * This file contains a small pseudo-random number generator with an explicit
+ * state, which is used instead of rand() where reproducibility across
+ * threads and processes is needed. The generator is xoshiro256** by Blackman
+ * and Vigna, which is seeded through the splitmix64 generator. Bounded
+ * integers are drawn with the multiply-and-reject method of Lemire, which
+ * avoids the bias of the modulo operator and is cheaper than a division in
+ * the common case.
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "gensvm_rand.h"
+
+/**
+ * @brief Advance a splitmix64 state and return the next output
+ *
+ * @param[in,out] 	x 	the splitmix64 state
+ * @returns 			the next output of splitmix64
+ */
+static uint64_t gensvm_splitmix64(uint64_t *x)
+{
+	uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+/**
+ * @brief Rotate a 64-bit integer to the left
+ *
+ * @param[in] 	x 	the integer
+ * @param[in] 	k 	number of bits to rotate
+ * @returns 		the rotated integer
+ */
+static inline uint64_t gensvm_rotl(const uint64_t x, int k)
+{
+	return (x << k) | (x >> (64 - k));
+}
+
+/**
+ * @brief Initialize a GenRNG structure
+ *
+ * @param[in] 	seed 	the seed of the generator
+ * @returns 		initialized and seeded GenRNG
+ */
+struct GenRNG *gensvm_init_rng(uint64_t seed)
+{
+	struct GenRNG *rng = Malloc(struct GenRNG, 1);
+	gensvm_rng_seed(rng, seed);
+	return rng;
+}
+
+/**
+ * @brief Free a GenRNG structure
+ *
+ * @param[in] 	rng 	GenRNG to free
+ */
+void gensvm_free_rng(struct GenRNG *rng)
+{
+	Free(rng);
+	rng = NULL;
+}
+
+/**
+ * @brief Seed the random number generator
+ *
+ * @details
+ * The 256-bit state is filled with four outputs of splitmix64 started at the
+ * seed, as recommended by the authors of xoshiro256**. This guarantees that
+ * the state is never all zero, and that similar seeds give unrelated
+ * streams.
+ *
+ * @param[in,out] 	rng 	the GenRNG to seed
+ * @param[in] 		seed 	the seed
+ */
+void gensvm_rng_seed(struct GenRNG *rng, uint64_t seed)
+{
+	int i;
+	uint64_t x = seed;
+
+	for (i=0; i<4; i++)
+		rng->s[i] = gensvm_splitmix64(&x);
+}
+
+/**
+ * @brief Derive the seed of a substream from a base seed
+ *
+ * @details
+ * This is used to give every repeat or task its own reproducible stream,
+ * which only depends on the base seed and the index of the stream, and not
+ * on the order in which the streams are used.
+ *
+ * @param[in] 	seed 	the base seed
+ * @param[in] 	stream 	index of the substream
+ * @returns 		seed for the substream
+ */
+uint64_t gensvm_rng_derive(uint64_t seed, uint64_t stream)
+{
+	uint64_t x = seed ^ gensvm_splitmix64(&stream);
+	return gensvm_splitmix64(&x);
+}
+
+/**
+ * @brief Draw the next 64-bit random integer
+ *
+ * @param[in,out] 	rng 	the GenRNG
+ * @returns 			a uniformly distributed 64-bit integer
+ */
+uint64_t gensvm_rng_next(struct GenRNG *rng)
+{
+	uint64_t *s = rng->s;
+	const uint64_t result = gensvm_rotl(s[1] * 5, 7) * 9;
+	const uint64_t t = s[1] << 17;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = gensvm_rotl(s[3], 45);
+
+	return result;
+}
+
+/**
+ * @brief Draw a random integer in the range [0, bound)
+ *
+ * @details
+ * For bounds below @f$ 2^{32} @f$ Lemire's method is used: the product of
+ * a 32-bit random number and the bound is computed, and the high 32 bits are
+ * the result. The low 32 bits are used to reject the few values that would
+ * make the result biased, which requires a division only rarely. For larger
+ * bounds a threshold rejection method with the modulo operator is used.
+ *
+ * @param[in,out] 	rng 	the GenRNG
+ * @param[in] 		bound 	the upper bound (exclusive), must be positive
+ * @returns 			a uniformly distributed integer in [0, bound)
+ */
+uint64_t gensvm_rng_bounded(struct GenRNG *rng, uint64_t bound)
+{
+	uint64_t x, m, t;
+
+	if (bound > UINT32_MAX) {
+		t = (-bound) % bound;
+		do {
+			x = gensvm_rng_next(rng);
+		} while (x < t);
+		return x % bound;
+	}
+
+	m = (gensvm_rng_next(rng) >> 32) * bound;
+	if ((uint32_t) m < bound) {
+		t = ((uint32_t) -bound) % bound;
+		while ((uint32_t) m < t)
+			m = (gensvm_rng_next(rng) >> 32) * bound;
+	}
+	return m >> 32;
+}
+
+/**
+ * @brief Draw a random double in the range [0, 1)
+ *
+ * @param[in,out] 	rng 	the GenRNG
+ * @returns 			a uniformly distributed double in [0, 1)
+ */
+double gensvm_rng_uniform(struct GenRNG *rng)
+{
+	return (gensvm_rng_next(rng) >> 11) * 0x1.0p-53;
+}
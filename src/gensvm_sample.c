@@ -0,0 +1,417 @@
+/**
+ * @file gensvm_sample.c
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Functions for random and quasi-random search
+ *
+ * @details
+ * The full grid search enumerates the Cartesian product of all parameter
+ * values in the grid file, which grows quickly with the number of
+ * parameters. The functions in this file create a GenQueue of a fixed size
+ * instead, by sampling the parameters in the ranges given in the grid file.
+ * Three samplers are available: uniform random sampling, the Sobol sequence,
+ * and the Halton sequence. The latter two are low-discrepancy sequences,
+ * which cover the parameter space more evenly than random points.
+ *
+ * The Sobol sequence uses the direction numbers of Joe and Kuo (2008),
+ * <em>Constructing Sobol sequences with better two-dimensional
+ * projections</em>, SIAM J. Sci. Comput. 30, 2635-2654.
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+
+#include "gensvm_sample.h"
+
+/**
+ * Primitive polynomials and initial direction numbers of the Sobol sequence
+ * for dimensions 2 to #GENSVM_SAMPLE_MAX_DIM, from the new-joe-kuo-6.21201
+ * table. The first dimension is the van der Corput sequence in base 2.
+ */
+static const struct {
+	int s;
+	int a;
+	uint32_t m[5];
+} gensvm_sobol_table[GENSVM_SAMPLE_MAX_DIM-1] = {
+	{1, 0, {1}},
+	{2, 1, {1, 3}},
+	{3, 1, {1, 3, 1}},
+	{3, 2, {1, 1, 1}},
+	{4, 1, {1, 1, 3, 3}},
+	{4, 4, {1, 3, 5, 13}},
+	{5, 2, {1, 1, 5, 5, 17}}
+};
+
+/**
+ * The first #GENSVM_SAMPLE_MAX_DIM primes, used as the bases of the Halton
+ * sequence
+ */
+static const int gensvm_halton_primes[GENSVM_SAMPLE_MAX_DIM] = {
+	2, 3, 5, 7, 11, 13, 17, 19
+};
+
+/**
+ * @brief Initialize a Sobol sequence generator
+ *
+ * @details
+ * The direction numbers of every dimension are computed from the recurrence
+ * of its primitive polynomial. The first point of the sequence is the
+ * origin.
+ *
+ * @param[in] 	dim 	dimension of the points, at most
+ * 			#GENSVM_SAMPLE_MAX_DIM
+ * @returns 		initialized GenSobol
+ */
+struct GenSobol *gensvm_init_sobol(long dim)
+{
+	long d, k, l, s, a,
+	     n = maximum(dim, 1);
+	uint32_t *V = NULL;
+	struct GenSobol *sobol = NULL;
+
+	if (dim > GENSVM_SAMPLE_MAX_DIM) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: The Sobol sequence is only available "
+				"up to dimension %i\n", GENSVM_SAMPLE_MAX_DIM);
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
+
+	sobol = Malloc(struct GenSobol, 1);
+	sobol->dim = dim;
+	sobol->index = 0;
+	sobol->V = Calloc(uint32_t, n*GENSVM_SOBOL_BITS);
+	sobol->X = Calloc(uint32_t, n);
+
+	for (d=0; d<dim; d++) {
+		V = sobol->V + d*GENSVM_SOBOL_BITS;
+		if (d == 0) {
+			for (k=0; k<GENSVM_SOBOL_BITS; k++)
+				V[k] = 1u << (GENSVM_SOBOL_BITS - 1 - k);
+			continue;
+		}
+		s = gensvm_sobol_table[d-1].s;
+		a = gensvm_sobol_table[d-1].a;
+		for (k=0; k<s; k++)
+			V[k] = gensvm_sobol_table[d-1].m[k] <<
+				(GENSVM_SOBOL_BITS - 1 - k);
+		for (k=s; k<GENSVM_SOBOL_BITS; k++) {
+			V[k] = V[k-s] ^ (V[k-s] >> s);
+			for (l=1; l<s; l++)
+				if ((a >> (s - 1 - l)) & 1)
+					V[k] ^= V[k-l];
+		}
+	}
+
+	return sobol;
+}
+
+/**
+ * @brief Free a GenSobol structure
+ *
+ * @param[in] 	sobol 	GenSobol to free
+ */
+void gensvm_free_sobol(struct GenSobol *sobol)
+{
+	if (sobol == NULL)
+		return;
+	Free(sobol->V);
+	Free(sobol->X);
+	Free(sobol);
+	sobol = NULL;
+}
+
+/**
+ * @brief Generate the next point of a Sobol sequence
+ *
+ * @param[in,out] 	sobol 	the GenSobol
+ * @param[out] 		x 	the next point, in [0, 1)^dim
+ */
+void gensvm_sobol_next(struct GenSobol *sobol, double *x)
+{
+	long d, c = 0;
+	uint64_t i = sobol->index;
+
+	for (d=0; d<sobol->dim; d++)
+		x[d] = ((double) sobol->X[d]) / 4294967296.0;
+
+	// find the lowest zero bit of the index
+	while (i & 1) {
+		i >>= 1;
+		c++;
+	}
+	if (c >= GENSVM_SOBOL_BITS)
+		c = GENSVM_SOBOL_BITS - 1; // LCOV_EXCL_LINE
+	for (d=0; d<sobol->dim; d++)
+		sobol->X[d] ^= sobol->V[d*GENSVM_SOBOL_BITS + c];
+	sobol->index++;
+}
+
+/**
+ * @brief Compute a coordinate of a point of the Halton sequence
+ *
+ * @details
+ * This is the radical inverse of @p index in the base given by the prime
+ * number of the dimension.
+ *
+ * @param[in] 	index 	index of the point, starting at 1
+ * @param[in] 	dim 	the dimension, smaller than #GENSVM_SAMPLE_MAX_DIM
+ * @returns 		the coordinate, in [0, 1)
+ */
+double gensvm_halton(uint64_t index, long dim)
+{
+	int base = gensvm_halton_primes[dim];
+	double f = 1.0,
+	       r = 0.0;
+
+	while (index > 0) {
+		f /= base;
+		r += f * (index % base);
+		index /= base;
+	}
+	return r;
+}
+
+/**
+ * Scale of a parameter range when sampling
+ */
+typedef enum {
+	SCALE_LINEAR=0, 	/**< uniform between minimum and maximum */
+	SCALE_LOG=1, 		/**< log-uniform between minimum and maximum */
+	SCALE_DISCRETE=2 	/**< one of the given values */
+} SampleScale;
+
+/**
+ * @brief Map a coordinate in [0, 1) to a parameter value
+ *
+ * @details
+ * If @p levels is positive, a continuous parameter is rounded onto that many
+ * evenly spaced points on its scale, including the smallest and largest
+ * value.
+ *
+ * @param[in] 	values 	parameter values given in the grid file
+ * @param[in] 	N 	number of values, at least 1
+ * @param[in] 	scale 	scale of the parameter
+ * @param[in] 	levels 	number of values to round onto, or 0 to not round
+ * @param[in] 	u 	the coordinate
+ * @returns 		the parameter value
+ */
+static double gensvm_sample_value(double *values, long N, SampleScale scale,
+		long levels, double u)
+{
+	long i, idx;
+	double lo = values[0],
+	       hi = values[0];
+
+	if (N == 1)
+		return values[0];
+	if (scale == SCALE_DISCRETE) {
+		idx = u * N;
+		idx = minimum(idx, N-1);
+		return values[idx];
+	}
+	for (i=1; i<N; i++) {
+		lo = minimum(lo, values[i]);
+		hi = maximum(hi, values[i]);
+	}
+	if (levels > 1) {
+		idx = u * levels;
+		idx = minimum(idx, levels-1);
+		u = ((double) idx) / (levels - 1);
+	}
+	if (scale == SCALE_LOG)
+		return exp(log(lo) + u * (log(hi) - log(lo)));
+	return lo + u * (hi - lo);
+}
+
+/**
+ * @brief Comparison function for the order of sampled tasks
+ *
+ * @details
+ * Tasks are ordered by the kernel parameters first, such that tasks with the
+ * same kernel are trained consecutively, and then by the weights and lambda,
+ * such that GenModel::V of a task is a good initial value for the next.
+ *
+ * @param[in] 	elem1 	pointer to the first GenTask pointer
+ * @param[in] 	elem2 	pointer to the second GenTask pointer
+ * @returns 		comparison of the first task to the second
+ */
+static int gensvm_sample_compare(const void *elem1, const void *elem2)
+{
+	const struct GenTask *t1 = *((struct GenTask * const *) elem1);
+	const struct GenTask *t2 = *((struct GenTask * const *) elem2);
+
+	if (t1->gamma != t2->gamma)
+		return t1->gamma < t2->gamma ? -1 : 1;
+	if (t1->coef != t2->coef)
+		return t1->coef < t2->coef ? -1 : 1;
+	if (t1->degree != t2->degree)
+		return t1->degree < t2->degree ? -1 : 1;
+	if (t1->weight_idx != t2->weight_idx)
+		return t1->weight_idx < t2->weight_idx ? -1 : 1;
+	if (t1->lambda != t2->lambda)
+		return t1->lambda < t2->lambda ? -1 : 1;
+	return 0;
+}
+
+/**
+ * @brief Fill a GenQueue with sampled parameter configurations
+ *
+ * @details
+ * This is the alternative to gensvm_fill_queue() for the random, Sobol and
+ * Halton searches (see GenGrid::search). The queue contains
+ * GenGrid::n_tasks tasks. For every parameter the values in the grid file
+ * define the range to sample from:
+ *
+ * - @c lambda, @c epsilon and @c gamma are sampled log-uniformly between the
+ *   smallest and largest value, since they are scale parameters;
+ * - @c p, @c kappa and @c coef are sampled uniformly between the smallest and
+ *   largest value;
+ * - @c weight and @c degree are sampled from the given values.
+ *
+ * The kernel parameters @c gamma and @c coef are rounded onto
+ * #GENSVM_SAMPLE_KERNEL_LEVELS values of their range, such that tasks share
+ * a kernel.
+ *
+ * A parameter with a single value is fixed to that value, and only the
+ * parameters with more than one value are dimensions of the Sobol or Halton
+ * sequence. The dimensions are assigned in the order of the list above, so
+ * @c lambda uses the first (best) dimension of the sequence. The origin
+ * is skipped in both the Sobol and the Halton sequence, since it puts every
+ * parameter at the lower end of its range. The random
+ * search draws from the generator of the GenContext, so all processes of a
+ * sharded search must use the same seed.
+ *
+ * After sampling the tasks are sorted with gensvm_sample_compare() to
+ * benefit from warm starts in gensvm_train_queue(), and numbered in this
+ * order.
+ *
+ * @param[in] 	grid 		GenGrid with the ranges and the search type
+ * @param[out] 	queue 		GenQueue to add the tasks to
+ * @param[in] 	train_data 	GenData of the training set
+ * @param[in] 	test_data 	GenData of the test set
+ * @param[in] 	ctx 		GenContext for the random search, or NULL to
+ * 				use rand()
+ */
+void gensvm_sample_queue(struct GenGrid *grid, struct GenQueue *queue,
+		struct GenData *train_data, struct GenData *test_data,
+		struct GenContext *ctx)
+{
+	long i, j, D = 0,
+	     N = grid->n_tasks;
+	long coord[GENSVM_SAMPLE_MAX_DIM];
+	double u[GENSVM_SAMPLE_MAX_DIM];
+	double value;
+	double *weights = Malloc(double, maximum(grid->Nw, 1));
+	struct GenSobol *sobol = NULL;
+	struct GenTask *task = NULL;
+
+	// the parameters in the order of the dimensions
+	double *values[GENSVM_SAMPLE_MAX_DIM] = {grid->lambdas, grid->ps,
+		grid->kappas, grid->gammas, grid->coefs, grid->degrees,
+		weights, grid->epsilons};
+	long Ns[GENSVM_SAMPLE_MAX_DIM] = {grid->Nl, grid->Np, grid->Nk,
+		grid->Ng, grid->Nc, grid->Nd, grid->Nw, grid->Ne};
+	SampleScale scales[GENSVM_SAMPLE_MAX_DIM] = {SCALE_LOG, SCALE_LINEAR,
+		SCALE_LINEAR, SCALE_LOG, SCALE_LINEAR, SCALE_DISCRETE,
+		SCALE_DISCRETE, SCALE_LOG};
+
+	if (N < 1) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: The number of tasks must be specified "
+				"with \"tasks:\" for a random or "
+				"quasi-random search\n");
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
+
+	for (i=0; i<grid->Nw; i++)
+		weights[i] = grid->weight_idxs[i];
+
+	for (j=0; j<GENSVM_SAMPLE_MAX_DIM; j++) {
+		coord[j] = (Ns[j] > 1) ? D++ : -1;
+		if (scales[j] != SCALE_LOG)
+			continue;
+		for (i=0; i<Ns[j]; i++) {
+			if (values[j][i] <= 0) {
+				// LCOV_EXCL_START
+				err("[GenSVM Error]: Log-uniform sampling "
+						"requires positive values for "
+						"lambda, epsilon and gamma\n");
+				exit(EXIT_FAILURE);
+				// LCOV_EXCL_STOP
+			}
+		}
+	}
+
+	if (grid->search == S_SOBOL) {
+		sobol = gensvm_init_sobol(D);
+		gensvm_sobol_next(sobol, u);
+	}
+
+	queue->i = 0;
+	queue->N = N;
+	queue->tasks = Calloc(struct GenTask *, N);
+	for (i=0; i<N; i++) {
+		if (grid->search == S_SOBOL) {
+			gensvm_sobol_next(sobol, u);
+		} else {
+			for (j=0; j<D; j++)
+				u[j] = (grid->search == S_HALTON) ?
+					gensvm_halton(i+1, j) :
+					gensvm_context_uniform(ctx);
+		}
+
+		task = gensvm_init_task();
+		task->train_data = train_data;
+		task->test_data = test_data;
+		task->folds = grid->folds;
+		task->stratified = grid->stratified;
+		task->kerneltype = grid->kerneltype;
+
+		for (j=0; j<GENSVM_SAMPLE_MAX_DIM; j++) {
+			if (Ns[j] == 0)
+				continue;
+			value = gensvm_sample_value(values[j], Ns[j],
+					scales[j], (j == 3 || j == 4) ?
+					GENSVM_SAMPLE_KERNEL_LEVELS : 0,
+					coord[j] < 0 ? 0.0 : u[coord[j]]);
+			switch (j) {
+				case 0: task->lambda = value; break;
+				case 1: task->p = value; break;
+				case 2: task->kappa = value; break;
+				case 3: task->gamma = value; break;
+				case 4: task->coef = value; break;
+				case 5: task->degree = value; break;
+				case 6: task->weight_idx = value; break;
+				case 7: task->epsilon = value; break;
+			}
+		}
+		queue->tasks[i] = task;
+	}
+
+	qsort(queue->tasks, N, sizeof(struct GenTask *),
+			gensvm_sample_compare);
+	for (i=0; i<N; i++)
+		queue->tasks[i]->ID = i;
+
+	gensvm_free_sobol(sobol);
+	Free(weights);
+}
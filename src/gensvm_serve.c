@@ -0,0 +1,728 @@
+/**
+ * @file gensvm_serve.c
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Functions for serving predictions over a Unix domain socket
+ *
+ * @details
+ * A GenServer loads a set of models once and answers prediction requests
+ * on a Unix domain socket, so that the models don't have to be read for
+ * every prediction. The protocol is described in @ref spec_serve_protocol.
+ *
+ * Every worker thread accepts a connection and answers its requests until
+ * the client closes it. A request is answered with the labels and the
+ * decision values (the simplex space vectors) of its instances. For a
+ * nonlinear model the training data is loaded with the model and the
+ * instances are mapped to the kernel space with gensvm_kernel_postprocess().
+ * The simplex matrix of a model is computed when it is loaded, such that
+ * the workers only read the models and can share them.
+ *
+ * The models are replaced by gensvm_serve_reload() under a lock, so requests
+ * are answered with either the old or the new models. If the new models
+ * can't be loaded, the server keeps the old models.
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "gensvm_serve.h"
+
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern FILE *GENSVM_OUTPUT_FILE;
+
+/**
+ * @brief Load a model for the server
+ *
+ * @details
+ * Text model files don't store the kernel, so the kernel of
+ * GenServer::kernel is used for these files. For a nonlinear model the
+ * training data is read from the GenModel::data_file of the model and the
+ * kernel preprocessing is repeated. If GenServer::tolerance is positive, the
+ * model is compacted with gensvm_compact() and only the reduced set of
+ * training instances is kept.
+ *
+ * @param[in] 	server 		the server
+ * @param[in] 	filename 	filename of the model
+ * @param[out] 	sm 		the loaded model
+ */
+static void gensvm_serve_load_model(struct GenServer *server, char *filename,
+		struct GenServeModel *sm)
+{
+	double error;
+	struct GenData *support = NULL;
+	struct GenModel *model = gensvm_init_model();
+
+	model->kerneltype = server->kernel->kerneltype;
+	model->gamma = server->kernel->gamma;
+	model->coef = server->kernel->coef;
+	model->degree = server->kernel->degree;
+	model->kernel_eigen_cutoff = server->kernel->kernel_eigen_cutoff;
+	gensvm_read_model(model, filename);
+
+	model->U = Calloc(double, model->K*(model->K-1));
+	gensvm_simplex(model);
+
+	sm->model = model;
+	sm->traindata = NULL;
+	sm->m = model->m;
+	if (model->kerneltype == K_LINEAR)
+		return;
+
+	sm->traindata = gensvm_init_data();
+	gensvm_load_data(sm->traindata, model->data_file,
+			server->libsvm_format);
+	if (sm->traindata->Z == NULL)
+		gensvm_data_to_dense(sm->traindata);
+	gensvm_kernel_preprocess(model, sm->traindata);
+	if (sm->traindata->r != model->m) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: The kernel of the training data of %s has "
+				"%li dimensions, but the model has %li.\n",
+				filename, sm->traindata->r, model->m);
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
+	sm->m = sm->traindata->m;
+
+	if (server->tolerance <= 0)
+		return;
+	support = gensvm_init_data();
+	error = gensvm_compact(model, sm->traindata, support,
+			server->tolerance);
+	note("Compacted model %s to %li of %li training instances (relative "
+			"error %g)\n", filename, support->n, sm->traindata->n,
+			error);
+	gensvm_free_data(sm->traindata);
+	sm->traindata = support;
+}
+
+/**
+ * @brief Load all models of the server
+ *
+ * @param[in] 	server 	the server
+ * @returns 		array of GenServer::n_models loaded models
+ */
+static struct GenServeModel *gensvm_serve_load(struct GenServer *server)
+{
+	long i;
+	struct GenServeModel *models = Malloc(struct GenServeModel,
+			server->n_models);
+
+	for (i=0; i<server->n_models; i++) {
+		note("Loading model %li from %s\n", i,
+				server->model_files[i]);
+		gensvm_serve_load_model(server, server->model_files[i],
+				&models[i]);
+	}
+	return models;
+}
+
+/**
+ * @brief Free the models of the server
+ *
+ * @param[in] 	models 		array of loaded models, can be NULL
+ * @param[in] 	n_models 	number of models
+ */
+static void gensvm_serve_free_models(struct GenServeModel *models,
+		long n_models)
+{
+	long i;
+
+	if (models == NULL)
+		return;
+	for (i=0; i<n_models; i++) {
+		gensvm_free_model(models[i].model);
+		gensvm_free_data(models[i].traindata);
+	}
+	Free(models);
+}
+
+/**
+ * @brief Initialize a server and load its models
+ *
+ * @details
+ * The model filenames and the kernel model are not copied, so they should
+ * remain valid while the server exists.
+ *
+ * @param[in] 	model_files 	filenames of the models
+ * @param[in] 	n_models 	number of models
+ * @param[in] 	kernel 		model with the kernel for text model files
+ * @param[in] 	libsvm_format 	whether the training data of nonlinear
+ * 				models is in LibSVM/SVMlight format
+ * @param[in] 	tolerance 	relative error of the decision values for
+ * 				compacting nonlinear models, or 0
+ * @returns 			the server, to be freed with
+ * 				gensvm_free_server()
+ */
+struct GenServer *gensvm_init_server(char **model_files, long n_models,
+		struct GenModel *kernel, bool libsvm_format,
+		double tolerance)
+{
+	struct GenServer *server = Malloc(struct GenServer, 1);
+
+	server->model_files = model_files;
+	server->n_models = n_models;
+	server->kernel = kernel;
+	server->libsvm_format = libsvm_format;
+	server->tolerance = tolerance;
+	server->socket_path = NULL;
+	server->listen_fd = -1;
+	server->n_workers = 0;
+	server->workers = NULL;
+	server->conns = NULL;
+	server->stopping = false;
+	pthread_rwlock_init(&server->lock, NULL);
+	pthread_mutex_init(&server->conn_lock, NULL);
+
+	server->models = gensvm_serve_load(server);
+
+	return server;
+}
+
+/**
+ * @brief Check that the models of a server can be loaded
+ *
+ * @details
+ * The model and data readers exit the program when a file is missing or
+ * corrupt. The models are therefore loaded in a child process first, which
+ * exits successfully only if all models are loaded. The errors of the child
+ * are written to #GENSVM_ERROR_FILE, its other output is suppressed.
+ *
+ * @param[in] 	server 	the server
+ * @returns 		whether the models can be loaded
+ */
+static bool gensvm_serve_check(struct GenServer *server)
+{
+	int status;
+	pid_t pid;
+
+	fflush(NULL);
+	pid = fork();
+	if (pid < 0) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: Couldn't create a process to check the "
+				"models: %s\n", strerror(errno));
+		return false;
+		// LCOV_EXCL_STOP
+	}
+	if (pid == 0) {
+		GENSVM_OUTPUT_FILE = NULL;
+		gensvm_serve_load(server);
+		_exit(EXIT_SUCCESS);
+	}
+
+	while (waitpid(pid, &status, 0) < 0) {
+		if (errno != EINTR) {
+			// LCOV_EXCL_START
+			err("[GenSVM Error]: Couldn't check the models: %s\n",
+					strerror(errno));
+			return false;
+			// LCOV_EXCL_STOP
+		}
+	}
+	return WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS;
+}
+
+/**
+ * @brief Load the models of a server again
+ *
+ * @details
+ * The models are loaded before the old models are replaced, so requests
+ * are not held up while the models are read. Model files should therefore
+ * be replaced by renaming a new file over them, since a binary model file
+ * is used from a memory map until it is replaced.
+ *
+ * Since the readers exit the program on a missing or corrupt file, the new
+ * models are first checked with gensvm_serve_check(). If that fails, an
+ * error is printed and the server keeps serving the old models.
+ *
+ * @param[in] 	server 	the server
+ * @returns 		whether the models were replaced
+ */
+bool gensvm_serve_reload(struct GenServer *server)
+{
+	struct GenServeModel *old = NULL,
+			     *models = NULL;
+
+	if (!gensvm_serve_check(server)) {
+		err("[GenSVM Error]: Couldn't load the models, keeping the "
+				"current models.\n");
+		return false;
+	}
+	models = gensvm_serve_load(server);
+
+	pthread_rwlock_wrlock(&server->lock);
+	old = server->models;
+	server->models = models;
+	pthread_rwlock_unlock(&server->lock);
+
+	gensvm_serve_free_models(old, server->n_models);
+	return true;
+}
+
+/**
+ * @brief Read a number of bytes from a connection
+ *
+ * @param[in] 	fd 	the connection
+ * @param[out] 	buffer 	buffer for the bytes
+ * @param[in] 	size 	number of bytes to read
+ * @returns 		whether all bytes were read
+ */
+static bool gensvm_serve_read(int fd, void *buffer, size_t size)
+{
+	char *p = buffer;
+	ssize_t nr;
+
+	while (size > 0) {
+		nr = recv(fd, p, size, 0);
+		if (nr < 0 && errno == EINTR)
+			continue;
+		if (nr <= 0)
+			return false;
+		p += nr;
+		size -= nr;
+	}
+	return true;
+}
+
+/**
+ * @brief Write a number of bytes to a connection
+ *
+ * @param[in] 	fd 	the connection
+ * @param[in] 	buffer 	the bytes to write
+ * @param[in] 	size 	number of bytes to write
+ * @returns 		whether all bytes were written
+ */
+static bool gensvm_serve_write(int fd, const void *buffer, size_t size)
+{
+	const char *p = buffer;
+	ssize_t nr;
+
+	while (size > 0) {
+		nr = send(fd, p, size, MSG_NOSIGNAL);
+		if (nr < 0 && errno == EINTR)
+			continue;
+		if (nr <= 0)
+			return false;
+		p += nr;
+		size -= nr;
+	}
+	return true;
+}
+
+/**
+ * @brief Write a response without predictions
+ *
+ * @param[in] 	fd 	the connection
+ * @param[in] 	status 	status of the response
+ * @param[in] 	K 	number of classes, or zero
+ * @returns 		whether the response was written
+ */
+static bool gensvm_serve_respond_status(int fd, ServeStatus status, long K)
+{
+	struct GenServeResponse response = {GENSVM_SERVE_MAGIC, status, 0,
+		K};
+
+	return gensvm_serve_write(fd, &response, sizeof(response));
+}
+
+/**
+ * @brief Build the data of a request for a model
+ *
+ * @details
+ * Dense instances are stored in GenData::RAW with a column of ones. Sparse
+ * instances are stored in GenData::spZ with a column of ones for a linear
+ * model, and as dense instances for a nonlinear model.
+ *
+ * @param[in] 	sm 		the model
+ * @param[in] 	request 	header of the request
+ * @param[in] 	payload 	data of the request
+ * @param[out] 	block 		initialized GenData for the instances
+ * @returns 			the status of the request
+ */
+static ServeStatus gensvm_serve_block(struct GenServeModel *sm,
+		struct GenServeRequest *request, char *payload,
+		struct GenData *block)
+{
+	long i, j, jj, n = request->n,
+	     m = request->m,
+	     nnz = request->nnz;
+	int64_t *ia = (int64_t *) payload,
+		*ja = ia + n + 1;
+	double *values = (double *) (ja + nnz),
+	       *rows = (double *) payload;
+
+	block->n = n;
+	block->m = m;
+	block->r = m;
+
+	if (request->flags & GENSVM_SERVE_SPARSE) {
+		if (ia[0] != 0 || ia[n] != nnz)
+			return SERVE_BAD_INDEX;
+		for (i=0; i<n; i++)
+			if (ia[i+1] < ia[i])
+				return SERVE_BAD_INDEX;
+		for (jj=0; jj<nnz; jj++)
+			if (ja[jj] < 0 || ja[jj] >= m)
+				return SERVE_BAD_INDEX;
+	}
+
+	if (!(request->flags & GENSVM_SERVE_SPARSE) ||
+			sm->traindata != NULL) {
+		if (n*(m+1) > GENSVM_SERVE_MAX_REQUEST / (long) sizeof(double))
+			return SERVE_BAD_REQUEST;
+		block->RAW = Calloc(double, n*(m+1));
+		block->Z = block->RAW;
+		for (i=0; i<n; i++) {
+			matrix_set(block->RAW, m+1, i, 0, 1.0);
+			if (request->flags & GENSVM_SERVE_SPARSE) {
+				for (jj=ia[i]; jj<ia[i+1]; jj++)
+					matrix_set(block->RAW, m+1, i,
+							ja[jj]+1, values[jj]);
+			} else {
+				for (j=0; j<m; j++)
+					matrix_set(block->RAW, m+1, i, j+1,
+							rows[i*m+j]);
+			}
+		}
+		return SERVE_OK;
+	}
+
+	// sparse instances for a linear model, with the column of ones
+	block->spZ = gensvm_init_sparse();
+	block->spZ->nnz = nnz + n;
+	block->spZ->n_row = n;
+	block->spZ->n_col = m+1;
+	block->spZ->ia = Malloc(long, n+1);
+	block->spZ->ja = Malloc(long, nnz+n);
+	block->spZ->values = Malloc(double, nnz+n);
+	for (i=0; i<n; i++) {
+		block->spZ->ia[i] = ia[i] + i;
+		block->spZ->ja[ia[i] + i] = 0;
+		block->spZ->values[ia[i] + i] = 1.0;
+		for (jj=ia[i]; jj<ia[i+1]; jj++) {
+			block->spZ->ja[jj + i + 1] = ja[jj] + 1;
+			block->spZ->values[jj + i + 1] = values[jj];
+		}
+	}
+	block->spZ->ia[n] = nnz + n;
+	return SERVE_OK;
+}
+
+/**
+ * @brief Predict the instances of a request with a model
+ *
+ * @param[in] 	sm 	the model
+ * @param[in] 	block 	the instances, see gensvm_serve_block()
+ * @param[out] 	predy 	the predicted labels
+ * @param[out] 	ZV 	the simplex space vectors of the instances
+ */
+static void gensvm_serve_predict(struct GenServeModel *sm,
+		struct GenData *block, long *predy, double *ZV)
+{
+	long K = sm->model->K;
+	double *S = Malloc(double, GENSVM_BLOCK_SIZE*K);
+
+	if (sm->traindata != NULL)
+		gensvm_kernel_postprocess(sm->model, sm->traindata, block);
+	gensvm_calculate_ZV(sm->model, block, ZV);
+	gensvm_predict_assign_rows(ZV, sm->model->U, block->n, K, S, predy,
+			NULL);
+
+	Free(S);
+}
+
+/**
+ * @brief Answer a single request on a connection
+ *
+ * @param[in] 	server 	the server
+ * @param[in] 	fd 	the connection
+ * @returns 		whether the connection can be used for the next
+ * 			request
+ */
+static bool gensvm_serve_request(struct GenServer *server, int fd)
+{
+	bool ok = true;
+	long i, K = 0;
+	size_t size;
+	char *payload = NULL;
+	long *predy = NULL;
+	int64_t *labels = NULL;
+	double *ZV = NULL;
+	ServeStatus status;
+	struct GenServeRequest request;
+	struct GenServeResponse response;
+	struct GenServeModel *sm = NULL;
+	struct GenData *block = NULL;
+	const long limit = GENSVM_SERVE_MAX_REQUEST / sizeof(double);
+
+	if (!gensvm_serve_read(fd, &request, sizeof(request)))
+		return false;
+
+	if (request.magic != GENSVM_SERVE_MAGIC || request.n < 0 ||
+			request.m < 1 || request.nnz < 0 ||
+			request.n > limit || request.m > limit ||
+			request.nnz > limit) {
+		gensvm_serve_respond_status(fd, SERVE_BAD_REQUEST, 0);
+		return false;
+	}
+	if (request.flags & GENSVM_SERVE_SPARSE)
+		size = (request.n + 1 + request.nnz) * sizeof(int64_t) +
+			request.nnz * sizeof(double);
+	else
+		size = request.n * request.m * sizeof(double);
+	if (size > GENSVM_SERVE_MAX_REQUEST) {
+		gensvm_serve_respond_status(fd, SERVE_BAD_REQUEST, 0);
+		return false;
+	}
+
+	payload = Malloc(char, size);
+	if (!gensvm_serve_read(fd, payload, size)) {
+		Free(payload);
+		return false;
+	}
+
+	pthread_rwlock_rdlock(&server->lock);
+	if (request.model < 0 || request.model >= server->n_models) {
+		status = SERVE_BAD_MODEL;
+	} else {
+		sm = &server->models[request.model];
+		K = sm->model->K;
+		status = (request.m == sm->m) ? SERVE_OK : SERVE_BAD_FEATURES;
+	}
+	if (status == SERVE_OK && request.n > 0) {
+		block = gensvm_init_data();
+		status = gensvm_serve_block(sm, &request, payload, block);
+	}
+	if (status == SERVE_OK && request.n > 0) {
+		predy = Calloc(long, request.n);
+		ZV = Calloc(double, request.n*(K-1));
+		gensvm_serve_predict(sm, block, predy, ZV);
+	}
+	pthread_rwlock_unlock(&server->lock);
+
+	if (status != SERVE_OK) {
+		ok = gensvm_serve_respond_status(fd, status, K);
+		ok = ok && status != SERVE_BAD_REQUEST;
+	} else {
+		labels = Malloc(int64_t, request.n);
+		for (i=0; i<request.n; i++)
+			labels[i] = predy[i];
+		response.magic = GENSVM_SERVE_MAGIC;
+		response.status = SERVE_OK;
+		response.n = request.n;
+		response.K = K;
+		ok = gensvm_serve_write(fd, &response, sizeof(response)) &&
+			gensvm_serve_write(fd, labels,
+					request.n*sizeof(int64_t)) &&
+			gensvm_serve_write(fd, ZV,
+					request.n*(K-1)*sizeof(double));
+	}
+
+	gensvm_free_data(block);
+	Free(payload);
+	Free(predy);
+	Free(labels);
+	Free(ZV);
+
+	return ok;
+}
+
+/**
+ * @brief Worker thread of the server
+ *
+ * @details
+ * The worker accepts connections until the server is stopped, and answers
+ * the requests on a connection until it is closed.
+ *
+ * @param[in] 	arg 	the server
+ * @returns 		NULL
+ */
+static void *gensvm_serve_worker(void *arg)
+{
+	int fd;
+	long slot;
+	struct GenServer *server = arg;
+
+	while (true) {
+		fd = accept(server->listen_fd, NULL, NULL);
+		if (fd < 0 && (errno == EINTR || errno == ECONNABORTED))
+			continue;
+		if (fd < 0)
+			break;
+
+		// register the connection so that it can be closed on stop
+		pthread_mutex_lock(&server->conn_lock);
+		if (server->stopping) {
+			pthread_mutex_unlock(&server->conn_lock);
+			close(fd);
+			break;
+		}
+		for (slot=0; server->conns[slot] >= 0; slot++);
+		server->conns[slot] = fd;
+		pthread_mutex_unlock(&server->conn_lock);
+
+		while (gensvm_serve_request(server, fd));
+
+		pthread_mutex_lock(&server->conn_lock);
+		server->conns[slot] = -1;
+		pthread_mutex_unlock(&server->conn_lock);
+		close(fd);
+	}
+
+	pthread_mutex_lock(&server->conn_lock);
+	if (!server->stopping) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: Couldn't accept connections: %s\n",
+				strerror(errno));
+		// LCOV_EXCL_STOP
+	}
+	pthread_mutex_unlock(&server->conn_lock);
+
+	return NULL;
+}
+
+/**
+ * @brief Start serving predictions on a Unix domain socket
+ *
+ * @details
+ * An existing socket at socket_path is removed first. The function returns
+ * after the worker threads are started, the server is stopped with
+ * gensvm_serve_stop().
+ *
+ * @param[in] 	server 		the server
+ * @param[in] 	socket_path 	path of the socket
+ * @param[in] 	n_workers 	number of worker threads, which is the
+ * 				number of connections that are served at the
+ * 				same time
+ */
+void gensvm_serve_start(struct GenServer *server, char *socket_path,
+		long n_workers)
+{
+	long t;
+	struct stat st;
+	struct sockaddr_un addr;
+
+	if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: Socket path %s is too long.\n",
+				socket_path);
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, socket_path);
+
+	if (stat(socket_path, &st) == 0 && S_ISSOCK(st.st_mode))
+		unlink(socket_path);
+
+	server->listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (server->listen_fd < 0 || bind(server->listen_fd,
+				(struct sockaddr *) &addr, sizeof(addr)) != 0
+			|| listen(server->listen_fd, SOMAXCONN) != 0) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: Couldn't listen on socket %s: %s\n",
+				socket_path, strerror(errno));
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
+	server->socket_path = socket_path;
+	server->stopping = false;
+
+	server->n_workers = maximum(n_workers, 1);
+	server->conns = Malloc(int, server->n_workers);
+	for (t=0; t<server->n_workers; t++)
+		server->conns[t] = -1;
+	server->workers = Malloc(pthread_t, server->n_workers);
+	for (t=0; t<server->n_workers; t++) {
+		if (pthread_create(&server->workers[t], NULL,
+					gensvm_serve_worker, server) != 0) {
+			// LCOV_EXCL_START
+			err("[GenSVM Error]: Couldn't create thread\n");
+			exit(EXIT_FAILURE);
+			// LCOV_EXCL_STOP
+		}
+	}
+}
+
+/**
+ * @brief Stop serving predictions
+ *
+ * @details
+ * The listening socket and the open connections are shut down, after which
+ * the worker threads finish the request they are working on and stop. The
+ * socket file is removed.
+ *
+ * @param[in] 	server 	the server
+ */
+void gensvm_serve_stop(struct GenServer *server)
+{
+	long t;
+
+	if (server->listen_fd < 0)
+		return;
+
+	pthread_mutex_lock(&server->conn_lock);
+	server->stopping = true;
+	shutdown(server->listen_fd, SHUT_RDWR);
+	for (t=0; t<server->n_workers; t++)
+		if (server->conns[t] >= 0)
+			shutdown(server->conns[t], SHUT_RDWR);
+	pthread_mutex_unlock(&server->conn_lock);
+
+	for (t=0; t<server->n_workers; t++)
+		pthread_join(server->workers[t], NULL);
+
+	close(server->listen_fd);
+	unlink(server->socket_path);
+	server->listen_fd = -1;
+
+	Free(server->workers);
+	Free(server->conns);
+	server->workers = NULL;
+	server->conns = NULL;
+	server->n_workers = 0;
+}
+
+/**
+ * @brief Free a server
+ *
+ * @details
+ * The server is stopped first if it is running.
+ *
+ * @param[in] 	server 	the server to free, can be NULL
+ */
+void gensvm_free_server(struct GenServer *server)
+{
+	if (server == NULL)
+		return;
+
+	gensvm_serve_stop(server);
+	gensvm_serve_free_models(server->models, server->n_models);
+	pthread_rwlock_destroy(&server->lock);
+	pthread_mutex_destroy(&server->conn_lock);
+	Free(server);
+}
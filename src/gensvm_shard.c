@@ -0,0 +1,654 @@
+/**
+ * @file gensvm_shard.c
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Functions for distributing a grid search over several processes
+ *
+ * @details
+ * A large grid search can be split over several processes, possibly on
+ * different machines, which share a directory (for instance on NFS). No
+ * communication between the processes is needed other than through files in
+ * this directory. The queue is divided in chunks of consecutive tasks, such
+ * that the ordering of the tasks (see gensvm_fill_queue()) is preserved
+ * within a chunk. A worker claims a chunk by creating a lease file with
+ * O_EXCL, which is atomic. The results of a chunk are written to a journal
+ * (see gensvm_journal.c) in the shared directory, and a marker file is
+ * created when the chunk is finished.
+ *
+ * The activity of a worker on a chunk is measured by the modification time
+ * of the lease and of the journal of the chunk. The worker holding a lease
+ * touches it from a heartbeat thread every quarter of the lease time, also
+ * while a single task takes longer than that. If there has been no
+ * activity for GenShard::lease_time seconds, the worker is assumed to have
+ * stopped, and another worker can reclaim the chunk. This is done by
+ * atomically renaming the lease file. Since the journal of the chunk is
+ * kept, the new worker doesn't repeat the tasks that were already
+ * completed. A worker only touches or removes a lease that holds its own
+ * identifier.
+ *
+ * When all chunks are finished, one of the workers is elected to merge the
+ * results by taking the merge lease, with the same expiry and reclaiming as
+ * the leases of the chunks. The merged journal is renamed into place before
+ * the merge lease is removed. All workers must use the same seed for the
+ * random number generator, such that the cross validation split is the same
+ * for all chunks.
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "gensvm_shard.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief Initialize a GenShard structure
+ *
+ * @details
+ * The shared directory is created if it doesn't exist yet. The identifier of
+ * the worker is constructed from the hostname and the process id, and the
+ * default values for the chunk size and the lease and poll times are set.
+ *
+ * @param[in] 	dir 	the shared directory
+ * @param[in] 	seed 	seed for the RNG, the same for all workers
+ * @returns 		initialized GenShard
+ */
+struct GenShard *gensvm_init_shard(char *dir, long seed)
+{
+	char hostname[GENSVM_MAX_LINE_LENGTH];
+	struct GenShard *shard = Malloc(struct GenShard, 1);
+
+	if (mkdir(dir, 0777) != 0 && errno != EEXIST) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: Couldn't create shard directory %s\n",
+				dir);
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
+
+	shard->dir = Malloc(char, strlen(dir)+1);
+	strcpy(shard->dir, dir);
+
+	if (gethostname(hostname, GENSVM_MAX_LINE_LENGTH - 32) != 0)
+		strcpy(hostname, "localhost"); // LCOV_EXCL_LINE
+	hostname[GENSVM_MAX_LINE_LENGTH - 33] = '\0';
+	shard->worker = Malloc(char, strlen(hostname) + 32);
+	sprintf(shard->worker, "%s.%li", hostname, (long) getpid());
+
+	shard->seed = seed;
+	shard->chunk_size = GENSVM_SHARD_CHUNK_SIZE;
+	shard->lease_time = GENSVM_SHARD_LEASE_TIME;
+	shard->poll_time = GENSVM_SHARD_POLL_TIME;
+
+	return shard;
+}
+
+/**
+ * @brief Free a GenShard structure
+ *
+ * @details
+ * The files in the shared directory are not removed.
+ *
+ * @param[in] 	shard 	GenShard to free
+ */
+void gensvm_free_shard(struct GenShard *shard)
+{
+	if (shard == NULL)
+		return;
+	Free(shard->dir);
+	Free(shard->worker);
+	Free(shard);
+	shard = NULL;
+}
+
+/**
+ * @brief Construct the path of a file in the shared directory
+ *
+ * @details
+ * The files of a chunk are named @c chunk_000012.ext in the shared
+ * directory, where @c ext is the given extension. If @p chunk is negative,
+ * the path of the file @p ext in the shared directory is returned.
+ *
+ * @param[in] 	shard 	the GenShard
+ * @param[in] 	chunk 	index of the chunk
+ * @param[in] 	ext 	extension or name of the file
+ * @returns 		newly allocated path of the file
+ */
+char *gensvm_shard_path(struct GenShard *shard, long chunk, char *ext)
+{
+	char *path = Malloc(char, strlen(shard->dir) + strlen(ext) + 32);
+
+	if (chunk < 0)
+		sprintf(path, "%s/%s", shard->dir, ext);
+	else
+		sprintf(path, "%s/chunk_%06li.%s", shard->dir, chunk, ext);
+	return path;
+}
+
+/**
+ * @brief Check if a chunk is finished
+ *
+ * @param[in] 	shard 	the GenShard
+ * @param[in] 	chunk 	index of the chunk
+ * @returns 		whether the marker file of the chunk exists
+ */
+bool gensvm_shard_is_done(struct GenShard *shard, long chunk)
+{
+	bool done;
+	char *path = gensvm_shard_path(shard, chunk, "done");
+
+	done = (access(path, F_OK) == 0);
+	Free(path);
+	return done;
+}
+
+/**
+ * @brief Check if a lease has expired
+ *
+ * @details
+ * The last activity on a lease is the latest modification time of the lease
+ * and of the journal that is written by the holder of the lease.
+ *
+ * @param[in] 	shard 	the GenShard
+ * @param[in] 	lease 	path of the lease file
+ * @param[in] 	journal path of the journal of the holder of the lease
+ * @param[out] 	st 	the status of the lease file
+ * @returns 		true if the lease exists and has expired
+ */
+static bool gensvm_shard_expired(struct GenShard *shard, char *lease,
+		char *journal, struct stat *st)
+{
+	time_t last;
+	struct stat jst;
+	bool exists = (stat(lease, st) == 0);
+
+	last = st->st_mtime;
+	if (exists && stat(journal, &jst) == 0)
+		last = maximum(last, jst.st_mtime);
+
+	return exists && difftime(time(NULL), last) > shard->lease_time;
+}
+
+/**
+ * @brief Create a lease file
+ *
+ * @param[in] 	shard 	the GenShard
+ * @param[in] 	lease 	path of the lease file
+ * @returns 		true if the lease was created, false if it exists
+ */
+static bool gensvm_shard_create_lease(struct GenShard *shard, char *lease)
+{
+	int fd = open(lease, O_WRONLY | O_CREAT | O_EXCL, 0666);
+
+	if (fd < 0) {
+		if (errno == EEXIST)
+			return false;
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: Couldn't create lease file %s\n", lease);
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
+	if (write(fd, shard->worker, strlen(shard->worker)) < 0)
+		err("[GenSVM Warning]: Couldn't write to %s\n", lease); // LCOV_EXCL_LINE
+	close(fd);
+	return true;
+}
+
+/**
+ * @brief Open a lease file if this worker holds it
+ *
+ * @details
+ * The lease file holds the identifier of the worker that created it. The
+ * file is only returned if this is GenShard::worker, such that a worker
+ * never touches or removes a lease that another worker has reclaimed.
+ *
+ * @param[in] 	shard 	the GenShard
+ * @param[in] 	lease 	path of the lease file
+ * @returns 		file descriptor of the lease, or -1 if this worker
+ * 			doesn't hold it
+ */
+static int gensvm_shard_open_lease(struct GenShard *shard, char *lease)
+{
+	char buf[GENSVM_MAX_LINE_LENGTH];
+	ssize_t n;
+	int fd = open(lease, O_RDONLY);
+
+	if (fd < 0)
+		return -1;
+	n = read(fd, buf, GENSVM_MAX_LINE_LENGTH - 1);
+	buf[maximum(n, 0)] = '\0';
+	if (n < 0 || strcmp(buf, shard->worker) != 0) {
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+/**
+ * @brief Remove a lease file if this worker holds it
+ *
+ * @param[in] 	shard 	the GenShard
+ * @param[in] 	lease 	path of the lease file
+ */
+static void gensvm_shard_release_lease(struct GenShard *shard, char *lease)
+{
+	int fd = gensvm_shard_open_lease(shard, lease);
+
+	if (fd < 0) {
+		err("[GenSVM Warning]: Lease %s was taken over by another "
+				"worker\n", lease);
+		return;
+	}
+	unlink(lease);
+	close(fd);
+}
+
+/**
+ * @brief Take a lease, reclaiming it if it has expired
+ *
+ * @details
+ * The lease is taken by creating the lease file with O_EXCL, which fails if
+ * the lease already exists. If the existing lease has expired, it is
+ * atomically renamed to a name that is unique for this worker. Only one
+ * worker can succeed in this rename. Since another worker may have replaced
+ * the expired lease by a fresh one in the meantime, the renamed file is
+ * compared to the expired lease, and put back if it's not the same file.
+ * Finally, the lease is created again with O_EXCL. This is used for the
+ * leases of the chunks and for the lease of the merge.
+ *
+ * @param[in] 	shard 	the GenShard
+ * @param[in] 	lease 	path of the lease file
+ * @param[in] 	journal path of the journal of the holder of the lease
+ * @returns 		whether this worker now holds the lease
+ */
+static bool gensvm_shard_take_lease(struct GenShard *shard, char *lease,
+		char *journal)
+{
+	bool taken;
+	struct stat st, sst;
+	char *stale = Malloc(char, strlen(lease) + strlen(shard->worker) + 8);
+
+	sprintf(stale, "%s.%s", lease, shard->worker);
+
+	taken = gensvm_shard_create_lease(shard, lease);
+	if (!taken && gensvm_shard_expired(shard, lease, journal, &st)) {
+		if (rename(lease, stale) != 0)
+			goto cleanup;
+		if (stat(stale, &sst) != 0 || sst.st_ino != st.st_ino ||
+				sst.st_dev != st.st_dev) {
+			// we renamed a fresh lease, put it back
+			if (link(stale, lease) != 0)
+				err("[GenSVM Warning]: Couldn't restore lease "
+						"%s\n", lease); // LCOV_EXCL_LINE
+			unlink(stale);
+			goto cleanup;
+		}
+		unlink(stale);
+		note("Reclaiming expired lease %s\n", lease);
+		taken = gensvm_shard_create_lease(shard, lease);
+	}
+
+cleanup:
+	Free(stale);
+	return taken;
+}
+
+/**
+ * @brief Claim a chunk of the queue
+ *
+ * @details
+ * The lease of the chunk is taken with gensvm_shard_take_lease(), where the
+ * activity on the chunk includes the journal of the chunk. A chunk that is
+ * finished can't be claimed.
+ *
+ * @param[in] 	shard 	the GenShard
+ * @param[in] 	chunk 	index of the chunk
+ * @returns 		whether this worker now holds the lease of the chunk
+ */
+bool gensvm_shard_claim(struct GenShard *shard, long chunk)
+{
+	bool claimed = false;
+	char *lease = gensvm_shard_path(shard, chunk, "lease");
+	char *journal = gensvm_shard_path(shard, chunk, "journal");
+
+	if (!gensvm_shard_is_done(shard, chunk))
+		claimed = gensvm_shard_take_lease(shard, lease, journal);
+
+	// the chunk may have been finished while we took the lease
+	if (claimed && gensvm_shard_is_done(shard, chunk)) {
+		gensvm_shard_release_lease(shard, lease);
+		claimed = false;
+	}
+
+	Free(lease);
+	Free(journal);
+	return claimed;
+}
+
+/**
+ * @brief Mark a chunk as finished and release its lease
+ *
+ * @details
+ * The lease is only removed if this worker still holds it, see
+ * gensvm_shard_release_lease().
+ *
+ * @param[in] 	shard 	the GenShard
+ * @param[in] 	chunk 	index of the chunk
+ */
+void gensvm_shard_finish(struct GenShard *shard, long chunk)
+{
+	int fd;
+	char *done = gensvm_shard_path(shard, chunk, "done");
+	char *lease = gensvm_shard_path(shard, chunk, "lease");
+
+	fd = open(done, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if (fd < 0) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: Couldn't create file %s\n", done);
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
+	if (write(fd, shard->worker, strlen(shard->worker)) < 0)
+		err("[GenSVM Warning]: Couldn't write to %s\n", done); // LCOV_EXCL_LINE
+	fsync(fd);
+	close(fd);
+	gensvm_shard_release_lease(shard, lease);
+
+	Free(done);
+	Free(lease);
+}
+
+/**
+ * @brief Thread function of the heartbeat of a lease
+ *
+ * @param[in] 	arg 	the GenShardHeartbeat
+ * @returns 		NULL
+ */
+static void *gensvm_shard_heartbeat(void *arg)
+{
+	int fd;
+	struct timespec until;
+	struct GenShardHeartbeat *hb = arg;
+	long interval = maximum(hb->shard->lease_time / 4, 1);
+
+	pthread_mutex_lock(&hb->lock);
+	while (!hb->stop) {
+		clock_gettime(CLOCK_REALTIME, &until);
+		until.tv_sec += interval;
+		pthread_cond_timedwait(&hb->cond, &hb->lock, &until);
+		if (hb->stop)
+			break;
+		fd = gensvm_shard_open_lease(hb->shard, hb->lease);
+		if (fd >= 0) {
+			futimens(fd, NULL);
+			close(fd);
+		}
+	}
+	pthread_mutex_unlock(&hb->lock);
+	return NULL;
+}
+
+/**
+ * @brief Start the heartbeat of a lease
+ *
+ * @details
+ * The expiry of a lease is based on the modification time of the lease
+ * file. A thread is started that sets this time to the current time every
+ * quarter of GenShard::lease_time, as long as this worker holds the lease.
+ * The lease therefore only expires if the worker stops, and not if a
+ * single task takes longer than the lease time.
+ *
+ * @param[in] 	shard 	the GenShard
+ * @param[in] 	lease 	path of the lease file held by this worker
+ * @returns 		the heartbeat, to be stopped with
+ * 			gensvm_shard_stop_heartbeat()
+ */
+struct GenShardHeartbeat *gensvm_shard_start_heartbeat(
+		struct GenShard *shard, char *lease)
+{
+	struct GenShardHeartbeat *hb = Malloc(struct GenShardHeartbeat, 1);
+
+	hb->shard = shard;
+	hb->lease = Malloc(char, strlen(lease)+1);
+	strcpy(hb->lease, lease);
+	hb->stop = false;
+	pthread_mutex_init(&hb->lock, NULL);
+	pthread_cond_init(&hb->cond, NULL);
+	if (pthread_create(&hb->thread, NULL, gensvm_shard_heartbeat,
+				hb) != 0) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: Couldn't create thread\n");
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
+	return hb;
+}
+
+/**
+ * @brief Stop the heartbeat of a lease
+ *
+ * @details
+ * The thread of the heartbeat is stopped and the heartbeat is freed. The
+ * lease itself is not removed.
+ *
+ * @param[in] 	hb 	the GenShardHeartbeat to stop
+ */
+void gensvm_shard_stop_heartbeat(struct GenShardHeartbeat *hb)
+{
+	pthread_mutex_lock(&hb->lock);
+	hb->stop = true;
+	pthread_cond_signal(&hb->cond);
+	pthread_mutex_unlock(&hb->lock);
+	pthread_join(hb->thread, NULL);
+
+	pthread_mutex_destroy(&hb->lock);
+	pthread_cond_destroy(&hb->cond);
+	Free(hb->lease);
+	Free(hb);
+}
+
+/**
+ * @brief Train the tasks of a single chunk
+ *
+ * @details
+ * The tasks in the chunk are trained with gensvm_train_queue(), using the
+ * journal of the chunk in the shared directory. Tasks which are already in
+ * the journal (because a previous worker on this chunk was interrupted) are
+ * not trained again. The generator of the context is seeded with
+ * GenShard::seed before training, such that every chunk uses the same cross
+ * validation split.
+ *
+ * @param[in] 		shard 	the GenShard
+ * @param[in,out] 	q 	the full GenQueue
+ * @param[in] 		chunk 	index of the chunk
+ * @param[in] 		ctx 	the GenContext, or NULL to use the global
+ * 				state
+ */
+void gensvm_shard_train_chunk(struct GenShard *shard, struct GenQueue *q,
+		long chunk, struct GenContext *ctx)
+{
+	long start = chunk * shard->chunk_size;
+	long stop = minimum(start + shard->chunk_size, q->N);
+	char *path = gensvm_shard_path(shard, chunk, "journal");
+	struct GenJournal *journal = gensvm_journal_open(path);
+	struct GenQueue *sub = gensvm_init_queue();
+
+	// the subqueue shares the tasks of the full queue
+	sub->tasks = q->tasks + start;
+	sub->N = stop - start;
+
+	gensvm_note(ctx, "Training chunk %li (tasks %li to %li)\n", chunk,
+			start+1, stop);
+	gensvm_context_seed(ctx, shard->seed);
+	gensvm_train_queue(sub, journal, ctx);
+
+	gensvm_free_journal(journal);
+	Free(sub);
+	Free(path);
+}
+
+/**
+ * @brief Work on a sharded grid search until all chunks are finished
+ *
+ * @details
+ * The chunks of the queue are scanned in order, and every chunk that can be
+ * claimed is trained and marked as finished. The lease of the chunk is kept
+ * active with gensvm_shard_start_heartbeat() during training. If there are chunks left that
+ * are held by other workers, the directory is scanned again after
+ * GenShard::poll_time seconds, such that expired leases are taken over. This
+ * function returns when all chunks are finished.
+ *
+ * @param[in] 		shard 	the GenShard
+ * @param[in,out] 	q 	the full GenQueue
+ * @param[in] 		ctx 	the GenContext, or NULL to use the global
+ * 				state
+ */
+void gensvm_shard_work(struct GenShard *shard, struct GenQueue *q,
+		struct GenContext *ctx)
+{
+	long c, remaining;
+	long n_chunks = (q->N + shard->chunk_size - 1) / shard->chunk_size;
+	char *lease = NULL;
+	struct GenShardHeartbeat *hb = NULL;
+
+	gensvm_note(ctx, "Worker %s on %li chunks in %s\n", shard->worker,
+			n_chunks, shard->dir);
+	while (true) {
+		remaining = 0;
+		for (c=0; c<n_chunks; c++) {
+			if (gensvm_shard_is_done(shard, c))
+				continue;
+			if (gensvm_shard_claim(shard, c)) {
+				lease = gensvm_shard_path(shard, c, "lease");
+				hb = gensvm_shard_start_heartbeat(shard, lease);
+				gensvm_shard_train_chunk(shard, q, c, ctx);
+				gensvm_shard_stop_heartbeat(hb);
+				gensvm_shard_finish(shard, c);
+				Free(lease);
+			} else {
+				remaining++;
+			}
+		}
+		if (remaining == 0)
+			break;
+		gensvm_note(ctx, "Waiting for %li chunks of other workers\n",
+				remaining);
+		sleep(shard->poll_time);
+	}
+}
+
+/**
+ * @brief Merge the results of a sharded grid search
+ *
+ * @details
+ * The merge is done by a single worker, which takes the lease
+ * @c merge.lease in the shared directory with gensvm_shard_take_lease(), in
+ * the same way as the lease of a chunk. The other workers wait until the
+ * merged results exist, and take over the lease if it expires because the
+ * merging worker stopped.
+ *
+ * The elected worker reads the journals of all chunks into a new journal
+ * @c merge.journal.tmp, and runs gensvm_train_queue() with it, which fills
+ * in the performance of all tasks in the queue. Any task which is missing
+ * from the journals is trained by the merging worker and appended to this
+ * journal. The lease is kept active with a heartbeat during the merge (see
+ * gensvm_shard_start_heartbeat()). The entries of the chunks are then
+ * written to the journal as well, which is renamed to @c merge.journal when
+ * it is complete. Finally the merge lease is removed. This function should
+ * be called after gensvm_shard_work().
+ *
+ * @param[in] 		shard 	the GenShard
+ * @param[in,out] 	q 	the full GenQueue
+ * @param[in] 		ctx 	the GenContext, or NULL to use the global
+ * 				state
+ * @returns 			true if this worker merged the results, false
+ * 				if another worker did so
+ */
+bool gensvm_shard_merge(struct GenShard *shard, struct GenQueue *q,
+		struct GenContext *ctx)
+{
+	bool elected = false;
+	long c, i, n_read;
+	long n_chunks = (q->N + shard->chunk_size - 1) / shard->chunk_size;
+	char *lease = gensvm_shard_path(shard, -1, "merge.lease");
+	char *tmp = gensvm_shard_path(shard, -1, "merge.journal.tmp");
+	char *merged = gensvm_shard_path(shard, -1, "merge.journal");
+	char *path = NULL;
+	struct GenJournalEntry entry;
+	struct GenJournal *journal = NULL;
+	struct GenShardHeartbeat *hb = NULL;
+
+	while (access(merged, F_OK) != 0) {
+		if (gensvm_shard_take_lease(shard, lease, tmp)) {
+			// the merge may have finished while we took the lease
+			if (access(merged, F_OK) == 0)
+				gensvm_shard_release_lease(shard, lease);
+			else
+				elected = true;
+			break;
+		}
+		gensvm_note(ctx, "Waiting for the merge of another worker\n");
+		sleep(shard->poll_time);
+	}
+	if (!elected)
+		goto cleanup;
+
+	// a previous merging worker may have left an incomplete journal
+	hb = gensvm_shard_start_heartbeat(shard, lease);
+	unlink(tmp);
+	journal = gensvm_journal_open(tmp);
+	for (c=0; c<n_chunks; c++) {
+		path = gensvm_shard_path(shard, c, "journal");
+		gensvm_journal_read(journal, path);
+		Free(path);
+	}
+	n_read = journal->N;
+
+	gensvm_note(ctx, "Merging results of %li chunks\n", n_chunks);
+	q->i = 0;
+	gensvm_context_seed(ctx, shard->seed);
+	gensvm_train_queue(q, journal, ctx);
+
+	// the tasks trained here are in the file, add those of the chunks
+	for (i=0; i<n_read; i++) {
+		entry = journal->entries[i];
+		gensvm_journal_append(journal, entry.key, entry.performance,
+				entry.iter, entry.duration, entry.temperature);
+	}
+	gensvm_free_journal(journal);
+
+	if (rename(tmp, merged) != 0) {
+		// LCOV_EXCL_START
+		err("[GenSVM Error]: Couldn't rename %s to %s\n", tmp,
+				merged);
+		exit(EXIT_FAILURE);
+		// LCOV_EXCL_STOP
+	}
+	gensvm_shard_stop_heartbeat(hb);
+	gensvm_shard_release_lease(shard, lease);
+
+cleanup:
+	Free(lease);
+	Free(tmp);
+	Free(merged);
+	return elected;
+}
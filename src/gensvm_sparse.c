@@ -61,10 +61,10 @@ struct GenSparse *gensvm_init_sparse(void)
  */
 void gensvm_free_sparse(struct GenSparse *sp)
 {
-	free(sp->values);
-	free(sp->ia);
-	free(sp->ja);
-	free(sp);
+	Free(sp->values);
+	Free(sp->ia);
+	Free(sp->ja);
+	Free(sp);
 	sp = NULL;
 }
 
@@ -0,0 +1,154 @@
+/**
+ * @file gensvm_stream.c
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Functions for streaming the rows of a data matrix in blocks
+ *
+ * @details
+ * A dataset that is read from a binary data file (see
+ * gensvm_read_data_binary()) lies in a memory map of the file, so the data
+ * doesn't have to fit in memory. When GenData::out_of_core is set, the
+ * functions that pass over the rows of the data matrix do so in blocks of
+ * #GENSVM_BLOCK_SIZE rows. Before a block is processed the next block is
+ * prefetched with gensvm_stream_prefetch(), such that reading the file
+ * overlaps with the computations on the current block. After a block is
+ * processed its pages are released with gensvm_stream_release(). Only the
+ * arrays of size O(n*K) therefore stay in memory during training.
+ *
+ * Both functions are hints to the operating system and don't change the
+ * data. They do nothing if GenData::out_of_core is not set, or if the data
+ * matrix doesn't lie in a memory map.
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "gensvm_stream.h"
+
+/**
+ * @brief Give advice on a memory range to the operating system
+ *
+ * @details
+ * The range is clipped to the memory map. Since madvise() works on whole
+ * pages, the range is extended to whole pages if @p outward is true, and
+ * shrunk to whole pages otherwise. The latter is used when pages are
+ * released, to keep the neighbouring rows in memory.
+ *
+ * @param[in] 	map 	memory map that holds the range
+ * @param[in] 	start 	start of the range
+ * @param[in] 	end 	end of the range
+ * @param[in] 	advice 	advice for madvise()
+ * @param[in] 	outward whether to extend or shrink the range to whole pages
+ */
+static void gensvm_stream_advise(struct GenFileMap *map, const void *start,
+		const void *end, int advice, bool outward)
+{
+	uintptr_t page = sysconf(_SC_PAGESIZE);
+	uintptr_t lo = (uintptr_t) start;
+	uintptr_t hi = (uintptr_t) end;
+
+	lo = maximum(lo, (uintptr_t) map->data);
+	hi = minimum(hi, (uintptr_t) (map->data + map->size));
+	if (lo >= hi)
+		return;
+
+	if (outward) {
+		lo -= lo % page;
+		hi += (page - hi % page) % page;
+	} else {
+		lo += (page - lo % page) % page;
+		hi -= hi % page;
+	}
+	if (lo < hi)
+		madvise((void *) lo, hi - lo, advice);
+}
+
+/**
+ * @brief Give advice on the rows of a data matrix to the operating system
+ *
+ * @param[in] 	data 	GenData with GenData::out_of_core set
+ * @param[in] 	start 	first row
+ * @param[in] 	end 	row after the last row
+ * @param[in] 	advice 	advice for madvise()
+ * @param[in] 	outward whether to extend or shrink the range to whole pages
+ */
+static void gensvm_stream_advise_rows(struct GenData *data, long start,
+		long end, int advice, bool outward)
+{
+	long m = data->m;
+	struct GenFileMap *map = data->map;
+	struct GenSparse *spZ = data->spZ;
+
+	if (!data->out_of_core || map == NULL || !map->mapped)
+		return;
+
+	start = maximum(start, 0);
+	end = minimum(end, data->n);
+	if (start >= end)
+		return;
+
+	if (data->Z != NULL && gensvm_map_contains(map, data->Z)) {
+		gensvm_stream_advise(map, data->Z + start*(m+1),
+				data->Z + end*(m+1), advice, outward);
+	} else if (data->Z == NULL && gensvm_map_contains(map, spZ->ja)) {
+		gensvm_stream_advise(map, spZ->ja + spZ->ia[start],
+				spZ->ja + spZ->ia[end], advice, outward);
+		gensvm_stream_advise(map, spZ->values + spZ->ia[start],
+				spZ->values + spZ->ia[end], advice,
+				outward);
+	}
+}
+
+/**
+ * @brief Prefetch rows of the data matrix
+ *
+ * @details
+ * The operating system starts reading the rows from the file in the
+ * background, and this function returns immediately.
+ *
+ * @param[in] 	data 	GenData structure
+ * @param[in] 	start 	first row to prefetch
+ * @param[in] 	end 	row after the last row to prefetch
+ */
+void gensvm_stream_prefetch(struct GenData *data, long start, long end)
+{
+	gensvm_stream_advise_rows(data, start, end, MADV_WILLNEED, true);
+}
+
+/**
+ * @brief Release rows of the data matrix from memory
+ *
+ * @details
+ * The pages that hold the rows are reclaimed by the operating system. The
+ * data is not lost: it is read from the file again when it is used. If the
+ * operating system doesn't support this, the pages are only marked as
+ * suitable for reclaiming.
+ *
+ * @param[in] 	data 	GenData structure
+ * @param[in] 	start 	first row to release
+ * @param[in] 	end 	row after the last row to release
+ */
+void gensvm_stream_release(struct GenData *data, long start, long end)
+{
+#if defined(MADV_PAGEOUT)
+	gensvm_stream_advise_rows(data, start, end, MADV_PAGEOUT, false);
+#elif defined(MADV_COLD)
+	gensvm_stream_advise_rows(data, start, end, MADV_COLD, false);
+#endif
+}
@@ -166,13 +166,53 @@ char **str_split(char *original, const char *delims, int *len_ret)
 
 		token = strtok(NULL, all_delim);
 	}
-	free(copy);
+	Free(copy);
 
 	*len_ret = i;
 
 	return result;
 }
 
+/**
+ * @brief Convert a size with an optional unit to a number of bytes
+ *
+ * @details
+ * The size is a number followed by an optional unit K, M, G or T (for
+ * powers of 1024), such as "512M" or "1.5G". A number without a unit is a
+ * number of bytes.
+ *
+ * @param[in] 	str 	the size
+ * @returns 		the number of bytes, or 0 if the size is invalid
+ */
+size_t str_to_bytes(const char *str)
+{
+	char *end = NULL;
+	double size = strtod(str, &end);
+
+	if (end == str || size < 0)
+		return 0;
+	switch (toupper(*end)) {
+		case 'T':
+			size *= 1024.0;
+			// fall through
+		case 'G':
+			size *= 1024.0;
+			// fall through
+		case 'M':
+			size *= 1024.0;
+			// fall through
+		case 'K':
+			size *= 1024.0;
+			end++;
+			break;
+	}
+	if (toupper(*end) == 'B')
+		end++;
+	if (*end != '\0')
+		return 0;
+	return (size_t) size;
+}
+
 /**
  * @brief Move to next line in file
  *
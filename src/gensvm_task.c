@@ -42,6 +42,7 @@ struct GenTask *gensvm_init_task(void)
 	t->kerneltype = K_LINEAR;
 	t->weight_idx = 1;
 	t->folds = 10;
+	t->stratified = false;
 	t->ID = -1;
 	t->p = 1.0;
 	t->kappa = 0.0;
@@ -53,6 +54,7 @@ struct GenTask *gensvm_init_task(void)
 	t->train_data = NULL;
 	t->test_data = NULL;
 	t->performance = 0.0;
+	t->temperature = 1.0;
 	t->max_iter = 1000000000;
 
 	return t;
@@ -70,7 +72,7 @@ struct GenTask *gensvm_init_task(void)
  */
 void gensvm_free_task(struct GenTask *t)
 {
-	free(t);
+	Free(t);
 	t = NULL;
 }
 
@@ -90,6 +92,7 @@ struct GenTask *gensvm_copy_task(struct GenTask *t)
 	struct GenTask *nt = gensvm_init_task();
 	nt->weight_idx = t->weight_idx;
 	nt->folds = t->folds;
+	nt->stratified = t->stratified;
 	nt->ID = t->ID;
 	nt->p = t->p;
 	nt->kappa = t->kappa;
@@ -98,6 +101,7 @@ struct GenTask *gensvm_copy_task(struct GenTask *t)
 	nt->train_data = t->train_data;
 	nt->test_data = t->test_data;
 	nt->performance = t->performance;
+	nt->temperature = t->temperature;
 
 	nt->kerneltype = t->kerneltype;
 	nt->gamma = t->gamma;
@@ -136,4 +140,5 @@ void gensvm_task_to_model(struct GenTask *task, struct GenModel *model)
 
 	// copy other parameters
 	model->max_iter = task->max_iter;
+	model->temperature = task->temperature;
 }
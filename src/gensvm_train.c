@@ -36,13 +36,21 @@
  * model can be passed to the function to seed the V matrix with. When no such 
  * model is used this parameter should be set to NULL.
  *
+ * The random number generator and the output streams are taken from the
+ * GenContext. Models can be trained concurrently in different threads if
+ * every thread uses its own context. If memory use is tracked (see
+ * gensvm_memory_track()), a report of the memory use is written at the
+ * end.
+ *
  * @param[in] 	model 		a GenModel instance
  * @param[in] 	data 		a GenData instance with the training data
  * @param[in] 	seed_model 	an optional GenModel to seed the V matrix
+ * @param[in] 	ctx 		the GenContext, or NULL to use the global
+ * 				state
  *
  */
 void gensvm_train(struct GenModel *model, struct GenData *data,
-		struct GenModel *seed_model)
+		struct GenModel *seed_model, struct GenContext *ctx)
 {
 	long real_seed;
 
@@ -56,7 +64,7 @@ void gensvm_train(struct GenModel *model, struct GenData *data,
 
 	// set the random seed
 	real_seed = (model->seed == -1) ? time(NULL) : model->seed;
-	srand(real_seed);
+	gensvm_context_seed(ctx, real_seed);
 
 	// preprocess kernel
 	gensvm_kernel_preprocess(model, data);
@@ -65,11 +73,14 @@ void gensvm_train(struct GenModel *model, struct GenData *data,
 	gensvm_reallocate_model(model, data->n, data->r);
 
 	// initialize the V matrix (potentially with a seed model)
-	gensvm_init_V(seed_model, model, data);
+	gensvm_init_V(seed_model, model, data, ctx);
 
 	// initialize weights
 	gensvm_initialize_weights(data, model);
 
 	// start training
-	gensvm_optimize(model, data);
+	gensvm_optimize(model, data, ctx);
+
+	// print the memory use if it is tracked
+	gensvm_memory_report(ctx);
 }
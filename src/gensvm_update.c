@@ -26,14 +26,6 @@
 
 #include "gensvm_update.h"
 
-/**
- * Number of rows in a single block for the ZAZ calculation in 
- * gensvm_get_ZAZ_ZB_sparse().
- */
-#ifndef GENSVM_BLOCK_SIZE
-  #define GENSVM_BLOCK_SIZE 512
-#endif
-
 /**
  * @brief Calculate the value of omega for a single instance
  *
@@ -328,6 +320,7 @@ void gensvm_get_update(struct GenModel *model, struct GenData *data,
 
 	long m = model->m;
 	long K = model->K;
+	long ld = work->ld;
 
 	// compute the ZAZ and ZB matrices
 	gensvm_get_ZAZ_ZB(model, data, work);
@@ -336,26 +329,26 @@ void gensvm_get_update(struct GenModel *model, struct GenData *data,
 	// dsymm performs ZB := 1.0 * (ZAZ) * Vbar + 1.0 * ZB
 	// the right-hand side is thus stored in ZB after this call
 	// Note: LDB and LDC are second dimensions of the matrices due to
-	// Row-Major order
+	// Row-Major order, and the second dimension of ZAZ is padded
 	cblas_dsymm(CblasRowMajor, CblasLeft, CblasUpper, m+1, K-1, 1,
-			work->ZAZ, m+1, model->V, K-1, 1.0, work->ZB, K-1);
+			work->ZAZ, ld, model->V, K-1, 1.0, work->ZB, K-1);
 
 	// Calculate left-hand side of system we want to solve
 	// Add lambda to all diagonal elements except the first one. Recall
 	// that ZAZ is of size m+1 and is symmetric.
-	for (i=m+2; i<=m*(m+2); i+=m+2)
-		work->ZAZ[i] += model->lambda;
+	for (i=1; i<m+1; i++)
+		matrix_add(work->ZAZ, ld, i, i, model->lambda);
 
 	// Lapack uses column-major order, so we transform the ZB matrix to
 	// correspond to this.
 	for (i=0; i<m+1; i++)
 		for (j=0; j<K-1; j++)
-			work->ZBc[j*(m+1)+i] = work->ZB[i*(K-1)+j];
+			work->ZBc[j*ld+i] = work->ZB[i*(K-1)+j];
 
 	// Solve the system using dposv. Note that above the upper triangular
 	// part has always been used in row-major order for ZAZ. This
 	// corresponds to the lower triangular part in column-major order.
-	status = dposv('L', m+1, K-1, work->ZAZ, m+1, work->ZBc, m+1);
+	status = dposv('L', m+1, K-1, work->ZAZ, ld, work->ZBc, ld);
 
 	// Use dsysv as fallback, for when the ZAZ matrix is not positive
 	// semi-definite for some reason (perhaps due to rounding errors).
@@ -365,19 +358,19 @@ void gensvm_get_update(struct GenModel *model, struct GenData *data,
 				"dposv: %i\n", status);
 		int *IPIV = Malloc(int, m+1);
 		double *WORK = Malloc(double, 1);
-		status = dsysv('L', m+1, K-1, work->ZAZ, m+1, IPIV, work->ZBc,
-				m+1, WORK, -1);
+		status = dsysv('L', m+1, K-1, work->ZAZ, ld, IPIV, work->ZBc,
+				ld, WORK, -1);
 
 		int LWORK = WORK[0];
 		WORK = Realloc(WORK, double, LWORK);
-		status = dsysv('L', m+1, K-1, work->ZAZ, m+1, IPIV, work->ZBc,
-				m+1, WORK, LWORK);
+		status = dsysv('L', m+1, K-1, work->ZAZ, ld, IPIV, work->ZBc,
+				ld, WORK, LWORK);
 		if (status != 0)
 			err("[GenSVM Warning]: Received nonzero "
 					"status from dsysv: %i\n", status);
-		free(WORK);
+		Free(WORK);
 		WORK = NULL;
-		free(IPIV);
+		Free(IPIV);
 		IPIV = NULL;
 	}
 
@@ -385,7 +378,7 @@ void gensvm_get_update(struct GenModel *model, struct GenData *data,
 	// convert this back to row-major order
 	for (i=0; i<m+1; i++)
 		for (j=0; j<K-1; j++)
-			work->ZB[i*(K-1)+j] = work->ZBc[j*(m+1)+i];
+			work->ZB[i*(K-1)+j] = work->ZBc[j*ld+i];
 
 	// copy the old V to Vbar and the new solution to V
 	for (i=0; i<m+1; i++) {
@@ -410,6 +403,12 @@ void gensvm_get_update(struct GenModel *model, struct GenData *data,
  * the most efficient way to do these computations in several simulation
  * studies.
  *
+ * The rows of Z are processed in blocks of #GENSVM_BLOCK_SIZE rows, such
+ * that LZ only holds a single block. This also allows the data to be
+ * streamed from a memory map, see gensvm_stream.c. The rows of LZ and ZAZ
+ * are padded to GenWork::ld elements, such that every row of LZ starts on
+ * a cache line.
+ *
  * @param[in] 		model 	a GenModel holding the current model
  * @param[in] 		data 	a GenData with the data
  * @param[in,out] 	work 	an allocated GenWork structure, contains
@@ -418,38 +417,51 @@ void gensvm_get_update(struct GenModel *model, struct GenData *data,
 void gensvm_get_ZAZ_ZB_dense(struct GenModel *model, struct GenData *data,
 		struct GenWork *work)
 {
-	long i;
-	double alpha, sqalpha;
+	long i, blk_start, blk_end;
+	double alpha, sqalpha, *LZ_row = NULL;
 
 	long n = model->n;
 	long m = model->m;
 	long K = model->K;
 
-	// generate Z'*A*Z and Z'*B by rank 1 operations
-	for (i=0; i<n; i++) {
-		alpha = gensvm_get_alpha_beta(model, data, i, work->beta);
-
-		// calculate row of matrix LZ, which is a scalar
-		// multiplication of sqrt(alpha_i) and row z_i' of Z
-		// Note that we use the fact that the first column of Z is
-		// always 1, by only computing the product for m values and
-		// copying the first element over.
-		sqalpha = sqrt(alpha);
-		work->LZ[i*(m+1)] = sqalpha;
-		cblas_daxpy(m, sqalpha, &data->Z[i*(m+1)+1], 1,
-				&work->LZ[i*(m+1)+1], 1);
-
-		// rank 1 update of matrix Z'*B
-		// Note: LDA is the second dimension of ZB because of
-		// Row-Major order
-		cblas_dger(CblasRowMajor, m+1, K-1, 1, &data->Z[i*(m+1)], 1,
-				work->beta, 1, work->ZB, K-1);
-	}
+	for (blk_start=0; blk_start<n; blk_start+=GENSVM_BLOCK_SIZE) {
+		blk_end = minimum(n, blk_start + GENSVM_BLOCK_SIZE);
+		gensvm_stream_prefetch(data, blk_end,
+				blk_end + GENSVM_BLOCK_SIZE);
+
+		// generate Z'*A*Z and Z'*B by rank 1 operations
+		for (i=blk_start; i<blk_end; i++) {
+			alpha = gensvm_get_alpha_beta(model, data, i,
+					work->beta);
+
+			// calculate row of matrix LZ, which is a scalar
+			// multiplication of sqrt(alpha_i) and row z_i' of Z
+			// Note that we use the fact that the first column of
+			// Z is always 1, by only computing the product for m
+			// values and copying the first element over.
+			sqalpha = sqrt(alpha);
+			LZ_row = &work->LZ[(i - blk_start)*work->ld];
+			LZ_row[0] = sqalpha;
+			cblas_dcopy(m, &data->Z[i*(m+1)+1], 1, LZ_row+1, 1);
+			cblas_dscal(m, sqalpha, LZ_row+1, 1);
+
+			// rank 1 update of matrix Z'*B
+			// Note: LDA is the second dimension of ZB because of
+			// Row-Major order
+			cblas_dger(CblasRowMajor, m+1, K-1, 1,
+					&data->Z[i*(m+1)], 1, work->beta, 1,
+					work->ZB, K-1);
+		}
+
+		// add the Z'*A*Z of this block by symmetric multiplication of
+		// LZ with itself (ZAZ += (LZ)' * (LZ))
+		cblas_dsyrk(CblasRowMajor, CblasUpper, CblasTrans, m+1,
+				blk_end - blk_start, 1.0, work->LZ, work->ld,
+				(blk_start == 0) ? 0.0 : 1.0, work->ZAZ,
+				work->ld);
 
-	// calculate Z'*A*Z by symmetric multiplication of LZ with itself
-	// (ZAZ = (LZ)' * (LZ)
-	cblas_dsyrk(CblasRowMajor, CblasUpper, CblasTrans, m+1, n, 1.0,
-			work->LZ, m+1, 0.0, work->ZAZ, m+1);
+		gensvm_stream_release(data, blk_start, blk_end);
+	}
 }
 
 /**
@@ -485,7 +497,7 @@ void gensvm_get_ZAZ_ZB_sparse(struct GenModel *model, struct GenData *data,
 	     *Zja = NULL;
 	long b, i, j, k, K, jj, kk, jj_start, jj_end, blk_start, blk_end,
 	     rem_size, n_blocks, n_row = data->spZ->n_row,
-	     n_col = data->spZ->n_col;
+	     n_col = data->spZ->n_col, ld = work->ld;
 	double temp, alpha, z_ij, *vals = NULL;
 
 	K = model->K;
@@ -505,7 +517,10 @@ void gensvm_get_ZAZ_ZB_sparse(struct GenModel *model, struct GenData *data,
 		blk_end = blk_start;
 		blk_end += (b == n_blocks) ? rem_size : GENSVM_BLOCK_SIZE;
 
-		Memset(work->tmpZAZ, double, n_col*n_col);
+		gensvm_stream_prefetch(data, blk_end,
+				blk_end + GENSVM_BLOCK_SIZE);
+
+		Memset(work->tmpZAZ, double, n_col*ld);
 		for (i=blk_start; i<blk_end; i++) {
 			alpha = gensvm_get_alpha_beta(model, data, i, 
 					work->beta);
@@ -519,7 +534,7 @@ void gensvm_get_ZAZ_ZB_sparse(struct GenModel *model, struct GenData *data,
 						&work->ZB[j*(K-1)], 1);
 				z_ij *= alpha;
 				for (kk=jj; kk<jj_end; kk++) {
-					matrix_add(work->tmpZAZ, n_col, j, 
+					matrix_add(work->tmpZAZ, ld, j,
 							Zja[kk], 
 							z_ij * vals[kk]);
 				}
@@ -529,10 +544,12 @@ void gensvm_get_ZAZ_ZB_sparse(struct GenModel *model, struct GenData *data,
 		// copy the intermediate results over to the actual ZAZ matrix
 		for (j=0; j<n_col; j++) {
 			for (k=j; k<n_col; k++) {
-				temp = matrix_get(work->tmpZAZ, n_col, j, k);
-				matrix_add(work->ZAZ, n_col, j, k, temp);
+				temp = matrix_get(work->tmpZAZ, ld, j, k);
+				matrix_add(work->ZAZ, ld, j, k, temp);
 			}
 		}
+
+		gensvm_stream_release(data, blk_start, blk_end);
 	}
 }
 
@@ -72,6 +72,7 @@ void gensvm_calculate_ZV_sparse(struct GenModel *model,
 {
 	long i, j, jj, jj_start, jj_end, K,
 	    n_row = data->spZ->n_row;
+	long blk_start, blk_end;
 	double z_ij;
 
 	K = model->K;
@@ -80,17 +81,25 @@ void gensvm_calculate_ZV_sparse(struct GenModel *model,
 	long *Zja = data->spZ->ja;
 	double *vals = data->spZ->values;
 
-	for (i=0; i<n_row; i++) {
-		jj_start = Zia[i];
-		jj_end = Zia[i+1];
+	for (blk_start=0; blk_start<n_row; blk_start+=GENSVM_BLOCK_SIZE) {
+		blk_end = minimum(n_row, blk_start + GENSVM_BLOCK_SIZE);
+		gensvm_stream_prefetch(data, blk_end,
+				blk_end + GENSVM_BLOCK_SIZE);
 
-		for (jj=jj_start; jj<jj_end; jj++) {
-			j = Zja[jj];
-			z_ij = vals[jj];
+		for (i=blk_start; i<blk_end; i++) {
+			jj_start = Zia[i];
+			jj_end = Zia[i+1];
 
-			cblas_daxpy(K-1, z_ij, &model->V[j*(K-1)], 1,
-					&ZV[i*(K-1)], 1);
+			for (jj=jj_start; jj<jj_end; jj++) {
+				j = Zja[jj];
+				z_ij = vals[jj];
+
+				cblas_daxpy(K-1, z_ij, &model->V[j*(K-1)], 1,
+						&ZV[i*(K-1)], 1);
+			}
 		}
+
+		gensvm_stream_release(data, blk_start, blk_end);
 	}
 }
 
@@ -99,7 +108,8 @@ void gensvm_calculate_ZV_sparse(struct GenModel *model,
  *
  * @details
  * This function uses cblas_dgemm() to compute the matrix product between Z 
- * and V.
+ * and V. If the data is streamed (see GenData::out_of_core), the product is
+ * computed for one block of rows at a time.
  *
  * @param[in] 	model 	a GenModel instance holding the model
  * @param[in] 	data 	a GenData instance with the data
@@ -112,7 +122,23 @@ void gensvm_calculate_ZV_dense(struct GenModel *model,
 	long n = data->n;
 	long m = model->m;
 	long K = model->K;
+	long blk_start, blk_end;
 
-	cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, n, K-1, m+1,
-			1.0, data->Z, m+1, model->V, K-1, 0, ZV, K-1);
+	if (!data->out_of_core) {
+		cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, n, K-1,
+				m+1, 1.0, data->Z, m+1, model->V, K-1, 0, ZV,
+				K-1);
+		return;
+	}
+
+	for (blk_start=0; blk_start<n; blk_start+=GENSVM_BLOCK_SIZE) {
+		blk_end = minimum(n, blk_start + GENSVM_BLOCK_SIZE);
+		gensvm_stream_prefetch(data, blk_end,
+				blk_end + GENSVM_BLOCK_SIZE);
+		cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans,
+				blk_end - blk_start, K-1, m+1, 1.0,
+				&data->Z[blk_start*(m+1)], m+1, model->V,
+				K-1, 0, &ZV[blk_start*(K-1)], K-1);
+		gensvm_stream_release(data, blk_start, blk_end);
+	}
 }
@@ -112,6 +112,14 @@ char *test_init_free_work()
 	mu_assert(work->ZV != NULL, "ZV variable is NULL");
 	mu_assert(work->beta != NULL, "beta variable is NULL");
 
+	mu_assert(work->ld >= model->m+1, "ld variable is too small");
+	mu_assert(work->ld == gensvm_padded_ld(model->m+1, sizeof(double)),
+			"ld variable set incorrectly");
+	mu_assert(((size_t) work->LZ) % GENSVM_ALIGN == 0,
+			"LZ isn't aligned");
+	mu_assert(((size_t) work->ZAZ) % GENSVM_ALIGN == 0,
+			"ZAZ isn't aligned");
+
 	gensvm_free_model(model);
 	gensvm_free_work(work);
 
@@ -180,6 +188,68 @@ char *test_reset_work()
 	return NULL;
 }
 
+char *test_data_to_dense()
+{
+	struct GenData *data = gensvm_init_data();
+	double Z[] = {1.0, 0.0, 2.0,
+		      1.0, 3.0, 0.0};
+
+	data->n = 2;
+	data->m = 2;
+	data->spZ = gensvm_dense_to_sparse(Z, 2, 3);
+
+	// start test code //
+	gensvm_data_to_dense(data);
+	mu_assert(data->spZ == NULL, "spZ is not NULL");
+	mu_assert(data->Z == data->RAW, "Z is not RAW");
+	mu_assert(matrix_get(data->RAW, 3, 0, 2) == 2.0,
+			"Incorrect RAW value at 0, 2");
+	mu_assert(matrix_get(data->RAW, 3, 1, 1) == 3.0,
+			"Incorrect RAW value at 1, 1");
+	mu_assert(matrix_get(data->RAW, 3, 1, 2) == 0.0,
+			"Incorrect RAW value at 1, 2");
+
+	// converting dense data does nothing
+	gensvm_data_to_dense(data);
+	mu_assert(data->spZ == NULL, "spZ is not NULL");
+	// end test code //
+
+	gensvm_free_data(data);
+
+	return NULL;
+}
+
+char *test_init_work_arena()
+{
+	struct GenModel *model = gensvm_init_model();
+	struct GenArena *arena = gensvm_init_arena(gensvm_work_size(10, 4,
+				3));
+	model->n = 10;
+	model->m = 4;
+	model->K = 3;
+
+	struct GenWork *work = gensvm_init_work_arena(model, arena);
+
+	mu_assert(model->n == work->n, "n variable copied incorrectly");
+	mu_assert(model->m == work->m, "m variable copied incorrectly");
+	mu_assert(model->K == work->K, "K variable copied incorrectly");
+	mu_assert(work->arena == arena, "arena variable set incorrectly");
+
+	// the workspace fits exactly in the reserved arena
+	mu_assert(arena->used == arena->size, "Incorrect workspace size");
+	mu_assert(arena->n_extra == 0, "Workspace doesn't fit in arena");
+	mu_assert((char *) work->yhat + gensvm_arena_size(10, sizeof(long))
+			== arena->base + arena->used, "yhat isn't last");
+
+	// freeing the workspace leaves it to the arena
+	gensvm_free_work(work);
+	mu_assert(arena->used == arena->size, "Workspace was freed");
+
+	gensvm_free_model(model);
+	gensvm_free_arena(arena);
+
+	return NULL;
+}
 
 char *all_tests()
 {
@@ -192,9 +262,11 @@ char *all_tests()
 	mu_run_test(test_init_free_data_1);
 	mu_run_test(test_init_free_data_2);
 	mu_run_test(test_init_free_data_3);
+	mu_run_test(test_data_to_dense);
 
 	mu_run_test(test_init_free_work);
 	mu_run_test(test_reset_work);
+	mu_run_test(test_init_work_arena);
 
 	return NULL;
 }
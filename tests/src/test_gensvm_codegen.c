@@ -0,0 +1,163 @@
+/**
+ * @file test_gensvm_predictor.c
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Unit tests for gensvm_codegen.c functions
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "minunit.h"
+#include "gensvm_codegen.h"
+
+/**
+ * Read a file into a string
+ */
+char *codegen_read_file(char *filename)
+{
+	long size;
+	char *buffer = NULL;
+	FILE *fid = fopen(filename, "r");
+
+	if (fid == NULL)
+		return NULL;
+	fseek(fid, 0, SEEK_END);
+	size = ftell(fid);
+	fseek(fid, 0, SEEK_SET);
+	buffer = Calloc(char, size+1);
+	if (fread(buffer, 1, size, fid) != (size_t) size) {
+		free(buffer);
+		buffer = NULL;
+	}
+	fclose(fid);
+	return buffer;
+}
+
+char *test_gensvm_codegen_prefix()
+{
+	char prefix[GENSVM_CODEGEN_MAX_PREFIX];
+
+	gensvm_codegen_prefix("model.c", prefix);
+	mu_assert(strcmp(prefix, "model") == 0, "Incorrect prefix (1)");
+
+	gensvm_codegen_prefix("./out/edge-scorer.v2.c", prefix);
+	mu_assert(strcmp(prefix, "edge_scorer") == 0, "Incorrect prefix (2)");
+
+	gensvm_codegen_prefix("/tmp/2classes.c", prefix);
+	mu_assert(strcmp(prefix, "gensvm_2classes") == 0,
+			"Incorrect prefix (3)");
+
+	gensvm_codegen_prefix("dir/.c", prefix);
+	mu_assert(strcmp(prefix, "gensvm_model") == 0,
+			"Incorrect prefix (4)");
+
+	gensvm_codegen_prefix("a_very_long_filename_that_is_much_longer_than"
+			"_the_maximum_length_of_a_prefix.c", prefix);
+	mu_assert(strlen(prefix) == GENSVM_CODEGEN_MAX_PREFIX - 1,
+			"Incorrect length of long prefix");
+
+	return NULL;
+}
+
+char *test_gensvm_write_model_c()
+{
+	char *content = NULL,
+	     *filename = "./data/test_codegen_model.c";
+	struct GenModel *model = gensvm_init_model();
+
+	model->m = 2;
+	model->K = 3;
+	model->V = Calloc(double, (model->m+1)*(model->K-1));
+	matrix_set(model->V, model->K-1, 0, 0, 0.5);
+	matrix_set(model->V, model->K-1, 0, 1, -1.5);
+	matrix_set(model->V, model->K-1, 1, 0, 2.0);
+	matrix_set(model->V, model->K-1, 1, 1, 0.25);
+	matrix_set(model->V, model->K-1, 2, 0, -3.0);
+	matrix_set(model->V, model->K-1, 2, 1, 0.125);
+
+	// start test code //
+	gensvm_write_model_c(model, filename, "scorer");
+	content = codegen_read_file(filename);
+	mu_assert(content != NULL, "Couldn't read generated file");
+
+	mu_assert(strstr(content, "#define SCORER_M 2\n"
+				"#define SCORER_K 3\n") != NULL,
+			"Incorrect macros");
+	mu_assert(strstr(content, "static const double scorer_bias[2] = {\n"
+				"\t0.5,\n\t-1.5,\n};\n") != NULL,
+			"Incorrect bias");
+	mu_assert(strstr(content, "static const double scorer_W[2][2] = {\n"
+				"\t{\n\t\t2,\n\t\t-3,\n\t},\n"
+				"\t{\n\t\t0.25,\n\t\t0.125,\n\t},\n};\n")
+			!= NULL, "Incorrect weights");
+	mu_assert(strstr(content, "static const double scorer_U[3][2] = {\n")
+			!= NULL, "Incorrect simplex");
+	mu_assert(strstr(content,
+				"void scorer_decision(const double *x, "
+				"double *zv)\n{\n"
+				"\tzv[0] = scorer_bias[0]\n"
+				"\t\t+ scorer_W[0][0] * x[0]\n"
+				"\t\t+ scorer_W[0][1] * x[1];\n"
+				"\tzv[1] = scorer_bias[1]\n"
+				"\t\t+ scorer_W[1][0] * x[0]\n"
+				"\t\t+ scorer_W[1][1] * x[1];\n}\n") != NULL,
+			"Incorrect dense decision function");
+	mu_assert(strstr(content,
+				"\t\tif (j < 0 || j >= SCORER_M)\n"
+				"\t\t\tcontinue;\n"
+				"\t\tzv[0] += scorer_W[0][j] * val[jj];\n"
+				"\t\tzv[1] += scorer_W[1][j] * val[jj];\n")
+			!= NULL, "Incorrect sparse decision function");
+	mu_assert(strstr(content,
+				"\tbest = scorer_U[0][0] * zv[0]\n"
+				"\t\t+ scorer_U[0][1] * zv[1];\n"
+				"\tdot = scorer_U[1][0] * zv[0]\n"
+				"\t\t+ scorer_U[1][1] * zv[1];\n"
+				"\tif (dot > best) {\n"
+				"\t\tbest = dot;\n"
+				"\t\tlabel = 2;\n"
+				"\t}\n") != NULL, "Incorrect assign function");
+	mu_assert(strstr(content, "long scorer_predict(const double *x)\n")
+			!= NULL, "Missing dense predict function");
+	mu_assert(strstr(content, "long scorer_predict_sparse(const long "
+				"*idx, const double *val, long nnz)\n")
+			!= NULL, "Missing sparse predict function");
+	mu_assert(strstr(content, "cblas") == NULL, "Unexpected BLAS call");
+	mu_assert(strstr(content, "#include") == NULL,
+			"Unexpected include");
+	// end test code //
+
+	free(content);
+	remove(filename);
+	gensvm_free_model(model);
+
+	return NULL;
+}
+
+char *all_tests()
+{
+	mu_suite_start();
+	mu_run_test(test_gensvm_codegen_prefix);
+	mu_run_test(test_gensvm_write_model_c);
+
+	return NULL;
+}
+
+RUN_TESTS(all_tests);
@@ -0,0 +1,176 @@
+/**
+ * @file test_gensvm_predictor.c
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Unit tests for gensvm_compact.c functions
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "minunit.h"
+#include "gensvm_compact.h"
+#include "gensvm_predict.h"
+#include "gensvm_train.h"
+
+/**
+ * Generate a dataset with three overlapping classes
+ */
+struct GenData *compact_test_data(long n, unsigned int seed)
+{
+	long i, j;
+	double value;
+	struct GenData *data = gensvm_init_data();
+
+	data->n = n;
+	data->m = 3;
+	data->r = data->m;
+	data->K = 3;
+	data->RAW = Calloc(double, data->n*(data->m+1));
+	data->Z = data->RAW;
+	data->y = Calloc(long, data->n);
+	srand(seed);
+	for (i=0; i<data->n; i++) {
+		data->y[i] = i % data->K + 1;
+		matrix_set(data->RAW, data->m+1, i, 0, 1.0);
+		for (j=1; j<data->m+1; j++) {
+			value = 2.0*rand()/RAND_MAX + 0.5*data->y[i]*j;
+			matrix_set(data->RAW, data->m+1, i, j, value);
+		}
+	}
+	return data;
+}
+
+/**
+ * Train an RBF model on the data
+ */
+struct GenModel *compact_test_model(struct GenData *data)
+{
+	struct GenModel *model = gensvm_init_model();
+
+	model->kerneltype = K_RBF;
+	model->gamma = 0.5;
+	model->max_iter = 500;
+	model->seed = 123;
+	gensvm_train(model, data, NULL, NULL);
+
+	return model;
+}
+
+char *test_gensvm_compact_tolerance()
+{
+	long i, n_agree = 0;
+	double error, tolerance = 0.05;
+	struct GenData *train = compact_test_data(120, 123);
+	struct GenData *test = compact_test_data(60, 321);
+	struct GenData *compact_test = compact_test_data(60, 321);
+	struct GenData *support = gensvm_init_data();
+	struct GenModel *model = compact_test_model(train);
+	long *predy = Calloc(long, test->n),
+	     *compact_predy = Calloc(long, test->n);
+
+	gensvm_kernel_postprocess(model, train, test);
+	gensvm_predict_labels(test, model, predy);
+
+	// start test code //
+	error = gensvm_compact(model, train, support, tolerance);
+	mu_assert(error <= tolerance, "Incorrect error");
+	mu_assert(support->n < train->n, "Model wasn't compacted");
+	mu_assert(support->n > 0, "Empty reduced set");
+	mu_assert(support->m == train->m, "Incorrect support m");
+	mu_assert(support->r == model->K - 1, "Incorrect support r");
+	mu_assert(model->m == model->K - 1, "Incorrect model m");
+	for (i=0; i<support->n; i++) {
+		mu_assert(matrix_get(support->Z, support->r+1, i, 0) == 1.0,
+				"Incorrect column of ones");
+		mu_assert(support->y[i] >= 1 && support->y[i] <= model->K,
+				"Incorrect support label");
+	}
+
+	gensvm_kernel_postprocess(model, support, compact_test);
+	gensvm_predict_labels(compact_test, model, compact_predy);
+	for (i=0; i<test->n; i++)
+		n_agree += (predy[i] == compact_predy[i]);
+	mu_assert(n_agree >= 0.9*test->n, "Too many changed labels");
+	// end test code //
+
+	gensvm_free_model(model);
+	gensvm_free_data(train);
+	gensvm_free_data(test);
+	gensvm_free_data(compact_test);
+	gensvm_free_data(support);
+	free(predy);
+	free(compact_predy);
+
+	return NULL;
+}
+
+char *test_gensvm_compact_exact()
+{
+	long i, k, K;
+	double error;
+	struct GenData *train = compact_test_data(60, 123);
+	struct GenData *test = compact_test_data(30, 321);
+	struct GenData *compact_test = compact_test_data(30, 321);
+	struct GenData *support = gensvm_init_data();
+	struct GenModel *model = compact_test_model(train);
+	double *ZV = NULL,
+	       *compact_ZV = NULL;
+
+	K = model->K;
+	ZV = Calloc(double, test->n*(K-1));
+	compact_ZV = Calloc(double, test->n*(K-1));
+	gensvm_kernel_postprocess(model, train, test);
+	gensvm_calculate_ZV(model, test, ZV);
+
+	// start test code //
+	error = gensvm_compact(model, train, support, 0.0);
+	mu_assert(support->n == train->n, "Incorrect size of reduced set");
+	mu_assert(error < 1e-6, "Incorrect error");
+
+	gensvm_kernel_postprocess(model, support, compact_test);
+	gensvm_calculate_ZV(model, compact_test, compact_ZV);
+	for (i=0; i<test->n; i++)
+		for (k=0; k<K-1; k++)
+			mu_assert(fabs(matrix_get(ZV, K-1, i, k) -
+					matrix_get(compact_ZV, K-1, i, k)) <
+					1e-4, "Incorrect decision value");
+	// end test code //
+
+	gensvm_free_model(model);
+	gensvm_free_data(train);
+	gensvm_free_data(test);
+	gensvm_free_data(compact_test);
+	gensvm_free_data(support);
+	free(ZV);
+	free(compact_ZV);
+
+	return NULL;
+}
+
+char *all_tests()
+{
+	mu_suite_start();
+	mu_run_test(test_gensvm_compact_tolerance);
+	mu_run_test(test_gensvm_compact_exact);
+
+	return NULL;
+}
+
+RUN_TESTS(all_tests);
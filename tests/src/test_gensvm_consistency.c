@@ -27,6 +27,8 @@
 #include "minunit.h"
 #include "gensvm_consistency.h"
 
+extern FILE *GENSVM_OUTPUT_FILE;
+
 char *test_doublesort()
 {
 	double a = 1.0;
@@ -112,7 +114,7 @@ char *test_top_queue()
 	// start test code //
 
 	// boundary should be determined at: 0.389501266501712
-	struct GenQueue *nq = gensvm_top_queue(q, 75.0);
+	struct GenQueue *nq = gensvm_top_queue(q, 75.0, NULL);
 	mu_assert(nq->N == 3, "Incorrect size of top queue");
 
 	// end test code //
@@ -122,9 +124,303 @@ char *test_top_queue()
 	return NULL;
 }
 
+struct GenQueue *make_consistency_queue(struct GenData *data)
+{
+	long i, j;
+	struct GenQueue *q = gensvm_init_queue();
+
+	data->n = 12;
+	data->m = 2;
+	data->r = 2;
+	data->K = 3;
+	data->y = Malloc(long, data->n);
+	data->RAW = Calloc(double, data->n*(data->m+1));
+	for (i=0; i<data->n; i++) {
+		data->y[i] = 1 + (i % 3);
+		matrix_set(data->RAW, data->m+1, i, 0, 1.0);
+		for (j=1; j<data->m+1; j++)
+			matrix_set(data->RAW, data->m+1, i, j,
+					((i*7 + j*5) % 13)/13.0 +
+					(data->y[i] == j));
+	}
+	data->Z = data->RAW;
+
+	q->N = 4;
+	q->tasks = Malloc(struct GenTask *, q->N);
+	for (i=0; i<q->N; i++) {
+		q->tasks[i] = gensvm_init_task();
+		q->tasks[i]->ID = i;
+		q->tasks[i]->folds = 3;
+		q->tasks[i]->lambda = pow(2.0, -i);
+		q->tasks[i]->performance = 50.0 + i;
+		q->tasks[i]->train_data = data;
+	}
+	return q;
+}
+
+char *test_consistency_repeat()
+{
+	long i, V_size;
+	double p;
+	struct GenData *data = gensvm_init_data();
+	struct GenQueue *q = make_consistency_queue(data);
+	struct GenQueue *sub = gensvm_init_queue();
+	struct GenRepeats *reps = Malloc(struct GenRepeats, 1);
+	FILE *fid = GENSVM_OUTPUT_FILE;
+
+	GENSVM_OUTPUT_FILE = NULL;
+	V_size = (data->m+1)*(data->K-1);
+
+	reps->q = q;
+	reps->repeats = 2;
+	reps->n_threads = 1;
+	reps->cache_size = 1;
+	reps->ctx = NULL;
+	reps->seed = 0;
+	reps->cv_idx = Calloc(long, 2*data->n);
+	reps->V = Calloc(double, 2*V_size);
+	reps->perf = Calloc(double, q->N*2);
+	reps->time = Calloc(double, q->N*2);
+	for (i=0; i<data->n; i++) {
+		reps->cv_idx[i] = i % 3;
+		reps->cv_idx[data->n + i] = i % 3;
+	}
+	for (i=0; i<V_size; i++) {
+		reps->V[i] = 0.1*(i+1);
+		reps->V[V_size + i] = 0.1*(i+1);
+	}
+
+	// identical splits and initial values give identical results,
+	// regardless of the order of the repeats
+	gensvm_consistency_repeat(reps, 1);
+	gensvm_consistency_repeat(reps, 0);
+	for (i=0; i<q->N; i++) {
+		mu_assert(matrix_get(reps->perf, 2, i, 0) >= 0.0,
+				"Performance not set");
+		mu_assert(matrix_get(reps->perf, 2, i, 0) ==
+				matrix_get(reps->perf, 2, i, 1),
+				"Repeats not equal");
+	}
+
+	// the result doesn't depend on the previous task (no warm start)
+	p = matrix_get(reps->perf, 2, 2, 0);
+	sub->tasks = q->tasks + 2;
+	sub->N = 1;
+	reps->q = sub;
+	gensvm_consistency_repeat(reps, 0);
+	mu_assert(matrix_get(reps->perf, 2, 0, 0) == p,
+			"Result depends on previous task");
+
+	GENSVM_OUTPUT_FILE = fid;
+	free(reps->cv_idx);
+	free(reps->V);
+	free(reps->perf);
+	free(reps->time);
+	free(reps);
+	free(sub);
+	gensvm_free_queue(q);
+	gensvm_free_data(data);
+
+	return NULL;
+}
+
+char *test_kernel_cache_get()
+{
+	long c, f, i;
+	long cv_idx[12];
+	struct GenData *data = gensvm_init_data();
+	struct GenQueue *q = make_consistency_queue(data);
+	struct GenData *fold_data = NULL;
+	struct GenKernelFolds cache[GENSVM_KERNEL_CACHE_SIZE];
+	struct GenKernelFolds *first = NULL,
+			      *entry = NULL;
+	struct GenModel *model = gensvm_init_model();
+	struct GenContext *ctx = gensvm_init_context(1);
+
+	for (i=0; i<12; i++)
+		cv_idx[i] = i % 3;
+	fold_data = gensvm_make_fold_data(data, cv_idx, 3);
+	for (c=0; c<GENSVM_KERNEL_CACHE_SIZE; c++) {
+		cache[c].task = NULL;
+		cache[c].used = -1;
+		cache[c].train_folds = Malloc(struct GenData *, 3);
+		cache[c].test_folds = Malloc(struct GenData *, 3);
+		for (f=0; f<3; f++) {
+			cache[c].train_folds[f] = gensvm_init_data();
+			cache[c].test_folds[f] = gensvm_init_data();
+			gensvm_get_tt_view(fold_data, cache[c].train_folds[f],
+					cache[c].test_folds[f], cv_idx, f);
+		}
+	}
+	ctx->output = NULL;
+
+	// start test code //
+	// tasks 0 and 2 have the same kernel, task 1 another one
+	for (i=0; i<3; i++) {
+		q->tasks[i]->kerneltype = K_RBF;
+		q->tasks[i]->gamma = (i == 1) ? 2.0 : 1.0;
+	}
+	gensvm_task_to_model(q->tasks[0], model);
+	first = gensvm_kernel_cache_get(cache, GENSVM_KERNEL_CACHE_SIZE,
+			q->tasks[0], model, 3, 0, ctx);
+	mu_assert(first->task == q->tasks[0], "Incorrect task of entry");
+	mu_assert(first->train_folds[0]->Z != first->train_folds[0]->RAW,
+			"Kernel not computed");
+
+	gensvm_task_to_model(q->tasks[1], model);
+	entry = gensvm_kernel_cache_get(cache, GENSVM_KERNEL_CACHE_SIZE,
+			q->tasks[1], model, 3, 1, ctx);
+	mu_assert(entry != first, "Kernel of other task reused");
+
+	gensvm_task_to_model(q->tasks[2], model);
+	entry = gensvm_kernel_cache_get(cache, GENSVM_KERNEL_CACHE_SIZE,
+			q->tasks[2], model, 3, 2, ctx);
+	mu_assert(entry == first, "Kernel not reused");
+	mu_assert(entry->task == q->tasks[0], "Entry recomputed");
+	mu_assert(entry->used == 2, "Incorrect last use of entry");
+	// end test code //
+
+	for (c=0; c<GENSVM_KERNEL_CACHE_SIZE; c++) {
+		for (f=0; f<3; f++) {
+			gensvm_free_data(cache[c].train_folds[f]);
+			gensvm_free_data(cache[c].test_folds[f]);
+		}
+		free(cache[c].train_folds);
+		free(cache[c].test_folds);
+	}
+	gensvm_free_data(fold_data);
+	gensvm_free_model(model);
+	gensvm_free_context(ctx);
+	gensvm_free_queue(q);
+	gensvm_free_data(data);
+
+	return NULL;
+}
+
+char *test_repeats_cache_size()
+{
+	long i, n_threads, cache_size;
+	size_t kept, kernel;
+	struct GenData *data = gensvm_init_data();
+	struct GenQueue *q = make_consistency_queue(data);
+
+	// start test code //
+	mu_assert(gensvm_repeats_memory(q, 3, 4) == 0,
+			"Memory of linear kernels");
+
+	for (i=0; i<q->N; i++)
+		q->tasks[i]->kerneltype = K_RBF;
+	// 3 folds of 12 instances, 8 training instances per fold
+	kept = 3*12*9*sizeof(double);
+	kernel = gensvm_kernel_memory(8);
+	mu_assert(gensvm_repeats_memory(q, 3, 4) == 3*(4*kept + kernel),
+			"Incorrect memory of the kernels");
+
+	// without a limit the full cache and all threads are used
+	n_threads = 3;
+	cache_size = gensvm_repeats_cache_size(q, &n_threads);
+	mu_assert(cache_size == GENSVM_KERNEL_CACHE_SIZE,
+			"Incorrect cache size without limit");
+	mu_assert(n_threads == 3, "Incorrect threads without limit");
+
+	// the cache is reduced first, then the number of threads
+	gensvm_memory_reset();
+	gensvm_memory_set_limit(3*(2*kept + kernel));
+	n_threads = 3;
+	cache_size = gensvm_repeats_cache_size(q, &n_threads);
+	mu_assert(cache_size == 2, "Incorrect reduced cache size");
+	mu_assert(n_threads == 3, "Incorrect threads with reduced cache");
+
+	gensvm_memory_set_limit(2*(kept + kernel));
+	n_threads = 3;
+	cache_size = gensvm_repeats_cache_size(q, &n_threads);
+	mu_assert(cache_size == 1, "Incorrect cache size");
+	mu_assert(n_threads == 2, "Incorrect reduced threads");
+
+	gensvm_memory_set_limit(1);
+	n_threads = 3;
+	cache_size = gensvm_repeats_cache_size(q, &n_threads);
+	mu_assert(cache_size == 1, "Incorrect smallest cache size");
+	mu_assert(n_threads == 1, "Incorrect smallest threads");
+	gensvm_memory_set_limit(0);
+	gensvm_memory_reset();
+	// end test code //
+
+	gensvm_free_queue(q);
+	gensvm_free_data(data);
+
+	return NULL;
+}
+
 char *test_consistency_repeats()
 {
-	mu_test_missing();
+	int best_ID;
+	struct GenData *data = gensvm_init_data();
+	struct GenQueue *q = make_consistency_queue(data);
+	FILE *fid = GENSVM_OUTPUT_FILE;
+
+	GENSVM_OUTPUT_FILE = NULL;
+	srand(123);
+	best_ID = gensvm_consistency_repeats(q, 3, 50.0, NULL);
+	mu_assert(best_ID >= 2 && best_ID <= 3, "Incorrect best ID");
+
+	GENSVM_OUTPUT_FILE = fid;
+	gensvm_free_queue(q);
+	gensvm_free_data(data);
+
+	return NULL;
+}
+
+char *test_consistency_threads()
+{
+	long i, r, repeats = 4;
+	struct GenData *data = gensvm_init_data();
+	struct GenQueue *q = make_consistency_queue(data);
+	struct GenContext *ctx = gensvm_init_context(123);
+	struct GenContext *serial_ctx = gensvm_init_context(123);
+	struct GenRepeats *reps = NULL,
+			  *serial = NULL;
+
+	ctx->output = NULL;
+	ctx->n_threads = 3;
+	serial_ctx->output = NULL;
+	serial_ctx->n_threads = 1;
+
+	// start test code //
+	// alternate the kernels, such that the kernel cache is used
+	for (i=0; i<q->N; i++) {
+		q->tasks[i]->kerneltype = K_RBF;
+		q->tasks[i]->gamma = (i % 2) ? 2.0 : 0.5;
+	}
+
+	reps = gensvm_init_repeats(q, repeats, ctx);
+	mu_assert(reps->n_threads == 3, "Incorrect number of threads");
+	gensvm_run_repeats(reps, ctx);
+
+	// a serial run with the same seed gives the same performances
+	serial = gensvm_init_repeats(q, repeats, serial_ctx);
+	mu_assert(serial->n_threads == 1, "Incorrect number of threads");
+	for (r=repeats-1; r>=0; r--)
+		gensvm_consistency_repeat(serial, r);
+
+	for (i=0; i<q->N; i++) {
+		for (r=0; r<repeats; r++) {
+			mu_assert(matrix_get(reps->perf, repeats, i, r) >= 0.0,
+					"Performance not set");
+			mu_assert(matrix_get(reps->perf, repeats, i, r) ==
+					matrix_get(serial->perf, repeats, i,
+						r),
+					"Threaded repeats differ from serial");
+		}
+	}
+	// end test code //
+
+	gensvm_free_repeats(reps);
+	gensvm_free_repeats(serial);
+	gensvm_free_context(ctx);
+	gensvm_free_context(serial_ctx);
+	gensvm_free_queue(q);
+	gensvm_free_data(data);
 
 	return NULL;
 }
@@ -136,7 +432,11 @@ char *all_tests()
 	mu_run_test(test_percentile_1);
 	mu_run_test(test_percentile);
 	mu_run_test(test_top_queue);
+	mu_run_test(test_consistency_repeat);
+	mu_run_test(test_kernel_cache_get);
+	mu_run_test(test_repeats_cache_size);
 	mu_run_test(test_consistency_repeats);
+	mu_run_test(test_consistency_threads);
 
 	return NULL;
 }
@@ -0,0 +1,220 @@
+/**
+ * @file test_gensvm_context.c
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Unit tests for gensvm_context.c functions
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+
+#include "minunit.h"
+#include "gensvm_context.h"
+
+extern FILE *GENSVM_OUTPUT_FILE;
+extern FILE *GENSVM_ERROR_FILE;
+
+char *test_init_free_context()
+{
+	struct GenContext *ctx = gensvm_init_context(1);
+
+	mu_assert(ctx->output == NULL, "Incorrect default output");
+	mu_assert(ctx->error == stderr, "Incorrect default error");
+	mu_assert(ctx->rng != NULL, "No RNG in context");
+	mu_assert(ctx->n_threads == 0, "Incorrect default n_threads");
+
+	gensvm_free_context(ctx);
+	gensvm_free_context(NULL);
+	return NULL;
+}
+
+char *test_context_note()
+{
+	char buffer[GENSVM_MAX_LINE_LENGTH];
+	FILE *fid = tmpfile();
+	FILE *glb = tmpfile();
+	FILE *old = GENSVM_OUTPUT_FILE;
+	struct GenContext *ctx = gensvm_init_context(1);
+
+	// start test code //
+	GENSVM_OUTPUT_FILE = glb;
+	ctx->output = fid;
+	gensvm_note(ctx, "to the %s\n", "context");
+	gensvm_note(NULL, "to the %s\n", "global");
+	ctx->output = NULL;
+	gensvm_note(ctx, "to nothing\n");
+	GENSVM_OUTPUT_FILE = old;
+
+	rewind(fid);
+	mu_assert(fgets(buffer, GENSVM_MAX_LINE_LENGTH, fid) != NULL,
+			"No output in context stream");
+	mu_assert(strcmp(buffer, "to the context\n") == 0,
+			"Incorrect output in context stream");
+	mu_assert(fgets(buffer, GENSVM_MAX_LINE_LENGTH, fid) == NULL,
+			"Too much output in context stream");
+
+	rewind(glb);
+	mu_assert(fgets(buffer, GENSVM_MAX_LINE_LENGTH, glb) != NULL,
+			"No output in global stream");
+	mu_assert(strcmp(buffer, "to the global\n") == 0,
+			"Incorrect output in global stream");
+	mu_assert(fgets(buffer, GENSVM_MAX_LINE_LENGTH, glb) == NULL,
+			"Too much output in global stream");
+	// end test code //
+
+	fclose(fid);
+	fclose(glb);
+	gensvm_free_context(ctx);
+	return NULL;
+}
+
+char *test_context_error()
+{
+	char buffer[GENSVM_MAX_LINE_LENGTH];
+	FILE *fid = tmpfile();
+	FILE *glb = tmpfile();
+	FILE *old = GENSVM_ERROR_FILE;
+	struct GenContext *ctx = gensvm_init_context(1);
+
+	// start test code //
+	GENSVM_ERROR_FILE = glb;
+	ctx->error = fid;
+	gensvm_error(ctx, "error %i\n", 1);
+	gensvm_error(NULL, "error %i\n", 2);
+	GENSVM_ERROR_FILE = old;
+
+	rewind(fid);
+	mu_assert(fgets(buffer, GENSVM_MAX_LINE_LENGTH, fid) != NULL,
+			"No output in context stream");
+	mu_assert(strcmp(buffer, "error 1\n") == 0,
+			"Incorrect output in context stream");
+
+	rewind(glb);
+	mu_assert(fgets(buffer, GENSVM_MAX_LINE_LENGTH, glb) != NULL,
+			"No output in global stream");
+	mu_assert(strcmp(buffer, "error 2\n") == 0,
+			"Incorrect output in global stream");
+	// end test code //
+
+	fclose(fid);
+	fclose(glb);
+	gensvm_free_context(ctx);
+	return NULL;
+}
+
+char *test_context_silence()
+{
+	struct GenContext quiet;
+	struct GenContext *ctx = gensvm_init_context(1);
+	ctx->output = stdout;
+	ctx->n_threads = 3;
+
+	// start test code //
+	gensvm_context_silence(ctx, &quiet);
+	mu_assert(quiet.output == NULL, "Output not silenced");
+	mu_assert(quiet.error == ctx->error, "Incorrect error stream");
+	mu_assert(quiet.rng == ctx->rng, "RNG not shared");
+	mu_assert(quiet.n_threads == 3, "Incorrect n_threads");
+	mu_assert(ctx->output == stdout, "Original context changed");
+
+	gensvm_context_silence(NULL, &quiet);
+	mu_assert(quiet.output == NULL, "Output not silenced");
+	mu_assert(quiet.error == GENSVM_ERROR_FILE, "Incorrect error stream");
+	mu_assert(quiet.rng == NULL, "Incorrect RNG");
+	// end test code //
+
+	gensvm_free_context(ctx);
+	return NULL;
+}
+
+char *test_context_random()
+{
+	int i;
+	uint64_t x;
+	double u;
+	struct GenContext *ctx = gensvm_init_context(0);
+
+	// start test code //
+	gensvm_context_seed(ctx, 42);
+	x = gensvm_context_random(ctx);
+	u = gensvm_context_uniform(ctx);
+	gensvm_context_seed(ctx, 42);
+	mu_assert(gensvm_context_random(ctx) == x, "Seed not reproducible");
+	mu_assert(gensvm_context_uniform(ctx) == u, "Seed not reproducible");
+
+	// the context doesn't touch the generator of rand()
+	srand(42);
+	x = rand();
+	srand(42);
+	for (i=0; i<10; i++)
+		gensvm_context_random(ctx);
+	mu_assert((uint64_t) rand() == x, "Context uses rand()");
+
+	// without a context rand() is used
+	gensvm_context_seed(NULL, 42);
+	mu_assert(gensvm_context_random(NULL) == x,
+			"No context doesn't use rand()");
+	for (i=0; i<100; i++) {
+		u = gensvm_context_uniform(NULL);
+		mu_assert(u >= 0.0 && u <= 1.0, "Uniform out of range");
+	}
+	// end test code //
+
+	gensvm_free_context(ctx);
+	return NULL;
+}
+
+char *test_context_threads()
+{
+	struct GenContext *ctx = gensvm_init_context(0);
+
+	// start test code //
+	mu_assert(gensvm_context_threads(NULL, 1) == 1,
+			"Incorrect number of threads for 1 job");
+	mu_assert(gensvm_context_threads(NULL, 0) == 1,
+			"Incorrect number of threads for 0 jobs");
+	mu_assert(gensvm_context_threads(NULL, 1000) <= 1000,
+			"More threads than jobs");
+
+	ctx->n_threads = 3;
+	mu_assert(gensvm_context_threads(ctx, 1000) == 3,
+			"Thread budget not respected");
+	mu_assert(gensvm_context_threads(ctx, 2) == 2,
+			"More threads than jobs");
+	// end test code //
+
+	gensvm_free_context(ctx);
+	return NULL;
+}
+
+char *all_tests()
+{
+	mu_suite_start();
+	mu_run_test(test_init_free_context);
+	mu_run_test(test_context_note);
+	mu_run_test(test_context_error);
+	mu_run_test(test_context_silence);
+	mu_run_test(test_context_random);
+	mu_run_test(test_context_threads);
+
+	return NULL;
+}
+
+RUN_TESTS(all_tests);
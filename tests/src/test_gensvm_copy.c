@@ -40,6 +40,7 @@ char *test_copy_model_linear()
 	from_model->kerneltype = K_LINEAR;
 	from_model->max_iter = 100;
 	from_model->seed = 123;
+	from_model->temperature = 0.25;
 
 	gensvm_copy_model(from_model, to_model);
 
@@ -52,6 +53,7 @@ char *test_copy_model_linear()
 	mu_assert(to_model->kerneltype == K_LINEAR, "to->kerneltype incorrect");
 	mu_assert(to_model->max_iter == 100, "to->max_iter incorrect");
 	mu_assert(to_model->seed == 123, "to->seed incorrect");
+	mu_assert(to_model->temperature == 0.25, "to->temperature incorrect");
 
 	gensvm_free_model(from_model);
 	gensvm_free_model(to_model);
@@ -109,6 +109,86 @@ char *test_make_cv_split_2()
 	return NULL;
 }
 
+char *test_make_cv_split_rng()
+{
+	long i, N = 103, folds = 5;
+	long *cv_idx = Malloc(long, N);
+	long *cv_idx2 = Malloc(long, N);
+	long counts[5] = {0};
+	struct GenRNG *rng = gensvm_init_rng(1);
+
+	// start test code //
+	gensvm_make_cv_split_rng(N, folds, cv_idx, rng);
+	for (i=0; i<N; i++) {
+		mu_assert(0 <= cv_idx[i] && cv_idx[i] < folds,
+				"CV range incorrect.");
+		counts[cv_idx[i]]++;
+	}
+	// the first N % folds folds are the big ones
+	mu_assert(counts[0] == 21 && counts[1] == 21 && counts[2] == 21 &&
+			counts[3] == 20 && counts[4] == 20,
+			"Incorrect fold sizes");
+
+	// the split is determined by the seed
+	gensvm_rng_seed(rng, 1);
+	gensvm_make_cv_split_rng(N, folds, cv_idx2, rng);
+	for (i=0; i<N; i++)
+		mu_assert(cv_idx[i] == cv_idx2[i], "Split not reproducible");
+	// end test code //
+
+	gensvm_free_rng(rng);
+	free(cv_idx);
+	free(cv_idx2);
+
+	return NULL;
+}
+
+char *test_make_stratified_cv_split()
+{
+	long i, f, k, N = 50, folds = 4;
+	long *y = Malloc(long, N);
+	long *cv_idx = Malloc(long, N);
+	long counts[3][4] = {{0}};
+	long class_size[3] = {0};
+	long fold_size[4] = {0};
+	struct GenRNG *rng = gensvm_init_rng(7);
+
+	// unbalanced classes: 30, 15, 5
+	for (i=0; i<N; i++) {
+		y[i] = (i % 10 < 6) ? 1 : ((i % 10 < 9) ? 2 : 3);
+		class_size[y[i]-1]++;
+	}
+
+	// start test code //
+	gensvm_make_stratified_cv_split(N, folds, y, cv_idx, rng);
+	for (i=0; i<N; i++) {
+		mu_assert(0 <= cv_idx[i] && cv_idx[i] < folds,
+				"CV range incorrect.");
+		counts[y[i]-1][cv_idx[i]]++;
+		fold_size[cv_idx[i]]++;
+	}
+	for (f=0; f<folds; f++) {
+		mu_assert(fold_size[f] == N/folds + (f < N % folds),
+				"Incorrect fold size");
+		for (k=0; k<3; k++)
+			mu_assert(labs(counts[k][f]*folds - class_size[k])
+					< folds, "Fold not stratified");
+	}
+
+	// without labels the split is not stratified
+	gensvm_make_stratified_cv_split(N, folds, NULL, cv_idx, rng);
+	for (i=0; i<N; i++)
+		mu_assert(0 <= cv_idx[i] && cv_idx[i] < folds,
+				"CV range incorrect.");
+	// end test code //
+
+	gensvm_free_rng(rng);
+	free(y);
+	free(cv_idx);
+
+	return NULL;
+}
+
 char *test_get_tt_split_dense()
 {
 	struct GenData *full = gensvm_init_data();
@@ -427,13 +507,128 @@ char *test_get_tt_split_sparse()
 	return NULL;
 }
 
+char *test_get_tt_view(bool sparse)
+{
+	long f, g, i, j, jj, k, folds = 3;
+	long cv_idx[10] = {2, 1, 0, 2, 1, 0, 1, 1, 2, 0};
+	long *order = Malloc(long, 10);
+	double *row = Malloc(double, 3);
+	struct GenData *full = gensvm_init_data();
+	struct GenData *fold_data = NULL;
+	struct GenData *train = NULL,
+		       *test = NULL,
+		       *view = NULL;
+
+	full->K = 3;
+	full->n = 10;
+	full->m = 2;
+	full->r = 2;
+	full->y = Malloc(long, full->n);
+	full->RAW = Calloc(double, full->n*(full->m+1));
+	for (i=0; i<full->n; i++) {
+		full->y[i] = 1 + (i % 3);
+		matrix_set(full->RAW, full->m+1, i, 0, 1.0);
+		// leave some zeros for the sparse matrix
+		if (i % 2)
+			matrix_set(full->RAW, full->m+1, i, 1, 0.1*i);
+		if (i % 3)
+			matrix_set(full->RAW, full->m+1, i, 2, -0.2*i);
+	}
+	full->Z = full->RAW;
+	if (sparse) {
+		full->spZ = gensvm_dense_to_sparse(full->RAW, full->n,
+				full->m+1);
+		full->Z = NULL;
+	}
+
+	// start test code //
+	fold_data = gensvm_make_fold_data(full, cv_idx, folds);
+	mu_assert(fold_data->n == 2*full->n, "Incorrect fold data size");
+
+	for (f=0; f<folds; f++) {
+		train = gensvm_init_data();
+		test = gensvm_init_data();
+		gensvm_get_tt_view(fold_data, train, test, cv_idx, f);
+
+		mu_assert(train->is_view && test->is_view, "Not a view");
+		mu_assert(train->K == 3 && test->K == 3, "Incorrect K");
+		mu_assert(train->m == 2 && test->m == 2, "Incorrect m");
+		mu_assert((test->Z == NULL) == sparse,
+				"Incorrect storage type");
+
+		// expected order: the test fold, then the folds after it
+		k = 0;
+		for (g=f; g<f+folds; g++)
+			for (i=0; i<full->n; i++)
+				if (cv_idx[i] == g % folds)
+					order[k++] = i;
+		mu_assert(test->n + train->n == full->n,
+				"Incorrect number of instances");
+
+		for (k=0; k<full->n; k++) {
+			view = (k < test->n) ? test : train;
+			i = (k < test->n) ? k : k - test->n;
+			mu_assert(view->y[i] == full->y[order[k]],
+					"Incorrect label");
+			if (!sparse) {
+				for (j=0; j<3; j++)
+					row[j] = matrix_get(view->Z, 3, i, j);
+			} else {
+				row[0] = row[1] = row[2] = 0.0;
+				for (jj=view->spZ->ia[i];
+						jj<view->spZ->ia[i+1]; jj++)
+					row[view->spZ->ja[jj]] =
+						view->spZ->values[jj];
+			}
+			for (j=0; j<3; j++)
+				mu_assert(row[j] == matrix_get(full->RAW, 3,
+							order[k], j),
+						"Incorrect value");
+		}
+		if (sparse) {
+			mu_assert(test->spZ->n_row == test->n,
+					"Incorrect number of sparse rows");
+			mu_assert(test->spZ->nnz + train->spZ->nnz ==
+					full->spZ->nnz,
+					"Incorrect number of nonzeros");
+		}
+
+		gensvm_free_data(train);
+		gensvm_free_data(test);
+	}
+	// end test code //
+
+	gensvm_free_data(fold_data);
+	if (sparse)
+		full->Z = full->RAW;
+	gensvm_free_data(full);
+	free(order);
+	free(row);
+
+	return NULL;
+}
+
+char *test_get_tt_view_dense()
+{
+	return test_get_tt_view(false);
+}
+
+char *test_get_tt_view_sparse()
+{
+	return test_get_tt_view(true);
+}
+
 char *all_tests()
 {
 	mu_suite_start();
 	mu_run_test(test_make_cv_split_1);
 	mu_run_test(test_make_cv_split_2);
+	mu_run_test(test_make_cv_split_rng);
+	mu_run_test(test_make_stratified_cv_split);
 	mu_run_test(test_get_tt_split_dense);
 	mu_run_test(test_get_tt_split_sparse);
+	mu_run_test(test_get_tt_view_dense);
+	mu_run_test(test_get_tt_view_sparse);
 
 	return NULL;
 }
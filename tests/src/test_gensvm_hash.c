@@ -0,0 +1,108 @@
+/**
+ * @file test_gensvm_hash.c
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Unit tests for gensvm_hash.c functions
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+
+#include "minunit.h"
+#include "gensvm_hash.h"
+
+char *test_hash_bytes()
+{
+	uint64_t hash;
+
+	// reference values of the 64-bit FNV-1a hash
+	hash = gensvm_hash_bytes(GENSVM_HASH_INIT, "", 0);
+	mu_assert(hash == 0xcbf29ce484222325ULL, "Incorrect empty hash");
+	hash = gensvm_hash_bytes(GENSVM_HASH_INIT, "a", 1);
+	mu_assert(hash == 0xaf63dc4c8601ec8cULL, "Incorrect hash of 'a'");
+	hash = gensvm_hash_bytes(GENSVM_HASH_INIT, "foobar", 6);
+	mu_assert(hash == 0x85944171f73967e8ULL,
+			"Incorrect hash of 'foobar'");
+
+	// continuing a hash is the same as hashing the concatenation
+	hash = gensvm_hash_bytes(GENSVM_HASH_INIT, "foo", 3);
+	hash = gensvm_hash_bytes(hash, "bar", 3);
+	mu_assert(hash == 0x85944171f73967e8ULL,
+			"Incorrect continued hash");
+
+	return NULL;
+}
+
+char *test_hash_data()
+{
+	uint64_t h1, h2;
+	struct GenData *data = gensvm_init_data();
+
+	data->n = 3;
+	data->m = 2;
+	data->K = 2;
+	data->y = Malloc(long, data->n);
+	data->y[0] = 1;
+	data->y[1] = 2;
+	data->y[2] = 1;
+	data->RAW = Calloc(double, data->n*(data->m+1));
+	matrix_set(data->RAW, data->m+1, 0, 0, 1.0);
+	matrix_set(data->RAW, data->m+1, 1, 0, 1.0);
+	matrix_set(data->RAW, data->m+1, 2, 0, 1.0);
+	matrix_set(data->RAW, data->m+1, 0, 1, 0.5);
+	matrix_set(data->RAW, data->m+1, 2, 2, -0.3);
+	data->Z = data->RAW;
+
+	h1 = gensvm_hash_data(data);
+	mu_assert(h1 == gensvm_hash_data(data), "Hash is not deterministic");
+
+	// changing the data changes the hash
+	matrix_set(data->RAW, data->m+1, 1, 2, 0.1);
+	h2 = gensvm_hash_data(data);
+	mu_assert(h1 != h2, "Hash doesn't change with data");
+
+	// changing the labels changes the hash
+	matrix_set(data->RAW, data->m+1, 1, 2, 0.0);
+	mu_assert(h1 == gensvm_hash_data(data), "Hash not restored");
+	data->y[2] = 2;
+	h2 = gensvm_hash_data(data);
+	mu_assert(h1 != h2, "Hash doesn't change with labels");
+
+	// the kernel matrix is not part of the hash
+	data->Z = Calloc(double, data->n*(data->m+1));
+	mu_assert(h2 == gensvm_hash_data(data), "Hash depends on Z");
+	free(data->Z);
+	data->Z = data->RAW;
+
+	gensvm_free_data(data);
+
+	return NULL;
+}
+
+char *all_tests()
+{
+	mu_suite_start();
+	mu_run_test(test_hash_bytes);
+	mu_run_test(test_hash_data);
+
+	return NULL;
+}
+
+RUN_TESTS(all_tests);
@@ -54,7 +54,7 @@ char *test_init_null_dense()
 	}
 	data->Z = data->RAW;
 
-	gensvm_init_V(NULL, model, data);
+	gensvm_init_V(NULL, model, data, NULL);
 
 	// first row all ones
 	value = matrix_get(model->V, K-1, 0, 0);
@@ -114,7 +114,7 @@ char *test_init_null_sparse()
 	data->RAW = NULL;
 	data->Z = NULL;
 
-	gensvm_init_V(NULL, model, data);
+	gensvm_init_V(NULL, model, data, NULL);
 
 	// first row all ones
 	value = matrix_get(model->V, K-1, 0, 0);
@@ -170,7 +170,7 @@ char *test_init_seed()
 	matrix_set(seed->V, seed->K-1, 5, 0, 222.0);
 	matrix_set(seed->V, seed->K-1, 3, 1, 333.0);
 
-	gensvm_init_V(seed, model, data);
+	gensvm_init_V(seed, model, data, NULL);
 
 	mu_assert(matrix_get(model->V, model->K-1, 0, 0) == 123.0,
 			"Incorrect V value at 0, 0");
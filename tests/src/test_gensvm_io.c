@@ -265,6 +265,116 @@ char *test_gensvm_read_data_no_label()
 	return NULL;
 }
 
+char *test_gensvm_read_data_chunks()
+{
+	long i, j, n = 100000, m = 4;
+	char *filename = "./data/test_file_read_data_chunks.txt";
+	double *X = Malloc(double, (n+10)*m);
+	long *y = Malloc(long, n+10);
+	struct GenData *data = gensvm_init_data();
+	FILE *fid = fopen(filename, "w");
+
+	// write a file that is split into several chunks, with blank lines,
+	// carriage returns, and more instances than in the header
+	srand(123);
+	fprintf(fid, "%li %li\n\n", n, m);
+	for (i=0; i<n+10; i++) {
+		for (j=0; j<m; j++) {
+			X[i*m+j] = ((double) rand())/RAND_MAX - 0.5;
+			fprintf(fid, "%.17g ", X[i*m+j]);
+		}
+		y[i] = (i < n) ? 1 + rand() % 3 : 4;
+		fprintf(fid, "%li%s\n", y[i], (i % 7) ? "" : "\r");
+		if (i % 1000 == 0)
+			fprintf(fid, " \n");
+	}
+	fclose(fid);
+
+	// start test code //
+	gensvm_read_data(data, filename);
+
+	mu_assert(data->n == n, "Incorrect value for n");
+	mu_assert(data->m == m, "Incorrect value for m");
+	mu_assert(data->K == 3, "Incorrect value for K");
+	for (i=0; i<n; i++) {
+		mu_assert(matrix_get(data->Z, m+1, i, 0) == 1.0,
+				"Incorrect column of ones");
+		for (j=0; j<m; j++)
+			mu_assert(matrix_get(data->Z, m+1, i, j+1) ==
+					X[i*m+j], "Incorrect Z value");
+		mu_assert(data->y[i] == y[i], "Incorrect label");
+	}
+	// end test code //
+
+	remove(filename);
+	gensvm_free_data(data);
+	free(X);
+	free(y);
+	return NULL;
+}
+
+char *test_gensvm_read_data_sparse_chunks()
+{
+	long i, j, n = 50000, m = 20;
+	char *filename = "./data/test_file_read_data_sparse_chunks.txt";
+	double *Z = Calloc(double, n*(m+1));
+	long *y = Malloc(long, n);
+	struct GenSparse *spZ = NULL;
+	struct GenData *data = gensvm_init_data();
+	FILE *fid = fopen(filename, "w");
+
+	// write a sparse file that is split into several chunks
+	srand(123);
+	fprintf(fid, "%li\n%li\n", n, m);
+	for (i=0; i<n; i++) {
+		matrix_set(Z, m+1, i, 0, 1.0);
+		for (j=1; j<m+1; j++) {
+			if (rand() % 10 == 0) {
+				matrix_set(Z, m+1, i, j,
+						((double) rand())/RAND_MAX);
+				fprintf(fid, "%.17g ",
+						matrix_get(Z, m+1, i, j));
+			} else {
+				fprintf(fid, "0 ");
+			}
+		}
+		y[i] = 1 + rand() % 3;
+		fprintf(fid, "%li\n", y[i]);
+	}
+	fclose(fid);
+	spZ = gensvm_dense_to_sparse(Z, n, m+1);
+
+	// start test code //
+	gensvm_read_data(data, filename);
+
+	mu_assert(data->n == n, "Incorrect value for n");
+	mu_assert(data->m == m, "Incorrect value for m");
+	mu_assert(data->K == 3, "Incorrect value for K");
+	mu_assert(data->RAW == NULL, "RAW is not NULL");
+	mu_assert(data->Z == NULL, "Z is not NULL");
+	mu_assert(data->spZ != NULL, "spZ is NULL");
+	mu_assert(data->spZ->nnz == spZ->nnz, "Incorrect nnz");
+	mu_assert(data->spZ->n_row == n, "Incorrect n_row");
+	mu_assert(data->spZ->n_col == m+1, "Incorrect n_col");
+	for (i=0; i<n+1; i++)
+		mu_assert(data->spZ->ia[i] == spZ->ia[i], "Incorrect ia");
+	for (i=0; i<spZ->nnz; i++) {
+		mu_assert(data->spZ->ja[i] == spZ->ja[i], "Incorrect ja");
+		mu_assert(data->spZ->values[i] == spZ->values[i],
+				"Incorrect values");
+	}
+	for (i=0; i<n; i++)
+		mu_assert(data->y[i] == y[i], "Incorrect label");
+	// end test code //
+
+	remove(filename);
+	gensvm_free_data(data);
+	gensvm_free_sparse(spZ);
+	free(Z);
+	free(y);
+	return NULL;
+}
+
 char *test_gensvm_read_data_libsvm()
 {
 	char *filename = "./data/test_file_read_data_libsvm.txt";
@@ -510,6 +620,67 @@ char *test_gensvm_read_data_libsvm_sparse()
 	return NULL;
 }
 
+char *test_gensvm_read_data_libsvm_chunks()
+{
+	long i, j, jj, n = 2000, m = 300;
+	char *filename = "./data/test_file_read_data_libsvm_chunks.txt";
+	double *X = Calloc(double, n*m);
+	double *Z = Calloc(double, n*(m+1));
+	long *y = Malloc(long, n);
+	struct GenData *data = gensvm_init_data();
+	FILE *fid = fopen(filename, "w");
+
+	// write a file with lines much longer than GENSVM_MAX_LINE_LENGTH,
+	// that is split into several chunks, with blank lines and carriage
+	// returns
+	srand(123);
+	for (i=0; i<n; i++) {
+		y[i] = 1 + rand() % 4;
+		fprintf(fid, "%li", y[i]);
+		for (j=0; j<m; j++) {
+			if (rand() % 10 < 3) {
+				X[i*m+j] = ((double) rand())/RAND_MAX;
+				fprintf(fid, " %li:%.17g", j+1, X[i*m+j]);
+			}
+		}
+		fprintf(fid, "%s\n", (i % 7) ? "" : "\r");
+		if (i % 100 == 0)
+			fprintf(fid, "\n");
+	}
+	fclose(fid);
+
+	// start test code //
+	gensvm_read_data_libsvm(data, filename);
+
+	mu_assert(data->n == n, "Incorrect value for n");
+	mu_assert(data->m == m, "Incorrect value for m");
+	mu_assert(data->K == 4, "Incorrect value for K");
+	mu_assert(data->spZ != NULL, "Data is not sparse");
+	mu_assert(data->spZ->ia[n] == data->spZ->nnz, "Incorrect nnz");
+
+	for (i=0; i<n; i++) {
+		for (jj=data->spZ->ia[i]; jj<data->spZ->ia[i+1]; jj++)
+			matrix_set(Z, m+1, i, data->spZ->ja[jj],
+					data->spZ->values[jj]);
+	}
+	for (i=0; i<n; i++) {
+		mu_assert(data->y[i] == y[i], "Incorrect label");
+		mu_assert(matrix_get(Z, m+1, i, 0) == 1.0,
+				"Incorrect column of ones");
+		for (j=0; j<m; j++)
+			mu_assert(matrix_get(Z, m+1, i, j+1) == X[i*m+j],
+					"Incorrect Z value");
+	}
+	// end test code //
+
+	remove(filename);
+	gensvm_free_data(data);
+	free(X);
+	free(Z);
+	free(y);
+	return NULL;
+}
+
 char *test_gensvm_read_data_libsvm_no_label()
 {
 	char *filename = "./data/test_file_read_data_no_label_libsvm.txt";
@@ -580,6 +751,236 @@ char *test_gensvm_read_data_libsvm_no_label()
 	return NULL;
 }
 
+char *test_gensvm_binary_data_dense()
+{
+	long i, j;
+	char *filename = "./data/test_file_binary_data.bin";
+	struct GenData *text = gensvm_init_data();
+	struct GenData *data = gensvm_init_data();
+
+	gensvm_read_data(text, "./data/test_file_read_data.txt");
+	mu_assert(!gensvm_is_binary_data("./data/test_file_read_data.txt"),
+			"Text file recognized as binary");
+
+	// start test code //
+	gensvm_write_data_binary(text, filename);
+	mu_assert(gensvm_is_binary_data(filename),
+			"Binary file not recognized");
+	gensvm_load_data(data, filename, false);
+
+	mu_assert(data->map != NULL, "Data is not mapped");
+	mu_assert(data->n == text->n, "Incorrect value for n");
+	mu_assert(data->m == text->m, "Incorrect value for m");
+	mu_assert(data->r == text->r, "Incorrect value for r");
+	mu_assert(data->K == text->K, "Incorrect value for K");
+	mu_assert(data->spZ == NULL, "spZ is not NULL");
+	mu_assert(data->Z == data->RAW, "Z is not RAW");
+	mu_assert(((size_t) data->RAW) % GENSVM_BINARY_ALIGN == 0,
+			"RAW is not aligned");
+	for (i=0; i<data->n; i++) {
+		mu_assert(data->y[i] == text->y[i], "Incorrect label");
+		for (j=0; j<data->m+1; j++)
+			mu_assert(matrix_get(data->RAW, data->m+1, i, j) ==
+					matrix_get(text->RAW, text->m+1, i,
+						j), "Incorrect RAW value");
+	}
+
+	// the mapped data can be changed without changing the file
+	matrix_set(data->RAW, data->m+1, 0, 1, -1.0);
+	// end test code //
+
+	gensvm_free_data(data);
+	data = gensvm_init_data();
+	gensvm_read_data_binary(data, filename);
+	mu_assert(matrix_get(data->RAW, data->m+1, 0, 1) ==
+			matrix_get(text->RAW, text->m+1, 0, 1),
+			"Change written to file");
+
+	remove(filename);
+	gensvm_free_data(data);
+	gensvm_free_data(text);
+	return NULL;
+}
+
+char *test_gensvm_binary_data_sparse()
+{
+	long i;
+	char *filename = "./data/test_file_binary_data_sparse.bin";
+	struct GenData *text = gensvm_init_data();
+	struct GenData *data = gensvm_init_data();
+
+	gensvm_read_data_libsvm(text,
+			"./data/test_file_read_data_no_label_libsvm.txt");
+	if (text->spZ == NULL)
+		text->spZ = gensvm_dense_to_sparse(text->RAW, text->n,
+				text->m+1);
+
+	// start test code //
+	gensvm_write_data_binary(text, filename);
+	gensvm_load_data(data, filename, true);
+
+	mu_assert(data->n == text->n, "Incorrect value for n");
+	mu_assert(data->m == text->m, "Incorrect value for m");
+	mu_assert(data->y == NULL, "y is not NULL");
+	mu_assert(data->RAW == NULL, "RAW is not NULL");
+	mu_assert(data->spZ != NULL, "spZ is NULL");
+	mu_assert(data->spZ->nnz == text->spZ->nnz, "Incorrect nnz");
+	mu_assert(data->spZ->n_row == text->spZ->n_row, "Incorrect n_row");
+	mu_assert(data->spZ->n_col == text->spZ->n_col, "Incorrect n_col");
+	for (i=0; i<data->n+1; i++)
+		mu_assert(data->spZ->ia[i] == text->spZ->ia[i],
+				"Incorrect ia");
+	for (i=0; i<data->spZ->nnz; i++) {
+		mu_assert(data->spZ->ja[i] == text->spZ->ja[i],
+				"Incorrect ja");
+		mu_assert(data->spZ->values[i] == text->spZ->values[i],
+				"Incorrect values");
+	}
+
+	// converting to dense doesn't free the mapped arrays
+	gensvm_data_to_dense(data);
+	mu_assert(data->spZ == NULL, "spZ is not NULL");
+	mu_assert(data->RAW != NULL, "RAW is NULL");
+	mu_assert(!gensvm_map_contains(data->map, data->RAW),
+			"RAW is in the map");
+	// end test code //
+
+	remove(filename);
+	gensvm_free_data(data);
+	gensvm_free_data(text);
+	return NULL;
+}
+
+char *test_gensvm_data_stream_dense()
+{
+	long i, j, b, rows, n = 30000, m = 10, blocks = 0;
+	char *filename = "./data/test_file_data_stream_dense.txt";
+	double *X = Malloc(double, n*m);
+	long *y = Malloc(long, n);
+	struct GenData *block = NULL;
+	struct GenDataStream *stream = NULL;
+	FILE *fid = fopen(filename, "w");
+
+	// write a file that is read in several blocks, with blank lines and
+	// carriage returns
+	srand(123);
+	fprintf(fid, "%li\n%li\n", n, m);
+	for (i=0; i<n; i++) {
+		y[i] = 1 + rand() % 4;
+		for (j=0; j<m; j++) {
+			X[i*m+j] = ((double) rand())/RAND_MAX;
+			fprintf(fid, "%.17g ", X[i*m+j]);
+		}
+		fprintf(fid, "%li%s\n", y[i], (i % 7) ? "" : "\r");
+		if (i % 100 == 0)
+			fprintf(fid, "\n");
+	}
+	fclose(fid);
+
+	// start test code //
+	stream = gensvm_open_data_stream(filename, false, 0);
+	mu_assert(stream->n == n, "Incorrect value for n");
+	mu_assert(stream->m == m, "Incorrect value for m");
+
+	i = 0;
+	block = gensvm_init_data();
+	while ((rows = gensvm_read_data_stream(stream, block)) > 0) {
+		mu_assert(block->n == rows, "Incorrect block size");
+		mu_assert(block->m == m, "Incorrect block features");
+		mu_assert(block->Z == block->RAW, "Block should be dense");
+		mu_assert(block->y != NULL, "Block has no labels");
+		for (b=0; b<rows; b++, i++) {
+			mu_assert(block->y[b] == y[i], "Incorrect label");
+			mu_assert(matrix_get(block->Z, m+1, b, 0) == 1.0,
+					"Incorrect column of ones");
+			for (j=0; j<m; j++)
+				mu_assert(matrix_get(block->Z, m+1, b, j+1)
+						== X[i*m+j],
+						"Incorrect Z value");
+		}
+		gensvm_free_data(block);
+		block = gensvm_init_data();
+		blocks++;
+	}
+	mu_assert(i == n, "Incorrect number of instances");
+	mu_assert(blocks > 1, "File should be read in several blocks");
+	mu_assert(stream->rows == n, "Incorrect number of rows read");
+
+	gensvm_free_data(block);
+	gensvm_close_data_stream(stream);
+	// end test code //
+
+	remove(filename);
+	free(X);
+	free(y);
+	return NULL;
+}
+
+char *test_gensvm_data_stream_no_label()
+{
+	long rows;
+	char *filename = "./data/test_file_read_data_no_label.txt";
+	struct GenData *data = gensvm_init_data();
+	struct GenData *block = gensvm_init_data();
+	struct GenDataStream *stream = NULL;
+
+	// start test code //
+	gensvm_read_data(data, filename);
+	stream = gensvm_open_data_stream(filename, false, 0);
+	rows = gensvm_read_data_stream(stream, block);
+
+	mu_assert(rows == data->n, "Incorrect number of rows");
+	mu_assert(block->m == data->m, "Incorrect value for m");
+	mu_assert(block->y == NULL, "Block shouldn't have labels");
+	mu_assert(memcmp(block->Z, data->Z, rows*(data->m+1)*sizeof(double))
+			== 0, "Incorrect Z values");
+	mu_assert(gensvm_read_data_stream(stream, block) == 0,
+			"Stream should be at the end");
+
+	gensvm_close_data_stream(stream);
+	// end test code //
+
+	gensvm_free_data(data);
+	gensvm_free_data(block);
+	return NULL;
+}
+
+char *test_gensvm_data_stream_libsvm()
+{
+	long rows;
+	char *filename = "./data/test_file_read_data_libsvm.txt";
+	struct GenData *data = gensvm_init_data();
+	struct GenData *block = gensvm_init_data();
+	struct GenDataStream *stream = NULL;
+
+	// start test code //
+	gensvm_read_data_libsvm(data, filename);
+	stream = gensvm_open_data_stream(filename, true, data->m);
+	rows = gensvm_read_data_stream(stream, block);
+
+	mu_assert(rows == data->n, "Incorrect number of rows");
+	mu_assert(stream->n == -1, "Number of instances should be unknown");
+	mu_assert(block->m == data->m, "Incorrect value for m");
+	mu_assert(block->spZ != NULL, "Block should be sparse");
+	mu_assert(block->spZ->nnz == rows*(data->m+1), "Incorrect nnz");
+	mu_assert(block->spZ->n_row == rows, "Incorrect n_row");
+	mu_assert(block->spZ->n_col == data->m+1, "Incorrect n_col");
+	gensvm_data_to_dense(block);
+	mu_assert(memcmp(block->Z, data->Z, rows*(data->m+1)*sizeof(double))
+			== 0, "Incorrect Z values");
+	mu_assert(memcmp(block->y, data->y, rows*sizeof(long)) == 0,
+			"Incorrect labels");
+	mu_assert(gensvm_read_data_stream(stream, block) == 0,
+			"Stream should be at the end");
+
+	gensvm_close_data_stream(stream);
+	// end test code //
+
+	gensvm_free_data(data);
+	gensvm_free_data(block);
+	return NULL;
+}
+
 char *test_gensvm_read_model()
 {
 	struct GenModel *model = gensvm_init_model();
@@ -741,6 +1142,135 @@ char *test_gensvm_write_model()
 	return NULL;
 }
 
+char *test_gensvm_binary_model()
+{
+	long i;
+	char *filename = "./data/test_write_model_binary.bin";
+	struct GenModel *model = gensvm_init_model();
+	struct GenModel *read = gensvm_init_model();
+
+	model->p = 0.90328;
+	model->lambda = 0.0130;
+	model->kappa = 1.1832;
+	model->epsilon = 1e-8;
+	model->weight_idx = 2;
+	model->kerneltype = K_RBF;
+	model->gamma = 0.25;
+	model->coef = 1.5;
+	model->degree = 3.0;
+	model->kernel_eigen_cutoff = 1e-6;
+	model->max_iter = 500;
+	model->elapsed_iter = 123;
+	model->seed = 42;
+	model->temperature = 0.125;
+	model->training_error = 0.3141;
+	model->data_file = strdup("./data/test_file_read_data.txt");
+	model->n = 10;
+	model->m = 2;
+	model->K = 3;
+
+	model->V = Calloc(double, (model->m+1)*(model->K-1));
+	matrix_set(model->V, model->K-1, 0, 0, 0.4989893785603748);
+	matrix_set(model->V, model->K-1, 0, 1, 0.0599082796573645);
+	matrix_set(model->V, model->K-1, 1, 0, 0.7918204761759593);
+	matrix_set(model->V, model->K-1, 1, 1, 0.6456613497110559);
+	matrix_set(model->V, model->K-1, 2, 0, 0.9711956316284261);
+	matrix_set(model->V, model->K-1, 2, 1, 0.5010714686310176);
+
+	// start test code //
+	mu_assert(sizeof(struct GenBinaryModelHeader) % GENSVM_BINARY_ALIGN
+			== 0, "Header is not aligned");
+	gensvm_write_model_binary(model, filename);
+	mu_assert(gensvm_is_binary_model(filename),
+			"Binary model not recognized");
+	mu_assert(!gensvm_is_binary_model("./data/test_read_model.txt"),
+			"Text model recognized as binary");
+
+	// binary models are recognized by gensvm_read_model
+	gensvm_read_model(read, filename);
+	mu_assert(read->map != NULL, "Model is not mapped");
+	mu_assert(gensvm_map_contains(read->map, read->V), "V is not mapped");
+	mu_assert(((size_t) read->V) % GENSVM_BINARY_ALIGN == 0,
+			"V is not aligned");
+
+	mu_assert(read->p == model->p, "Incorrect read for p");
+	mu_assert(read->lambda == model->lambda, "Incorrect read for lambda");
+	mu_assert(read->kappa == model->kappa, "Incorrect read for kappa");
+	mu_assert(read->epsilon == model->epsilon, "Incorrect read for "
+			"epsilon");
+	mu_assert(read->weight_idx == model->weight_idx, "Incorrect read for "
+			"weight_idx");
+	mu_assert(read->kerneltype == model->kerneltype, "Incorrect read for "
+			"kerneltype");
+	mu_assert(read->gamma == model->gamma, "Incorrect read for gamma");
+	mu_assert(read->coef == model->coef, "Incorrect read for coef");
+	mu_assert(read->degree == model->degree, "Incorrect read for degree");
+	mu_assert(read->kernel_eigen_cutoff == model->kernel_eigen_cutoff,
+			"Incorrect read for kernel_eigen_cutoff");
+	mu_assert(read->max_iter == model->max_iter, "Incorrect read for "
+			"max_iter");
+	mu_assert(read->elapsed_iter == model->elapsed_iter, "Incorrect read "
+			"for elapsed_iter");
+	mu_assert(read->seed == model->seed, "Incorrect read for seed");
+	mu_assert(read->temperature == model->temperature, "Incorrect read "
+			"for temperature");
+	mu_assert(read->training_error == model->training_error,
+			"Incorrect read for training_error");
+	mu_assert(strcmp(read->data_file, model->data_file) == 0,
+			"Incorrect read for data_file");
+	mu_assert(read->n == model->n, "Incorrect read for n");
+	mu_assert(read->m == model->m, "Incorrect read for m");
+	mu_assert(read->K == model->K, "Incorrect read for K");
+	for (i=0; i<(model->m+1)*(model->K-1); i++)
+		mu_assert(read->V[i] == model->V[i], "Incorrect read for V");
+
+	// a mapped V is copied when the model is reallocated
+	gensvm_reallocate_model(read, read->n, read->m+1);
+	mu_assert(!gensvm_map_contains(read->map, read->V), "V is mapped");
+	// end test code //
+
+	remove(filename);
+	gensvm_free_model(model);
+	gensvm_free_model(read);
+	return NULL;
+}
+
+char *test_gensvm_binary_model_from_text()
+{
+	long i;
+	char *filename = "./data/test_read_model_binary.bin";
+	struct GenModel *text = gensvm_init_model();
+	struct GenModel *read = gensvm_init_model();
+
+	gensvm_read_model(text, "./data/test_read_model.txt");
+
+	// start test code //
+	gensvm_write_model_binary(text, filename);
+	gensvm_read_model_binary(read, filename);
+
+	mu_assert(read->p == text->p, "Incorrect read for p");
+	mu_assert(read->lambda == text->lambda, "Incorrect read for lambda");
+	mu_assert(read->kappa == text->kappa, "Incorrect read for kappa");
+	mu_assert(read->epsilon == text->epsilon, "Incorrect read for "
+			"epsilon");
+	mu_assert(read->weight_idx == text->weight_idx, "Incorrect read for "
+			"weight_idx");
+	mu_assert(read->temperature == 1.0, "Incorrect read for temperature");
+	mu_assert(strcmp(read->data_file, text->data_file) == 0,
+			"Incorrect read for data_file");
+	mu_assert(read->n == text->n, "Incorrect read for n");
+	mu_assert(read->m == text->m, "Incorrect read for m");
+	mu_assert(read->K == text->K, "Incorrect read for K");
+	for (i=0; i<(text->m+1)*(text->K-1); i++)
+		mu_assert(read->V[i] == text->V[i], "Incorrect read for V");
+	// end test code //
+
+	remove(filename);
+	gensvm_free_model(text);
+	gensvm_free_model(read);
+	return NULL;
+}
+
 char *test_gensvm_write_predictions()
 {
 	int n = 5,
@@ -837,6 +1367,110 @@ char *test_gensvm_write_predictions()
 	return NULL;
 }
 
+char *test_gensvm_write_predictions_format()
+{
+	long i;
+	long predy[3] = {2, 1, 3};
+	double ZV[6] = {0.5, -0.25, 1.0, 0.0, -1.5, 0.125};
+	double P[9] = {0.25, 0.5, 0.25, 0.75, 0.125, 0.125, 0.0, 0.0, 1.0};
+	char *filename = "./data/test_write_predictions_format.txt";
+	char buffer[GENSVM_MAX_LINE_LENGTH];
+	struct GenData *data = gensvm_init_data();
+	FILE *fid = NULL;
+
+	data->n = 3;
+	data->m = 3;
+	data->K = 3;
+	data->RAW = Calloc(double, data->n*(data->m+1));
+	for (i=0; i<data->n; i++) {
+		matrix_set(data->RAW, data->m+1, i, 0, 1.0);
+		matrix_set(data->RAW, data->m+1, i, i+1, 0.5*(i+1));
+	}
+	data->spZ = gensvm_dense_to_sparse(data->RAW, data->n, data->m+1);
+	free(data->RAW);
+	data->RAW = NULL;
+
+	// start test code //
+	// sparse data is written with explicit zeros
+	gensvm_write_predictions(data, predy, filename);
+	fid = fopen(filename, "r");
+	mu_assert(fid != NULL, "Couldn't open output file for reading");
+	fgets(buffer, GENSVM_MAX_LINE_LENGTH, fid);
+	mu_assert(strcmp(buffer, "3\n") == 0, "Incorrect first line");
+	fgets(buffer, GENSVM_MAX_LINE_LENGTH, fid);
+	mu_assert(strcmp(buffer, "3\n") == 0, "Incorrect second line");
+	fgets(buffer, GENSVM_MAX_LINE_LENGTH, fid);
+	mu_assert(strcmp(buffer, "0.5000000000000000 0.0000000000000000 "
+				"0.0000000000000000 2\n") == 0,
+			"Incorrect sparse line (0)");
+	fgets(buffer, GENSVM_MAX_LINE_LENGTH, fid);
+	mu_assert(strcmp(buffer, "0.0000000000000000 1.0000000000000000 "
+				"0.0000000000000000 1\n") == 0,
+			"Incorrect sparse line (1)");
+	fgets(buffer, GENSVM_MAX_LINE_LENGTH, fid);
+	mu_assert(strcmp(buffer, "0.0000000000000000 0.0000000000000000 "
+				"1.5000000000000000 3\n") == 0,
+			"Incorrect sparse line (2)");
+	fclose(fid);
+
+	// labels only
+	gensvm_write_predictions_format(data, predy, NULL, 0, P_LABELS,
+			filename);
+	fid = fopen(filename, "r");
+	mu_assert(fid != NULL, "Couldn't open output file for reading");
+	for (i=0; i<data->n; i++) {
+		fgets(buffer, GENSVM_MAX_LINE_LENGTH, fid);
+		mu_assert(strtol(buffer, NULL, 10) == predy[i],
+				"Incorrect label");
+	}
+	mu_assert(fgets(buffer, GENSVM_MAX_LINE_LENGTH, fid) == NULL,
+			"Too many lines");
+	fclose(fid);
+
+	// labels and decision values
+	gensvm_write_predictions_format(data, predy, ZV, 3, P_DECISION,
+			filename);
+	fid = fopen(filename, "r");
+	mu_assert(fid != NULL, "Couldn't open output file for reading");
+	fgets(buffer, GENSVM_MAX_LINE_LENGTH, fid);
+	mu_assert(strcmp(buffer, "2 0.5000000000000000 -0.2500000000000000\n")
+			== 0, "Incorrect decision line (0)");
+	fgets(buffer, GENSVM_MAX_LINE_LENGTH, fid);
+	mu_assert(strcmp(buffer, "1 1.0000000000000000 0.0000000000000000\n")
+			== 0, "Incorrect decision line (1)");
+	fgets(buffer, GENSVM_MAX_LINE_LENGTH, fid);
+	mu_assert(strcmp(buffer, "3 -1.5000000000000000 0.1250000000000000\n")
+			== 0, "Incorrect decision line (2)");
+	fclose(fid);
+
+	// labels and class probabilities
+	gensvm_write_predictions_format(data, predy, P, 3, P_PROBABILITIES,
+			filename);
+	fid = fopen(filename, "r");
+	mu_assert(fid != NULL, "Couldn't open output file for reading");
+	fgets(buffer, GENSVM_MAX_LINE_LENGTH, fid);
+	mu_assert(strcmp(buffer, "2 0.2500000000000000 0.5000000000000000 "
+				"0.2500000000000000\n") == 0,
+			"Incorrect probability line (0)");
+	fgets(buffer, GENSVM_MAX_LINE_LENGTH, fid);
+	mu_assert(strcmp(buffer, "1 0.7500000000000000 0.1250000000000000 "
+				"0.1250000000000000\n") == 0,
+			"Incorrect probability line (1)");
+	fgets(buffer, GENSVM_MAX_LINE_LENGTH, fid);
+	mu_assert(strcmp(buffer, "3 0.0000000000000000 0.0000000000000000 "
+				"1.0000000000000000\n") == 0,
+			"Incorrect probability line (2)");
+	mu_assert(fgets(buffer, GENSVM_MAX_LINE_LENGTH, fid) == NULL,
+			"Too many lines");
+	fclose(fid);
+	// end test code //
+
+	remove(filename);
+	gensvm_free_data(data);
+
+	return NULL;
+}
+
 char *test_gensvm_time_string()
 {
 	// not sure how to unit test this function.
@@ -851,14 +1485,26 @@ char *all_tests()
 	mu_run_test(test_gensvm_read_data);
 	mu_run_test(test_gensvm_read_data_sparse);
 	mu_run_test(test_gensvm_read_data_no_label);
+	mu_run_test(test_gensvm_read_data_chunks);
+	mu_run_test(test_gensvm_read_data_sparse_chunks);
 	mu_run_test(test_gensvm_read_data_libsvm);
 	mu_run_test(test_gensvm_read_data_libsvm_0based);
 	mu_run_test(test_gensvm_read_data_libsvm_sparse);
 	mu_run_test(test_gensvm_read_data_libsvm_no_label);
+	mu_run_test(test_gensvm_read_data_libsvm_chunks);
+
+	mu_run_test(test_gensvm_binary_data_dense);
+	mu_run_test(test_gensvm_binary_data_sparse);
+	mu_run_test(test_gensvm_data_stream_dense);
+	mu_run_test(test_gensvm_data_stream_no_label);
+	mu_run_test(test_gensvm_data_stream_libsvm);
 
 	mu_run_test(test_gensvm_read_model);
 	mu_run_test(test_gensvm_write_model);
+	mu_run_test(test_gensvm_binary_model);
+	mu_run_test(test_gensvm_binary_model_from_text);
 	mu_run_test(test_gensvm_write_predictions);
+	mu_run_test(test_gensvm_write_predictions_format);
 	mu_run_test(test_gensvm_time_string);
 
 	return NULL;
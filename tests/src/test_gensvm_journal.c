@@ -0,0 +1,333 @@
+/**
+ * @file test_gensvm_journal.c
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Unit tests for gensvm_journal.c functions
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+
+#include "minunit.h"
+#include "gensvm_journal.h"
+#include "gensvm_gridsearch.h"
+
+extern FILE *GENSVM_OUTPUT_FILE;
+
+char *test_init_free_journal()
+{
+	struct GenJournal *journal = gensvm_init_journal();
+	mu_assert(journal->N == 0, "Incorrect number of entries");
+	mu_assert(journal->fid == NULL, "Journal has a file handle");
+	gensvm_free_journal(journal);
+	return NULL;
+}
+
+char *test_journal_add_find()
+{
+	struct GenJournalEntry *entry = NULL;
+	struct GenJournal *journal = gensvm_init_journal();
+	uint64_t i;
+
+	for (i=0; i<40; i++)
+		gensvm_journal_add(journal, 1000 + i, 0.5*i, i, 0.1, 1.0);
+	mu_assert(journal->N == 40, "Incorrect number of entries");
+
+	entry = gensvm_journal_find(journal, 1017);
+	mu_assert(entry != NULL, "Entry not found");
+	mu_assert(entry->performance == 8.5, "Incorrect performance");
+	mu_assert(entry->iter == 17, "Incorrect iter");
+
+	// adding an existing key overwrites it
+	gensvm_journal_add(journal, 1017, 99.0, 3, 0.2, 0.5);
+	mu_assert(journal->N == 40, "Duplicate key added");
+	entry = gensvm_journal_find(journal, 1017);
+	mu_assert(entry->performance == 99.0, "Entry not overwritten");
+	mu_assert(entry->temperature == 0.5, "Temperature not overwritten");
+
+	mu_assert(gensvm_journal_find(journal, 17) == NULL,
+			"Found nonexistent entry");
+
+	gensvm_free_journal(journal);
+	return NULL;
+}
+
+char *test_journal_index()
+{
+	long i;
+	struct GenJournalEntry *entry = NULL;
+	struct GenJournal *journal = gensvm_init_journal();
+
+	// keys with the same lowest bits all collide in the hash table
+	for (i=0; i<1000; i++)
+		gensvm_journal_add(journal, ((uint64_t) i) << 32, i, i, 0.1,
+				1.0);
+	mu_assert(journal->N == 1000, "Incorrect number of entries");
+	mu_assert(journal->index_size >= 2*journal->N,
+			"Hash table too full");
+	for (i=0; i<1000; i++) {
+		entry = gensvm_journal_find(journal, ((uint64_t) i) << 32);
+		mu_assert(entry != NULL, "Entry not found");
+		mu_assert(entry->iter == i, "Incorrect entry found");
+	}
+	mu_assert(gensvm_journal_find(journal, 1000UL << 32) == NULL,
+			"Found nonexistent entry");
+
+	gensvm_free_journal(journal);
+	return NULL;
+}
+
+char *test_journal_sync()
+{
+	char *filename = "./data/tmp_test_journal_sync.txt";
+	struct GenJournal *journal = NULL;
+
+	remove(filename);
+
+	journal = gensvm_journal_open(filename);
+	gensvm_journal_append(journal, 1, 50.0, 10, 0.1, 1.0);
+	gensvm_journal_append(journal, 2, 60.0, 10, 0.1, 1.0);
+	mu_assert(journal->unsynced == 2, "Incorrect number of unsynced");
+	gensvm_journal_sync(journal);
+	mu_assert(journal->unsynced == 0, "Journal not synchronized");
+	gensvm_journal_append(journal, 3, 70.0, 10, 0.1, 1.0);
+	gensvm_free_journal(journal);
+
+	// entries are written before the journal is synchronized
+	journal = gensvm_journal_open(filename);
+	mu_assert(journal->N == 3, "Incorrect number of entries read");
+	mu_assert(journal->unsynced == 0, "Read entries unsynced");
+	mu_assert(gensvm_journal_find(journal, 3)->performance == 70.0,
+			"Incorrect performance");
+	gensvm_free_journal(journal);
+
+	remove(filename);
+	return NULL;
+}
+
+char *test_journal_write_read()
+{
+	char *filename = "./data/tmp_test_journal.txt";
+	struct GenJournal *journal = NULL;
+	struct GenJournalEntry *entry = NULL;
+	FILE *fid = NULL;
+
+	remove(filename);
+
+	journal = gensvm_journal_open(filename);
+	mu_assert(journal->N == 0, "New journal is not empty");
+	gensvm_journal_append(journal, 0xfedcba9876543210ULL,
+			83.1234567890123, 1234, 2.5, 0.3);
+	gensvm_journal_append(journal, 42, 1.0/3.0, 7, 0.125, 1.0);
+	gensvm_free_journal(journal);
+
+	// a line without the temperature, as written by older versions
+	fid = fopen(filename, "a");
+	fprintf(fid, "00000000000000aa 50 20 0.5\n");
+	fclose(fid);
+
+	// simulate a write that was interrupted
+	fid = fopen(filename, "a");
+	fprintf(fid, "00000000000000ff 12.5 10");
+	fclose(fid);
+
+	journal = gensvm_journal_open(filename);
+	mu_assert(journal->N == 3, "Incorrect number of entries read");
+	entry = gensvm_journal_find(journal, 0xfedcba9876543210ULL);
+	mu_assert(entry != NULL, "First entry not found");
+	mu_assert(entry->performance == 83.1234567890123,
+			"Performance not read exactly");
+	mu_assert(entry->iter == 1234, "Incorrect iter");
+	mu_assert(entry->duration == 2.5, "Incorrect duration");
+	mu_assert(entry->temperature == 0.3, "Incorrect temperature");
+	entry = gensvm_journal_find(journal, 42);
+	mu_assert(entry != NULL, "Second entry not found");
+	mu_assert(entry->performance == 1.0/3.0,
+			"Performance not read exactly");
+	entry = gensvm_journal_find(journal, 0xaa);
+	mu_assert(entry != NULL, "Entry without temperature not found");
+	mu_assert(entry->performance == 50.0, "Incorrect performance");
+	mu_assert(entry->temperature == 1.0, "Incorrect default temperature");
+	mu_assert(gensvm_journal_find(journal, 0xff) == NULL,
+			"Incomplete entry was read");
+
+	// the incomplete line doesn't corrupt new entries
+	gensvm_journal_append(journal, 0xff, 12.5, 10, 1.0, 2.0);
+	gensvm_free_journal(journal);
+
+	journal = gensvm_init_journal();
+	gensvm_journal_read(journal, filename);
+	mu_assert(journal->N == 4, "Incorrect number of entries reread");
+	entry = gensvm_journal_find(journal, 0xff);
+	mu_assert(entry != NULL, "Entry after incomplete line not found");
+	mu_assert(entry->performance == 12.5, "Incorrect performance");
+	mu_assert(entry->temperature == 2.0, "Incorrect temperature");
+	gensvm_free_journal(journal);
+
+	remove(filename);
+
+	return NULL;
+}
+
+char *test_journal_task_key()
+{
+	long cv_idx[4] = {0, 1, 0, 1};
+	uint64_t split_hash, key;
+	struct GenData *data = gensvm_init_data();
+	struct GenTask *task = gensvm_init_task();
+
+	data->n = 4;
+	data->m = 1;
+	data->K = 2;
+	data->RAW = Calloc(double, data->n*(data->m+1));
+	data->Z = data->RAW;
+
+	split_hash = gensvm_journal_split_hash(data, cv_idx);
+	key = gensvm_journal_task_key(task, split_hash);
+
+	// the ID and the performance are not part of the key
+	task->ID = 12;
+	task->performance = 50.0;
+	mu_assert(key == gensvm_journal_task_key(task, split_hash),
+			"Key depends on ID or performance");
+
+	// kernel parameters are ignored for the linear kernel
+	task->gamma = 2.0;
+	mu_assert(key == gensvm_journal_task_key(task, split_hash),
+			"Key depends on gamma for linear kernel");
+
+	task->lambda = 0.5;
+	mu_assert(key != gensvm_journal_task_key(task, split_hash),
+			"Key doesn't depend on lambda");
+	task->lambda = 1.0;
+
+	task->kerneltype = K_RBF;
+	key = gensvm_journal_task_key(task, split_hash);
+	task->gamma = 1.0;
+	mu_assert(key != gensvm_journal_task_key(task, split_hash),
+			"Key doesn't depend on gamma for RBF kernel");
+
+	// the split is part of the key
+	cv_idx[3] = 0;
+	mu_assert(split_hash != gensvm_journal_split_hash(data, cv_idx),
+			"Split hash doesn't depend on split");
+
+	gensvm_free_task(task);
+	gensvm_free_data(data);
+
+	return NULL;
+}
+
+char *test_train_queue_journal()
+{
+	long i, j;
+	char *filename = "./data/tmp_test_train_queue_journal.txt";
+	FILE *fid = GENSVM_OUTPUT_FILE;
+	struct GenJournal *journal = NULL;
+	struct GenData *data = gensvm_init_data();
+	struct GenQueue *q = gensvm_init_queue();
+	double perf[2], temp[2];
+
+	remove(filename);
+	GENSVM_OUTPUT_FILE = NULL;
+
+	data->n = 10;
+	data->m = 2;
+	data->r = 2;
+	data->K = 2;
+	data->y = Malloc(long, data->n);
+	data->RAW = Calloc(double, data->n*(data->m+1));
+	for (i=0; i<data->n; i++) {
+		data->y[i] = 1 + (i % 2);
+		matrix_set(data->RAW, data->m+1, i, 0, 1.0);
+		for (j=1; j<data->m+1; j++)
+			matrix_set(data->RAW, data->m+1, i, j,
+					((i*7 + j*3) % 11)/11.0 +
+					data->y[i] - 1.5);
+	}
+	data->Z = data->RAW;
+
+	q->N = 2;
+	q->tasks = Malloc(struct GenTask *, q->N);
+	for (i=0; i<q->N; i++) {
+		q->tasks[i] = gensvm_init_task();
+		q->tasks[i]->ID = i;
+		q->tasks[i]->folds = 2;
+		q->tasks[i]->lambda = (i == 0) ? 1.0 : 0.01;
+		q->tasks[i]->train_data = data;
+	}
+
+	// first run trains all tasks and fills the journal
+	journal = gensvm_journal_open(filename);
+	srand(123);
+	gensvm_train_queue(q, journal, NULL);
+	mu_assert(journal->N == 2, "Incorrect number of journal entries");
+	for (i=0; i<q->N; i++) {
+		perf[i] = q->tasks[i]->performance;
+		temp[i] = q->tasks[i]->temperature;
+		mu_assert(perf[i] >= 0, "Performance not set");
+		mu_assert(temp[i] >= GENSVM_MIN_TEMPERATURE &&
+				temp[i] <= GENSVM_MAX_TEMPERATURE,
+				"Temperature not set");
+	}
+	gensvm_free_journal(journal);
+
+	// second run with the same seed takes everything from the journal
+	q->i = 0;
+	for (i=0; i<q->N; i++) {
+		q->tasks[i]->performance = -1;
+		q->tasks[i]->temperature = -1;
+	}
+	journal = gensvm_journal_open(filename);
+	mu_assert(journal->N == 2, "Journal not read");
+	srand(123);
+	gensvm_train_queue(q, journal, NULL);
+	mu_assert(journal->N == 2, "Tasks were trained again");
+	for (i=0; i<q->N; i++) {
+		mu_assert(q->tasks[i]->performance == perf[i],
+				"Performance not restored from journal");
+		mu_assert(q->tasks[i]->temperature == temp[i],
+				"Temperature not restored from journal");
+	}
+	gensvm_free_journal(journal);
+
+	GENSVM_OUTPUT_FILE = fid;
+	remove(filename);
+	gensvm_free_queue(q);
+	gensvm_free_data(data);
+
+	return NULL;
+}
+
+char *all_tests()
+{
+	mu_suite_start();
+	mu_run_test(test_init_free_journal);
+	mu_run_test(test_journal_add_find);
+	mu_run_test(test_journal_index);
+	mu_run_test(test_journal_sync);
+	mu_run_test(test_journal_write_read);
+	mu_run_test(test_journal_task_key);
+	mu_run_test(test_train_queue_journal);
+
+	return NULL;
+}
+
+RUN_TESTS(all_tests);
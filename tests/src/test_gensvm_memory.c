@@ -0,0 +1,322 @@
+/**
+ * @file test_gensvm_predictor.c
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Unit tests for gensvm_memory.c functions
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "minunit.h"
+#include "gensvm_globals.h"
+#include "gensvm_strutil.h"
+
+char *test_aligned_calloc()
+{
+	long i;
+	double *a = AlignedCalloc(double, 13);
+	long *b = AlignedCalloc(long, 1);
+	char *c = AlignedMalloc(char, 0);
+
+	mu_assert(((size_t) a) % GENSVM_ALIGN == 0, "a isn't aligned");
+	mu_assert(((size_t) b) % GENSVM_ALIGN == 0, "b isn't aligned");
+	mu_assert(c != NULL, "c is NULL");
+	for (i=0; i<13; i++)
+		mu_assert(a[i] == 0.0, "a isn't zeroed");
+	mu_assert(b[0] == 0, "b isn't zeroed");
+
+	free(a);
+	free(b);
+	free(c);
+
+	return NULL;
+}
+
+char *test_padded_ld()
+{
+	if (!GENSVM_PAD_LD) {
+		mu_assert(gensvm_padded_ld(5, sizeof(double)) == 5,
+				"Incorrect unpadded ld");
+		return NULL;
+	}
+
+	mu_assert(gensvm_padded_ld(1, sizeof(double)) == 8,
+			"Incorrect ld (1)");
+	mu_assert(gensvm_padded_ld(8, sizeof(double)) == 8,
+			"Incorrect ld (2)");
+	mu_assert(gensvm_padded_ld(9, sizeof(double)) == 16,
+			"Incorrect ld (3)");
+	mu_assert(gensvm_padded_ld(17, sizeof(float)) == 32,
+			"Incorrect ld (4)");
+	mu_assert(gensvm_padded_ld(3, GENSVM_ALIGN) == 3,
+			"Incorrect ld (5)");
+
+	return NULL;
+}
+
+char *test_arena_calloc()
+{
+	long i;
+	struct GenArena *arena = gensvm_init_arena(1000);
+	double *a = NULL;
+	long *b = NULL;
+
+	mu_assert(arena->size == 1024, "Incorrect arena size");
+	mu_assert(((size_t) arena->base) % GENSVM_ARENA_ALIGN == 0,
+			"Arena isn't aligned");
+
+	a = ArenaCalloc(arena, double, 3);
+	b = ArenaCalloc(arena, long, 10);
+	mu_assert((char *) a == arena->base, "Incorrect first array");
+	mu_assert((char *) b == arena->base + GENSVM_ARENA_ALIGN,
+			"Incorrect second array");
+	mu_assert(((size_t) b) % GENSVM_ARENA_ALIGN == 0,
+			"Array isn't aligned");
+	mu_assert(arena->used == 3*GENSVM_ARENA_ALIGN, "Incorrect used");
+	mu_assert(arena->n_extra == 0, "Incorrect n_extra");
+
+	for (i=0; i<3; i++)
+		mu_assert(a[i] == 0.0, "Array isn't zeroed");
+	for (i=0; i<10; i++)
+		mu_assert(b[i] == 0, "Array isn't zeroed");
+
+	gensvm_free_arena(arena);
+
+	return NULL;
+}
+
+char *test_arena_mark_release()
+{
+	size_t mark;
+	struct GenArena *arena = gensvm_init_arena(1024);
+	double *a = NULL,
+	       *b = NULL;
+
+	a = ArenaCalloc(arena, double, 8);
+	mark = gensvm_arena_mark(arena);
+	b = ArenaCalloc(arena, double, 8);
+	b[0] = 1.0;
+	b[7] = 2.0;
+	gensvm_arena_release(arena, mark);
+	mu_assert(arena->used == mark, "Incorrect used after release");
+
+	// the released array is reused and zeroed again
+	b = ArenaCalloc(arena, double, 8);
+	mu_assert(b == a + 8, "Released array isn't reused");
+	mu_assert(b[0] == 0.0, "Reused array isn't zeroed");
+	mu_assert(b[7] == 0.0, "Reused array isn't zeroed");
+	mu_assert(arena->peak == 2*GENSVM_ARENA_ALIGN, "Incorrect peak");
+
+	gensvm_free_arena(arena);
+
+	return NULL;
+}
+
+char *test_arena_extra_reset()
+{
+	long i;
+	struct GenArena *arena = gensvm_init_arena(0);
+	double *a = NULL;
+
+	mu_assert(arena->size == 0, "Incorrect arena size");
+
+	// arrays that don't fit are allocated separately
+	a = ArenaCalloc(arena, double, 100);
+	for (i=0; i<100; i++)
+		mu_assert(a[i] == 0.0, "Array isn't zeroed");
+	a = ArenaCalloc(arena, double, 20);
+	mu_assert(arena->used == 0, "Incorrect used");
+	mu_assert(arena->n_extra == 2, "Incorrect n_extra");
+	mu_assert(arena->peak == 832 + 192, "Incorrect peak");
+
+	// a reset frees them and grows the arena to the peak
+	gensvm_arena_reset(arena);
+	mu_assert(arena->n_extra == 0, "Incorrect n_extra after reset");
+	mu_assert(arena->size == 1024, "Arena isn't grown to the peak");
+	mu_assert(arena->used == 0, "Incorrect used after reset");
+	mu_assert(arena->peak == 0, "Incorrect peak after reset");
+
+	// the same arrays now fit in the arena
+	a = ArenaCalloc(arena, double, 100);
+	a = ArenaCalloc(arena, double, 20);
+	mu_assert(a != NULL, "Array is NULL");
+	mu_assert(arena->n_extra == 0, "Arrays don't fit after reset");
+	mu_assert(arena->used == 1024, "Incorrect used");
+
+	gensvm_free_arena(arena);
+
+	return NULL;
+}
+
+char *test_arena_size()
+{
+	mu_assert(gensvm_arena_size(0, sizeof(double)) == 0,
+			"Incorrect size (1)");
+	mu_assert(gensvm_arena_size(1, sizeof(double)) == GENSVM_ARENA_ALIGN,
+			"Incorrect size (2)");
+	mu_assert(gensvm_arena_size(8, sizeof(double)) == 64,
+			"Incorrect size (3)");
+	mu_assert(gensvm_arena_size(9, sizeof(double)) == 128,
+			"Incorrect size (4)");
+
+	return NULL;
+}
+
+char *test_memory_track()
+{
+	long i, n_sites, line;
+	double *a = NULL;
+	size_t bytes = 10*1024*1024;
+	struct GenMemorySite *sites = NULL,
+			     *site = NULL;
+
+	gensvm_memory_reset();
+	gensvm_memory_track(true);
+	for (i=0; i<3; i++) {
+		line = __LINE__ + 1;
+		a = Malloc(double, (i+1)*1024);
+		Free(a);
+	}
+	mu_assert(gensvm_memory_live() == 0, "Incorrect live after Free");
+	mu_assert(gensvm_memory_peak() == 3*1024*sizeof(double),
+			"Incorrect peak after Free");
+
+	a = Calloc(char, bytes);
+	a[0] = 1.0;
+	mu_assert(gensvm_memory_live() == bytes, "Incorrect live");
+	mu_assert(gensvm_memory_peak() == bytes, "Incorrect peak");
+	gensvm_memory_track(false);
+
+	sites = gensvm_memory_sites(&n_sites);
+	mu_assert(n_sites == GENSVM_MEMORY_SITES, "Incorrect n_sites");
+	for (i=0; i<n_sites; i++)
+		if (sites[i].file != NULL && sites[i].line == line)
+			site = &sites[i];
+	mu_assert(site != NULL, "Site isn't recorded");
+	mu_assert(str_endswith(site->file, "test_gensvm_memory.c"),
+			"Incorrect file");
+	mu_assert(site->count == 3, "Incorrect count");
+	mu_assert(site->bytes == 6*1024*sizeof(double), "Incorrect bytes");
+	mu_assert(site->largest == 3*1024*sizeof(double),
+			"Incorrect largest");
+	mu_assert(site->live == 0, "Incorrect site live");
+	mu_assert(site->peak == 3*1024*sizeof(double), "Incorrect site peak");
+
+	// a block recorded while tracking is subtracted after tracking
+	Free(a);
+	mu_assert(gensvm_memory_live() == 0, "Incorrect live after tracking");
+	mu_assert(gensvm_memory_peak() == bytes, "Peak isn't kept");
+
+	// nothing is recorded when tracking is off
+	a = Malloc(double, 1024);
+	Free(a);
+	mu_assert(site->count == 3, "Incorrect count after tracking");
+
+	gensvm_memory_reset();
+	mu_assert(site->file == NULL, "Sites aren't reset");
+	mu_assert(gensvm_memory_peak() == 0, "Peak isn't reset");
+
+	return NULL;
+}
+
+char *test_memory_track_blocks()
+{
+	long i, n = 5000;
+	char **blocks = Malloc(char *, n);
+
+	gensvm_memory_reset();
+	gensvm_memory_track(true);
+	for (i=0; i<n; i++)
+		blocks[i] = Malloc(char, i+1);
+	mu_assert(gensvm_memory_live() == (size_t) n*(n+1)/2,
+			"Incorrect live");
+
+	// free every other block, then grow the others
+	for (i=0; i<n; i+=2)
+		Free(blocks[i]);
+	mu_assert(gensvm_memory_live() == (size_t) n*(n+2)/4,
+			"Incorrect live after Free");
+	for (i=1; i<n; i+=2)
+		blocks[i] = Realloc(blocks[i], char, 2*(i+1));
+	mu_assert(gensvm_memory_live() == (size_t) n*(n+2)/2,
+			"Incorrect live after Realloc");
+	mu_assert(gensvm_memory_peak() == (size_t) n*(n+2)/2,
+			"Incorrect peak after Realloc");
+
+	for (i=1; i<n; i+=2)
+		Free(blocks[i]);
+	mu_assert(gensvm_memory_live() == 0, "Incorrect live at the end");
+	gensvm_memory_track(false);
+	gensvm_memory_reset();
+	Free(blocks);
+
+	return NULL;
+}
+
+char *test_memory_limit()
+{
+	double *a = NULL;
+
+	mu_assert(gensvm_memory_limit() == 0, "Incorrect default limit");
+	mu_assert(gensvm_memory_available(((size_t) 1) << 60),
+			"Not available without limit");
+
+	gensvm_memory_reset();
+	gensvm_memory_set_limit(1024*1024);
+	mu_assert(gensvm_memory_live() == 0, "Incorrect live");
+	mu_assert(gensvm_memory_available(1024*1024),
+			"Allocation of limit isn't available");
+
+	// allocations are recorded when a limit is set
+	a = Malloc(double, 1024);
+	mu_assert(gensvm_memory_live() == 1024*sizeof(double),
+			"Incorrect live with limit");
+	mu_assert(!gensvm_memory_available(1024*1024),
+			"Allocation beyond limit is available");
+	mu_assert(gensvm_memory_available(1024*1024 - 1024*sizeof(double)),
+			"Allocation up to limit isn't available");
+	Free(a);
+	mu_assert(gensvm_memory_available(1024*1024),
+			"Freed memory isn't available");
+
+	gensvm_memory_set_limit(0);
+	mu_assert(gensvm_memory_limit() == 0, "Limit isn't reset");
+	gensvm_memory_reset();
+
+	return NULL;
+}
+
+char *all_tests()
+{
+	mu_suite_start();
+	mu_run_test(test_aligned_calloc);
+	mu_run_test(test_padded_ld);
+	mu_run_test(test_arena_calloc);
+	mu_run_test(test_arena_mark_release);
+	mu_run_test(test_arena_extra_reset);
+	mu_run_test(test_arena_size);
+	mu_run_test(test_memory_track);
+	mu_run_test(test_memory_track_blocks);
+	mu_run_test(test_memory_limit);
+
+	return NULL;
+}
+
+RUN_TESTS(all_tests);
@@ -27,9 +27,14 @@
 #include "minunit.h"
 #include "gensvm_optimize.h"
 #include "gensvm_init.h"
+#include "gensvm_strutil.h"
 
 char *test_gensvm_optimize()
 {
+	long i, n_sites;
+	struct GenMemorySite *sites = NULL;
+	struct GenArena *arena = gensvm_init_arena(1024*1024);
+	struct GenContext *ctx = gensvm_init_context(0);
 	struct GenModel *model = gensvm_init_model();
 	struct GenModel *seed_model = gensvm_init_model();
 	struct GenData *data = gensvm_init_data();
@@ -115,7 +120,7 @@ char *test_gensvm_optimize()
 	matrix_set(seed_model->V, K-1, 3, 1, 0.0840834388268874);
 	matrix_set(seed_model->V, K-1, 3, 2, 0.5312457860071739);
 
-	gensvm_init_V(seed_model, model, data);
+	gensvm_init_V(seed_model, model, data, NULL);
 	gensvm_initialize_weights(data, model);
 
 	model->rho[0] = 0.3607870295944514;
@@ -128,7 +133,22 @@ char *test_gensvm_optimize()
 	model->rho[7] = 0.1633697022472280;
 
 	// start test code //
-	gensvm_optimize(model, data);
+	// the training accuracy is predicted without a separate allocation
+	ctx->output = NULL;
+	ctx->arena = arena;
+	gensvm_memory_reset();
+	gensvm_memory_track(true);
+	gensvm_optimize(model, data, ctx);
+	gensvm_memory_track(false);
+	mu_assert(arena->used == 0, "Arena not released");
+
+	sites = gensvm_memory_sites(&n_sites);
+	for (i=0; i<n_sites; i++)
+		mu_assert(sites[i].file == NULL ||
+				!str_endswith(sites[i].file,
+					"gensvm_predict.c"),
+				"Prediction allocated memory");
+	gensvm_memory_reset();
 
 	double eps = 1e-7;
 	mu_assert(fabs(matrix_get(model->V, model->K-1, 0, 0) -
@@ -173,6 +193,8 @@ char *test_gensvm_optimize()
 	gensvm_free_data(data);
 	gensvm_free_model(model);
 	gensvm_free_model(seed_model);
+	gensvm_free_context(ctx);
+	gensvm_free_arena(arena);
 
 	return NULL;
 }
@@ -0,0 +1,237 @@
+/**
+ * @file test_gensvm_parse.c
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Unit tests for gensvm_parse.c functions
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "minunit.h"
+#include "gensvm_parse.h"
+
+#include <float.h>
+
+char *test_map_file()
+{
+	char *filename = "./data/test_file_read_data.txt";
+	struct GenFileMap *map = gensvm_map_file(filename, false);
+
+	mu_assert(map != NULL, "Couldn't map file");
+	mu_assert(map->size > 0, "Empty file mapped");
+	mu_assert(map->data[0] == '5', "Incorrect first character");
+	mu_assert(map->data[map->size-1] == '\n', "Incorrect last character");
+	gensvm_unmap_file(map);
+
+	map = gensvm_map_file("./data/no_such_file.txt", false);
+	mu_assert(map == NULL, "Mapped a file that doesn't exist");
+
+	return NULL;
+}
+
+char *test_next_line()
+{
+	const char *s = "  1 2\t3\n\n4 5\n";
+	const char *end = s + strlen(s);
+	const char *p = gensvm_skip_blank(s, end);
+
+	mu_assert(p == s + 2, "Incorrect skip blank");
+	p = gensvm_next_line(p, end);
+	mu_assert(p == s + 8, "Incorrect next line (1)");
+	mu_assert(gensvm_skip_blank(p, end) == p, "Newline skipped");
+	p = gensvm_next_line(p, end);
+	mu_assert(p == s + 9, "Incorrect next line (2)");
+	p = gensvm_next_line(p, end);
+	mu_assert(p == end, "Incorrect next line (3)");
+	p = gensvm_next_line(p, end);
+	mu_assert(p == end, "Moved beyond end");
+
+	return NULL;
+}
+
+char *test_parse_double()
+{
+	size_t i;
+	double value;
+	const char *p = NULL, *end = NULL;
+	const char *tokens[] = {"0", "-0", "1", "+1", "-1", "0.1", ".5", "5.",
+		"3.14159265358979", "-2.5e-3", "1E10", "1e-22", "1e22",
+		"9007199254740993", "12345678901234567890123",
+		"0.30000000000000004", "2.2250738585072014e-308",
+		"4.9e-324", "1e300", "-1.7976931348623157e308",
+		"123456789012345678e-5", "0.000000000000000000000001",
+		"1e-400", "inf", "-nan", "0x1p3"};
+
+	for (i=0; i<sizeof(tokens)/sizeof(tokens[0]); i++) {
+		p = tokens[i];
+		end = p + strlen(p);
+		mu_assert(gensvm_parse_double(&p, end, &value),
+				"Couldn't parse number");
+		mu_assert(p == end, "Number not fully consumed");
+		if (isnan(value)) {
+			mu_assert(isnan(strtod(tokens[i], NULL)),
+					"Incorrect nan");
+		} else {
+			mu_assert(value == strtod(tokens[i], NULL),
+					"Number differs from strtod");
+		}
+	}
+
+	p = " \t1.5 -2e1\n3";
+	end = p + strlen(p);
+	mu_assert(gensvm_parse_double(&p, end, &value) && value == 1.5,
+			"Incorrect first number");
+	mu_assert(gensvm_parse_double(&p, end, &value) && value == -20.0,
+			"Incorrect second number");
+	mu_assert(!gensvm_parse_double(&p, end, &value),
+			"Parsed beyond end of line");
+	mu_assert(*p == '\n', "Incorrect position at end of line");
+
+	p = "1.5x";
+	end = p + strlen(p);
+	mu_assert(!gensvm_parse_double(&p, end, &value),
+			"Parsed invalid number");
+	p = "1.5";
+	end = p + 2;
+	mu_assert(gensvm_parse_double(&p, end, &value) && value == 1.0,
+			"Parsed beyond end of data");
+
+	return NULL;
+}
+
+char *test_parse_double_random()
+{
+	long i;
+	double x, value;
+	char buffer[GENSVM_MAX_NUMBER_LENGTH];
+	const char *p = NULL;
+
+	srand(123);
+	for (i=0; i<10000; i++) {
+		x = ((double) rand())/RAND_MAX - 0.5;
+		x *= pow(10.0, rand() % 40 - 20);
+		sprintf(buffer, (i % 2) ? "%.17g" : "%.6f", x);
+		p = buffer;
+		mu_assert(gensvm_parse_double(&p, buffer + strlen(buffer),
+					&value), "Couldn't parse number");
+		mu_assert(value == strtod(buffer, NULL),
+				"Number differs from strtod");
+	}
+
+	return NULL;
+}
+
+char *test_parse_long()
+{
+	long value;
+	const char *p = " 42 -7 3.5";
+	const char *end = p + strlen(p);
+
+	mu_assert(gensvm_parse_long(&p, end, &value) && value == 42,
+			"Incorrect first integer");
+	mu_assert(gensvm_parse_long(&p, end, &value) && value == -7,
+			"Incorrect second integer");
+	mu_assert(!gensvm_parse_long(&p, end, &value),
+			"Parsed a float as integer");
+
+	return NULL;
+}
+
+char *test_format_long()
+{
+	int i;
+	size_t len;
+	long values[] = {0, 7, -7, 42, 1234567890, LONG_MAX, LONG_MIN};
+	char buffer[GENSVM_MAX_NUMBER_LENGTH],
+	     expected[GENSVM_MAX_NUMBER_LENGTH];
+
+	for (i=0; i<7; i++) {
+		len = gensvm_format_long(buffer, values[i]);
+		buffer[len] = '\0';
+		sprintf(expected, "%li", values[i]);
+		mu_assert(strcmp(buffer, expected) == 0,
+				"Integer differs from printf");
+	}
+
+	return NULL;
+}
+
+char *test_format_double()
+{
+	int i;
+	size_t len;
+	double values[] = {0.0, -0.0, 1.0, -2.5, 0.1, 7.62939453125e-06,
+		5e-17, -5e-17, 1e-30, 123456789.123456789, 1e300, DBL_MAX,
+		4.9e-324, INFINITY, -INFINITY};
+	char buffer[GENSVM_MAX_DOUBLE_LENGTH+1],
+	     expected[GENSVM_MAX_DOUBLE_LENGTH+1];
+
+	for (i=0; i<15; i++) {
+		len = gensvm_format_double(buffer, values[i]);
+		buffer[len] = '\0';
+		sprintf(expected, "%.16f", values[i]);
+		mu_assert(strcmp(buffer, expected) == 0,
+				"Number differs from printf");
+	}
+
+	return NULL;
+}
+
+char *test_format_double_random()
+{
+	long i;
+	size_t len;
+	double x;
+	char buffer[GENSVM_MAX_DOUBLE_LENGTH+1],
+	     expected[GENSVM_MAX_DOUBLE_LENGTH+1];
+
+	srand(123);
+	for (i=0; i<100000; i++) {
+		x = ((double) rand())/RAND_MAX - 0.5;
+		if (i % 2)
+			x *= pow(10.0, rand() % 40 - 20);
+		else
+			x = ldexp(rand() % 1000, -(rand() % 80));
+		len = gensvm_format_double(buffer, x);
+		buffer[len] = '\0';
+		sprintf(expected, "%.16f", x);
+		mu_assert(strcmp(buffer, expected) == 0,
+				"Number differs from printf");
+	}
+
+	return NULL;
+}
+
+char *all_tests()
+{
+	mu_suite_start();
+	mu_run_test(test_map_file);
+	mu_run_test(test_next_line);
+	mu_run_test(test_parse_double);
+	mu_run_test(test_parse_double_random);
+	mu_run_test(test_parse_long);
+	mu_run_test(test_format_long);
+	mu_run_test(test_format_double);
+	mu_run_test(test_format_double_random);
+
+	return NULL;
+}
+
+RUN_TESTS(all_tests);
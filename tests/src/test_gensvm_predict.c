@@ -271,11 +271,300 @@ char *test_gensvm_prediction_perf()
 	return NULL;
 }
 
+char *test_gensvm_predict_assign()
+{
+	long i, j, k, label, n = 3*GENSVM_PREDICT_MIN_ROWS + 17, K = 7;
+	double dist, min_dist, diff;
+	double *ZV = Malloc(double, n*(K-1));
+	double *D = Malloc(double, n*K);
+	long *predy = Calloc(long, n);
+	struct GenModel *model = gensvm_init_model();
+
+	model->K = K;
+	model->U = Calloc(double, K*(K-1));
+	gensvm_simplex(model);
+
+	srand(123);
+	for (i=0; i<n*(K-1); i++)
+		ZV[i] = 2.0*((double) rand())/RAND_MAX - 1.0;
+
+	// start test code //
+	gensvm_predict_assign(ZV, model->U, n, K, predy, D, NULL);
+
+	// compare with the nearest vertex by Euclidean distance
+	for (i=0; i<n; i++) {
+		label = 0;
+		min_dist = INFINITY;
+		for (j=0; j<K; j++) {
+			dist = 0;
+			for (k=0; k<K-1; k++) {
+				diff = matrix_get(ZV, K-1, i, k) -
+					matrix_get(model->U, K-1, j, k);
+				dist += diff * diff;
+			}
+			mu_assert(fabs(sqrt(dist) - matrix_get(D, K, i, j))
+					< 1e-12, "Incorrect distance");
+			if (dist < min_dist) {
+				label = j+1;
+				min_dist = dist;
+			}
+		}
+		mu_assert(predy[i] == label, "Incorrect label");
+	}
+	// end test code //
+
+	gensvm_free_model(model);
+	free(ZV);
+	free(D);
+	free(predy);
+
+	return NULL;
+}
+
+char *test_gensvm_predict_assign_context()
+{
+	long i, n = 3*GENSVM_PREDICT_MIN_ROWS + 17, K = 5;
+	double *ZV = Malloc(double, n*(K-1));
+	double *D = Malloc(double, n*K);
+	double *D_ctx = Malloc(double, n*K);
+	long *predy = Calloc(long, n);
+	long *predy_ctx = Calloc(long, n);
+	struct GenModel *model = gensvm_init_model();
+	struct GenContext *ctx = gensvm_init_context(1);
+	struct GenArena *arena = gensvm_init_arena(
+			gensvm_predict_assign_size(n, K));
+
+	model->K = K;
+	model->U = Calloc(double, K*(K-1));
+	gensvm_simplex(model);
+
+	srand(321);
+	for (i=0; i<n*(K-1); i++)
+		ZV[i] = 2.0*((double) rand())/RAND_MAX - 1.0;
+
+	// start test code //
+	gensvm_predict_assign(ZV, model->U, n, K, predy, D, NULL);
+
+	// two threads with the work arrays from the arena
+	ctx->n_threads = 2;
+	ctx->arena = arena;
+	gensvm_predict_assign(ZV, model->U, n, K, predy_ctx, D_ctx, ctx);
+	mu_assert(arena->used == 0, "Arena not released");
+	mu_assert(arena->n_extra == 0, "Arena too small");
+
+	// a single thread, as used by the consistency repeats
+	ctx->n_threads = 1;
+	gensvm_predict_assign(ZV, model->U, n, K, predy_ctx, D_ctx, ctx);
+	mu_assert(arena->used == 0, "Arena not released");
+
+	for (i=0; i<n; i++)
+		mu_assert(predy[i] == predy_ctx[i], "Incorrect label");
+	for (i=0; i<n*K; i++)
+		mu_assert(D[i] == D_ctx[i], "Incorrect distance");
+	// end test code //
+
+	gensvm_free_arena(arena);
+	gensvm_free_context(ctx);
+	gensvm_free_model(model);
+	free(ZV);
+	free(D);
+	free(D_ctx);
+	free(predy);
+	free(predy_ctx);
+
+	return NULL;
+}
+
+char *test_gensvm_predict_values()
+{
+	long i, j, n = 1000, m = 5, K = 4;
+	long *predy = Calloc(long, n);
+	long *labels = Calloc(long, n);
+	double sum, max_prob, *ZV = Calloc(double, n*(K-1)),
+	       *dec = Calloc(double, n*(K-1)),
+	       *dist = Calloc(double, n*K),
+	       *prob = Calloc(double, n*K);
+	struct GenData *data = gensvm_init_data();
+	struct GenModel *model = gensvm_init_model();
+
+	data->n = n;
+	data->m = m;
+	data->r = m;
+	data->K = K;
+	data->Z = Calloc(double, n*(m+1));
+	model->n = n;
+	model->m = m;
+	model->K = K;
+	model->temperature = 0.5;
+	gensvm_allocate_model(model);
+
+	srand(123);
+	for (i=0; i<n; i++) {
+		matrix_set(data->Z, m+1, i, 0, 1.0);
+		for (j=1; j<m+1; j++)
+			matrix_set(data->Z, m+1, i, j,
+					2.0*((double) rand())/RAND_MAX - 1.0);
+	}
+	for (i=0; i<(m+1)*(K-1); i++)
+		model->V[i] = 2.0*((double) rand())/RAND_MAX - 1.0;
+
+	// start test code //
+	gensvm_predict_labels(data, model, labels);
+	gensvm_calculate_ZV(model, data, ZV);
+
+	gensvm_predict_values(data, model, P_DECISION, predy, dec);
+	for (i=0; i<n; i++)
+		mu_assert(predy[i] == labels[i], "Incorrect label (decision)");
+	for (i=0; i<n*(K-1); i++)
+		mu_assert(dec[i] == ZV[i], "Incorrect decision value");
+
+	gensvm_predict_values(data, model, P_DISTANCES, predy, dist);
+	for (i=0; i<n; i++) {
+		mu_assert(predy[i] == labels[i], "Incorrect label (distance)");
+		for (j=0; j<K; j++)
+			mu_assert(matrix_get(dist, K, i, j) >=
+					matrix_get(dist, K, i, predy[i]-1),
+					"Label is not the nearest vertex");
+	}
+
+	gensvm_predict_values(data, model, P_PROBABILITIES, predy, prob);
+	for (i=0; i<n; i++) {
+		mu_assert(predy[i] == labels[i], "Incorrect label (prob)");
+		sum = 0;
+		max_prob = 0;
+		for (j=0; j<K; j++) {
+			sum += matrix_get(prob, K, i, j);
+			max_prob = maximum(max_prob, matrix_get(prob, K, i,
+						j));
+		}
+		mu_assert(fabs(sum - 1.0) < 1e-12,
+				"Probabilities don't sum to one");
+		mu_assert(matrix_get(prob, K, i, predy[i]-1) == max_prob,
+				"Label doesn't have the largest probability");
+	}
+
+	// the probabilities are the softmax of the distances
+	gensvm_predict_softmax(dist, n, K, model->temperature);
+	for (i=0; i<n*K; i++)
+		mu_assert(fabs(dist[i] - prob[i]) < 1e-15,
+				"Incorrect probability");
+	// end test code //
+
+	gensvm_free_data(data);
+	gensvm_free_model(model);
+	free(predy);
+	free(labels);
+	free(ZV);
+	free(dec);
+	free(dist);
+	free(prob);
+
+	return NULL;
+}
+
+char *test_gensvm_predict_softmax()
+{
+	double P[6] = {1.0, 2.0, 3.0, 100.0, 100.0, 100.0};
+	double z = 1.0 + exp(-2.0) + exp(-4.0);
+
+	// start test code //
+	gensvm_predict_softmax(P, 2, 3, 0.5);
+	mu_assert(fabs(P[0] - 1.0/z) < 1e-15, "Incorrect P[0]");
+	mu_assert(fabs(P[1] - exp(-2.0)/z) < 1e-15, "Incorrect P[1]");
+	mu_assert(fabs(P[2] - exp(-4.0)/z) < 1e-15, "Incorrect P[2]");
+	// large distances don't underflow
+	mu_assert(fabs(P[3] - 1.0/3.0) < 1e-15, "Incorrect P[3]");
+	mu_assert(fabs(P[4] - 1.0/3.0) < 1e-15, "Incorrect P[4]");
+	mu_assert(fabs(P[5] - 1.0/3.0) < 1e-15, "Incorrect P[5]");
+	// end test code //
+
+	return NULL;
+}
+
+char *test_gensvm_fit_temperature()
+{
+	long i, j, n = 500, K = 3;
+	long *y = Calloc(long, n);
+	double T, grad, nll, nll_T, sum, *D = Calloc(double, n*K),
+	       *P = Calloc(double, n*K);
+
+	srand(42);
+	for (i=0; i<n; i++) {
+		y[i] = 1 + (i % K);
+		for (j=0; j<K; j++)
+			matrix_set(D, K, i, j, 1.0 + ((double) rand())/
+					RAND_MAX);
+		// the true class is usually, but not always, the nearest
+		if (i % 4 != 0)
+			matrix_set(D, K, i, y[i]-1, 0.5*((double) rand())/
+					RAND_MAX);
+	}
+
+	// start test code //
+	T = gensvm_fit_temperature(D, y, n, K);
+	mu_assert(T > GENSVM_MIN_TEMPERATURE && T < GENSVM_MAX_TEMPERATURE,
+			"Temperature is at the boundary");
+
+	// the derivative of the negative log-likelihood is zero at T
+	grad = 0;
+	for (i=0; i<n; i++) {
+		sum = 0;
+		for (j=0; j<K; j++)
+			sum += exp(-matrix_get(D, K, i, j)/T);
+		grad += matrix_get(D, K, i, y[i]-1);
+		for (j=0; j<K; j++)
+			grad -= matrix_get(D, K, i, j) *
+				exp(-matrix_get(D, K, i, j)/T)/sum;
+	}
+	mu_assert(fabs(grad) < 1e-8, "Temperature is not optimal");
+
+	// and the likelihood is better than that of the default temperature
+	nll = 0;
+	nll_T = 0;
+	for (i=0; i<n*K; i++)
+		P[i] = D[i];
+	gensvm_predict_softmax(P, n, K, 1.0);
+	for (i=0; i<n; i++)
+		nll -= log(matrix_get(P, K, i, y[i]-1));
+	for (i=0; i<n*K; i++)
+		P[i] = D[i];
+	gensvm_predict_softmax(P, n, K, T);
+	for (i=0; i<n; i++)
+		nll_T -= log(matrix_get(P, K, i, y[i]-1));
+	mu_assert(nll_T < nll, "Likelihood didn't improve");
+
+	// if all instances are separated the temperature is the minimum
+	for (i=0; i<n; i++)
+		for (j=0; j<K; j++)
+			matrix_set(D, K, i, j, (j == y[i]-1) ? 0.0 : 1.0);
+	T = gensvm_fit_temperature(D, y, n, K);
+	mu_assert(T == GENSVM_MIN_TEMPERATURE, "Incorrect temperature for "
+			"separated data");
+
+	// if all distances are equal the default is returned
+	for (i=0; i<n*K; i++)
+		D[i] = 1.0;
+	T = gensvm_fit_temperature(D, y, n, K);
+	mu_assert(T == 1.0, "Incorrect temperature for equal distances");
+	// end test code //
+
+	free(y);
+	free(D);
+	free(P);
+
+	return NULL;
+}
+
 char *all_tests()
 {
 	mu_suite_start();
 	mu_run_test(test_gensvm_predict_labels_dense);
 	mu_run_test(test_gensvm_predict_labels_sparse);
+	mu_run_test(test_gensvm_predict_assign);
+	mu_run_test(test_gensvm_predict_assign_context);
+	mu_run_test(test_gensvm_predict_values);
+	mu_run_test(test_gensvm_predict_softmax);
+	mu_run_test(test_gensvm_fit_temperature);
 	mu_run_test(test_gensvm_prediction_perf);
 
 	return NULL;
@@ -0,0 +1,235 @@
+/**
+ * @file test_gensvm_predictor.c
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Unit tests for gensvm_predictor.c functions
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "minunit.h"
+#include "gensvm_predictor.h"
+
+extern FILE *GENSVM_ERROR_FILE;
+
+/**
+ * Generate a dataset with roughly a third of the feature values zero, and a
+ * linear model with random weights for it.
+ */
+struct GenData *predictor_test_data(struct GenModel *model)
+{
+	long i, j;
+	double value;
+	struct GenData *data = gensvm_init_data();
+
+	data->n = 1000;
+	data->m = 6;
+	data->r = data->m;
+	data->K = 5;
+	data->RAW = Calloc(double, data->n*(data->m+1));
+	data->Z = data->RAW;
+	srand(123);
+	for (i=0; i<data->n; i++) {
+		matrix_set(data->RAW, data->m+1, i, 0, 1.0);
+		for (j=1; j<data->m+1; j++) {
+			value = 2.0*((double) rand())/RAND_MAX - 1.0;
+			if (rand() % 3 == 0)
+				value = 0.0;
+			matrix_set(data->RAW, data->m+1, i, j, value);
+		}
+	}
+
+	model->n = data->n;
+	model->m = data->m;
+	model->K = data->K;
+	gensvm_allocate_model(model);
+	for (i=0; i<(model->m+1)*(model->K-1); i++)
+		model->V[i] = 2.0*((double) rand())/RAND_MAX - 1.0;
+
+	return data;
+}
+
+char *test_gensvm_predictor_dense()
+{
+	long i, j, n, m;
+	double *rows = NULL;
+	long *predy = NULL,
+	     *batch = NULL;
+	struct GenModel *model = gensvm_init_model();
+	struct GenData *data = predictor_test_data(model);
+	struct GenPredictor *predictor = NULL;
+
+	n = data->n;
+	m = data->m;
+	predy = Calloc(long, n);
+	batch = Calloc(long, n);
+	rows = Malloc(double, n*m);
+	for (i=0; i<n; i++)
+		for (j=0; j<m; j++)
+			rows[i*m+j] = matrix_get(data->Z, m+1, i, j+1);
+
+	gensvm_predict_labels(data, model, predy);
+
+	// start test code //
+	predictor = gensvm_init_predictor(model, 64);
+	// the predictor shouldn't depend on the model after it is created
+	gensvm_free_model(model);
+
+	gensvm_predict_batch(predictor, rows, n, batch);
+	for (i=0; i<n; i++)
+		mu_assert(batch[i] == predy[i], "Incorrect batch label");
+
+	for (i=0; i<n; i++) {
+		gensvm_predict_batch(predictor, &rows[i*m], 1, batch);
+		mu_assert(batch[0] == predy[i], "Incorrect single label");
+	}
+	gensvm_free_predictor(predictor);
+	// end test code //
+
+	gensvm_free_data(data);
+	free(predy);
+	free(batch);
+	free(rows);
+
+	return NULL;
+}
+
+char *test_gensvm_predictor_sparse()
+{
+	long i, j, n, m, nnz = 0;
+	double value;
+	long *ia = NULL,
+	     *ja = NULL,
+	     *predy = NULL,
+	     *batch = NULL;
+	double *values = NULL;
+	struct GenModel *model = gensvm_init_model();
+	struct GenData *data = predictor_test_data(model);
+	struct GenPredictor *predictor = NULL;
+
+	n = data->n;
+	m = data->m;
+	predy = Calloc(long, n);
+	batch = Calloc(long, n);
+	ia = Calloc(long, n+1);
+	ja = Calloc(long, n*m);
+	values = Calloc(double, n*m);
+	for (i=0; i<n; i++) {
+		ia[i] = nnz;
+		for (j=0; j<m; j++) {
+			value = matrix_get(data->Z, m+1, i, j+1);
+			if (value != 0) {
+				ja[nnz] = j;
+				values[nnz++] = value;
+			}
+		}
+	}
+	ia[n] = nnz;
+
+	gensvm_predict_labels(data, model, predy);
+
+	// start test code //
+	predictor = gensvm_init_predictor(model, 0);
+	mu_assert(predictor->max_rows == GENSVM_BLOCK_SIZE,
+			"Incorrect default batch size");
+
+	mu_assert(gensvm_predict_batch_sparse(predictor, ia, ja, values, n,
+				batch), "Batch not predicted");
+	for (i=0; i<n; i++)
+		mu_assert(batch[i] == predy[i], "Incorrect batch label");
+
+	for (i=0; i<n; i++) {
+		mu_assert(gensvm_predict_batch_sparse(predictor, &ia[i], ja,
+					values, 1, batch), "Label not predicted");
+		mu_assert(batch[0] == predy[i], "Incorrect single label");
+	}
+	gensvm_free_predictor(predictor);
+	// end test code //
+
+	gensvm_free_model(model);
+	gensvm_free_data(data);
+	free(ia);
+	free(ja);
+	free(values);
+	free(predy);
+	free(batch);
+
+	return NULL;
+}
+
+char *test_gensvm_predictor_errors()
+{
+	long ia[3] = {0, 2, 3},
+	     ja[3] = {0, 5, 6},
+	     batch[2] = {-1, -1};
+	double values[3] = {1.0, 2.0, 3.0};
+	FILE *old = GENSVM_ERROR_FILE;
+	struct GenModel *model = gensvm_init_model();
+	struct GenData *data = predictor_test_data(model);
+	struct GenPredictor *predictor = NULL;
+
+	// start test code //
+	GENSVM_ERROR_FILE = NULL;
+
+	predictor = gensvm_init_predictor(model, 0);
+	mu_assert(predictor != NULL, "Predictor not created");
+	mu_assert(!gensvm_predict_batch_sparse(predictor, ia, ja, values, 2,
+				batch), "Index out of range not rejected");
+	mu_assert(batch[0] == -1 && batch[1] == -1, "Labels changed");
+
+	ja[2] = -1;
+	mu_assert(!gensvm_predict_batch_sparse(predictor, ia, ja, values, 2,
+				batch), "Negative index not rejected");
+
+	ja[2] = 2;
+	mu_assert(gensvm_predict_batch_sparse(predictor, ia, ja, values, 2,
+				batch), "Valid batch rejected");
+	gensvm_free_predictor(predictor);
+
+	model->kerneltype = K_RBF;
+	mu_assert(gensvm_init_predictor(model, 0) == NULL,
+			"Predictor created for a nonlinear model");
+
+	model->kerneltype = K_LINEAR;
+	model->K = 1;
+	mu_assert(gensvm_init_predictor(model, 0) == NULL,
+			"Predictor created for an untrained model");
+	model->K = data->K;
+
+	GENSVM_ERROR_FILE = old;
+	// end test code //
+
+	gensvm_free_model(model);
+	gensvm_free_data(data);
+
+	return NULL;
+}
+
+char *all_tests()
+{
+	mu_suite_start();
+	mu_run_test(test_gensvm_predictor_dense);
+	mu_run_test(test_gensvm_predictor_sparse);
+	mu_run_test(test_gensvm_predictor_errors);
+
+	return NULL;
+}
+
+RUN_TESTS(all_tests);
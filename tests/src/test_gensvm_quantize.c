@@ -0,0 +1,353 @@
+/**
+ * @file test_gensvm_predictor.c
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Unit tests for gensvm_quantize.c functions
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "minunit.h"
+#include "gensvm_quantize.h"
+#include "gensvm_train.h"
+
+/**
+ * Generate a dataset with three classes and about a third of the feature
+ * values zero.
+ */
+struct GenData *quantize_test_data(long n, unsigned int seed)
+{
+	long i, j;
+	double value;
+	struct GenData *data = gensvm_init_data();
+
+	data->n = n;
+	data->m = 6;
+	data->r = data->m;
+	data->K = 3;
+	data->RAW = Calloc(double, data->n*(data->m+1));
+	data->Z = data->RAW;
+	data->y = Calloc(long, data->n);
+	srand(seed);
+	for (i=0; i<data->n; i++) {
+		data->y[i] = i % data->K + 1;
+		matrix_set(data->RAW, data->m+1, i, 0, 1.0);
+		for (j=1; j<data->m+1; j++) {
+			value = ((double) rand())/RAND_MAX + 0.2*data->y[i]*j;
+			if (rand() % 3 == 0)
+				value = 0.0;
+			matrix_set(data->RAW, data->m+1, i, j, value);
+		}
+	}
+	return data;
+}
+
+/**
+ * Train a linear model on the data
+ */
+struct GenModel *quantize_test_model(struct GenData *data)
+{
+	struct GenModel *model = gensvm_init_model();
+
+	model->max_iter = 500;
+	model->seed = 123;
+	gensvm_train(model, data, NULL, NULL);
+
+	return model;
+}
+
+char *test_gensvm_double_to_half()
+{
+	mu_assert(gensvm_double_to_half(0.0) == 0x0000, "Incorrect zero");
+	mu_assert(gensvm_double_to_half(1.0) == 0x3c00, "Incorrect one");
+	mu_assert(gensvm_double_to_half(-2.0) == 0xc000, "Incorrect -2");
+	mu_assert(gensvm_double_to_half(0.5) == 0x3800, "Incorrect 0.5");
+	mu_assert(gensvm_double_to_half(65504.0) == 0x7bff,
+			"Incorrect largest number");
+	mu_assert(gensvm_double_to_half(1e6) == 0x7bff,
+			"Incorrect saturation");
+	mu_assert(gensvm_double_to_half(-1e6) == 0xfbff,
+			"Incorrect negative saturation");
+	mu_assert(gensvm_double_to_half(pow(2.0, -24)) == 0x0001,
+			"Incorrect smallest subnormal");
+	mu_assert(gensvm_double_to_half(pow(2.0, -26)) == 0x0000,
+			"Incorrect underflow");
+	// 1 + 2^-11 is halfway between 1 and 1 + 2^-10, ties to even
+	mu_assert(gensvm_double_to_half(1.0 + pow(2.0, -11)) == 0x3c00,
+			"Incorrect tie to even");
+	mu_assert(gensvm_double_to_half(1.0 + 3*pow(2.0, -11)) == 0x3c02,
+			"Incorrect tie to even (2)");
+	mu_assert(gensvm_double_to_half(1.0/3.0) == 0x3555,
+			"Incorrect 1/3");
+
+	return NULL;
+}
+
+char *test_gensvm_half_to_double()
+{
+	long i;
+	double value;
+
+	mu_assert(gensvm_half_to_double(0x3c00) == 1.0, "Incorrect one");
+	mu_assert(gensvm_half_to_double(0xc000) == -2.0, "Incorrect -2");
+	mu_assert(gensvm_half_to_double(0x7bff) == 65504.0,
+			"Incorrect largest number");
+	mu_assert(gensvm_half_to_double(0x0001) == pow(2.0, -24),
+			"Incorrect smallest subnormal");
+	mu_assert(gensvm_half_to_double(0x8001) == -pow(2.0, -24),
+			"Incorrect negative subnormal");
+	mu_assert(isinf(gensvm_half_to_double(0x7c00)), "Incorrect inf");
+	mu_assert(isnan(gensvm_half_to_double(0x7e00)), "Incorrect nan");
+
+	// every finite half converts back to itself
+	for (i=0; i<0x10000; i++) {
+		if ((i & 0x7c00) == 0x7c00)
+			continue;
+		value = gensvm_half_to_double((uint16_t) i);
+		if (i == 0x8000)
+			continue;
+		mu_assert(gensvm_double_to_half(value) == i,
+				"Incorrect round trip");
+	}
+
+	return NULL;
+}
+
+char *test_gensvm_quantize_model_int8()
+{
+	long j, k, m = 3, K = 3;
+	double value;
+	struct GenModel *model = gensvm_init_model();
+	struct GenQuantModel *q = NULL;
+
+	model->m = m;
+	model->K = K;
+	model->V = Calloc(double, (m+1)*(K-1));
+	matrix_set(model->V, K-1, 0, 0, 0.25);
+	matrix_set(model->V, K-1, 0, 1, -0.75);
+	matrix_set(model->V, K-1, 1, 0, 1.27);
+	matrix_set(model->V, K-1, 2, 0, -0.635);
+	matrix_set(model->V, K-1, 3, 0, 0.01);
+	matrix_set(model->V, K-1, 1, 1, 0.0);
+	matrix_set(model->V, K-1, 2, 1, 0.0);
+	matrix_set(model->V, K-1, 3, 1, 0.0);
+
+	// start test code //
+	q = gensvm_quantize_model(model, Q_INT8);
+	mu_assert(q->type == Q_INT8, "Incorrect type");
+	mu_assert(q->m == m, "Incorrect m");
+	mu_assert(q->K == K, "Incorrect K");
+	mu_assert(q->W16 == NULL, "Incorrect W16");
+	mu_assert(q->bias[0] == 0.25, "Incorrect bias (0)");
+	mu_assert(q->bias[1] == -0.75, "Incorrect bias (1)");
+	mu_assert(fabs(q->scale[0] - 0.01) < 1e-15, "Incorrect scale (0)");
+	mu_assert(q->scale[1] == 1.0, "Incorrect scale of zero column");
+	mu_assert(q->W8[0] == 127, "Incorrect W8 (0)");
+	mu_assert(q->W8[1] == -64, "Incorrect W8 (1)");
+	mu_assert(q->W8[2] == 1, "Incorrect W8 (2)");
+	for (j=0; j<m; j++)
+		mu_assert(q->W8[m+j] == 0, "Incorrect W8 of zero column");
+
+	// the quantization error is at most half the scale
+	for (k=0; k<K-1; k++) {
+		for (j=0; j<m; j++) {
+			value = matrix_get(model->V, K-1, j+1, k);
+			mu_assert(fabs(q->W8[k*m+j]*q->scale[k] - value) <=
+					0.5*q->scale[k] + 1e-15,
+					"Incorrect quantization error");
+		}
+	}
+	gensvm_free_quant_model(q);
+	// end test code //
+
+	gensvm_free_model(model);
+
+	return NULL;
+}
+
+char *test_gensvm_quant_calculate_ZV()
+{
+	long i, k, K;
+	struct GenData *data = quantize_test_data(50, 123);
+	struct GenModel *model = quantize_test_model(data);
+	struct GenQuantModel *q8 = gensvm_quantize_model(model, Q_INT8);
+	struct GenQuantModel *q16 = gensvm_quantize_model(model, Q_FLOAT16);
+	struct GenData *sparse = quantize_test_data(50, 321);
+	double *ZV = NULL,
+	       *ZV8 = NULL,
+	       *ZV16 = NULL,
+	       *sp_ZV = NULL;
+
+	K = model->K;
+	ZV = Calloc(double, data->n*(K-1));
+	ZV8 = Calloc(double, data->n*(K-1));
+	ZV16 = Calloc(double, data->n*(K-1));
+	sp_ZV = Calloc(double, data->n*(K-1));
+
+	// start test code //
+	gensvm_calculate_ZV(model, data, ZV);
+	gensvm_quant_calculate_ZV(q8, data, ZV8);
+	gensvm_quant_calculate_ZV(q16, data, ZV16);
+	for (i=0; i<data->n; i++) {
+		for (k=0; k<K-1; k++) {
+			mu_assert(fabs(ZV[i*(K-1)+k] - ZV8[i*(K-1)+k]) <
+					0.5*q8->scale[k]*model->m*2.0,
+					"Incorrect int8 ZV");
+			mu_assert(fabs(ZV[i*(K-1)+k] - ZV16[i*(K-1)+k]) <
+					1e-2, "Incorrect float16 ZV");
+		}
+	}
+
+	// sparse data gives the same decision values
+	gensvm_quant_calculate_ZV(q8, sparse, ZV8);
+	sparse->spZ = gensvm_dense_to_sparse(sparse->Z, sparse->n,
+			sparse->m+1);
+	sparse->Z = NULL;
+	gensvm_quant_calculate_ZV(q8, sparse, sp_ZV);
+	for (i=0; i<sparse->n*(K-1); i++)
+		mu_assert(fabs(ZV8[i] - sp_ZV[i]) < 1e-12,
+				"Incorrect sparse int8 ZV");
+
+	sparse->Z = sparse->RAW;
+	gensvm_quant_calculate_ZV(q16, sparse, ZV16);
+	sparse->Z = NULL;
+	gensvm_quant_calculate_ZV(q16, sparse, sp_ZV);
+	for (i=0; i<sparse->n*(K-1); i++)
+		mu_assert(fabs(ZV16[i] - sp_ZV[i]) < 1e-12,
+				"Incorrect sparse float16 ZV");
+	sparse->Z = sparse->RAW;
+	// end test code //
+
+	gensvm_free_quant_model(q8);
+	gensvm_free_quant_model(q16);
+	gensvm_free_model(model);
+	gensvm_free_data(data);
+	gensvm_free_data(sparse);
+	free(ZV);
+	free(ZV8);
+	free(ZV16);
+	free(sp_ZV);
+
+	return NULL;
+}
+
+char *test_gensvm_quant_predict_values()
+{
+	long i, k, K;
+	struct GenData *data = quantize_test_data(60, 123);
+	struct GenModel *model = quantize_test_model(data);
+	struct GenQuantModel *q = gensvm_quantize_model(model, Q_FLOAT16);
+	long *predy = NULL;
+	double sum, *ZV = NULL,
+	       *values = NULL;
+
+	K = model->K;
+	predy = Calloc(long, data->n);
+	ZV = Calloc(double, data->n*(K-1));
+	values = Calloc(double, data->n*K);
+
+	// start test code //
+	gensvm_quant_predict_values(q, data, P_DECISION, predy, ZV);
+	gensvm_quant_calculate_ZV(q, data, values);
+	for (i=0; i<data->n*(K-1); i++)
+		mu_assert(ZV[i] == values[i], "Incorrect decision values");
+
+	gensvm_quant_predict_values(q, data, P_PROBABILITIES, predy, values);
+	for (i=0; i<data->n; i++) {
+		sum = 0;
+		for (k=0; k<K; k++) {
+			sum += values[i*K+k];
+			mu_assert(values[i*K+k] <= values[i*K+predy[i]-1],
+					"Label doesn't have the largest "
+					"probability");
+		}
+		mu_assert(fabs(sum - 1.0) < 1e-12,
+				"Probabilities don't sum to one");
+	}
+	// end test code //
+
+	gensvm_free_quant_model(q);
+	gensvm_free_model(model);
+	gensvm_free_data(data);
+	free(predy);
+	free(ZV);
+	free(values);
+
+	return NULL;
+}
+
+char *test_gensvm_quant_compare()
+{
+	long i, n_correct = 0;
+	struct GenData *train = quantize_test_data(90, 123);
+	struct GenData *test = quantize_test_data(40, 321);
+	struct GenModel *model = quantize_test_model(train);
+	struct GenQuantModel *q = gensvm_quantize_model(model, Q_INT8);
+	struct GenQuantReport *report = gensvm_init_quant_report();
+	long *predy = Calloc(long, test->n);
+
+	gensvm_predict_labels(test, model, predy);
+	for (i=0; i<test->n; i++)
+		n_correct += (predy[i] == test->y[i]);
+
+	// start test code //
+	gensvm_quant_compare(report, q, model, test);
+	gensvm_quant_compare(report, q, model, test);
+	mu_assert(report->n == 2*test->n, "Incorrect n");
+	mu_assert(report->n_labeled == 2*test->n, "Incorrect n_labeled");
+	mu_assert(report->n_correct == 2*n_correct, "Incorrect n_correct");
+	mu_assert(report->n_agree >= 0.9*report->n, "Too few agreements");
+	mu_assert(report->n_agree <= report->n, "Incorrect n_agree");
+	mu_assert(report->max_error > 0, "Incorrect max_error");
+	mu_assert(report->sum_sq_error <= report->n*(model->K-1)*
+			pow(report->max_error, 2.0), "Incorrect sum_sq_error");
+
+	free(test->y);
+	test->y = NULL;
+	gensvm_quant_compare(report, q, model, test);
+	mu_assert(report->n == 3*test->n, "Incorrect n without labels");
+	mu_assert(report->n_labeled == 2*test->n,
+			"Incorrect n_labeled without labels");
+	// end test code //
+
+	gensvm_free_quant_report(report);
+	gensvm_free_quant_model(q);
+	gensvm_free_model(model);
+	gensvm_free_data(train);
+	gensvm_free_data(test);
+	free(predy);
+
+	return NULL;
+}
+
+char *all_tests()
+{
+	mu_suite_start();
+	mu_run_test(test_gensvm_double_to_half);
+	mu_run_test(test_gensvm_half_to_double);
+	mu_run_test(test_gensvm_quantize_model_int8);
+	mu_run_test(test_gensvm_quant_calculate_ZV);
+	mu_run_test(test_gensvm_quant_predict_values);
+	mu_run_test(test_gensvm_quant_compare);
+
+	return NULL;
+}
+
+RUN_TESTS(all_tests);
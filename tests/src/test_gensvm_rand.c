@@ -0,0 +1,134 @@
+/**
+ * @file test_gensvm_rand.c
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Unit tests for gensvm_rand.c functions
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+
+#include "minunit.h"
+#include "gensvm_rand.h"
+
+char *test_init_free_rng()
+{
+	struct GenRNG *rng = gensvm_init_rng(0);
+	mu_assert(rng->s[0] != 0 || rng->s[1] != 0 || rng->s[2] != 0 ||
+			rng->s[3] != 0, "State is all zero");
+	gensvm_free_rng(rng);
+	return NULL;
+}
+
+char *test_rng_seed()
+{
+	int i;
+	uint64_t a, b;
+	struct GenRNG *rng1 = gensvm_init_rng(123);
+	struct GenRNG *rng2 = gensvm_init_rng(123);
+	struct GenRNG *rng3 = gensvm_init_rng(124);
+
+	// the first output of splitmix64 with seed 0
+	gensvm_rng_seed(rng1, 0);
+	mu_assert(rng1->s[0] == 0xe220a8397b1dcdafULL,
+			"Incorrect splitmix64 seeding");
+	gensvm_rng_seed(rng1, 123);
+
+	for (i=0; i<100; i++) {
+		a = gensvm_rng_next(rng1);
+		b = gensvm_rng_next(rng2);
+		mu_assert(a == b, "Same seed gives different stream");
+		mu_assert(a != gensvm_rng_next(rng3),
+				"Different seed gives same stream");
+	}
+
+	gensvm_free_rng(rng1);
+	gensvm_free_rng(rng2);
+	gensvm_free_rng(rng3);
+	return NULL;
+}
+
+char *test_rng_derive()
+{
+	mu_assert(gensvm_rng_derive(1, 0) == gensvm_rng_derive(1, 0),
+			"Derived seed not reproducible");
+	mu_assert(gensvm_rng_derive(1, 0) != gensvm_rng_derive(1, 1),
+			"Streams have the same seed");
+	mu_assert(gensvm_rng_derive(1, 0) != gensvm_rng_derive(2, 0),
+			"Base seeds give the same stream");
+	return NULL;
+}
+
+char *test_rng_bounded()
+{
+	long i, counts[7] = {0};
+	uint64_t x;
+	struct GenRNG *rng = gensvm_init_rng(42);
+
+	for (i=0; i<70000; i++) {
+		x = gensvm_rng_bounded(rng, 7);
+		mu_assert(x < 7, "Bounded value out of range");
+		counts[x]++;
+	}
+	// each count is binomial with mean 10000 and sd ~ 92
+	for (i=0; i<7; i++)
+		mu_assert(labs(counts[i] - 10000) < 500,
+				"Bounded values not uniform");
+
+	mu_assert(gensvm_rng_bounded(rng, 1) == 0, "Incorrect bound 1");
+	for (i=0; i<100; i++) {
+		x = gensvm_rng_bounded(rng, 10000000000ULL);
+		mu_assert(x < 10000000000ULL, "Large bound out of range");
+	}
+
+	gensvm_free_rng(rng);
+	return NULL;
+}
+
+char *test_rng_uniform()
+{
+	long i;
+	double u, mean = 0.0;
+	struct GenRNG *rng = gensvm_init_rng(42);
+
+	for (i=0; i<10000; i++) {
+		u = gensvm_rng_uniform(rng);
+		mu_assert(u >= 0.0 && u < 1.0, "Uniform value out of range");
+		mean += u/10000.0;
+	}
+	mu_assert(fabs(mean - 0.5) < 0.02, "Incorrect mean of uniform");
+
+	gensvm_free_rng(rng);
+	return NULL;
+}
+
+char *all_tests()
+{
+	mu_suite_start();
+	mu_run_test(test_init_free_rng);
+	mu_run_test(test_rng_seed);
+	mu_run_test(test_rng_derive);
+	mu_run_test(test_rng_bounded);
+	mu_run_test(test_rng_uniform);
+
+	return NULL;
+}
+
+RUN_TESTS(all_tests);
@@ -0,0 +1,269 @@
+/**
+ * @file test_gensvm_sample.c
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Unit tests for gensvm_sample.c functions
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+
+#include "minunit.h"
+#include "gensvm_sample.h"
+
+char *test_sobol_first_dim()
+{
+	long i;
+	double x[1];
+	double expected[8] = {0.0, 0.5, 0.75, 0.25, 0.375, 0.875, 0.625,
+		0.125};
+	struct GenSobol *sobol = gensvm_init_sobol(1);
+
+	// start test code //
+	for (i=0; i<8; i++) {
+		gensvm_sobol_next(sobol, x);
+		mu_assert(x[0] == expected[i], "Incorrect Sobol point");
+	}
+	// end test code //
+
+	gensvm_free_sobol(sobol);
+	return NULL;
+}
+
+char *test_sobol_stratified()
+{
+	long i, d, cell, N = 64;
+	long counts[GENSVM_SAMPLE_MAX_DIM][64] = {{0}};
+	long cells[64] = {0};
+	double x[GENSVM_SAMPLE_MAX_DIM];
+	struct GenSobol *sobol = gensvm_init_sobol(GENSVM_SAMPLE_MAX_DIM);
+
+	// start test code //
+	for (i=0; i<N; i++) {
+		gensvm_sobol_next(sobol, x);
+		for (d=0; d<GENSVM_SAMPLE_MAX_DIM; d++) {
+			mu_assert(x[d] >= 0.0 && x[d] < 1.0,
+					"Sobol point out of range");
+			counts[d][(long) (x[d] * N)]++;
+		}
+		cell = ((long) (x[0] * 8)) * 8 + ((long) (x[1] * 8));
+		cells[cell]++;
+	}
+	// every one-dimensional projection has one point per interval
+	for (d=0; d<GENSVM_SAMPLE_MAX_DIM; d++)
+		for (i=0; i<N; i++)
+			mu_assert(counts[d][i] == 1,
+					"Sobol projection not stratified");
+	// the first two dimensions form a (0, 6, 2)-net
+	for (i=0; i<64; i++)
+		mu_assert(cells[i] == 1, "Sobol points not a net");
+	// end test code //
+
+	gensvm_free_sobol(sobol);
+	return NULL;
+}
+
+char *test_halton()
+{
+	double eps = 1e-15;
+
+	// start test code //
+	mu_assert(fabs(gensvm_halton(1, 0) - 0.5) < eps, "Incorrect (1, 0)");
+	mu_assert(fabs(gensvm_halton(2, 0) - 0.25) < eps, "Incorrect (2, 0)");
+	mu_assert(fabs(gensvm_halton(3, 0) - 0.75) < eps, "Incorrect (3, 0)");
+	mu_assert(fabs(gensvm_halton(1, 1) - 1.0/3.0) < eps,
+			"Incorrect (1, 1)");
+	mu_assert(fabs(gensvm_halton(3, 1) - 1.0/9.0) < eps,
+			"Incorrect (3, 1)");
+	mu_assert(fabs(gensvm_halton(7, 2) - 11.0/25.0) < eps,
+			"Incorrect (7, 2)");
+	mu_assert(gensvm_halton(0, 7) == 0.0, "Incorrect (0, 7)");
+	// end test code //
+
+	return NULL;
+}
+
+struct GenGrid *make_sample_grid(SearchType search, long n_tasks)
+{
+	struct GenGrid *grid = gensvm_init_grid();
+
+	grid->search = search;
+	grid->n_tasks = n_tasks;
+	grid->folds = 7;
+	grid->kerneltype = K_RBF;
+	grid->Np = 2;
+	grid->ps = Calloc(double, 2);
+	grid->ps[0] = 2.0;
+	grid->ps[1] = 1.0;
+	grid->Nl = 3;
+	grid->lambdas = Calloc(double, 3);
+	grid->lambdas[0] = 1e-4;
+	grid->lambdas[1] = 1.0;
+	grid->lambdas[2] = 1e2;
+	grid->Nk = 1;
+	grid->kappas = Calloc(double, 1);
+	grid->kappas[0] = 0.5;
+	grid->Ne = 1;
+	grid->epsilons = Calloc(double, 1);
+	grid->epsilons[0] = 1e-6;
+	grid->Nw = 2;
+	grid->weight_idxs = Calloc(int, 2);
+	grid->weight_idxs[0] = 1;
+	grid->weight_idxs[1] = 2;
+	grid->Ng = 2;
+	grid->gammas = Calloc(double, 2);
+	grid->gammas[0] = 1e-3;
+	grid->gammas[1] = 1e3;
+
+	return grid;
+}
+
+char *test_sample_queue()
+{
+	long i, n_low = 0;
+	SearchType searches[3] = {S_RANDOM, S_SOBOL, S_HALTON};
+	struct GenTask *task = NULL;
+	struct GenGrid *grid = NULL;
+	struct GenQueue *q = NULL;
+	struct GenContext *ctx = gensvm_init_context(1);
+	long s;
+
+	// start test code //
+	for (s=0; s<3; s++) {
+		grid = make_sample_grid(searches[s], 32);
+		q = gensvm_init_queue();
+		gensvm_sample_queue(grid, q, NULL, NULL, ctx);
+
+		mu_assert(q->N == 32, "Incorrect queue size");
+		mu_assert(q->i == 0, "Incorrect queue index");
+		n_low = 0;
+		for (i=0; i<q->N; i++) {
+			task = q->tasks[i];
+			mu_assert(task->ID == i, "Incorrect ID");
+			mu_assert(task->folds == 7, "Incorrect folds");
+			mu_assert(task->kerneltype == K_RBF,
+					"Incorrect kernel");
+			mu_assert(1.0 <= task->p && task->p <= 2.0,
+					"p out of range");
+			mu_assert(1e-4 <= task->lambda && task->lambda <= 1e2,
+					"lambda out of range");
+			mu_assert(1e-3 <= task->gamma && task->gamma <= 1e3,
+					"gamma out of range");
+			mu_assert(task->kappa == 0.5, "kappa not fixed");
+			mu_assert(task->epsilon == 1e-6, "epsilon not fixed");
+			mu_assert(task->weight_idx == 1 ||
+					task->weight_idx == 2,
+					"Incorrect weight_idx");
+			n_low += (task->lambda < 1e-1);
+			if (i > 0)
+				mu_assert(q->tasks[i-1]->gamma <= task->gamma,
+						"Queue not sorted");
+		}
+		// log-uniform: half of the tasks below the midpoint 1e-1
+		mu_assert(8 <= n_low && n_low <= 24,
+				"lambda not sampled log-uniformly");
+
+		gensvm_free_queue(q);
+		gensvm_free_grid(grid);
+	}
+	// end test code //
+
+	gensvm_free_context(ctx);
+	return NULL;
+}
+
+char *test_sample_queue_reproducible()
+{
+	long i;
+	struct GenGrid *grid = make_sample_grid(S_RANDOM, 10);
+	struct GenQueue *q1 = gensvm_init_queue();
+	struct GenQueue *q2 = gensvm_init_queue();
+	struct GenContext *ctx = gensvm_init_context(5);
+
+	// start test code //
+	gensvm_sample_queue(grid, q1, NULL, NULL, ctx);
+	gensvm_context_seed(ctx, 5);
+	gensvm_sample_queue(grid, q2, NULL, NULL, ctx);
+	for (i=0; i<10; i++) {
+		mu_assert(q1->tasks[i]->lambda == q2->tasks[i]->lambda,
+				"Random search not reproducible");
+		mu_assert(q1->tasks[i]->gamma == q2->tasks[i]->gamma,
+				"Random search not reproducible");
+	}
+	// end test code //
+
+	gensvm_free_queue(q1);
+	gensvm_free_queue(q2);
+	gensvm_free_grid(grid);
+	gensvm_free_context(ctx);
+	return NULL;
+}
+
+char *test_sample_queue_sobol_kernel()
+{
+	long i, j, n_gamma = 0;
+	double gammas[32];
+	struct GenGrid *grid = make_sample_grid(S_SOBOL, 32);
+	struct GenQueue *q = gensvm_init_queue();
+
+	// start test code //
+	gensvm_sample_queue(grid, q, NULL, NULL, NULL);
+	for (i=0; i<q->N; i++) {
+		// the origin of the sequence is skipped
+		mu_assert(q->tasks[i]->lambda > 1e-4,
+				"Sobol search starts at the origin");
+		for (j=0; j<n_gamma; j++)
+			if (gammas[j] == q->tasks[i]->gamma)
+				break;
+		if (j == n_gamma)
+			gammas[n_gamma++] = q->tasks[i]->gamma;
+	}
+	mu_assert(n_gamma <= GENSVM_SAMPLE_KERNEL_LEVELS,
+			"gamma not rounded onto levels");
+	for (j=0; j<n_gamma; j++) {
+		for (i=0; i<GENSVM_SAMPLE_KERNEL_LEVELS; i++)
+			if (fabs(log10(gammas[j]) - (-3.0 + 6.0*i/
+						(GENSVM_SAMPLE_KERNEL_LEVELS-1)))
+					< 1e-12)
+				break;
+		mu_assert(i < GENSVM_SAMPLE_KERNEL_LEVELS,
+				"gamma not on a level");
+	}
+	// end test code //
+
+	gensvm_free_queue(q);
+	gensvm_free_grid(grid);
+	return NULL;
+}
+
+char *all_tests()
+{
+	mu_suite_start();
+	mu_run_test(test_sobol_first_dim);
+	mu_run_test(test_sobol_stratified);
+	mu_run_test(test_halton);
+	mu_run_test(test_sample_queue);
+	mu_run_test(test_sample_queue_reproducible);
+	mu_run_test(test_sample_queue_sobol_kernel);
+
+	return NULL;
+}
+
+RUN_TESTS(all_tests);
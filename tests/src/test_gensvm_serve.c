@@ -0,0 +1,359 @@
+/**
+ * @file test_gensvm_serve.c
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Unit tests for gensvm_serve.c functions
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "minunit.h"
+#include "gensvm_serve.h"
+#include "gensvm_train.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+extern FILE *GENSVM_ERROR_FILE;
+
+/**
+ * Generate a dataset with three classes and about a third of the feature
+ * values zero.
+ */
+struct GenData *serve_test_data(long n, unsigned int seed)
+{
+	long i, j;
+	double value;
+	struct GenData *data = gensvm_init_data();
+
+	data->n = n;
+	data->m = 4;
+	data->r = data->m;
+	data->K = 3;
+	data->RAW = Calloc(double, data->n*(data->m+1));
+	data->Z = data->RAW;
+	data->y = Calloc(long, data->n);
+	srand(seed);
+	for (i=0; i<data->n; i++) {
+		data->y[i] = i % data->K + 1;
+		matrix_set(data->RAW, data->m+1, i, 0, 1.0);
+		for (j=1; j<data->m+1; j++) {
+			value = ((double) rand())/RAND_MAX + 0.3*data->y[i]*j;
+			if (rand() % 3 == 0)
+				value = 0.0;
+			matrix_set(data->RAW, data->m+1, i, j, value);
+		}
+	}
+	return data;
+}
+
+/**
+ * Train a model and write it to a binary model file
+ */
+struct GenModel *serve_test_model(struct GenData *data, KernelType kernel,
+		char *filename)
+{
+	struct GenModel *model = gensvm_init_model();
+
+	model->kerneltype = kernel;
+	model->gamma = 0.5;
+	model->max_iter = 200;
+	model->seed = 123;
+	model->data_file = Calloc(char, GENSVM_MAX_LINE_LENGTH);
+	strcpy(model->data_file, "./data/test_serve_train.bin");
+	gensvm_train(model, data, NULL, NULL);
+	gensvm_write_model_binary(model, filename);
+
+	return model;
+}
+
+/**
+ * Connect to a socket
+ */
+int serve_connect(char *socket_path)
+{
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	struct sockaddr_un addr;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, socket_path);
+	if (connect(fd, (struct sockaddr *) &addr, sizeof(addr)) != 0) {
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+/**
+ * Send a request and read the response, returns the status
+ */
+int serve_request(int fd, int64_t model, struct GenData *data, bool sparse,
+		int64_t bad_index, int64_t *labels, double *ZV)
+{
+	long i, j, n = data->n,
+	     m = data->m;
+	int64_t nnz = 0,
+		*ia = Calloc(int64_t, n+1),
+		*ja = Calloc(int64_t, n*m);
+	double value,
+	       *values = Calloc(double, n*m),
+	       *rows = Calloc(double, n*m);
+	struct GenServeRequest request;
+	struct GenServeResponse response;
+
+	for (i=0; i<n; i++) {
+		ia[i] = nnz;
+		for (j=0; j<m; j++) {
+			value = matrix_get(data->RAW, m+1, i, j+1);
+			rows[i*m+j] = value;
+			if (value != 0) {
+				ja[nnz] = j;
+				values[nnz++] = value;
+			}
+		}
+	}
+	ia[n] = nnz;
+	if (bad_index >= 0)
+		ja[0] = bad_index;
+
+	request.magic = GENSVM_SERVE_MAGIC;
+	request.flags = sparse ? GENSVM_SERVE_SPARSE : 0;
+	request.model = model;
+	request.n = n;
+	request.m = m;
+	request.nnz = sparse ? nnz : 0;
+
+	send(fd, &request, sizeof(request), 0);
+	if (sparse) {
+		send(fd, ia, (n+1)*sizeof(int64_t), 0);
+		send(fd, ja, nnz*sizeof(int64_t), 0);
+		send(fd, values, nnz*sizeof(double), 0);
+	} else {
+		send(fd, rows, n*m*sizeof(double), 0);
+	}
+
+	recv(fd, &response, sizeof(response), MSG_WAITALL);
+	if (response.status == SERVE_OK) {
+		recv(fd, labels, n*sizeof(int64_t), MSG_WAITALL);
+		recv(fd, ZV, n*(response.K-1)*sizeof(double), MSG_WAITALL);
+	}
+
+	free(ia);
+	free(ja);
+	free(values);
+	free(rows);
+
+	return (response.magic == GENSVM_SERVE_MAGIC) ? response.status : -1;
+}
+
+char *test_gensvm_serve_linear()
+{
+	long i, K = 3;
+	int fd, fd2;
+	char *socket_path = "./data/test_serve.sock";
+	char *model_files[] = {"./data/test_serve_linear.bin"};
+	struct GenData *train = serve_test_data(90, 123);
+	struct GenData *test = serve_test_data(40, 321);
+	struct GenModel *model = serve_test_model(train, K_LINEAR,
+			model_files[0]);
+	struct GenModel *kernel = gensvm_init_model();
+	struct GenServer *server = NULL;
+	long *predy = Calloc(long, test->n);
+	double *ZV = Calloc(double, test->n*(K-1)),
+	       *served_ZV = Calloc(double, test->n*(K-1));
+	int64_t *labels = Calloc(int64_t, test->n);
+
+	gensvm_predict_labels(test, model, predy);
+	gensvm_calculate_ZV(model, test, ZV);
+
+	// start test code //
+	server = gensvm_init_server(model_files, 1, kernel, false, 0);
+	gensvm_serve_start(server, socket_path, 2);
+
+	fd = serve_connect(socket_path);
+	fd2 = serve_connect(socket_path);
+	mu_assert(fd >= 0 && fd2 >= 0, "Couldn't connect to the server");
+
+	mu_assert(serve_request(fd, 0, test, false, -1, labels, served_ZV)
+			== SERVE_OK, "Dense request failed");
+	for (i=0; i<test->n; i++)
+		mu_assert(labels[i] == predy[i], "Incorrect dense label");
+	for (i=0; i<test->n*(K-1); i++)
+		mu_assert(served_ZV[i] == ZV[i], "Incorrect dense ZV");
+
+	mu_assert(serve_request(fd2, 0, test, true, -1, labels, served_ZV)
+			== SERVE_OK, "Sparse request failed");
+	for (i=0; i<test->n; i++)
+		mu_assert(labels[i] == predy[i], "Incorrect sparse label");
+	for (i=0; i<test->n*(K-1); i++)
+		mu_assert(fabs(served_ZV[i] - ZV[i]) < 1e-12,
+				"Incorrect sparse ZV");
+
+	// errors don't close the connection
+	mu_assert(serve_request(fd, 1, test, false, -1, labels, served_ZV)
+			== SERVE_BAD_MODEL, "Model should be invalid");
+	mu_assert(serve_request(fd, 0, test, true, 4, labels, served_ZV)
+			== SERVE_BAD_INDEX, "Index should be invalid");
+	test->m = 3;
+	mu_assert(serve_request(fd, 0, test, false, -1, labels, served_ZV)
+			== SERVE_BAD_FEATURES, "Features should be invalid");
+	test->m = 4;
+	mu_assert(serve_request(fd, 0, test, false, -1, labels, served_ZV)
+			== SERVE_OK, "Request after errors failed");
+	for (i=0; i<test->n; i++)
+		mu_assert(labels[i] == predy[i], "Incorrect label after errors");
+
+	// the server closes the open connections when it stops
+	gensvm_serve_stop(server);
+	mu_assert(serve_connect(socket_path) < 0,
+			"Server should be stopped");
+	close(fd);
+	close(fd2);
+	gensvm_free_server(server);
+	// end test code //
+
+	remove(model_files[0]);
+	gensvm_free_model(model);
+	gensvm_free_model(kernel);
+	gensvm_free_data(train);
+	gensvm_free_data(test);
+	free(predy);
+	free(ZV);
+	free(served_ZV);
+	free(labels);
+
+	return NULL;
+}
+
+char *test_gensvm_serve_kernel_reload()
+{
+	long i, K = 3;
+	int fd;
+	char *socket_path = "./data/test_serve.sock";
+	char *model_files[] = {"./data/test_serve_rbf.bin"};
+	FILE *fid = NULL,
+	     *old = GENSVM_ERROR_FILE;
+	struct GenData *train = serve_test_data(60, 123);
+	struct GenData *linear_train = serve_test_data(60, 123);
+	struct GenData *test = serve_test_data(30, 321);
+	struct GenData *kernel_test = serve_test_data(30, 321);
+	struct GenModel *model = NULL;
+	struct GenModel *linear = NULL;
+	struct GenModel *kernel = gensvm_init_model();
+	struct GenServer *server = NULL;
+	long *predy = Calloc(long, test->n);
+	double *ZV = Calloc(double, test->n*(K-1)),
+	       *served_ZV = Calloc(double, test->n*(K-1));
+	int64_t *labels = Calloc(int64_t, test->n);
+
+	gensvm_write_data_binary(train, "./data/test_serve_train.bin");
+	model = serve_test_model(train, K_RBF, model_files[0]);
+	linear = serve_test_model(linear_train, K_LINEAR,
+			"./data/test_serve_rbf.tmp");
+
+	gensvm_kernel_postprocess(model, train, kernel_test);
+	gensvm_predict_labels(kernel_test, model, predy);
+	gensvm_calculate_ZV(model, kernel_test, ZV);
+
+	// start test code //
+	server = gensvm_init_server(model_files, 1, kernel, false, 0);
+	gensvm_serve_start(server, socket_path, 1);
+	fd = serve_connect(socket_path);
+	mu_assert(fd >= 0, "Couldn't connect to the server");
+
+	mu_assert(serve_request(fd, 0, test, false, -1, labels, served_ZV)
+			== SERVE_OK, "Kernel request failed");
+	for (i=0; i<test->n; i++)
+		mu_assert(labels[i] == predy[i], "Incorrect kernel label");
+	for (i=0; i<test->n*(K-1); i++)
+		mu_assert(fabs(served_ZV[i] - ZV[i]) < 1e-8,
+				"Incorrect kernel ZV");
+
+	mu_assert(serve_request(fd, 0, test, true, -1, labels, served_ZV)
+			== SERVE_OK, "Sparse kernel request failed");
+	for (i=0; i<test->n; i++)
+		mu_assert(labels[i] == predy[i],
+				"Incorrect sparse kernel label");
+
+	// replace the model file and reload
+	rename("./data/test_serve_rbf.tmp", model_files[0]);
+	mu_assert(gensvm_serve_reload(server), "Models not reloaded");
+	gensvm_predict_labels(test, linear, predy);
+	gensvm_calculate_ZV(linear, test, ZV);
+
+	mu_assert(serve_request(fd, 0, test, false, -1, labels, served_ZV)
+			== SERVE_OK, "Request after reload failed");
+	for (i=0; i<test->n; i++)
+		mu_assert(labels[i] == predy[i], "Incorrect label after reload");
+	for (i=0; i<test->n*(K-1); i++)
+		mu_assert(served_ZV[i] == ZV[i], "Incorrect ZV after reload");
+
+	// a corrupt or missing model file keeps the current models
+	GENSVM_ERROR_FILE = NULL;
+	fid = fopen("./data/test_serve_rbf.tmp", "w");
+	fprintf(fid, "not a model\n");
+	fclose(fid);
+	rename("./data/test_serve_rbf.tmp", model_files[0]);
+	mu_assert(!gensvm_serve_reload(server),
+			"Corrupt model file reloaded");
+	remove(model_files[0]);
+	mu_assert(!gensvm_serve_reload(server),
+			"Missing model file reloaded");
+	GENSVM_ERROR_FILE = old;
+
+	mu_assert(serve_request(fd, 0, test, false, -1, labels, served_ZV)
+			== SERVE_OK, "Request after failed reload failed");
+	for (i=0; i<test->n; i++)
+		mu_assert(labels[i] == predy[i],
+				"Incorrect label after failed reload");
+
+	close(fd);
+	gensvm_free_server(server);
+	// end test code //
+
+	remove(model_files[0]);
+	remove("./data/test_serve_train.bin");
+	gensvm_free_model(model);
+	gensvm_free_model(linear);
+	gensvm_free_model(kernel);
+	gensvm_free_data(train);
+	gensvm_free_data(linear_train);
+	gensvm_free_data(test);
+	gensvm_free_data(kernel_test);
+	free(predy);
+	free(ZV);
+	free(served_ZV);
+	free(labels);
+
+	return NULL;
+}
+
+char *all_tests()
+{
+	mu_suite_start();
+	mu_run_test(test_gensvm_serve_linear);
+	mu_run_test(test_gensvm_serve_kernel_reload);
+
+	return NULL;
+}
+
+RUN_TESTS(all_tests);
@@ -0,0 +1,365 @@
+/**
+ * @file test_gensvm_shard.c
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Unit tests for gensvm_shard.c functions
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+
+#include "minunit.h"
+#include "gensvm_shard.h"
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <utime.h>
+
+extern FILE *GENSVM_OUTPUT_FILE;
+extern FILE *GENSVM_ERROR_FILE;
+
+void remove_dir(char *dir)
+{
+	char path[GENSVM_MAX_LINE_LENGTH];
+	struct dirent *entry = NULL;
+	DIR *d = opendir(dir);
+
+	if (d == NULL)
+		return;
+	while ((entry = readdir(d)) != NULL) {
+		if (entry->d_name[0] == '.')
+			continue;
+		sprintf(path, "%s/%s", dir, entry->d_name);
+		remove(path);
+	}
+	closedir(d);
+	rmdir(dir);
+}
+
+struct GenQueue *make_queue(struct GenData *data, long N)
+{
+	long i, j;
+	struct GenQueue *q = gensvm_init_queue();
+
+	data->n = 12;
+	data->m = 2;
+	data->r = 2;
+	data->K = 3;
+	data->y = Malloc(long, data->n);
+	data->RAW = Calloc(double, data->n*(data->m+1));
+	for (i=0; i<data->n; i++) {
+		data->y[i] = 1 + (i % 3);
+		matrix_set(data->RAW, data->m+1, i, 0, 1.0);
+		for (j=1; j<data->m+1; j++)
+			matrix_set(data->RAW, data->m+1, i, j,
+					((i*7 + j*5) % 13)/13.0 +
+					(data->y[i] == j));
+	}
+	data->Z = data->RAW;
+
+	q->N = N;
+	q->tasks = Malloc(struct GenTask *, q->N);
+	for (i=0; i<q->N; i++) {
+		q->tasks[i] = gensvm_init_task();
+		q->tasks[i]->ID = i;
+		q->tasks[i]->folds = 3;
+		q->tasks[i]->lambda = pow(2.0, -i);
+		q->tasks[i]->performance = -1;
+		q->tasks[i]->train_data = data;
+	}
+
+	return q;
+}
+
+char *test_init_free_shard()
+{
+	char *dir = "./data/tmp_test_shard_init";
+	char *path = NULL;
+	struct GenShard *shard = NULL;
+
+	remove_dir(dir);
+	shard = gensvm_init_shard(dir, 42);
+	mu_assert(access(dir, F_OK) == 0, "Shard directory not created");
+	mu_assert(shard->seed == 42, "Incorrect seed");
+
+	path = gensvm_shard_path(shard, 12, "lease");
+	mu_assert(strcmp(path, "./data/tmp_test_shard_init/"
+				"chunk_000012.lease") == 0,
+			"Incorrect chunk path");
+	free(path);
+	path = gensvm_shard_path(shard, -1, "merge.lease");
+	mu_assert(strcmp(path, "./data/tmp_test_shard_init/merge.lease") == 0,
+			"Incorrect path");
+	free(path);
+
+	gensvm_free_shard(shard);
+	remove_dir(dir);
+
+	return NULL;
+}
+
+char *test_shard_claim()
+{
+	char *dir = "./data/tmp_test_shard_claim";
+	char *lease = NULL;
+	struct utimbuf times;
+	struct GenShard *shard = NULL;
+
+	remove_dir(dir);
+	shard = gensvm_init_shard(dir, 42);
+	shard->lease_time = 60;
+	lease = gensvm_shard_path(shard, 0, "lease");
+
+	mu_assert(gensvm_shard_claim(shard, 0) == true,
+			"Couldn't claim free chunk");
+	mu_assert(access(lease, F_OK) == 0, "Lease not created");
+	mu_assert(gensvm_shard_claim(shard, 0) == false,
+			"Claimed chunk with active lease");
+	mu_assert(gensvm_shard_claim(shard, 1) == true,
+			"Couldn't claim second chunk");
+
+	// let the lease of the first chunk expire
+	times.actime = time(NULL) - 120;
+	times.modtime = time(NULL) - 120;
+	utime(lease, &times);
+	mu_assert(gensvm_shard_claim(shard, 0) == true,
+			"Couldn't reclaim expired lease");
+	mu_assert(gensvm_shard_claim(shard, 0) == false,
+			"Claimed chunk with reclaimed lease");
+
+	// finished chunks can't be claimed
+	mu_assert(gensvm_shard_is_done(shard, 0) == false,
+			"Chunk done before finish");
+	gensvm_shard_finish(shard, 0);
+	mu_assert(gensvm_shard_is_done(shard, 0) == true,
+			"Chunk not done after finish");
+	mu_assert(access(lease, F_OK) != 0, "Lease not removed");
+	mu_assert(gensvm_shard_claim(shard, 0) == false,
+			"Claimed finished chunk");
+
+	free(lease);
+	gensvm_free_shard(shard);
+	remove_dir(dir);
+
+	return NULL;
+}
+
+char *test_shard_heartbeat()
+{
+	FILE *fid = NULL;
+	char *dir = "./data/tmp_test_shard_heartbeat";
+	char *lease = NULL;
+	struct stat st;
+	struct utimbuf times;
+	struct GenShard *shard = NULL;
+	struct GenShardHeartbeat *hb = NULL;
+
+	remove_dir(dir);
+	shard = gensvm_init_shard(dir, 42);
+	shard->lease_time = 4;
+	lease = gensvm_shard_path(shard, 0, "lease");
+
+	// the heartbeat keeps a lease active that would otherwise expire
+	mu_assert(gensvm_shard_claim(shard, 0) == true,
+			"Couldn't claim free chunk");
+	times.actime = time(NULL) - 120;
+	times.modtime = time(NULL) - 120;
+	utime(lease, &times);
+	hb = gensvm_shard_start_heartbeat(shard, lease);
+	sleep(2);
+	stat(lease, &st);
+	mu_assert(difftime(time(NULL), st.st_mtime) < 3,
+			"Lease not touched by heartbeat");
+	gensvm_shard_stop_heartbeat(hb);
+
+	// a lease of another worker isn't touched or removed
+	fid = fopen(lease, "w");
+	fprintf(fid, "other.1");
+	fclose(fid);
+	utime(lease, &times);
+	hb = gensvm_shard_start_heartbeat(shard, lease);
+	sleep(2);
+	gensvm_shard_stop_heartbeat(hb);
+	stat(lease, &st);
+	mu_assert(difftime(time(NULL), st.st_mtime) > 60,
+			"Lease of other worker touched");
+	GENSVM_ERROR_FILE = NULL;
+	gensvm_shard_finish(shard, 0);
+	GENSVM_ERROR_FILE = stderr;
+	mu_assert(access(lease, F_OK) == 0,
+			"Lease of other worker removed");
+
+	free(lease);
+	gensvm_free_shard(shard);
+	remove_dir(dir);
+
+	return NULL;
+}
+
+char *test_shard_processes()
+{
+	int status;
+	long i, n_merged = 0, n_workers = 3;
+	pid_t pid;
+	char *dir = "./data/tmp_test_shard_processes";
+	FILE *fid = GENSVM_OUTPUT_FILE;
+	struct GenData *data = gensvm_init_data();
+	struct GenQueue *q = make_queue(data, 7);
+	struct GenShard *shard = NULL;
+
+	GENSVM_OUTPUT_FILE = NULL;
+	remove_dir(dir);
+
+	// every worker process exits with status 1 if it merged the results
+	for (i=0; i<n_workers; i++) {
+		pid = fork();
+		mu_assert(pid >= 0, "Fork failed");
+		if (pid == 0) {
+			shard = gensvm_init_shard(dir, 1234);
+			shard->chunk_size = 2;
+			shard->poll_time = 1;
+			gensvm_shard_work(shard, q, NULL);
+			status = gensvm_shard_merge(shard, q, NULL);
+			for (i=0; i<q->N && status; i++)
+				if (q->tasks[i]->performance < 0)
+					status = 2;
+			gensvm_free_shard(shard);
+			_exit(status);
+		}
+	}
+	for (i=0; i<n_workers; i++) {
+		wait(&status);
+		mu_assert(WIFEXITED(status), "Worker didn't exit normally");
+		mu_assert(WEXITSTATUS(status) < 2,
+				"Merged results are incomplete");
+		n_merged += WEXITSTATUS(status);
+	}
+	mu_assert(n_merged == 1, "Results not merged by a single worker");
+	mu_assert(access("./data/tmp_test_shard_processes/merge.journal",
+				F_OK) == 0, "Merged journal not created");
+	mu_assert(access("./data/tmp_test_shard_processes/merge.lease",
+				F_OK) != 0, "Merge lease not removed");
+
+	for (i=0; i<4; i++) {
+		shard = gensvm_init_shard(dir, 1234);
+		shard->chunk_size = 2;
+		mu_assert(gensvm_shard_is_done(shard, i),
+				"Chunk not finished");
+		gensvm_free_shard(shard);
+	}
+
+	// merging again in this process reads all results from the journals
+	shard = gensvm_init_shard(dir, 1234);
+	shard->chunk_size = 2;
+	remove("./data/tmp_test_shard_processes/merge.journal");
+	mu_assert(gensvm_shard_merge(shard, q, NULL) == true,
+			"Merge not elected");
+	mu_assert(gensvm_shard_merge(shard, q, NULL) == false,
+			"Merge elected twice");
+	for (i=0; i<q->N; i++)
+		mu_assert(q->tasks[i]->performance >= 0,
+				"Performance not merged");
+	gensvm_free_shard(shard);
+
+	GENSVM_OUTPUT_FILE = fid;
+	remove_dir(dir);
+	gensvm_free_queue(q);
+	gensvm_free_data(data);
+
+	return NULL;
+}
+
+char *test_shard_merge_takeover()
+{
+	long i;
+	char *dir = "./data/tmp_test_shard_takeover";
+	char *lease = NULL,
+	     *merged = NULL;
+	FILE *fid = GENSVM_OUTPUT_FILE;
+	struct utimbuf times;
+	struct GenData *data = gensvm_init_data();
+	struct GenQueue *q = make_queue(data, 5);
+	struct GenShard *shard = NULL;
+	struct GenJournal *journal = NULL;
+
+	GENSVM_OUTPUT_FILE = NULL;
+	remove_dir(dir);
+	shard = gensvm_init_shard(dir, 1234);
+	shard->chunk_size = 2;
+	shard->lease_time = 60;
+	lease = gensvm_shard_path(shard, -1, "merge.lease");
+	merged = gensvm_shard_path(shard, -1, "merge.journal");
+
+	// start test code //
+	gensvm_shard_work(shard, q, NULL);
+
+	// the lease of a merging worker that stopped has expired
+	fclose(fopen(lease, "w"));
+	times.actime = time(NULL) - 120;
+	times.modtime = time(NULL) - 120;
+	utime(lease, &times);
+	for (i=0; i<q->N; i++)
+		q->tasks[i]->performance = -1;
+
+	mu_assert(gensvm_shard_merge(shard, q, NULL) == true,
+			"Expired merge lease not taken over");
+	mu_assert(access(lease, F_OK) != 0, "Merge lease not removed");
+	for (i=0; i<q->N; i++)
+		mu_assert(q->tasks[i]->performance >= 0,
+				"Performance not merged");
+
+	// the merged journal has all tasks
+	journal = gensvm_init_journal();
+	gensvm_journal_read(journal, merged);
+	mu_assert(journal->N == q->N, "Incorrect merged journal");
+	gensvm_free_journal(journal);
+
+	// a lease taken after the merge finished is not a new merge
+	fclose(fopen(lease, "w"));
+	mu_assert(gensvm_shard_merge(shard, q, NULL) == false,
+			"Merged twice");
+	// end test code //
+
+	GENSVM_OUTPUT_FILE = fid;
+	free(lease);
+	free(merged);
+	gensvm_free_shard(shard);
+	remove_dir(dir);
+	gensvm_free_queue(q);
+	gensvm_free_data(data);
+
+	return NULL;
+}
+
+char *all_tests()
+{
+	mu_suite_start();
+	mu_run_test(test_init_free_shard);
+	mu_run_test(test_shard_claim);
+	mu_run_test(test_shard_heartbeat);
+	mu_run_test(test_shard_processes);
+	mu_run_test(test_shard_merge_takeover);
+
+	return NULL;
+}
+
+RUN_TESTS(all_tests);
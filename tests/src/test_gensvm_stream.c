@@ -0,0 +1,219 @@
+/**
+ * @file test_gensvm_stream.c
+ * @author G.J.J. van den Burg
+ * @date 2026-10-18
+ * @brief Unit tests for gensvm_stream.c functions
+ *
+ * @copyright
+ Copyright 2016, G.J.J. van den Burg.
+
+ This file is part of GenSVM.
+
+ GenSVM is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ GenSVM is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GenSVM. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "minunit.h"
+#include "gensvm_stream.h"
+#include "gensvm_io.h"
+#include "gensvm_train.h"
+
+/**
+ * Generate a dataset that spans several blocks of rows, with roughly half of
+ * the feature values zero.
+ */
+struct GenData *stream_test_data()
+{
+	long i, j;
+	double value;
+	struct GenData *data = gensvm_init_data();
+
+	data->n = 3*GENSVM_BLOCK_SIZE + 17;
+	data->m = 4;
+	data->r = data->m;
+	data->K = 3;
+	data->RAW = Calloc(double, data->n*(data->m+1));
+	data->Z = data->RAW;
+	data->y = Calloc(long, data->n);
+
+	for (i=0; i<data->n; i++) {
+		data->y[i] = i % data->K + 1;
+		matrix_set(data->RAW, data->m+1, i, 0, 1.0);
+		for (j=1; j<data->m+1; j++) {
+			value = sin(1.3*i + 0.7*j) + 0.5*data->y[i]*j;
+			if ((i + j) % 2 == 0)
+				value = 0.0;
+			matrix_set(data->RAW, data->m+1, i, j, value);
+		}
+	}
+	return data;
+}
+
+struct GenModel *stream_test_model()
+{
+	struct GenModel *model = gensvm_init_model();
+
+	model->p = 1.5;
+	model->kappa = 0.5;
+	model->lambda = 0.01;
+	model->epsilon = 1e-8;
+	model->weight_idx = 1;
+	model->kerneltype = K_LINEAR;
+	model->seed = 123;
+
+	return model;
+}
+
+char *test_gensvm_stream_no_map()
+{
+	long i, j;
+	struct GenData *data = stream_test_data();
+	struct GenData *copy = stream_test_data();
+
+	// start test code //
+	data->out_of_core = true;
+	gensvm_stream_prefetch(data, 0, data->n);
+	gensvm_stream_release(data, 0, data->n);
+	gensvm_stream_release(data, -10, 2*data->n);
+	for (i=0; i<data->n; i++) {
+		for (j=0; j<data->m+1; j++) {
+			mu_assert(matrix_get(data->Z, data->m+1, i, j) ==
+					matrix_get(copy->Z, copy->m+1, i, j),
+					"Incorrect Z value");
+		}
+	}
+	// end test code //
+
+	gensvm_free_data(data);
+	gensvm_free_data(copy);
+	return NULL;
+}
+
+char *test_gensvm_stream_release_dense()
+{
+	long i, j;
+	char *filename = "./data/test_file_stream_dense.bin";
+	struct GenData *text = stream_test_data();
+	struct GenData *data = gensvm_init_data();
+
+	gensvm_write_data_binary(text, filename);
+	gensvm_read_data_binary(data, filename);
+	data->out_of_core = true;
+
+	// start test code //
+	mu_assert(gensvm_map_contains(data->map, data->Z), "Z is not mapped");
+	gensvm_stream_prefetch(data, 0, GENSVM_BLOCK_SIZE);
+	gensvm_stream_release(data, 0, data->n);
+	for (i=0; i<data->n; i++) {
+		for (j=0; j<data->m+1; j++) {
+			mu_assert(matrix_get(data->Z, data->m+1, i, j) ==
+					matrix_get(text->Z, text->m+1, i, j),
+					"Incorrect Z value after release");
+		}
+	}
+	// end test code //
+
+	remove(filename);
+	gensvm_free_data(data);
+	gensvm_free_data(text);
+	return NULL;
+}
+
+char *test_gensvm_stream_train_dense()
+{
+	long i;
+	char *filename = "./data/test_file_stream_train_dense.bin";
+	struct GenData *text = stream_test_data();
+	struct GenData *data = gensvm_init_data();
+	struct GenModel *model = stream_test_model();
+	struct GenModel *stream_model = stream_test_model();
+
+	gensvm_write_data_binary(text, filename);
+	gensvm_read_data_binary(data, filename);
+	data->out_of_core = true;
+
+	// start test code //
+	srand(123);
+	gensvm_train(model, text, NULL, NULL);
+	srand(123);
+	gensvm_train(stream_model, data, NULL, NULL);
+
+	mu_assert(model->elapsed_iter == stream_model->elapsed_iter,
+			"Incorrect number of iterations");
+	for (i=0; i<(model->m+1)*(model->K-1); i++) {
+		mu_assert(fabs(model->V[i] - stream_model->V[i]) < 1e-10,
+				"Incorrect V value");
+	}
+	// end test code //
+
+	remove(filename);
+	gensvm_free_model(model);
+	gensvm_free_model(stream_model);
+	gensvm_free_data(data);
+	gensvm_free_data(text);
+	return NULL;
+}
+
+char *test_gensvm_stream_train_sparse()
+{
+	long i;
+	char *filename = "./data/test_file_stream_train_sparse.bin";
+	struct GenData *text = stream_test_data();
+	struct GenData *data = gensvm_init_data();
+	struct GenModel *model = stream_test_model();
+	struct GenModel *stream_model = stream_test_model();
+
+	text->spZ = gensvm_dense_to_sparse(text->RAW, text->n, text->m+1);
+	gensvm_write_data_binary(text, filename);
+	gensvm_read_data_binary(data, filename);
+	data->out_of_core = true;
+
+	// start test code //
+	mu_assert(data->Z == NULL, "Z is not NULL");
+	mu_assert(gensvm_map_contains(data->map, data->spZ->values),
+			"spZ is not mapped");
+
+	srand(123);
+	gensvm_train(model, text, NULL, NULL);
+	srand(123);
+	gensvm_train(stream_model, data, NULL, NULL);
+
+	mu_assert(model->elapsed_iter == stream_model->elapsed_iter,
+			"Incorrect number of iterations");
+	for (i=0; i<(model->m+1)*(model->K-1); i++) {
+		mu_assert(fabs(model->V[i] - stream_model->V[i]) < 1e-10,
+				"Incorrect V value");
+	}
+	// end test code //
+
+	remove(filename);
+	gensvm_free_model(model);
+	gensvm_free_model(stream_model);
+	gensvm_free_data(data);
+	gensvm_free_data(text);
+	return NULL;
+}
+
+char *all_tests()
+{
+	mu_suite_start();
+	mu_run_test(test_gensvm_stream_no_map);
+	mu_run_test(test_gensvm_stream_release_dense);
+	mu_run_test(test_gensvm_stream_train_dense);
+	mu_run_test(test_gensvm_stream_train_sparse);
+
+	return NULL;
+}
+
+RUN_TESTS(all_tests);
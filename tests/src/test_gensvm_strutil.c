@@ -269,6 +269,24 @@ char *test_all_longs_str()
 	return NULL;
 }
 
+char *test_str_to_bytes()
+{
+	mu_assert(str_to_bytes("1000") == 1000, "incorrect bytes (1)");
+	mu_assert(str_to_bytes("4K") == 4096, "incorrect bytes (2)");
+	mu_assert(str_to_bytes("512m") == 512UL*1024*1024,
+			"incorrect bytes (3)");
+	mu_assert(str_to_bytes("1.5G") == 3*512UL*1024*1024,
+			"incorrect bytes (4)");
+	mu_assert(str_to_bytes("2TB") == 2UL*1024*1024*1024*1024,
+			"incorrect bytes (5)");
+	mu_assert(str_to_bytes("") == 0, "incorrect bytes (6)");
+	mu_assert(str_to_bytes("G") == 0, "incorrect bytes (7)");
+	mu_assert(str_to_bytes("10X") == 0, "incorrect bytes (8)");
+	mu_assert(str_to_bytes("-1G") == 0, "incorrect bytes (9)");
+
+	return NULL;
+}
+
 char *all_tests()
 {
 	mu_suite_start();
@@ -280,6 +298,7 @@ char *all_tests()
 	mu_run_test(test_get_fmt_long);
 	mu_run_test(test_all_doubles_str);
 	mu_run_test(test_all_longs_str);
+	mu_run_test(test_str_to_bytes);
 
 	return NULL;
 }
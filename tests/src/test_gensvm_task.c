@@ -47,6 +47,7 @@ char *test_task_to_model_linear()
 	task->epsilon = 5e-3;
 	task->kerneltype = K_LINEAR;
 	task->max_iter = 100;
+	task->temperature = 0.5;
 
 	gensvm_task_to_model(task, model);
 
@@ -57,6 +58,7 @@ char *test_task_to_model_linear()
 	mu_assert(model->epsilon == 5e-3, "Incorrect model epsilon");
 	mu_assert(model->kerneltype == K_LINEAR, "Incorrect model kerneltype");
 	mu_assert(model->max_iter == 100, "Incorrect model max_iter");
+	mu_assert(model->temperature == 0.5, "Incorrect model temperature");
 	// end test code //
 
 	gensvm_free_model(model);
@@ -179,6 +181,7 @@ char *test_copy_task_linear()
 	task->train_data = train;
 	task->test_data = test;
 	task->performance = 11.11;
+	task->temperature = 0.75;
 
 	copy = gensvm_copy_task(task);
 
@@ -192,6 +195,7 @@ char *test_copy_task_linear()
 	mu_assert(copy->train_data == train, "Incorrect copy train data");
 	mu_assert(copy->test_data == test, "Incorrect copy test data");
 	mu_assert(copy->performance == 11.11, "Incorrect copy performance");
+	mu_assert(copy->temperature == 0.75, "Incorrect copy temperature");
 	mu_assert(copy->kerneltype == K_LINEAR, "Incorrect copy kerneltype");
 
 	// end test code //
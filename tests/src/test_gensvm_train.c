@@ -27,6 +27,8 @@
 #include "minunit.h"
 #include "gensvm_train.h"
 
+#include <pthread.h>
+
 char *test_gensvm_train_seed_linear()
 {
 	struct GenModel *model = gensvm_init_model();
@@ -119,7 +121,7 @@ char *test_gensvm_train_seed_linear()
 	matrix_set(seed->V, data->K-1, 3, 2, 0.2665038412777220);
 
 	// start test code //
-	gensvm_train(model, data, seed);
+	gensvm_train(model, data, seed, NULL);
 
 	mu_assert(model->n == data->n, "Incorrect model n");
 	mu_assert(model->m == data->m, "Incorrect model m");
@@ -273,7 +275,7 @@ char *test_gensvm_train_seed_kernel()
 
 	// start test code //
 
-	gensvm_train(model, data, seed);
+	gensvm_train(model, data, seed, NULL);
 
 	mu_assert(model->n == data->n, "Incorrect model n");
 	mu_assert(model->m == data->r, "Incorrect model m");
@@ -379,12 +381,91 @@ char *test_gensvm_train_seed_kernel()
 	return NULL;
 }
 
+struct TrainArg {
+	struct GenModel *model;
+	struct GenData *data;
+	struct GenContext *ctx;
+};
+
+void *train_thread(void *arg)
+{
+	struct TrainArg *a = arg;
+	gensvm_train(a->model, a->data, NULL, a->ctx);
+	return NULL;
+}
+
+char *test_gensvm_train_context()
+{
+	long i, j, t, n = 60, m = 3, K = 3;
+	struct GenData *data = gensvm_init_data();
+	struct GenContext *gen = gensvm_init_context(7);
+	struct GenModel *models[3];
+	struct GenContext *ctxs[3];
+	struct TrainArg args[3];
+	pthread_t threads[3];
+
+	data->n = n;
+	data->m = m;
+	data->K = K;
+	data->RAW = Calloc(double, n*(m+1));
+	data->Z = data->RAW;
+	data->y = Calloc(long, n);
+	for (i=0; i<n; i++) {
+		data->y[i] = i % K + 1;
+		matrix_set(data->Z, m+1, i, 0, 1.0);
+		for (j=1; j<m+1; j++)
+			matrix_set(data->Z, m+1, i, j, data->y[i] * (j == 1) +
+					gensvm_context_uniform(gen));
+	}
+
+	for (t=0; t<3; t++) {
+		models[t] = gensvm_init_model();
+		models[t]->seed = 123;
+		models[t]->epsilon = 1e-8;
+		ctxs[t] = gensvm_init_context(t);
+	}
+
+	// start test code //
+	// a sequential run as reference
+	gensvm_train(models[0], data, NULL, ctxs[0]);
+
+	// two concurrent runs with their own context
+	for (t=1; t<3; t++) {
+		args[t].model = models[t];
+		args[t].data = data;
+		args[t].ctx = ctxs[t];
+		pthread_create(&threads[t], NULL, train_thread, &args[t]);
+	}
+	for (t=1; t<3; t++)
+		pthread_join(threads[t], NULL);
+
+	for (t=1; t<3; t++) {
+		for (i=0; i<(m+1)*(K-1); i++)
+			mu_assert(models[t]->V[i] == models[0]->V[i],
+					"Concurrent training differs");
+		mu_assert(models[t]->elapsed_iter ==
+				models[0]->elapsed_iter,
+				"Incorrect number of iterations");
+	}
+	// end test code //
+
+	for (t=0; t<3; t++) {
+		gensvm_free_model(models[t]);
+		gensvm_free_context(ctxs[t]);
+	}
+	gensvm_free_context(gen);
+	gensvm_free_data(data);
+
+	return NULL;
+}
+
 char *all_tests()
 {
 	mu_suite_start();
 
 	mu_run_test(test_gensvm_train_seed_linear);
 	mu_run_test(test_gensvm_train_seed_kernel);
+	mu_run_test(test_gensvm_train_context);
 
 	return NULL;
 }